@@ -1,6 +1,55 @@
 #ifndef COLLISION_H
 #define COLLISION_H
 
+#include <stdint.h>
+
+#include "tile_flags.h"
+
+// Cached per-room collision map: one byte of TF_* flags and one shape table
+// offset per metatile cell, rebuilt on room load. Pixel coordinates are
+// room-relative; cells outside the room read as 0 (open) so movers can
+// detect edge exits.
+#define COLL_MAX_W 20
+#define COLL_MAX_H 12
+
+// Flags that follow the tile's collision shape; the rest cover the whole cell.
+#define COLL_SHAPED_FLAGS (TF_SOLID | TF_STANDABLE | TF_FLOOR)
+
+// TF_PLATE lives above the cached flag byte, so it rides in the low nibble
+// of the cell's shape offset (slot * 16 leaves those bits free).
+#define COLL_PLATE 0x01u
+
+// Moving platform decks (src/platform.c): 16x16 boxes, one-way STANDABLE
+// from above. Cells a deck overlaps are marked with COLL_DECK and
+// TF_STANDABLE, so only probes in those cells scan the deck list.
+#define COLL_DECK 0x02u
+#define COLL_DECKS 4
+extern uint16_t collision_deck_x[COLL_DECKS];
+extern uint16_t collision_deck_y[COLL_DECKS];
+extern uint8_t collision_deck_count;
+
+// Set by collision_at when it reports a shaped flag: room y of the first and
+// one past the last solid pixel in the probed column of that cell.
+extern uint16_t collision_top_y;
+extern uint16_t collision_bottom_y;
+
+// Room y of the water surface (src/water.c); every pixel at or below it is
+// water. COLL_NO_WATER when the room is dry. A compare, not a probe.
+#define COLL_NO_WATER 0xFFFFu
+extern uint16_t collision_water_y;
+#define collision_in_water(py) ((uint16_t)(py) >= collision_water_y)
+
+void collision_build(void);
+void collision_refresh_cell(uint8_t mx, uint8_t my);
+// Marks cell mx,my on both planes as overlapped by a deck; collision_refresh_cell
+// clears the mark.
+void collision_mark_deck(uint8_t mx, uint8_t my);
+// Switches probes to the plane of room layer 0 (MAP) or 1 (ALTMAP).
+void collision_select_layer(uint8_t layer);
+uint8_t collision_at(uint16_t px, uint16_t py);
+uint8_t collision_cell(uint8_t mx, uint8_t my);
+// Non-zero when cell mx,my holds a PLATE tile on the active layer.
+uint8_t collision_plate(uint8_t mx, uint8_t my);
 void collision_update(void);
 
 #endif
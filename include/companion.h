@@ -0,0 +1,35 @@
+#ifndef COMPANION_H
+#define COMPANION_H
+
+#include "common.h"
+
+// Companion NPC (LEVEL companion=, ACT COMPANION FOLLOW|STAY). Instead of
+// pathfinding it replays the player's own path: the player drops a
+// breadcrumb every frame it moves and the companion walks COMPANION_DELAY
+// crumbs behind. Crumbs carry the room, so the companion changes rooms at
+// the crumb where the player took the exit.
+
+// Ring size (power of two) and the lag in crumbs. Crumbs older than the lag
+// are never read again, so the ring only has to cover the lag, not a whole
+// room crossing (256 crumbs at the run speed). At 1.25 px per crumb the
+// companion trails the player by about 30 px.
+#define COMPANION_TRAIL 32
+#define COMPANION_DELAY 24
+// Glide speed in px/frame while catching up with the trail after STAY.
+#define COMPANION_CATCHUP 3
+
+enum {
+    COMPANION_STAY = 0,
+    COMPANION_FOLLOW = 1
+};
+
+void companion_init(void);
+// A_COMPANION: FOLLOW restarts the trail from the player's next step.
+void companion_set_mode(uint8_t mode);
+// Player body position after its physics step; ignored when unchanged.
+void companion_trail_push(uint16_t x, uint16_t y);
+// Room load: shows the sprite only when the companion is in the new room.
+void companion_room_enter(void);
+void companion_update(void);
+
+#endif
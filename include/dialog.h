@@ -0,0 +1,20 @@
+#ifndef DIALOG_H
+#define DIALOG_H
+
+#include "common.h"
+
+// Dialogue graphs (levelc DIALOG, opened by ACT DIALOG). Nodes are read
+// straight from the blob as they are walked: RAM holds the open node's
+// offset, the mask of choices whose COND passed and the highlighted one.
+// A node's message shows in the textbox; Fire then either moves on to its
+// `next` node or lists its choices on the same row (Left/Right or Up/Down
+// to cycle, Fire to pick).
+
+// A_DIALOG: opens the node at `node` in the dialog block.
+void dialog_start(uint16_t node);
+// Non-zero while a dialog owns Fire and the joystick.
+uint8_t dialog_active(void);
+// Called by game_tick before player_update.
+void dialog_update(void);
+
+#endif
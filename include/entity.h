@@ -1,7 +1,27 @@
 #ifndef ENTITY_H
 #define ENTITY_H
 
+#include "common.h"
+
+// Entities: the companion plus the room's scripted NPCs (levelc NPC/NPCS).
+// An NPC runs its type's behaviour bytecode from the blob; there is no C
+// per NPC type. Each frame an NPC executes at most NPC_OPS_PER_FRAME ops
+// and stops early at a blocking op (MOVETO short of its cell, WAIT, YIELD,
+// STOP), resuming there next frame, so the per-frame cost depends on the
+// number of NPCs in the room only.
+
+// Ops per NPC per frame; a loop without YIELD just spreads over frames.
+// Keep in sync with levelc NPC_OPS_PER_FRAME.
+#define NPC_OPS_PER_FRAME 4
+
 void entity_init(void);
+// Called by room_load_with_spawn after laser_room_enter, which has already
+// hidden sprites 2..7; NPCs take sprites from 7 down.
+void entity_room_enter(void);
 void entity_update(void);
+// Knockback in px from an NPC's FIRE for a body centred on room pixel
+// (px, py), 0 = not hit. A shot lasts until the next entity_update; the
+// position is also what FACE PLAYER turns toward.
+int8_t entity_hit(uint16_t px, uint16_t py);
 
 #endif
@@ -1,7 +1,16 @@
 #ifndef IRQ_H
 #define IRQ_H
 
+// Raster IRQ slots (c64/rasterirq.h) by owner.
+enum {
+    IRQ_SLOT_WATER_SPLIT = 0,
+    IRQ_SLOT_WATER_RESTORE = 1
+};
+
 void irq_init(void);
 void kernal_irq_disable(void);
+// Starts the raster IRQ chain on first use, so levels that need no split
+// never run it.
+void irq_raster_start(void);
 
 #endif
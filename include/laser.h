@@ -0,0 +1,26 @@
+#ifndef LASER_H
+#define LASER_H
+
+#include "common.h"
+
+// Sweeping laser hazards (levelc LASERS). levelc compiles each beam's whole
+// sweep into a step table: the VIC position of its expanded sprites and a
+// mask of the cells it covers. A frame advances the index and tests one mask
+// bit at the player's cell; nothing about the beam is computed here.
+
+// Frames after a hit during which beams are harmless, so one pass knocks
+// the player back once.
+#define LASER_COOLDOWN 24
+
+// Copies the beam images next to the player's and companion's sprites.
+void laser_init(void);
+// Called by room_load_with_spawn: hides the last room's beams, shows this room's.
+void laser_room_enter(void);
+// Called by puzzle_flag_set/clear when a level flag actually changes.
+void laser_flag_changed(uint8_t flag_id);
+// Steps every beam due this frame.
+void laser_update(void);
+// Knockback in px for a body centred on room pixel (px, py), 0 = not hit.
+int8_t laser_hit(uint16_t px, uint16_t py);
+
+#endif
@@ -9,9 +9,9 @@
 #define LVL_MAGIC_1 'V'
 #define LVL_MAGIC_2 'L'
 #define LVL_MAGIC_3 '1'
-#define LVL_VERSION 1
+#define LVL_VERSION 12
 
-#define LVL_HEADER_SIZE 22
+#define LVL_HEADER_SIZE 46
 #define LVL_ROOM_DIRENTRY_SIZE 8
 #define LVL_OBJ_RECORD_SIZE 22
 
@@ -30,6 +30,19 @@
 #define LVL_HDR_OFS_CONDSTREAM   16
 #define LVL_HDR_OFS_ACTSTREAM    18
 #define LVL_HDR_OFS_MSGTABLE     20
+#define LVL_HDR_OFS_PAGES        22   /* 0 = unpaged */
+#define LVL_HDR_OFS_STATES       24   /* 0 = no tile states */
+#define LVL_HDR_OFS_LAYERS       26   /* 0 = no alternate layer */
+#define LVL_HDR_OFS_WATER        28   /* 0 = no water */
+#define LVL_HDR_OFS_WIND         30   /* 0 = no wind */
+#define LVL_HDR_OFS_COMPANION_ROOM  32  /* LVL_COMPANION_NONE = no companion */
+#define LVL_HDR_OFS_COMPANION_SPAWN 33
+#define LVL_HDR_OFS_PLATES       34   /* 0 = no pressure plates */
+#define LVL_HDR_OFS_ROUTES       36   /* 0 = no routing graphs */
+#define LVL_HDR_OFS_PLATFORMS    38   /* 0 = no moving platforms */
+#define LVL_HDR_OFS_LASERS       40   /* 0 = no sweeping lasers */
+#define LVL_HDR_OFS_DIALOGS      42   /* 0 = no dialogue graphs */
+#define LVL_HDR_OFS_NPCS         44   /* 0 = no scripted NPCs */
 
 /* Object record field offsets (byte offsets relative to object record base) */
 #define LVL_OBJ_OFS_X        0
@@ -54,6 +67,9 @@
 #define C_FLAG_CLR  3
 #define C_HAS_ITEM  4
 #define C_VAR_EQ    5
+#define C_FLAG_SET_W 6  /* [op, id lo, id hi] wide flag id */
+#define C_FLAG_CLR_W 7
+#define C_VAR_EQ_C   8  /* [op, campaign var, value] */
 
 /* Action opcodes (bytecode triples [op,a,b]) */
 #define A_END        0
@@ -65,6 +81,29 @@
 #define A_SET_VAR    6
 #define A_SFX        7
 #define A_TRANSITION 8
+#define A_SET_FLAG_W 9  /* [op, id lo, id hi] wide flag id */
+#define A_CLR_FLAG_W 10
+#define A_SET_VAR_C  11  /* [op, campaign var, value] */
+#define A_COMPANION  12  /* [op, mode]: 0 = stay, 1 = follow */
+#define A_PARTICLES  13  /* [op, x | kind << 5, y | (n - 1) << 4]: burst at map cell x,y */
+#define A_DIALOG     14  /* [op, node lo, node hi]: open a dialog node */
+
+/* NPC behaviour opcodes (bytecode triples [op,a,b]; targets are op indexes) */
+#define N_STOP   0
+#define N_YIELD  1
+#define N_WAIT   2  /* [op, frames] */
+#define N_MOVETO 3  /* [op, x, y]: walk to map cell x,y */
+#define N_FACE   4  /* [op, LVL_NPC_FACE_*] */
+#define N_FIRE   5  /* [op, range cells, push px] */
+#define N_ANIM   6  /* [op, image] */
+#define N_IFSET  7  /* [op, flag, target] */
+#define N_IFCLR  8  /* [op, flag, target] */
+#define N_GOTO   9  /* [op, target] */
+
+/* Wide flag ids: bit 15 selects the campaign tier (persists across levels) */
+#define LVL_FLAG_WIDE_CAMPAIGN  0x8000u
+#define LVL_CAMPAIGN_MAX_FLAGS  1024
+#define LVL_CAMPAIGN_MAX_VARS   64
 
 /* Verbs bitmask */
 #define VB_LOOK    (1<<0)
@@ -141,3 +180,337 @@ static inline uint8_t lvl_objects_count(const uint8_t* b, uint16_t objsOfs) {
 static inline uint16_t lvl_object_base(const uint8_t* b, uint16_t objsOfs, uint8_t idx) {
   return (uint16_t)(objsOfs + 1 + (uint16_t)idx * LVL_OBJ_RECORD_SIZE);
 }
+
+/* Tile pages (tilesets with more than 256 metatiles): map bytes index the
+   room's page, a list of up to 256 tileset ids.
+   u8 page_count, u8 room_page[room_count], u16 list_ofs[page_count];
+   each list: u16 count, u16 tile_id[count]. */
+static inline uint16_t lvl_pages_ofs(const uint8_t* b) {
+  return lvl_rd16(b, LVL_HDR_OFS_PAGES);
+}
+static inline uint8_t lvl_room_page(const uint8_t* b, uint16_t pagesOfs, uint8_t roomId) {
+  return lvl_rd8(b, (uint16_t)(pagesOfs + 1u + roomId));
+}
+static inline uint16_t lvl_page_list_ofs(const uint8_t* b, uint16_t pagesOfs, uint8_t page) {
+  uint16_t table = (uint16_t)(pagesOfs + 1u + lvl_rd8(b, LVL_HDR_OFS_ROOMCOUNT));
+  return lvl_rd16(b, (uint16_t)(table + (uint16_t)page * 2u));
+}
+
+/* Flag-bound tile states: u8 count, u8 start[flag_count + 1], then records
+   sorted by flag. Records start[f]..start[f+1]-1 belong to flag f; while it
+   is set, cell x,y of room shows tile (a map byte, page-local when paged). */
+#define LVL_STATE_RECORD_SIZE 4
+#define LVL_STATE_OFS_ROOM 0
+#define LVL_STATE_OFS_X    1
+#define LVL_STATE_OFS_Y    2
+#define LVL_STATE_OFS_TILE 3
+
+static inline uint16_t lvl_states_ofs(const uint8_t* b) {
+  return lvl_rd16(b, LVL_HDR_OFS_STATES);
+}
+static inline uint8_t lvl_states_count(const uint8_t* b, uint16_t statesOfs) {
+  return lvl_rd8(b, statesOfs);
+}
+static inline uint8_t lvl_states_first(const uint8_t* b, uint16_t statesOfs, uint8_t flagId) {
+  return lvl_rd8(b, (uint16_t)(statesOfs + 1u + flagId));
+}
+static inline uint16_t lvl_state_base(const uint8_t* b, uint16_t statesOfs, uint8_t index) {
+  return (uint16_t)(statesOfs + 2u + lvl_rd8(b, LVL_HDR_OFS_FLAGCOUNT) + (uint16_t)index * LVL_STATE_RECORD_SIZE);
+}
+
+/* Alternate layer (ALTMAP): u8 layer_flag, u16 diff_ofs[room_count]
+   (0 = room identical on both layers); each diff: u8 count, then
+   [x, y, tile] records in row-major order. */
+#define LVL_LAYER_RECORD_SIZE 3
+
+static inline uint16_t lvl_layers_ofs(const uint8_t* b) {
+  return lvl_rd16(b, LVL_HDR_OFS_LAYERS);
+}
+static inline uint8_t lvl_layer_flag(const uint8_t* b, uint16_t layersOfs) {
+  return lvl_rd8(b, layersOfs);
+}
+static inline uint16_t lvl_layer_diff_ofs(const uint8_t* b, uint16_t layersOfs, uint8_t roomId) {
+  return lvl_rd16(b, (uint16_t)(layersOfs + 1u + (uint16_t)roomId * 2u));
+}
+
+/* Water: u8 var, u8 bg, u8 mc1, u8 mc2, u8 level_count, then
+   u8 line[room_count][level_count]: room pixel y of the surface for each
+   value of var, LVL_WATER_DRY = no water. */
+#define LVL_WATER_DRY 0xFF
+#define LVL_WATER_OFS_VAR    0
+#define LVL_WATER_OFS_BG     1
+#define LVL_WATER_OFS_MC1    2
+#define LVL_WATER_OFS_MC2    3
+#define LVL_WATER_OFS_LEVELS 4
+#define LVL_WATER_OFS_TABLE  5
+
+static inline uint16_t lvl_water_ofs(const uint8_t* b) {
+  return lvl_rd16(b, LVL_HDR_OFS_WATER);
+}
+static inline uint8_t lvl_water_line(const uint8_t* b, uint16_t waterOfs, uint8_t roomId, uint8_t level) {
+  uint8_t levels = lvl_rd8(b, (uint16_t)(waterOfs + LVL_WATER_OFS_LEVELS));
+  if (level >= levels) {
+    level = (uint8_t)(levels - 1u);
+  }
+  return lvl_rd8(b, (uint16_t)(waterOfs + LVL_WATER_OFS_TABLE + (uint16_t)roomId * levels + level));
+}
+
+/* Wind: u16 room_ofs[room_count] (0 = calm room); each room: int16 vx[4]
+   (8.8 px/frame per force code), u8 map[map_h][(map_w + 3) / 4] with 2 bits
+   per cell (cell x in bits (x & 3) * 2), u8 shield_count, then per shield
+   u8 flag and a mask of the same size (3 = cell in the shielded lane). */
+#define LVL_WIND_NONE   0
+#define LVL_WIND_LEFT   1
+#define LVL_WIND_RIGHT  2
+#define LVL_WIND_STRONG 3
+#define LVL_WIND_OFS_MAP 8
+
+static inline uint16_t lvl_wind_ofs(const uint8_t* b) {
+  return lvl_rd16(b, LVL_HDR_OFS_WIND);
+}
+static inline uint16_t lvl_wind_room_ofs(const uint8_t* b, uint16_t windOfs, uint8_t roomId) {
+  return lvl_rd16(b, (uint16_t)(windOfs + (uint16_t)roomId * 2u));
+}
+
+/* Pressure plates: u8 count, u8 first[room_count + 1], then [x, y, flag]
+   records grouped by room; records first[r]..first[r+1]-1 belong to room r.
+   The flag is set while the player or the companion stands on the cell. */
+#define LVL_COMPANION_NONE 0xFF
+#define LVL_PLATE_RECORD_SIZE 3
+#define LVL_PLATE_OFS_X    0
+#define LVL_PLATE_OFS_Y    1
+#define LVL_PLATE_OFS_FLAG 2
+
+static inline uint16_t lvl_plates_ofs(const uint8_t* b) {
+  return lvl_rd16(b, LVL_HDR_OFS_PLATES);
+}
+static inline uint8_t lvl_plates_first(const uint8_t* b, uint16_t platesOfs, uint8_t roomId) {
+  return lvl_rd8(b, (uint16_t)(platesOfs + 1u + roomId));
+}
+static inline uint16_t lvl_plate_base(const uint8_t* b, uint16_t platesOfs, uint8_t index) {
+  return (uint16_t)(platesOfs + 2u + lvl_rd8(b, LVL_HDR_OFS_ROOMCOUNT) + (uint16_t)index * LVL_PLATE_RECORD_SIZE);
+}
+
+/* Moving platforms: u8 count, u8 first[room_count + 1], then [kind, x0, y0,
+   x1, y1, speed, flag] records grouped by room like plates. kind indexes the
+   tileset's platform kinds; the path is in cells along the kind's axis and
+   speed in px/frame. With a flag the deck sits at x1,y1 while it is set and
+   at x0,y0 while it is clear; LVL_PLATFORM_NO_FLAG shuttles end to end. */
+#define LVL_PLATFORM_RECORD_SIZE 7
+#define LVL_PLATFORM_ROOM_MAX 4
+#define LVL_PLATFORM_NO_FLAG 0xFF
+#define LVL_PLATFORM_OFS_KIND  0
+#define LVL_PLATFORM_OFS_X0    1
+#define LVL_PLATFORM_OFS_Y0    2
+#define LVL_PLATFORM_OFS_X1    3
+#define LVL_PLATFORM_OFS_Y1    4
+#define LVL_PLATFORM_OFS_SPEED 5
+#define LVL_PLATFORM_OFS_FLAG  6
+
+static inline uint16_t lvl_platforms_ofs(const uint8_t* b) {
+  return lvl_rd16(b, LVL_HDR_OFS_PLATFORMS);
+}
+static inline uint8_t lvl_platforms_first(const uint8_t* b, uint16_t platformsOfs, uint8_t roomId) {
+  return lvl_rd8(b, (uint16_t)(platformsOfs + 1u + roomId));
+}
+static inline uint16_t lvl_platform_base(const uint8_t* b, uint16_t platformsOfs, uint8_t index) {
+  return (uint16_t)(platformsOfs + 2u + lvl_rd8(b, LVL_HDR_OFS_ROOMCOUNT) + (uint16_t)index * LVL_PLATFORM_RECORD_SIZE);
+}
+
+/* Sweeping lasers: u8 count, u8 first[room_count + 1], then [axis, sprites,
+   color, rate, steps, push, cross_lo, cross_hi, off_flag, u16 steps_ofs]
+   records and their step tables. A step is [x lo, x hi | REVERSE, y] (VIC
+   position of the first beam sprite; the others follow at
+   LVL_LASER_SPRITE_LEN_V/H along the beam) and a 24-bit mask of the cells
+   the beam covers along the sweep: columns for a V beam, rows for an H beam.
+   cross_lo..cross_hi are the cells it covers the other way. */
+#define LVL_LASER_RECORD_SIZE 11
+#define LVL_LASER_STEP_SIZE 6
+#define LVL_LASER_ROOM_MAX 3
+#define LVL_LASER_SPRITES 6
+#define LVL_LASER_SPRITE_LEN_V 42
+#define LVL_LASER_SPRITE_LEN_H 48
+#define LVL_LASER_AXIS_V 0
+#define LVL_LASER_AXIS_H 1
+#define LVL_LASER_REVERSE 0x80
+#define LVL_LASER_NO_FLAG 0xFF
+#define LVL_LASER_OFS_AXIS     0
+#define LVL_LASER_OFS_SPRITES  1
+#define LVL_LASER_OFS_COLOR    2
+#define LVL_LASER_OFS_RATE     3
+#define LVL_LASER_OFS_STEPS    4
+#define LVL_LASER_OFS_PUSH     5
+#define LVL_LASER_OFS_CROSS_LO 6
+#define LVL_LASER_OFS_CROSS_HI 7
+#define LVL_LASER_OFS_FLAG     8
+#define LVL_LASER_OFS_TABLE    9
+#define LVL_LASER_STEP_OFS_XLO  0
+#define LVL_LASER_STEP_OFS_XHI  1
+#define LVL_LASER_STEP_OFS_Y    2
+#define LVL_LASER_STEP_OFS_MASK 3
+
+static inline uint16_t lvl_lasers_ofs(const uint8_t* b) {
+  return lvl_rd16(b, LVL_HDR_OFS_LASERS);
+}
+static inline uint8_t lvl_lasers_first(const uint8_t* b, uint16_t lasersOfs, uint8_t roomId) {
+  return lvl_rd8(b, (uint16_t)(lasersOfs + 1u + roomId));
+}
+static inline uint16_t lvl_laser_base(const uint8_t* b, uint16_t lasersOfs, uint8_t index) {
+  return (uint16_t)(lasersOfs + 2u + lvl_rd8(b, LVL_HDR_OFS_ROOMCOUNT) + (uint16_t)index * LVL_LASER_RECORD_SIZE);
+}
+
+/* Dialogs: u8 dialog_count, then nodes addressed by their offset from the
+   block (A_DIALOG and choice `next`; 0 = end). A node is [msg, choice_count]
+   followed by u16 next when it has no choices, else by choice_count
+   [label msg, u16 cond, u16 act, u16 next] records. cond/act are stream
+   offsets like an object's. */
+#define LVL_DIALOG_CHOICES_MAX 4
+#define LVL_DIALOG_CHOICE_SIZE 7
+#define LVL_DIALOG_END         0
+#define LVL_DIALOG_OFS_MSG     0
+#define LVL_DIALOG_OFS_COUNT   1
+#define LVL_DIALOG_OFS_NEXT    2
+#define LVL_DIALOG_OFS_CHOICES 2
+#define LVL_DIALOG_CHOICE_OFS_MSG  0
+#define LVL_DIALOG_CHOICE_OFS_COND 1
+#define LVL_DIALOG_CHOICE_OFS_ACT  3
+#define LVL_DIALOG_CHOICE_OFS_NEXT 5
+
+static inline uint16_t lvl_dialogs_ofs(const uint8_t* b) {
+  return lvl_rd16(b, LVL_HDR_OFS_DIALOGS);
+}
+static inline uint16_t lvl_dialog_choice_base(uint16_t nodeBase, uint8_t index) {
+  return (uint16_t)(nodeBase + LVL_DIALOG_OFS_CHOICES + (uint16_t)index * LVL_DIALOG_CHOICE_SIZE);
+}
+
+/* Scripted NPCs: u8 count, u8 first[room_count + 1], then [x, y, image,
+   speed, face, u16 script_ofs] records and the behaviour scripts, one per
+   NPC type. x,y is the spawn cell, image an include/npc_sprites_mc.h index
+   (NPC_*_OFF / 64) and script_ofs the blob offset of op 0. */
+#define LVL_NPC_RECORD_SIZE 7
+#define LVL_NPC_OP_SIZE     3
+#define LVL_NPC_ROOM_MAX    3
+#define LVL_NPC_IMAGES      10
+#define LVL_NPC_FACE_LEFT   0
+#define LVL_NPC_FACE_RIGHT  1
+#define LVL_NPC_FACE_PLAYER 2
+#define LVL_NPC_OFS_X      0
+#define LVL_NPC_OFS_Y      1
+#define LVL_NPC_OFS_IMAGE  2
+#define LVL_NPC_OFS_SPEED  3
+#define LVL_NPC_OFS_FACE   4
+#define LVL_NPC_OFS_SCRIPT 5
+
+static inline uint16_t lvl_npcs_ofs(const uint8_t* b) {
+  return lvl_rd16(b, LVL_HDR_OFS_NPCS);
+}
+static inline uint8_t lvl_npcs_first(const uint8_t* b, uint16_t npcsOfs, uint8_t roomId) {
+  return lvl_rd8(b, (uint16_t)(npcsOfs + 1u + roomId));
+}
+static inline uint16_t lvl_npc_base(const uint8_t* b, uint16_t npcsOfs, uint8_t index) {
+  return (uint16_t)(npcsOfs + 2u + lvl_rd8(b, LVL_HDR_OFS_ROOMCOUNT) + (uint16_t)index * LVL_NPC_RECORD_SIZE);
+}
+
+/* Routes: u8 route_count, u8 switch_routes[flag_count] (bit r = the flag
+   switches an edge of route r), then per route: u8 node_count, u8 edge_count,
+   u8 reach_count, u8 fixed[node_count] (bit j of fixed[i] = edge i -> j),
+   edge_count [flag, from | INVERT | ONEWAY, to] records and reach_count
+   [from, to, flag] records. REACH flags are derived: set while `to` is
+   reachable from `from`. */
+#define LVL_ROUTE_MAX        8
+#define LVL_ROUTE_MAX_NODES  8
+#define LVL_ROUTE_EDGE_INVERT 0x80
+#define LVL_ROUTE_EDGE_ONEWAY 0x40
+#define LVL_ROUTE_NODE_MASK   0x07
+#define LVL_ROUTE_RECORD_SIZE 3
+
+static inline uint16_t lvl_routes_ofs(const uint8_t* b) {
+  return lvl_rd16(b, LVL_HDR_OFS_ROUTES);
+}
+static inline uint8_t lvl_route_switch_mask(const uint8_t* b, uint16_t routesOfs, uint8_t flagId) {
+  return lvl_rd8(b, (uint16_t)(routesOfs + 1u + flagId));
+}
+/* First route record; the next one follows the previous route's reach list. */
+static inline uint16_t lvl_route_first(const uint8_t* b, uint16_t routesOfs) {
+  return (uint16_t)(routesOfs + 1u + lvl_rd8(b, LVL_HDR_OFS_FLAGCOUNT));
+}
+static inline uint16_t lvl_route_next(const uint8_t* b, uint16_t routeBase) {
+  return (uint16_t)(routeBase + 3u + lvl_rd8(b, routeBase) +
+                    (uint16_t)(lvl_rd8(b, (uint16_t)(routeBase + 1u)) + lvl_rd8(b, (uint16_t)(routeBase + 2u))) *
+                        LVL_ROUTE_RECORD_SIZE);
+}
+
+/* LVL2 segmented container: a resident index; each segment is an LVL1 blob.
+   Segment-local room ids >= the segment's room count are imports (rooms in
+   other segments), resolved through the segment's import list. */
+#define LVL2_MAGIC_3 '2'
+#define LVL2_VERSION 2
+
+#define LVL2_HEADER_SIZE 26
+#define LVL2_SEG_ENTRY_SIZE 8
+#define LVL2_ROOM_ENTRY_SIZE 2
+
+#define LVL2_HDR_OFS_VERSION     4
+#define LVL2_HDR_OFS_MAPW        5
+#define LVL2_HDR_OFS_MAPH        6
+#define LVL2_HDR_OFS_FLAGCOUNT   7
+#define LVL2_HDR_OFS_VARCOUNT    8
+#define LVL2_HDR_OFS_ITEMCOUNT   9
+#define LVL2_HDR_OFS_MSGCOUNT    10
+#define LVL2_HDR_OFS_SEGCOUNT    11
+#define LVL2_HDR_OFS_ROOMCOUNT   12  /* uint16_t */
+#define LVL2_HDR_OFS_STARTROOM   14  /* uint16_t */
+#define LVL2_HDR_OFS_STARTSPAWN  16
+#define LVL2_HDR_OFS_SEGTABLE    18  /* uint16_t */
+#define LVL2_HDR_OFS_ROOMTABLE   20  /* uint16_t */
+#define LVL2_HDR_OFS_NAME        22  /* uint16_t, NUL-terminated disk name prefix */
+
+/* Segment table entry field offsets */
+#define LVL2_SEG_OFS_PACK     0  /* uint24_t offset into the segment pack */
+#define LVL2_SEG_OFS_SIZE     3  /* uint16_t */
+#define LVL2_SEG_OFS_ROOMS    5
+#define LVL2_SEG_OFS_IMPORTS  6  /* uint16_t: u8 count + uint16_t global room ids */
+
+static inline uint8_t lvl2_segment_count(const uint8_t* b) {
+  return lvl_rd8(b, LVL2_HDR_OFS_SEGCOUNT);
+}
+static inline uint16_t lvl2_room_count(const uint8_t* b) {
+  return lvl_rd16(b, LVL2_HDR_OFS_ROOMCOUNT);
+}
+static inline uint16_t lvl2_start_room(const uint8_t* b) {
+  return lvl_rd16(b, LVL2_HDR_OFS_STARTROOM);
+}
+static inline const char* lvl2_name(const uint8_t* b) {
+  return (const char*)(b + lvl_rd16(b, LVL2_HDR_OFS_NAME));
+}
+
+static inline uint16_t lvl2_seg_entry_base(const uint8_t* b, uint8_t seg) {
+  return (uint16_t)(lvl_rd16(b, LVL2_HDR_OFS_SEGTABLE) + (uint16_t)seg * LVL2_SEG_ENTRY_SIZE);
+}
+static inline uint32_t lvl2_segment_pack_ofs(const uint8_t* b, uint8_t seg) {
+  uint16_t e = lvl2_seg_entry_base(b, seg);
+  return (uint32_t)lvl_rd16(b, e + LVL2_SEG_OFS_PACK) | ((uint32_t)lvl_rd8(b, e + LVL2_SEG_OFS_PACK + 2) << 16);
+}
+static inline uint16_t lvl2_segment_size(const uint8_t* b, uint8_t seg) {
+  return lvl_rd16(b, lvl2_seg_entry_base(b, seg) + LVL2_SEG_OFS_SIZE);
+}
+static inline uint8_t lvl2_segment_room_count(const uint8_t* b, uint8_t seg) {
+  return lvl_rd8(b, lvl2_seg_entry_base(b, seg) + LVL2_SEG_OFS_ROOMS);
+}
+static inline uint8_t lvl2_segment_import_count(const uint8_t* b, uint8_t seg) {
+  return lvl_rd8(b, lvl_rd16(b, lvl2_seg_entry_base(b, seg) + LVL2_SEG_OFS_IMPORTS));
+}
+static inline uint16_t lvl2_segment_import(const uint8_t* b, uint8_t seg, uint8_t idx) {
+  uint16_t list = lvl_rd16(b, lvl2_seg_entry_base(b, seg) + LVL2_SEG_OFS_IMPORTS);
+  return lvl_rd16(b, (uint16_t)(list + 1 + (uint16_t)idx * 2));
+}
+
+static inline uint16_t lvl2_room_entry_base(const uint8_t* b, uint16_t room) {
+  return (uint16_t)(lvl_rd16(b, LVL2_HDR_OFS_ROOMTABLE) + room * LVL2_ROOM_ENTRY_SIZE);
+}
+static inline uint8_t lvl2_room_segment(const uint8_t* b, uint16_t room) {
+  return lvl_rd8(b, lvl2_room_entry_base(b, room) + 0);
+}
+static inline uint8_t lvl2_room_local(const uint8_t* b, uint16_t room) {
+  return lvl_rd8(b, lvl2_room_entry_base(b, room) + 1);
+}
@@ -6,6 +6,17 @@
 void level_set_blob(const uint8_t* blob);
 const uint8_t* level_get_blob(void);
 
+// LVL2: resident index; level_get_blob() then returns the paged-in segment.
+void level_set_index(const uint8_t* index);
+uint8_t level_is_segmented(void);
+// Returned by level_select_room/level_resolve_room when the room cannot be paged in.
+#define LEVEL_ROOM_NONE 0xFFu
+
+// Pages in the segment holding a global room; returns its segment-local id.
+uint8_t level_select_room(uint16_t global_room);
+// Maps a segment-local room id (exit/TRANSITION target) to a loaded local id.
+uint8_t level_resolve_room(uint8_t room_id);
+
 uint8_t level_get_room_count(void);
 uint8_t level_get_map_width(void);
 uint8_t level_get_map_height(void);
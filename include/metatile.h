@@ -4,11 +4,25 @@
 #include "common.h"
 
 void metatile_init(void);
+// Maps map bytes 0..255 to a tile page (u16 count, u16 tileset ids[count]);
+// NULL selects the first 256 tiles. Called on room load.
+void metatile_select_page(const uint8_t* page);
 
 uint16_t metatile_get_flags(uint8_t mt_id);
 const uint8_t* metatile_get_chars(uint8_t mt_id);
 uint8_t metatile_get_color_mode(uint8_t mt_id);
 const uint8_t* metatile_get_colors(uint8_t mt_id);
+// 16 column bytes per shape slot (see tset_shape_inside); slot is
+// (flags & TSET_SHAPE_MASK) >> TSET_SHAPE_SHIFT.
+const uint8_t* metatile_get_shape_tables(uint8_t* out_count);
+// Platform kind record (TSET_PLATFORM_OFS_*), NULL when the tileset has no
+// such kind; metatile_get_platform_table gives its per-shift table.
+const uint8_t* metatile_get_platform(uint8_t kind);
+const uint8_t* metatile_get_platform_table(const uint8_t* rec);
+// TSET_PARTICLE_RECORD_SIZE record of particle kind `kind`; NULL = no such kind.
+const uint8_t* metatile_get_particle(uint8_t kind);
+// u8 count + [code, 8 rows] per glyph to copy over the charset; NULL = none.
+const uint8_t* metatile_get_glyphs(void);
 uint8_t metatile_get_bg_color(void);
 uint8_t metatile_get_mc1_color(void);
 uint8_t metatile_get_mc2_color(void);
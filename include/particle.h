@@ -0,0 +1,30 @@
+#ifndef PARTICLE_H
+#define PARTICLE_H
+
+#include "common.h"
+
+// Char-cell particles (tilesetc PARTICLES, spawned by ACT PARTICLES). A
+// particle is one screen char in a spare cell of the room, drawn with its
+// kind's dedicated glyphs over whatever was there; the char and color under
+// it are saved and put back when it moves or dies.
+
+// Pool size, a power of two; a burst that finds no free slot is cut short.
+#define PARTICLE_MAX 8
+// Raster lines the pool may spend per frame, and the cycles one particle's
+// restore, step and redraw cost. PARTICLE_BATCH particles are visited per
+// frame, round-robin, so a full pool ages more slowly instead of running
+// over its lines.
+#define PARTICLE_RASTER_LINES 16
+#define PARTICLE_CYCLES 220
+#define PARTICLE_BATCH (PARTICLE_RASTER_LINES * 63 / PARTICLE_CYCLES)
+
+// Called by room_load_with_spawn: the next room is drawn from scratch, so
+// the pool is dropped without restoring.
+void particle_room_enter(void);
+// Up to `n` particles of tset kind `kind` in the four chars of map cell
+// mx,my (a fifth and later in the cell above). Non-spare chars are skipped.
+void particle_spawn(uint8_t kind, uint8_t mx, uint8_t my, uint8_t n);
+// Restores, steps and redraws one batch; runs after render_update.
+void particle_update(void);
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef PHYSICS_H
+#define PHYSICS_H
+
+#include <stdint.h>
+
+// Platformer body. x/y are the collision box top-left in room pixels and
+// x_fx/y_fx their 1/256 fraction: 8.8 fixed point with a 16-bit integer
+// part, since rooms are 320 px wide. Velocities are signed 8.8 px/frame from
+// physics_tables.h (tools/physc.py).
+typedef struct {
+    uint16_t x;
+    uint16_t y;
+    uint8_t x_fx;
+    uint8_t y_fx;
+    uint8_t state;
+    uint8_t t;
+} PhysBody;
+
+enum {
+    PHYS_GROUND = 0,
+    PHYS_JUMP = 1,
+    PHYS_FALL = 2,
+    PHYS_CLIMB = 3
+};
+
+// physics_step result: the box touched this room edge and was clamped.
+enum {
+    PHYS_EDGE_L = 1u << 0,
+    PHYS_EDGE_R = 1u << 1,
+    PHYS_EDGE_U = 1u << 2,
+    PHYS_EDGE_D = 1u << 3
+};
+
+// Upper bound on collision_at calls in one physics_step (see tools/bench/phys_bench.c).
+#define PHYS_MAX_PROBES 12
+
+void physics_set_bounds(uint16_t w_px, uint16_t h_px);
+void physics_place(PhysBody* b, uint8_t mx, uint8_t my);
+uint8_t physics_step(PhysBody* b, uint8_t down, uint8_t pressed);
+// Moves a grounded body with the platform deck it stands on (src/platform.c);
+// returns PHYS_EDGE_* like physics_step.
+uint8_t physics_carry(PhysBody* b, int8_t dx, int8_t dy);
+// Laser hit (src/laser.c): shoves the body dx px and starts a short hop,
+// also off a ladder; returns PHYS_EDGE_* like physics_step.
+uint8_t physics_knockback(PhysBody* b, int8_t dx);
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef PLATE_H
+#define PLATE_H
+
+#include "common.h"
+
+// Pressure plates (levelc PLATES). A plate's flag is set while any presser
+// stands on its cell. Pressers report the cell under their feet every frame;
+// the blob is only searched when that cell changes and holds a PLATE tile.
+
+#define PLATE_PLAYER 0
+#define PLATE_COMPANION 1
+#define PLATE_PRESSERS 2
+
+// Cell coordinate for a presser that is airborne or out of the room.
+#define PLATE_NO_CELL 0xFF
+
+void plate_init(void);
+// Called by room_load_with_spawn: the player has left the previous room.
+void plate_room_enter(void);
+// Presser `who` stands on cell mx,my of the current room (PLATE_NO_CELL = none).
+void plate_press(uint8_t who, uint8_t mx, uint8_t my);
+// Lifts presser `who` off its plate, wherever that plate is.
+void plate_release(uint8_t who);
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef PLATFORM_H
+#define PLATFORM_H
+
+#include "common.h"
+#include "physics.h"
+
+// Moving platforms and lifts (levelc PLATFORMS). A deck is a 2x2 metatile
+// drawn from the tileset's pre-shifted glyphs (tilesetc PLATFORMS): moving
+// it rewrites the 6 chars of its footprint and restores the chars it left,
+// never the whole tile row. Its 16x16 box is a one-way STANDABLE surface in
+// the collision map, so bodies land on and walk off it like any ledge.
+
+// Called by room_load_with_spawn after collision_build.
+void platform_room_enter(void);
+// Called by render_room: the room was just redrawn under every deck.
+void platform_redraw(void);
+// Moves every deck one frame; runs before player_update.
+void platform_update(void);
+// Moves `b` with the deck under its feet, if that deck moved this frame.
+// Returns PHYS_EDGE_* like physics_step.
+uint8_t platform_carry(PhysBody* b);
+
+#endif
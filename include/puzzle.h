@@ -10,6 +10,12 @@ void puzzle_flag_set(FlagId flag_id);
 void puzzle_flag_clear(FlagId flag_id);
 unsigned char puzzle_var_get(VarId var_id);
 void puzzle_var_set(VarId var_id, unsigned char value);
+void puzzle_campaign_reset(void);
+unsigned char puzzle_campaign_flag_get(unsigned short flag_id);
+void puzzle_campaign_flag_set(unsigned short flag_id);
+void puzzle_campaign_flag_clear(unsigned short flag_id);
+unsigned char puzzle_campaign_var_get(unsigned char var_id);
+void puzzle_campaign_var_set(unsigned char var_id, unsigned char value);
 unsigned char puzzle_conditions_pass(unsigned short cond_ofs);
 void puzzle_run_actions(unsigned short act_ofs);
 
@@ -6,5 +6,19 @@
 void render_init(void);
 void render_room(void);
 void render_metatile(uint8_t mx, uint8_t my, uint8_t mt_id);
+// Queues one map cell for redraw; render_update flushes the queue each frame.
+void render_mark_dirty(uint8_t mx, uint8_t my);
+// Redraws a list of [x, y, tile] records over the next frames using the
+// current map (layer toggle); NULL cancels.
+void render_sweep(const uint8_t* cells, uint8_t count);
+void render_update(void);
+// Char-cell writes for movers (src/platform.c): one char and its color RAM,
+// or one char restored from the room map. Off-screen cells are ignored.
+void render_put_char(uint8_t cx, uint8_t cy, uint8_t ch, uint8_t color);
+void render_restore_char(uint8_t cx, uint8_t cy);
+// Char and color (without the multicolor bit) currently at cell cx, cy;
+// the caller keeps it on screen (src/particle.c).
+uint8_t render_get_char(uint8_t cx, uint8_t cy);
+uint8_t render_get_color(uint8_t cx, uint8_t cy);
 
 #endif
@@ -1,10 +1,27 @@
 #ifndef ROOM_H
 #define ROOM_H
 
+// Largest map (w * h) kept as a mutable RAM copy; matches ROOM_CELLS_MAX in levelc.py.
+#define ROOM_CELLS_MAX 240
+
 void room_load(unsigned char room_id);
-void room_load_with_spawn(unsigned char room_id, unsigned char spawn_id);
+// Returns 0 and keeps the current room when a segmented level cannot page the room in.
+unsigned char room_load_with_spawn(unsigned char room_id, unsigned char spawn_id);
 void room_render(void);
 const unsigned char* room_get_map(void);
+// Map of one layer (0 = MAP, 1 = ALTMAP); NULL for layer 1 when the room has no ALTMAP.
+const unsigned char* room_get_layer_map(unsigned char layer);
+unsigned char room_get_layer(void);
+// Shows layer 0 or 1 (LEVEL layer= flag); only the differing cells are redrawn.
+void room_set_layer(unsigned char layer);
+// Writes a cell of both RAM layers only; for use before the room is drawn.
+void room_put_cell(unsigned char mx, unsigned char my, unsigned char tile);
+// Writes a cell of the drawn room: refreshes its collision and queues the redraw.
+void room_set_cell(unsigned char mx, unsigned char my, unsigned char tile);
+// Restores a cell to its MAP/ALTMAP tile, with the same side effects. Only
+// correct for STATES because levelc allows one binding per cell: no other
+// set flag can own the cell being reset.
+void room_reset_cell(unsigned char mx, unsigned char my);
 unsigned char room_get_width(void);
 unsigned char room_get_height(void);
 unsigned char room_get_id(void);
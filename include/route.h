@@ -0,0 +1,15 @@
+#ifndef ROUTE_H
+#define ROUTE_H
+
+#include "common.h"
+
+// Routing puzzles (levelc ROUTE): small node graphs whose switchable edges
+// follow level flags. Each route keeps one adjacency byte per node; a switch
+// change flips its edges' bits and re-closes only the routes it belongs to,
+// then sets or clears the REACH flags that COND scripts read.
+
+void route_init(void);
+// Called by puzzle_flag_set/clear when a level flag actually changes.
+void route_flag_changed(uint8_t flag_id, uint8_t is_set);
+
+#endif
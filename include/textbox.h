@@ -4,6 +4,8 @@
 void textbox_init(void);
 void textbox_update(void);
 void textbox_show(const char* text);
+// A dialog choice: the text behind a '>' marker (src/dialog.c).
+void textbox_show_choice(const char* text);
 const char* textbox_get_text(void);
 
 #endif
@@ -12,5 +12,7 @@
 #define TF_INTERACTABLE (1u << 5)
 #define TF_FLOOR        (1u << 6)
 #define TF_HAZARD       (1u << 7)
+/* Bits 8..11 hold the collision shape slot (tileset_format.h) */
+#define TF_PLATE        (1u << 12)
 
 #endif
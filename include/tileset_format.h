@@ -8,10 +8,11 @@
 #define TSET_MAGIC_1 'S'
 #define TSET_MAGIC_2 'E'
 #define TSET_MAGIC_3 'T'
-#define TSET_VERSION 1
+#define TSET_VERSION 4
 
-#define TSET_HEADER_SIZE 17
+#define TSET_HEADER_SIZE 25
 #define TSET_RECORD_SIZE 12
+#define TSET_MAX_TILES   1024
 
 /* Header field offsets (byte offsets into blob) */
 #define TSET_HDR_OFS_VERSION     4
@@ -24,6 +25,11 @@
 #define TSET_HDR_OFS_BG          13  /* uint8_t */
 #define TSET_HDR_OFS_MC1         14  /* uint8_t */
 #define TSET_HDR_OFS_MC2         15  /* uint8_t */
+#define TSET_HDR_OFS_TILE_COUNT_HI 16  /* uint8_t, high byte of tile_count */
+#define TSET_HDR_OFS_SHAPES      17  /* uint16_t, u8 count + 16 bytes per shape slot */
+#define TSET_HDR_OFS_PLATFORMS   19  /* uint16_t, 0 = no platform kinds */
+#define TSET_HDR_OFS_GLYPHS      21  /* uint16_t, 0 = no extra glyphs */
+#define TSET_HDR_OFS_PARTICLES   23  /* uint16_t, 0 = no particle kinds */
 
 /* Record field offsets (byte offsets relative to record base) */
 #define TSET_REC_OFS_ID          0
@@ -32,9 +38,54 @@
 #define TSET_REC_OFS_COLORS      6
 #define TSET_REC_OFS_FLAGS       10  /* uint16_t */
 
+/* Record flags bits 8..11: collision shape slot */
+#define TSET_SHAPE_SHIFT 8
+#define TSET_SHAPE_MASK  0x0F00u
+
+/* Platform kinds: u8 count, then TSET_PLATFORM_RECORD_SIZE bytes per kind.
+   A kind's table has one row per shift: TSET_PLATFORM_CELLS char codes then
+   TSET_PLATFORM_CELLS colors for its footprint, row-major (V: 2 cols x 3
+   rows, H: 3 cols x 2 rows). shift = (pixel & 7) >> shift_rsh. */
+#define TSET_PLATFORM_RECORD_SIZE 4
+#define TSET_PLATFORM_OFS_AXIS    0  /* 0 = vertical, 1 = horizontal */
+#define TSET_PLATFORM_OFS_RSH     1
+#define TSET_PLATFORM_OFS_TABLE   2  /* uint16_t */
+#define TSET_PLATFORM_AXIS_V 0
+#define TSET_PLATFORM_AXIS_H 1
+#define TSET_PLATFORM_CELLS  6
+
+/* Extra glyphs: u8 count, then [char code, 8 bitmap rows] copied over the
+   charset after it is loaded (platform shifts, particle frames). */
+#define TSET_GLYPH_RECORD_SIZE 9
+
+/* Particle kinds: u8 count, then TSET_PARTICLE_RECORD_SIZE bytes per kind.
+   Each of the kind's `frames` glyphs shows for `hold` frames; every `move`
+   frames (0 = never) the particle steps `dy` rows and, with `spread`, one
+   column outward. */
+#define TSET_PARTICLE_RECORD_SIZE 10
+#define TSET_PARTICLE_OFS_COLOR   0
+#define TSET_PARTICLE_OFS_HOLD    1
+#define TSET_PARTICLE_OFS_MOVE    2
+#define TSET_PARTICLE_OFS_DY      3  /* int8_t */
+#define TSET_PARTICLE_OFS_SPREAD  4
+#define TSET_PARTICLE_OFS_FRAMES  5
+#define TSET_PARTICLE_OFS_CODES   6  /* 4 char codes */
+#define TSET_PARTICLE_FRAMES_MAX  4
+
+/* Shape column byte (one per pixel column x = 0..15):
+   0x00..0x10  solid from row v down (0x10 = empty column)
+   0x80 | n    solid from the top down to row n-1 */
+#define TSET_SHAPE_CEIL  0x80u
+
 static inline uint8_t tset_rd8(const uint8_t* b, uint16_t o) {
     return b[o];
 }
 static inline uint16_t tset_rd16(const uint8_t* b, uint16_t o) {
     return (uint16_t)b[o] | ((uint16_t)b[o + 1] << 8);
 }
+static inline uint16_t tset_tile_count(const uint8_t* b) {
+    return (uint16_t)b[TSET_HDR_OFS_TILE_COUNT] | ((uint16_t)b[TSET_HDR_OFS_TILE_COUNT_HI] << 8);
+}
+static inline uint8_t tset_shape_inside(uint8_t v, uint8_t row) {
+    return (v & TSET_SHAPE_CEIL) ? (row < (uint8_t)(v & 0x1Fu)) : (row >= v);
+}
@@ -0,0 +1,17 @@
+#ifndef TILESTATE_H
+#define TILESTATE_H
+
+#include "common.h"
+
+// Flag-bound tile states (levelc STATES): a cell shows its bound tile while
+// the flag is set and its MAP tile otherwise. The blob indexes records by
+// flag, so a change only visits that flag's bindings.
+
+// Room entry: writes the bound tiles of set flags into the fresh RAM map,
+// before collision is built and the room is drawn.
+void tilestate_apply_room(void);
+// Called by puzzle_flag_set/clear when a level flag actually changes; also
+// flips the room layer when the flag is the LEVEL layer= flag.
+void tilestate_flag_changed(uint8_t flag_id, uint8_t is_set);
+
+#endif
@@ -0,0 +1,19 @@
+#ifndef WATER_H
+#define WATER_H
+
+#include "common.h"
+
+// Raster-split water (LEVEL water=/ROOM water= in levelc). Below the split
+// line the background and multicolor registers switch to the water colors;
+// the level var picks each room's line from a table in the blob. Moving the
+// water only moves the split, so the screen is never redrawn.
+
+void water_init(void);
+// Room load: jump straight to the room's line for the current var value.
+void water_room_enter(void);
+// Called by puzzle_var_set when a level var actually changes.
+void water_var_changed(uint8_t var_id, uint8_t value);
+// Moves the split one pixel per frame towards its target line.
+void water_update(void);
+
+#endif
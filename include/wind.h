@@ -0,0 +1,29 @@
+#ifndef WIND_H
+#define WIND_H
+
+#include "common.h"
+
+// Wind push zones (levelc WIND). Each room's lanes are compiled to a 2-bit
+// force code per cell plus the velocity of each code, so the controller
+// reads one byte per frame instead of testing lane rectangles. A shield
+// flag clears its lane's cells from the RAM copy of the map.
+
+#define WIND_MAP_MAX 60 // 20x12 cells at 4 cells per byte
+
+extern uint8_t wind_map[WIND_MAP_MAX];
+extern uint8_t wind_stride;
+extern uint8_t wind_h;
+extern uint8_t wind_active;
+extern int16_t wind_vx[4];
+
+// Force code of the cell holding pixel (px, py); the caller checks
+// wind_active and that py is inside the map.
+#define wind_code_at(px, py) \
+    ((wind_map[(uint8_t)((py) >> 4) * wind_stride + (uint8_t)((px) >> 6)] >> ((uint8_t)((px) >> 3) & 6u)) & 3u)
+
+// Room load: copies the room's force map and clears shielded lanes.
+void wind_room_enter(void);
+// Called by puzzle_flag_set/clear when a level flag actually changes.
+void wind_flag_changed(uint8_t flag_id);
+
+#endif
@@ -1,4 +1,191 @@
 #include "collision.h"
 
+#include "room.h"
+#include "metatile.h"
+#include "tile_flags.h"
+#include "tileset_format.h"
+
+uint16_t collision_top_y = 0;
+uint16_t collision_bottom_y = 0;
+uint16_t collision_water_y = COLL_NO_WATER;
+uint16_t collision_deck_x[COLL_DECKS];
+uint16_t collision_deck_y[COLL_DECKS];
+uint8_t collision_deck_count = 0;
+
+// One plane per room layer (MAP / ALTMAP); coll_map/coll_shape point at the
+// active one, so the layer toggle never rebuilds anything.
+static uint8_t coll_plane_map[2][COLL_MAX_W * COLL_MAX_H];
+static uint8_t coll_plane_shape[2][COLL_MAX_W * COLL_MAX_H];
+static uint8_t* coll_map = coll_plane_map[0];
+static uint8_t* coll_shape = coll_plane_shape[0];
+static uint8_t coll_row_ofs[COLL_MAX_H];
+static uint8_t coll_w = 0;
+static uint8_t coll_h = 0;
+static const uint8_t* coll_shapes = 0;
+static uint8_t coll_shape_count = 0;
+
+static void collision_set(uint8_t plane, uint8_t ofs, uint8_t mt_id) {
+    uint16_t flags = metatile_get_flags(mt_id);
+    uint8_t slot = (uint8_t)((flags & TSET_SHAPE_MASK) >> TSET_SHAPE_SHIFT);
+
+    if (slot >= coll_shape_count) {
+        slot = 0;
+    }
+    coll_plane_map[plane][ofs] = (uint8_t)flags;
+    coll_plane_shape[plane][ofs] = (uint8_t)((slot << 4) | ((flags & TF_PLATE) ? COLL_PLATE : 0u));
+}
+
+static void collision_build_plane(uint8_t plane, const uint8_t* map) {
+    uint8_t mx;
+    uint8_t my;
+    uint8_t ofs = 0;
+
+    for (my = 0; my < coll_h; ++my) {
+        const uint8_t* row = map + (uint16_t)my * room_get_width();
+        for (mx = 0; mx < coll_w; ++mx) {
+            collision_set(plane, ofs, row[mx]);
+            ++ofs;
+        }
+    }
+}
+
+// Called from room_load_with_spawn once the tile page is selected; one flag
+// lookup per cell here keeps per-frame probes down to a row-table index.
+// Rooms with an ALTMAP get both planes built here.
+void collision_build(void) {
+    const uint8_t* map = room_get_layer_map(0);
+    const uint8_t* alt = room_get_layer_map(1);
+    uint8_t w = room_get_width();
+    uint8_t h = room_get_height();
+    uint8_t my;
+    uint8_t ofs = 0;
+
+    if (w > COLL_MAX_W) {
+        w = COLL_MAX_W;
+    }
+    if (h > COLL_MAX_H) {
+        h = COLL_MAX_H;
+    }
+    coll_w = w;
+    coll_h = h;
+    coll_shapes = metatile_get_shape_tables(&coll_shape_count);
+    collision_select_layer(room_get_layer());
+    if (!map || !coll_shapes || coll_shape_count == 0) {
+        coll_w = 0;
+        coll_h = 0;
+        return;
+    }
+
+    for (my = 0; my < h; ++my) {
+        coll_row_ofs[my] = ofs;
+        ofs = (uint8_t)(ofs + w);
+    }
+    collision_build_plane(0, map);
+    if (alt) {
+        collision_build_plane(1, alt);
+    }
+}
+
+void collision_select_layer(uint8_t layer) {
+    layer = layer ? 1u : 0u;
+    coll_map = coll_plane_map[layer];
+    coll_shape = coll_plane_shape[layer];
+}
+
+// A tile state changed one map cell; re-read only that cell on each plane.
+void collision_refresh_cell(uint8_t mx, uint8_t my) {
+    const uint8_t* map = room_get_layer_map(0);
+    const uint8_t* alt = room_get_layer_map(1);
+    uint16_t i = (uint16_t)my * room_get_width() + mx;
+    uint8_t ofs;
+
+    if (mx >= coll_w || my >= coll_h || !map) {
+        return;
+    }
+    ofs = (uint8_t)(coll_row_ofs[my] + mx);
+    collision_set(0, ofs, map[i]);
+    if (alt) {
+        collision_set(1, ofs, alt[i]);
+    }
+}
+
+void collision_mark_deck(uint8_t mx, uint8_t my) {
+    uint8_t ofs;
+
+    if (mx >= coll_w || my >= coll_h) {
+        return;
+    }
+    ofs = (uint8_t)(coll_row_ofs[my] + mx);
+    coll_plane_map[0][ofs] |= TF_STANDABLE;
+    coll_plane_map[1][ofs] |= TF_STANDABLE;
+    coll_plane_shape[0][ofs] |= COLL_DECK;
+    coll_plane_shape[1][ofs] |= COLL_DECK;
+}
+
+// Marked cells only: levelc keeps deck paths clear of shaped tiles, so the
+// cell's own flags never need a shape lookup here.
+static uint8_t collision_deck_at(uint16_t px, uint16_t py, uint8_t f) {
+    uint8_t d;
+
+    for (d = 0; d < collision_deck_count; ++d) {
+        if ((uint16_t)(px - collision_deck_x[d]) < 16u && (uint16_t)(py - collision_deck_y[d]) < 16u) {
+            collision_top_y = collision_deck_y[d];
+            collision_bottom_y = collision_deck_y[d] + 16u;
+            return f;
+        }
+    }
+    return (uint8_t)(f & ~COLL_SHAPED_FLAGS);
+}
+
+uint8_t collision_cell(uint8_t mx, uint8_t my) {
+    if (mx >= coll_w || my >= coll_h) {
+        return 0;
+    }
+    return coll_map[(uint8_t)(coll_row_ofs[my] + mx)];
+}
+
+uint8_t collision_plate(uint8_t mx, uint8_t my) {
+    if (mx >= coll_w || my >= coll_h) {
+        return 0;
+    }
+    return (uint8_t)(coll_shape[(uint8_t)(coll_row_ofs[my] + mx)] & COLL_PLATE);
+}
+
+// One shape-table lookup per probe; the pixel row is compared against the
+// column byte, so slopes and half tiles cost the same as full ones.
+uint8_t collision_at(uint16_t px, uint16_t py) {
+    uint8_t cx = (uint8_t)(px >> 4);
+    uint8_t cy = (uint8_t)(py >> 4);
+    uint8_t i;
+    uint8_t f;
+    uint8_t v;
+    uint16_t cell_top;
+
+    if ((px >> 4) >= coll_w || (py >> 4) >= coll_h) {
+        return 0;
+    }
+    i = (uint8_t)(coll_row_ofs[cy] + cx);
+    f = coll_map[i];
+    if (!(f & COLL_SHAPED_FLAGS)) {
+        return f;
+    }
+    if (coll_shape[i] & COLL_DECK) {
+        return collision_deck_at(px, py, f);
+    }
+    v = coll_shapes[(uint8_t)((coll_shape[i] & 0xF0u) | (uint8_t)(px & 15u))];
+    if (!tset_shape_inside(v, (uint8_t)(py & 15u))) {
+        return (uint8_t)(f & ~COLL_SHAPED_FLAGS);
+    }
+    cell_top = py & 0xFFF0u;
+    if (v & TSET_SHAPE_CEIL) {
+        collision_top_y = cell_top;
+        collision_bottom_y = cell_top + (v & 0x1Fu);
+    } else {
+        collision_top_y = cell_top + v;
+        collision_bottom_y = cell_top + 16u;
+    }
+    return f;
+}
+
 void collision_update(void) {
 }
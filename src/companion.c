@@ -0,0 +1,142 @@
+#include "companion.h"
+
+#include "level_runtime.h"
+#include "physics.h"
+#include "plate.h"
+#include "room.h"
+#include "vic_mem.h"
+#include "level_format.h"
+#include "npc_sprites_mc.h"
+#include "physics_tables.h"
+
+#include <c64/sprites.h>
+
+#define COMPANION_SPRITE 1
+#define COMPANION_MASK (COMPANION_TRAIL - 1)
+
+static const uint16_t companion_sprite_addr = SPRITE_ADDR + 64u;
+static uint8_t* const sprite_ptrs = (uint8_t*)SPRITE_PTR_ADDR;
+
+static const uint8_t sprite_offset_x = 24;
+static const uint8_t sprite_offset_y = 50;
+
+// Breadcrumbs: player body top-left and room, newest at trail_head - 1.
+static uint16_t trail_x[COMPANION_TRAIL];
+static uint8_t trail_y[COMPANION_TRAIL];
+static uint8_t trail_room[COMPANION_TRAIL];
+static uint8_t trail_head = 0;
+static uint8_t trail_len = 0;  // crumbs since FOLLOW, capped at COMPANION_DELAY
+
+static uint8_t comp_room = LVL_COMPANION_NONE;
+static uint8_t comp_mode = COMPANION_STAY;
+static uint16_t comp_x = 0;
+static uint8_t comp_y = 0;
+
+static void companion_sprite_move(void) {
+    spr_move(COMPANION_SPRITE, (int)(comp_x - PHYS_SPRITE_OFS_X + sprite_offset_x),
+             (int)(comp_y - PHYS_SPRITE_OFS_Y + sprite_offset_y));
+}
+
+static uint16_t companion_step(uint16_t from, uint16_t to) {
+    if (to > from + COMPANION_CATCHUP) {
+        return (uint16_t)(from + COMPANION_CATCHUP);
+    }
+    if (from > to + COMPANION_CATCHUP) {
+        return (uint16_t)(from - COMPANION_CATCHUP);
+    }
+    return to;
+}
+
+void companion_init(void) {
+    const uint8_t* blob = level_get_blob();
+    uint8_t* dst = (uint8_t*)companion_sprite_addr;
+    uint8_t sx = 0;
+    uint8_t sy = 0;
+    uint8_t i;
+
+    comp_room = lvl_rd8(blob, LVL_HDR_OFS_COMPANION_ROOM);
+    comp_mode = COMPANION_STAY;
+    trail_len = 0;
+    if (comp_room == LVL_COMPANION_NONE) {
+        spr_show(COMPANION_SPRITE, 0);
+        return;
+    }
+    lvl_spawn_xy(blob, lvl_room_spawns_ofs(blob, comp_room), lvl_rd8(blob, LVL_HDR_OFS_COMPANION_SPAWN), &sx, &sy);
+    // Standing on the floor of its spawn cell, like physics_place.
+    comp_x = (uint16_t)((uint16_t)sx * 16u + (16u - PHYS_BODY_W) / 2u);
+    comp_y = (uint8_t)(sy * 16u + (16u - PHYS_BODY_H));
+
+    for (i = 0; i < 64; ++i) {
+        dst[i] = npc_robot[i];
+    }
+    sprite_ptrs[COMPANION_SPRITE] = (uint8_t)(SPRITE_PTR_VALUE + 1u);
+    spr_set(COMPANION_SPRITE, 0, 0, 0, (uint8_t)(SPRITE_PTR_VALUE + 1u), NPC_ROBOT_COLOR, 1, 0, 0);
+    companion_room_enter();
+}
+
+void companion_set_mode(uint8_t mode) {
+    if (comp_room == LVL_COMPANION_NONE) {
+        return;
+    }
+    comp_mode = mode;
+    trail_len = 0;
+}
+
+void companion_trail_push(uint16_t x, uint16_t y) {
+    uint8_t last = (uint8_t)((trail_head - 1u) & COMPANION_MASK);
+    uint8_t room = room_get_id();
+
+    if (trail_x[last] == x && trail_y[last] == (uint8_t)y && trail_room[last] == room) {
+        return;
+    }
+    trail_x[trail_head] = x;
+    trail_y[trail_head] = (uint8_t)y;
+    trail_room[trail_head] = room;
+    trail_head = (uint8_t)((trail_head + 1u) & COMPANION_MASK);
+    if (trail_len < COMPANION_DELAY) {
+        ++trail_len;
+    }
+}
+
+void companion_room_enter(void) {
+    if (comp_room == LVL_COMPANION_NONE) {
+        return;
+    }
+    if (comp_room == room_get_id()) {
+        companion_sprite_move();
+        spr_show(COMPANION_SPRITE, 1);
+    } else {
+        spr_show(COMPANION_SPRITE, 0);
+    }
+}
+
+// Constant work per frame: one crumb read, two clamped steps, one plate
+// cell compare (the plate table is only read when that cell changes).
+void companion_update(void) {
+    uint8_t t;
+
+    if (comp_room == LVL_COMPANION_NONE) {
+        return;
+    }
+    if (comp_mode == COMPANION_FOLLOW && trail_len) {
+        // Until the lag has built up, head for the oldest crumb since FOLLOW.
+        t = (uint8_t)((trail_head - trail_len) & COMPANION_MASK);
+        if (trail_room[t] != comp_room) {
+            // The player took an exit here: arrive at its spawn and let go
+            // of any plate left behind.
+            plate_release(PLATE_COMPANION);
+            comp_room = trail_room[t];
+            comp_x = trail_x[t];
+            comp_y = trail_y[t];
+            companion_room_enter();
+        } else {
+            comp_x = companion_step(comp_x, trail_x[t]);
+            comp_y = (uint8_t)companion_step(comp_y, trail_y[t]);
+        }
+    }
+    if (comp_room != room_get_id()) {
+        return;  // out of sight; a held plate stays held
+    }
+    companion_sprite_move();
+    plate_press(PLATE_COMPANION, (uint8_t)((comp_x + PHYS_BODY_W / 2u) >> 4), (uint8_t)((comp_y + PHYS_BODY_H) >> 4));
+}
@@ -0,0 +1,131 @@
+#include "dialog.h"
+
+#include "input.h"
+#include "level_runtime.h"
+#include "puzzle.h"
+#include "textbox.h"
+
+#include "level_format.h"
+
+enum {
+    DIALOG_TEXT = 0,  // node message shown, waiting for Fire
+    DIALOG_CHOICE = 1 // choices listed, dlg_pick highlighted
+};
+
+static uint16_t dlg_node = 0;  // blob offset of the open node, 0 = closed
+static uint8_t dlg_state = DIALOG_TEXT;
+static uint8_t dlg_shown = 0;  // bit i = choice i passed its COND
+static uint8_t dlg_pick = 0;
+static uint8_t dlg_armed = 0;  // ignores the Fire that opened the dialog
+
+static void dialog_goto(uint16_t node) {
+    const uint8_t* blob = level_get_blob();
+
+    if (node == LVL_DIALOG_END) {
+        dlg_node = 0;
+        return;
+    }
+    dlg_node = (uint16_t)(lvl_dialogs_ofs(blob) + node);
+    dlg_state = DIALOG_TEXT;
+    dlg_armed = 0;
+    textbox_show(level_get_message(lvl_rd8(blob, (uint16_t)(dlg_node + LVL_DIALOG_OFS_MSG))));
+}
+
+static void dialog_show_pick(void) {
+    const uint8_t* blob = level_get_blob();
+    uint16_t c = lvl_dialog_choice_base(dlg_node, dlg_pick);
+
+    textbox_show_choice(level_get_message(lvl_rd8(blob, (uint16_t)(c + LVL_DIALOG_CHOICE_OFS_MSG))));
+}
+
+// Next shown choice after dlg_pick in direction `step` (1 or count - 1),
+// wrapping; dlg_shown is never 0 here.
+static void dialog_cycle(uint8_t count, uint8_t step) {
+    do {
+        dlg_pick = (uint8_t)(dlg_pick + step);
+        if (dlg_pick >= count) {
+            dlg_pick = (uint8_t)(dlg_pick - count);
+        }
+    } while (!(dlg_shown & (uint8_t)(1u << dlg_pick)));
+    dialog_show_pick();
+}
+
+// Choice conditions are tested once, when the list opens.
+static void dialog_open_choices(uint8_t count) {
+    const uint8_t* blob = level_get_blob();
+    uint8_t i;
+
+    dlg_shown = 0;
+    for (i = 0; i < count; ++i) {
+        uint16_t c = lvl_dialog_choice_base(dlg_node, i);
+
+        if (puzzle_conditions_pass(lvl_rd16(blob, (uint16_t)(c + LVL_DIALOG_CHOICE_OFS_COND)))) {
+            dlg_shown |= (uint8_t)(1u << i);
+        }
+    }
+    if (!dlg_shown) {
+        dlg_node = 0;
+        textbox_show(0);
+        return;
+    }
+    dlg_state = DIALOG_CHOICE;
+    dlg_pick = (uint8_t)(count - 1u);
+    dialog_cycle(count, 1);
+}
+
+// The dialog is closed while the choice's ACT runs, so an ACT that opens
+// another dialog wins over `next`; levelc rejects `next` after a TRANSITION.
+static void dialog_choose(void) {
+    const uint8_t* blob = level_get_blob();
+    uint16_t c = lvl_dialog_choice_base(dlg_node, dlg_pick);
+    uint16_t next = lvl_rd16(blob, (uint16_t)(c + LVL_DIALOG_CHOICE_OFS_NEXT));
+
+    dlg_node = 0;
+    textbox_show(0);
+    puzzle_run_actions(lvl_rd16(blob, (uint16_t)(c + LVL_DIALOG_CHOICE_OFS_ACT)));
+    if (!dlg_node) {
+        dialog_goto(next);
+    }
+}
+
+void dialog_start(uint16_t node) {
+    dialog_goto(node);
+}
+
+uint8_t dialog_active(void) {
+    return dlg_node != 0;
+}
+
+void dialog_update(void) {
+    const uint8_t* blob;
+    uint8_t count;
+
+    if (!dlg_node) {
+        return;
+    }
+    if (!dlg_armed) {
+        dlg_armed = 1;
+        return;
+    }
+    blob = level_get_blob();
+    count = lvl_rd8(blob, (uint16_t)(dlg_node + LVL_DIALOG_OFS_COUNT));
+    if (dlg_state == DIALOG_CHOICE) {
+        if (input_pressed & (INPUT_RIGHT | INPUT_DOWN)) {
+            dialog_cycle(count, 1);
+        } else if (input_pressed & (INPUT_LEFT | INPUT_UP)) {
+            dialog_cycle(count, (uint8_t)(count - 1u));
+        } else if (input_pressed & INPUT_FIRE) {
+            dialog_choose();
+        }
+        return;
+    }
+    if (!(input_pressed & INPUT_FIRE)) {
+        return;
+    }
+    if (count) {
+        dialog_open_choices(count);
+        return;
+    }
+    textbox_show(0);
+    dialog_goto(lvl_rd16(blob, (uint16_t)(dlg_node + LVL_DIALOG_OFS_NEXT)));
+}
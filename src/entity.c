@@ -1,7 +1,272 @@
 #include "entity.h"
 
+#include "companion.h"
+#include "level_runtime.h"
+#include "puzzle.h"
+#include "room.h"
+#include "vic_mem.h"
+#include "level_format.h"
+#include "npc_sprites_mc.h"
+#include "physics_tables.h"
+
+#include <c64/sprites.h>
+
+// NPC i shows on hardware sprite NPC_SPRITE_LAST - i from sprite data slot
+// NPC_IMAGE_FIRST + i, after the player, companion and laser images.
+#define NPC_SPRITE_LAST 7
+#define NPC_IMAGE_FIRST 4
+#define NPC_NO_IMAGE 0xFF
+#define NPC_UNPAIRED 0xFF
+#define NPC_WALK_ARRIVED 1
+#define NPC_WALK_TURNED 2
+
+static const uint8_t sprite_offset_x = 24;
+static const uint8_t sprite_offset_y = 50;
+
+// Indexed by levelc NPC_IMAGES (npc_sprites_mc.h order).
+static const uint8_t* const npc_images[LVL_NPC_IMAGES] = {
+    npc_tech, npc_robot, npc_janitor, npc_scientist, npc_ninja,
+    npc_soldier_l, npc_soldier_r, npc_turret, npc_electro_l, npc_electro_r
+};
+static const uint8_t npc_colors[LVL_NPC_IMAGES] = {
+    NPC_TECH_COLOR, NPC_ROBOT_COLOR, NPC_JANITOR_COLOR, NPC_SCIENTIST_COLOR, NPC_NINJA_COLOR,
+    NPC_SOLDIER_COLOR, NPC_SOLDIER_COLOR, NPC_TURRET_COLOR, NPC_ELECTRO_COLOR, NPC_ELECTRO_COLOR
+};
+// Left image of a left/right pair (the right one follows it), so turning
+// swaps the image.
+static const uint8_t npc_pair[LVL_NPC_IMAGES] = {
+    NPC_UNPAIRED, NPC_UNPAIRED, NPC_UNPAIRED, NPC_UNPAIRED, NPC_UNPAIRED,
+    5, 5, NPC_UNPAIRED, 8, 8
+};
+
+// Positions are the body box top-left in room pixels, like the companion's.
+static uint8_t npc_count = 0;
+static uint16_t npc_x[LVL_NPC_ROOM_MAX];
+static uint8_t npc_y[LVL_NPC_ROOM_MAX];
+static uint8_t npc_speed[LVL_NPC_ROOM_MAX];
+static uint8_t npc_image[LVL_NPC_ROOM_MAX];
+static uint8_t npc_face[LVL_NPC_ROOM_MAX];
+static uint16_t npc_script[LVL_NPC_ROOM_MAX];  // blob offset of op 0
+static uint16_t npc_pc[LVL_NPC_ROOM_MAX];      // blob offset of the op to resume at
+static uint8_t npc_wait[LVL_NPC_ROOM_MAX];     // frames left in WAIT, 0 = not waiting
+// FIRE: cells lo..hi of row `row` hurt until the next entity_update; push 0 = no shot.
+static int8_t npc_shot_push[LVL_NPC_ROOM_MAX];
+static uint8_t npc_shot_row[LVL_NPC_ROOM_MAX];
+static uint8_t npc_shot_lo[LVL_NPC_ROOM_MAX];
+static uint8_t npc_shot_hi[LVL_NPC_ROOM_MAX];
+static uint16_t npc_player_x = 0;
+
+// Copies the image into the NPC's data slot; returns 0 when it already shows.
+static uint8_t entity_set_image(uint8_t i, uint8_t image) {
+    uint8_t* dst = (uint8_t*)(SPRITE_ADDR + (uint16_t)(NPC_IMAGE_FIRST + i) * 64u);
+    const uint8_t* src;
+    uint8_t k;
+
+    if (image == npc_image[i]) {
+        return 0;
+    }
+    src = npc_images[image];
+    for (k = 0; k < 64; ++k) {
+        dst[k] = src[k];
+    }
+    npc_image[i] = image;
+    spr_color((uint8_t)(NPC_SPRITE_LAST - i), npc_colors[image]);
+    return 1;
+}
+
+static uint8_t entity_set_face(uint8_t i, uint8_t face) {
+    uint8_t pair = npc_pair[npc_image[i]];
+
+    npc_face[i] = face;
+    if (pair == NPC_UNPAIRED) {
+        return 0;
+    }
+    return entity_set_image(i, (uint8_t)(pair + face));
+}
+
+static uint16_t entity_approach(uint16_t from, uint16_t to, uint8_t step) {
+    if (to > from + step) {
+        return (uint16_t)(from + step);
+    }
+    if (from > to + step) {
+        return (uint16_t)(from - step);
+    }
+    return to;
+}
+
+// One MOVETO frame toward standing on cell mx,my, facing along x.
+// Returns NPC_WALK_* bits.
+static uint8_t entity_walk(uint8_t i, uint8_t mx, uint8_t my) {
+    uint16_t tx = (uint16_t)((uint16_t)mx * 16u + (16u - PHYS_BODY_W) / 2u);
+    uint8_t ty = (uint8_t)(my * 16u + (16u - PHYS_BODY_H));
+    uint8_t r = 0;
+
+    if (tx != npc_x[i] && entity_set_face(i, tx > npc_x[i] ? LVL_NPC_FACE_RIGHT : LVL_NPC_FACE_LEFT)) {
+        r = NPC_WALK_TURNED;
+    }
+    npc_x[i] = entity_approach(npc_x[i], tx, npc_speed[i]);
+    npc_y[i] = (uint8_t)entity_approach(npc_y[i], ty, npc_speed[i]);
+    if (npc_x[i] == tx && npc_y[i] == ty) {
+        r |= NPC_WALK_ARRIVED;
+    }
+    return r;
+}
+
+static void entity_fire(uint8_t i, uint8_t range, uint8_t push) {
+    uint8_t cx = (uint8_t)((npc_x[i] + PHYS_BODY_W / 2u) >> 4);
+
+    npc_shot_row[i] = (uint8_t)((npc_y[i] + PHYS_BODY_H / 2u) >> 4);
+    if (npc_face[i] == LVL_NPC_FACE_RIGHT) {
+        npc_shot_lo[i] = cx;
+        npc_shot_hi[i] = (uint8_t)(cx + range);
+        npc_shot_push[i] = (int8_t)push;
+    } else {
+        npc_shot_lo[i] = cx > range ? (uint8_t)(cx - range) : 0;
+        npc_shot_hi[i] = cx;
+        npc_shot_push[i] = (int8_t)-(int8_t)push;
+    }
+}
+
+// Runs NPC i's slice. Jumps and plain ops fall through to the next op
+// within the budget; a blocking op returns with npc_pc still on it (YIELD
+// steps past itself first). Swapping the image also ends the slice, so at
+// most one 64-byte copy is paid per NPC per frame.
+static void entity_run(uint8_t i) {
+    const uint8_t* blob = level_get_blob();
+    uint8_t budget;
+
+    for (budget = 0; budget < NPC_OPS_PER_FRAME; ++budget) {
+        uint16_t pc = npc_pc[i];
+        uint8_t op = lvl_rd8(blob, pc);
+        uint8_t a = lvl_rd8(blob, (uint16_t)(pc + 1u));
+        uint8_t b = lvl_rd8(blob, (uint16_t)(pc + 2u));
+
+        npc_pc[i] = (uint16_t)(pc + LVL_NPC_OP_SIZE);
+        switch (op) {
+        case N_YIELD:
+            return;
+        case N_WAIT:
+            // The frame WAIT starts on counts as the first of `a`.
+            if (!npc_wait[i]) {
+                npc_wait[i] = a;
+            }
+            if (--npc_wait[i]) {
+                npc_pc[i] = pc;
+                return;
+            }
+            break;
+        case N_MOVETO:
+            a = entity_walk(i, a, b);
+            if (!(a & NPC_WALK_ARRIVED)) {
+                npc_pc[i] = pc;
+                return;
+            }
+            if (a & NPC_WALK_TURNED) {
+                return;
+            }
+            break;
+        case N_FACE:
+            if (a == LVL_NPC_FACE_PLAYER) {
+                a = npc_player_x > npc_x[i] + PHYS_BODY_W / 2u ? LVL_NPC_FACE_RIGHT : LVL_NPC_FACE_LEFT;
+            }
+            if (entity_set_face(i, a)) {
+                return;
+            }
+            break;
+        case N_FIRE:
+            entity_fire(i, a, b);
+            break;
+        case N_ANIM:
+            if (entity_set_image(i, a)) {
+                return;
+            }
+            break;
+        case N_IFSET:
+        case N_IFCLR:
+            if ((puzzle_flag_get((FlagId)a) ? N_IFSET : N_IFCLR) == op) {
+                npc_pc[i] = (uint16_t)(npc_script[i] + (uint16_t)b * LVL_NPC_OP_SIZE);
+            }
+            break;
+        case N_GOTO:
+            npc_pc[i] = (uint16_t)(npc_script[i] + (uint16_t)a * LVL_NPC_OP_SIZE);
+            break;
+        default:
+            npc_pc[i] = pc;  // N_STOP: stays put for good
+            return;
+        }
+    }
+}
+
 void entity_init(void) {
+    companion_init();
 }
 
+void entity_room_enter(void) {
+    const uint8_t* blob = level_get_blob();
+    uint16_t ofs = lvl_npcs_ofs(blob);
+    uint8_t room;
+    uint8_t idx;
+    uint8_t end;
+
+    npc_count = 0;
+    if (!ofs) {
+        return;
+    }
+    room = room_get_id();
+    end = lvl_npcs_first(blob, ofs, (uint8_t)(room + 1u));
+    for (idx = lvl_npcs_first(blob, ofs, room); idx < end && npc_count < LVL_NPC_ROOM_MAX; ++idx) {
+        uint16_t base = lvl_npc_base(blob, ofs, idx);
+        uint8_t i = npc_count;
+        uint8_t image = lvl_rd8(blob, (uint16_t)(base + LVL_NPC_OFS_IMAGE));
+
+        npc_x[i] = (uint16_t)((uint16_t)lvl_rd8(blob, (uint16_t)(base + LVL_NPC_OFS_X)) * 16u + (16u - PHYS_BODY_W) / 2u);
+        npc_y[i] = (uint8_t)(lvl_rd8(blob, (uint16_t)(base + LVL_NPC_OFS_Y)) * 16u + (16u - PHYS_BODY_H));
+        npc_speed[i] = lvl_rd8(blob, (uint16_t)(base + LVL_NPC_OFS_SPEED));
+        npc_face[i] = lvl_rd8(blob, (uint16_t)(base + LVL_NPC_OFS_FACE));
+        npc_script[i] = lvl_rd16(blob, (uint16_t)(base + LVL_NPC_OFS_SCRIPT));
+        npc_pc[i] = npc_script[i];
+        npc_wait[i] = 0;
+        npc_shot_push[i] = 0;
+        npc_image[i] = NPC_NO_IMAGE;
+
+        spr_set((uint8_t)(NPC_SPRITE_LAST - i), 1, (int)(npc_x[i] - PHYS_SPRITE_OFS_X + sprite_offset_x),
+                (int)(npc_y[i] - PHYS_SPRITE_OFS_Y + sprite_offset_y), (uint8_t)(SPRITE_PTR_VALUE + NPC_IMAGE_FIRST + i),
+                NPC_TECH_COLOR, 1, 0, 0);
+        if (npc_pair[image] != NPC_UNPAIRED) {
+            image = (uint8_t)(npc_pair[image] + npc_face[i]);
+        }
+        entity_set_image(i, image);
+        ++npc_count;
+    }
+}
+
+// Shots from the last frame expire first: each one gets exactly one
+// entity_hit from the player_update in between.
 void entity_update(void) {
+    uint8_t i;
+
+    companion_update();
+    for (i = 0; i < npc_count; ++i) {
+        npc_shot_push[i] = 0;
+        entity_run(i);
+        spr_move((uint8_t)(NPC_SPRITE_LAST - i), (int)(npc_x[i] - PHYS_SPRITE_OFS_X + sprite_offset_x),
+                 (int)(npc_y[i] - PHYS_SPRITE_OFS_Y + sprite_offset_y));
+    }
+}
+
+int8_t entity_hit(uint16_t px, uint16_t py) {
+    uint8_t cx = (uint8_t)(px >> 4);
+    uint8_t cy = (uint8_t)(py >> 4);
+    uint8_t i;
+
+    npc_player_x = px;
+    for (i = 0; i < npc_count; ++i) {
+        int8_t push = npc_shot_push[i];
+
+        if (push && cy == npc_shot_row[i] && cx >= npc_shot_lo[i] && cx <= npc_shot_hi[i]) {
+            npc_shot_push[i] = 0;
+            return push;
+        }
+    }
+    return 0;
 }
@@ -21,9 +21,20 @@ void kernal_irq_disable(void) {
     (void)*CIA2_IRQ_CTRL;
 }
 
+static bool raster_started = false;
+
 void irq_init(void) {
     // Avoid KERNAL IRQ vector chaining during early startup; reduces reset/return-to-BASIC.
     rirq_init(false);
     // Temporarily disable raster IRQ start to isolate startup crashes.
     // rirq_start();
 }
+
+void irq_raster_start(void) {
+    if (raster_started) {
+        return;
+    }
+    rirq_init(false);
+    rirq_start();
+    raster_started = true;
+}
@@ -0,0 +1,192 @@
+#include "laser.h"
+
+#include "level_runtime.h"
+#include "puzzle.h"
+#include "room.h"
+#include "vic_mem.h"
+
+#include "level_format.h"
+
+#include <c64/sprites.h>
+
+// Hardware sprites 2..7; sprite data slots 2 and 3 after the player and companion.
+#define LASER_SPRITE_FIRST 2
+#define LASER_IMAGE_V 2
+#define LASER_IMAGE_H 3
+
+static uint8_t las_count = 0;
+static uint8_t las_axis[LVL_LASER_ROOM_MAX];
+static uint8_t las_sprite[LVL_LASER_ROOM_MAX];  // first hardware sprite
+static uint8_t las_sprites[LVL_LASER_ROOM_MAX];
+static uint8_t las_rate[LVL_LASER_ROOM_MAX];
+static uint8_t las_tick[LVL_LASER_ROOM_MAX];
+static uint8_t las_steps[LVL_LASER_ROOM_MAX];
+static uint8_t las_step[LVL_LASER_ROOM_MAX];
+static int8_t las_push[LVL_LASER_ROOM_MAX];
+static uint8_t las_lo[LVL_LASER_ROOM_MAX];
+static uint8_t las_hi[LVL_LASER_ROOM_MAX];
+static uint8_t las_flag[LVL_LASER_ROOM_MAX];
+static uint8_t las_on[LVL_LASER_ROOM_MAX];
+static uint16_t las_table[LVL_LASER_ROOM_MAX];  // blob offset of step 0
+static uint16_t las_cur[LVL_LASER_ROOM_MAX];    // blob offset of the current step
+static uint8_t las_cooldown = 0;
+
+static void laser_place(uint8_t i) {
+    const uint8_t* blob = level_get_blob();
+    uint16_t p = las_cur[i];
+    int x = (int)lvl_rd8(blob, (uint16_t)(p + LVL_LASER_STEP_OFS_XLO)) |
+            (int)(lvl_rd8(blob, (uint16_t)(p + LVL_LASER_STEP_OFS_XHI)) & 1u) << 8;
+    int y = (int)lvl_rd8(blob, (uint16_t)(p + LVL_LASER_STEP_OFS_Y));
+    uint8_t s;
+
+    for (s = 0; s < las_sprites[i]; ++s) {
+        spr_move((uint8_t)(las_sprite[i] + s), x, y);
+        if (las_axis[i] == LVL_LASER_AXIS_V) {
+            y += LVL_LASER_SPRITE_LEN_V;
+        } else {
+            x += LVL_LASER_SPRITE_LEN_H;
+        }
+    }
+}
+
+static void laser_show(uint8_t i, uint8_t on) {
+    uint8_t s;
+
+    las_on[i] = on;
+    if (on) {
+        laser_place(i);
+    }
+    for (s = 0; s < las_sprites[i]; ++s) {
+        spr_show((uint8_t)(las_sprite[i] + s), on);
+    }
+}
+
+// A V beam is a 2 px column, Y-expanded; an H beam a 2 px row, X-expanded.
+// Runs before the first room load, so it also points the sprite library at
+// the screen ahead of player_init.
+void laser_init(void) {
+    uint8_t* v = (uint8_t*)(SPRITE_ADDR + LASER_IMAGE_V * 64u);
+    uint8_t* h = (uint8_t*)(SPRITE_ADDR + LASER_IMAGE_H * 64u);
+    uint8_t i;
+
+    spr_init((char*)SCREEN_ADDR);
+    for (i = 0; i < 63; ++i) {
+        v[i] = (i % 3u) == 0 ? 0xC0u : 0x00u;
+        h[i] = i < 6 ? 0xFFu : 0x00u;
+    }
+}
+
+void laser_room_enter(void) {
+    const uint8_t* blob = level_get_blob();
+    uint16_t ofs = lvl_lasers_ofs(blob);
+    uint8_t sprite = LASER_SPRITE_FIRST;
+    uint8_t room;
+    uint8_t idx;
+    uint8_t end;
+
+    for (idx = 0; idx < LVL_LASER_SPRITES; ++idx) {
+        spr_show((uint8_t)(LASER_SPRITE_FIRST + idx), 0);
+    }
+    las_count = 0;
+    las_cooldown = 0;
+    if (!ofs) {
+        return;
+    }
+    room = room_get_id();
+    end = lvl_lasers_first(blob, ofs, (uint8_t)(room + 1u));
+    for (idx = lvl_lasers_first(blob, ofs, room); idx < end && las_count < LVL_LASER_ROOM_MAX; ++idx) {
+        uint16_t base = lvl_laser_base(blob, ofs, idx);
+        uint8_t i = las_count;
+        uint8_t image;
+
+        las_axis[i] = lvl_rd8(blob, (uint16_t)(base + LVL_LASER_OFS_AXIS));
+        las_sprites[i] = lvl_rd8(blob, (uint16_t)(base + LVL_LASER_OFS_SPRITES));
+        if ((uint8_t)(sprite + las_sprites[i]) > LASER_SPRITE_FIRST + LVL_LASER_SPRITES) {
+            break;
+        }
+        las_sprite[i] = sprite;
+        las_rate[i] = lvl_rd8(blob, (uint16_t)(base + LVL_LASER_OFS_RATE));
+        las_tick[i] = las_rate[i];
+        las_steps[i] = lvl_rd8(blob, (uint16_t)(base + LVL_LASER_OFS_STEPS));
+        las_step[i] = 0;
+        las_push[i] = (int8_t)lvl_rd8(blob, (uint16_t)(base + LVL_LASER_OFS_PUSH));
+        las_lo[i] = lvl_rd8(blob, (uint16_t)(base + LVL_LASER_OFS_CROSS_LO));
+        las_hi[i] = lvl_rd8(blob, (uint16_t)(base + LVL_LASER_OFS_CROSS_HI));
+        las_flag[i] = lvl_rd8(blob, (uint16_t)(base + LVL_LASER_OFS_FLAG));
+        las_table[i] = lvl_rd16(blob, (uint16_t)(base + LVL_LASER_OFS_TABLE));
+        las_cur[i] = las_table[i];
+
+        image = (uint8_t)(SPRITE_PTR_VALUE + (las_axis[i] == LVL_LASER_AXIS_V ? LASER_IMAGE_V : LASER_IMAGE_H));
+        for (; sprite != (uint8_t)(las_sprite[i] + las_sprites[i]); ++sprite) {
+            spr_set(sprite, 0, 0, 0, image, lvl_rd8(blob, (uint16_t)(base + LVL_LASER_OFS_COLOR)), 0,
+                    las_axis[i] == LVL_LASER_AXIS_H, las_axis[i] == LVL_LASER_AXIS_V);
+        }
+        laser_show(i, (uint8_t)(las_flag[i] == LVL_LASER_NO_FLAG || !puzzle_flag_get((FlagId)las_flag[i])));
+        ++las_count;
+    }
+}
+
+void laser_flag_changed(uint8_t flag_id) {
+    uint8_t i;
+
+    for (i = 0; i < las_count; ++i) {
+        if (las_flag[i] == flag_id) {
+            laser_show(i, (uint8_t)!puzzle_flag_get((FlagId)flag_id));
+        }
+    }
+}
+
+// The step table already holds the out-and-back cycle, so stepping is an
+// index wrap; `rate` frames pass between steps.
+void laser_update(void) {
+    uint8_t i;
+
+    if (las_cooldown) {
+        --las_cooldown;
+    }
+    for (i = 0; i < las_count; ++i) {
+        if (!las_on[i] || --las_tick[i]) {
+            continue;
+        }
+        las_tick[i] = las_rate[i];
+        if (++las_step[i] == las_steps[i]) {
+            las_step[i] = 0;
+            las_cur[i] = las_table[i];
+        } else {
+            las_cur[i] = (uint16_t)(las_cur[i] + LVL_LASER_STEP_SIZE);
+        }
+        laser_place(i);
+    }
+}
+
+// One mask bit per beam: the cell along the sweep against the step's mask,
+// the cell across it against the beam's fixed extent.
+int8_t laser_hit(uint16_t px, uint16_t py) {
+    const uint8_t* blob;
+    uint8_t cx = (uint8_t)(px >> 4);
+    uint8_t cy = (uint8_t)(py >> 4);
+    uint8_t i;
+
+    if (las_cooldown || !las_count) {
+        return 0;
+    }
+    blob = level_get_blob();
+    for (i = 0; i < las_count; ++i) {
+        uint8_t along = las_axis[i] == LVL_LASER_AXIS_V ? cx : cy;
+        uint8_t across = las_axis[i] == LVL_LASER_AXIS_V ? cy : cx;
+        uint16_t p = las_cur[i];
+
+        if (!las_on[i] || across < las_lo[i] || across > las_hi[i] || along >= 24u) {
+            continue;
+        }
+        if (!(lvl_rd8(blob, (uint16_t)(p + LVL_LASER_STEP_OFS_MASK + (along >> 3))) & (uint8_t)(1u << (along & 7u)))) {
+            continue;
+        }
+        las_cooldown = LASER_COOLDOWN;
+        if (lvl_rd8(blob, (uint16_t)(p + LVL_LASER_STEP_OFS_XHI)) & LVL_LASER_REVERSE) {
+            return (int8_t)-las_push[i];
+        }
+        return las_push[i];
+    }
+    return 0;
+}
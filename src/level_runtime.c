@@ -3,7 +3,23 @@
 #include "levels/boot_audit-blob.h"
 #include "level_format.h"
 
+#include <c64/kernalio.h>
+
+// LVL2 segments are loaded from disk into a fixed buffer outside the program
+// and VIC bank 1. Keep LEVEL_SEGMENT_MAX in sync with levelc --segment-size.
+#define LEVEL_SEGMENT_ADDR 0xc000u
+#define LEVEL_SEGMENT_MAX  0x1000u
+#define LEVEL_SEGMENT_NONE 0xffu
+
+enum {
+    LEVEL_DISK_DEVICE = 8,
+    LEVEL_DISK_FILE = 2,
+    LEVEL_DISK_NAME_MAX = 17
+};
+
 static const uint8_t* level_blob = boot_audit_blob;
+static const uint8_t* level_index = 0;  // LVL2 resident index, 0 for a plain LVL1 blob
+static uint8_t level_segment = LEVEL_SEGMENT_NONE;
 
 static uint8_t level_blob_valid(const uint8_t* blob) {
     if (!blob) {
@@ -19,7 +35,114 @@ static uint8_t level_blob_valid(const uint8_t* blob) {
 void level_set_blob(const uint8_t* blob) {
     if (level_blob_valid(blob)) {
         level_blob = blob;
+        level_index = 0;
+        level_segment = LEVEL_SEGMENT_NONE;
+    }
+}
+
+void level_set_index(const uint8_t* index) {
+    if (!index ||
+        index[0] != LVL_MAGIC_0 ||
+        index[1] != LVL_MAGIC_1 ||
+        index[2] != LVL_MAGIC_2 ||
+        index[3] != LVL2_MAGIC_3 ||
+        lvl_rd8(index, LVL2_HDR_OFS_VERSION) != LVL2_VERSION) {
+        return;
+    }
+    level_index = index;
+    level_segment = LEVEL_SEGMENT_NONE;
+}
+
+uint8_t level_is_segmented(void) {
+    return level_index != 0;
+}
+
+// Reads <NAME>.Snn into the segment buffer. 0 = the file could not be opened
+// (buffer untouched), 1 = loaded, 2 = a short or bad read clobbered the buffer.
+static uint8_t level_read_segment(uint8_t seg) {
+    char name[LEVEL_DISK_NAME_MAX];
+    const char* prefix = lvl2_name(level_index);
+    uint8_t* dst = (uint8_t*)LEVEL_SEGMENT_ADDR;
+    uint16_t size = lvl2_segment_size(level_index, seg);
+    uint8_t n = 0;
+    int got;
+
+    while (prefix[n] && n < LEVEL_DISK_NAME_MAX - 5) {
+        name[n] = prefix[n];
+        ++n;
+    }
+    name[n++] = '.';
+    name[n++] = 'S';
+    name[n++] = "0123456789ABCDEF"[seg >> 4];
+    name[n++] = "0123456789ABCDEF"[seg & 15u];
+    name[n] = 0;
+
+    krnio_setnam(name);
+    if (!krnio_open(LEVEL_DISK_FILE, LEVEL_DISK_DEVICE, LEVEL_DISK_FILE)) {
+        return 0;
     }
+    got = krnio_read(LEVEL_DISK_FILE, (char*)dst, (int)size);
+    krnio_close(LEVEL_DISK_FILE);
+    if (got != (int)size || !level_blob_valid(dst)) {
+        return 2;
+    }
+    return 1;
+}
+
+// Pages in a segment. On failure the previous segment is read back so the
+// current room stays live; if that fails too, level_blob is cleared (invalid).
+static uint8_t level_load_segment(uint8_t seg) {
+    uint8_t prev = level_segment;
+    uint8_t r;
+
+    if (seg == level_segment) {
+        return 1;
+    }
+    if (seg >= lvl2_segment_count(level_index) || lvl2_segment_size(level_index, seg) > LEVEL_SEGMENT_MAX) {
+        return 0;
+    }
+
+    r = level_read_segment(seg);
+    if (r == 1) {
+        level_blob = (const uint8_t*)LEVEL_SEGMENT_ADDR;
+        level_segment = seg;
+        return 1;
+    }
+    if (r == 2 && (prev == LEVEL_SEGMENT_NONE || level_read_segment(prev) != 1)) {
+        level_blob = 0;
+        level_segment = LEVEL_SEGMENT_NONE;
+    }
+    return 0;
+}
+
+uint8_t level_select_room(uint16_t global_room) {
+    if (!level_index || global_room >= lvl2_room_count(level_index)) {
+        return LEVEL_ROOM_NONE;
+    }
+    if (!level_load_segment(lvl2_room_segment(level_index, global_room))) {
+        return LEVEL_ROOM_NONE;
+    }
+    return lvl2_room_local(level_index, global_room);
+}
+
+uint8_t level_resolve_room(uint8_t room_id) {
+    uint8_t local_count;
+
+    if (room_id == LEVEL_ROOM_NONE) {
+        return LEVEL_ROOM_NONE;
+    }
+    if (!level_index || level_segment == LEVEL_SEGMENT_NONE) {
+        return room_id;
+    }
+    local_count = lvl2_segment_room_count(level_index, level_segment);
+    if (room_id < local_count) {
+        return room_id;
+    }
+    room_id = (uint8_t)(room_id - local_count);
+    if (room_id >= lvl2_segment_import_count(level_index, level_segment)) {
+        return LEVEL_ROOM_NONE;
+    }
+    return level_select_room(lvl2_segment_import(level_index, level_segment, room_id));
 }
 
 const uint8_t* level_get_blob(void) {
@@ -30,34 +153,48 @@ const uint8_t* level_get_blob(void) {
 }
 
 uint8_t level_get_room_count(void) {
-    return lvl_rd8(level_blob, LVL_HDR_OFS_ROOMCOUNT);
+    return lvl_rd8(level_get_blob(), LVL_HDR_OFS_ROOMCOUNT);
 }
 
 uint8_t level_get_map_width(void) {
-    return lvl_rd8(level_blob, LVL_HDR_OFS_MAPW);
+    return lvl_rd8(level_get_blob(), LVL_HDR_OFS_MAPW);
 }
 
 uint8_t level_get_map_height(void) {
-    return lvl_rd8(level_blob, LVL_HDR_OFS_MAPH);
+    return lvl_rd8(level_get_blob(), LVL_HDR_OFS_MAPH);
 }
 
 uint8_t level_get_start_room(void) {
-    return lvl_rd8(level_blob, LVL_HDR_OFS_STARTROOM);
+    uint8_t room;
+
+    if (level_index) {
+        room = level_select_room(lvl2_start_room(level_index));
+        if (room != LEVEL_ROOM_NONE) {
+            return room;
+        }
+        // No segment could be read: run the resident built-in level instead.
+        level_set_blob(boot_audit_blob);
+    }
+    return lvl_rd8(level_get_blob(), LVL_HDR_OFS_STARTROOM);
 }
 
 uint8_t level_get_start_spawn(void) {
-    return lvl_rd8(level_blob, LVL_HDR_OFS_STARTSPAWN);
+    if (level_index) {
+        return lvl_rd8(level_index, LVL2_HDR_OFS_STARTSPAWN);
+    }
+    return lvl_rd8(level_get_blob(), LVL_HDR_OFS_STARTSPAWN);
 }
 
 const char* level_get_message(uint8_t msg_id) {
-    uint16_t msg_table = lvl_msgtable_ofs(level_blob);
-    uint8_t msg_count = lvl_rd8(level_blob, msg_table);
+    const uint8_t* blob = level_get_blob();
+    uint16_t msg_table = lvl_msgtable_ofs(blob);
+    uint8_t msg_count = lvl_rd8(blob, msg_table);
     uint16_t msg_ofs;
 
     if (msg_id >= msg_count) {
         return 0;
     }
 
-    msg_ofs = lvl_rd16(level_blob, (uint16_t)(msg_table + 1u + (uint16_t)msg_id * 2u));
-    return (const char*)(level_blob + msg_ofs);
+    msg_ofs = lvl_rd16(blob, (uint16_t)(msg_table + 1u + (uint16_t)msg_id * 2u));
+    return (const char*)(blob + msg_ofs);
 }
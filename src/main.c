@@ -1,6 +1,8 @@
 #include "common.h"
+#include "dialog.h"
 #include "irq.h"
 #include "input.h"
+#include "laser.h"
 #include "player.h"
 #include "entity.h"
 #include "collision.h"
@@ -12,7 +14,12 @@
 #include "audio.h"
 #include "level_runtime.h"
 #include "metatile.h"
+#include "particle.h"
 #include "render.h"
+#include "route.h"
+#include "plate.h"
+#include "platform.h"
+#include "water.h"
 
 static void game_init(void) {
     kernal_irq_disable();
@@ -20,12 +27,17 @@ static void game_init(void) {
     // irq_init();
     input_init();
     inventory_init();
+    puzzle_campaign_reset();
     puzzle_init();
     menu_init();
     textbox_init();
     audio_init();
     metatile_init();
     render_init();
+    water_init();
+    plate_init();
+    laser_init();
+    route_init();
     room_load_with_spawn(level_get_start_room(), level_get_start_spawn());
     room_render();
     player_init();
@@ -34,12 +46,18 @@ static void game_init(void) {
 
 static void game_tick(void) {
     input_poll();
+    platform_update();
+    laser_update();
+    dialog_update();
     player_update();
     entity_update();
     collision_update();
     puzzle_update();
+    water_update();
     menu_update();
     textbox_update();
+    render_update();
+    particle_update();
     audio_update();
 }
 
@@ -12,6 +12,11 @@ static const uint8_t* mt_blob = boot_audit_tset_blob;
 static const uint8_t* mt_charset_blob = boot_audit_charset_blob;
 static uint32_t mt_charset_size = 0u;
 
+// Records addressable by map bytes: identity over the first 256 tiles, or the
+// room's tile page. Rebuilt on every room load (~256 record lookups, far below
+// the room redraw), so a segment swap can never leave a stale window.
+static const uint8_t* mt_window[256];
+
 static uint8_t metatile_blob_ok(const uint8_t* blob) {
     if (!blob) {
         return 0;
@@ -23,18 +28,11 @@ static uint8_t metatile_blob_ok(const uint8_t* blob) {
            tset_rd8(blob, TSET_HDR_OFS_VERSION) == TSET_VERSION;
 } 
 
-static const uint8_t* metatile_record(uint8_t mt_id) {
-    uint16_t ofs_records;
-    uint8_t rec_size;
-    uint8_t count;
+static const uint8_t* metatile_record_global(uint16_t tile_id) {
     const uint8_t* blob = mt_blob;
+    uint8_t rec_size;
 
-    if (!blob) {
-        return 0;
-    }
-
-    count = tset_rd8(blob, TSET_HDR_OFS_TILE_COUNT);
-    if (mt_id >= count) {
+    if (!blob || tile_id >= tset_tile_count(blob)) {
         return 0;
     }
 
@@ -43,14 +41,39 @@ static const uint8_t* metatile_record(uint8_t mt_id) {
         return 0;
     }
 
-    ofs_records = tset_rd16(blob, TSET_HDR_OFS_RECORDS);
-    return blob + ofs_records + (uint16_t)mt_id * rec_size;
+    return blob + tset_rd16(blob, TSET_HDR_OFS_RECORDS) + tile_id * rec_size;
+}
+
+static const uint8_t* metatile_record(uint8_t mt_id) {
+    return mt_window[mt_id];
+}
+
+void metatile_select_page(const uint8_t* page) {
+    uint16_t count = 256u;
+    uint16_t i;
+
+    if (page) {
+        count = tset_rd16(page, 0);
+        if (count > 256u) {
+            count = 256u;
+        }
+    }
+    for (i = 0; i < 256u; ++i) {
+        if (i >= count) {
+            mt_window[i] = 0;
+        } else if (page) {
+            mt_window[i] = metatile_record_global(tset_rd16(page, (uint16_t)(2u + i * 2u)));
+        } else {
+            mt_window[i] = metatile_record_global(i);
+        }
+    }
 }
 
 void metatile_init(void) {
     if (!metatile_blob_ok(mt_blob)) {
         mt_blob = NULL;
     }
+    metatile_select_page(NULL);
     mt_charset_size = boot_audit_charset_blob_size;
     if (!mt_charset_blob || mt_charset_size == 0u) {
         mt_charset_blob = NULL;
@@ -111,6 +134,58 @@ uint8_t metatile_get_mc2_color(void) {
     return tset_rd8(mt_blob, TSET_HDR_OFS_MC2);
 }
 
+const uint8_t* metatile_get_shape_tables(uint8_t* out_count) {
+    const uint8_t* shapes;
+
+    if (!mt_blob) {
+        *out_count = 0;
+        return 0;
+    }
+    shapes = mt_blob + tset_rd16(mt_blob, TSET_HDR_OFS_SHAPES);
+    *out_count = shapes[0];
+    return shapes + 1;
+}
+
+const uint8_t* metatile_get_platform(uint8_t kind) {
+    uint16_t ofs;
+
+    if (!mt_blob) {
+        return 0;
+    }
+    ofs = tset_rd16(mt_blob, TSET_HDR_OFS_PLATFORMS);
+    if (!ofs || kind >= mt_blob[ofs]) {
+        return 0;
+    }
+    return mt_blob + ofs + 1u + (uint16_t)kind * TSET_PLATFORM_RECORD_SIZE;
+}
+
+const uint8_t* metatile_get_platform_table(const uint8_t* rec) {
+    return mt_blob + tset_rd16(rec, TSET_PLATFORM_OFS_TABLE);
+}
+
+const uint8_t* metatile_get_particle(uint8_t kind) {
+    uint16_t ofs;
+
+    if (!mt_blob) {
+        return 0;
+    }
+    ofs = tset_rd16(mt_blob, TSET_HDR_OFS_PARTICLES);
+    if (!ofs || kind >= mt_blob[ofs]) {
+        return 0;
+    }
+    return mt_blob + ofs + 1u + (uint16_t)kind * TSET_PARTICLE_RECORD_SIZE;
+}
+
+const uint8_t* metatile_get_glyphs(void) {
+    uint16_t ofs;
+
+    if (!mt_blob) {
+        return 0;
+    }
+    ofs = tset_rd16(mt_blob, TSET_HDR_OFS_GLYPHS);
+    return ofs ? mt_blob + ofs : 0;
+}
+
 const uint8_t* metatile_get_charset_blob(void) {
     return mt_charset_blob;
 }
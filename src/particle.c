@@ -0,0 +1,175 @@
+#include "particle.h"
+
+#include "collision.h"
+#include "metatile.h"
+#include "render.h"
+#include "room.h"
+#include "tileset_format.h"
+
+#if PARTICLE_BATCH < 1 || PARTICLE_BATCH > PARTICLE_MAX
+#error "PARTICLE_BATCH must be 1..PARTICLE_MAX"
+#endif
+
+// part_rec is the kind's TSET_PARTICLE_* record; NULL marks a free slot.
+static const uint8_t* part_rec[PARTICLE_MAX];
+static uint8_t part_cx[PARTICLE_MAX];
+static uint8_t part_cy[PARTICLE_MAX];
+static int8_t part_dx[PARTICLE_MAX];
+static uint8_t part_frame[PARTICLE_MAX];
+static uint8_t part_hold[PARTICLE_MAX];  // visits left on this glyph
+static uint8_t part_tick[PARTICLE_MAX];  // visits left before the next step
+static uint8_t part_glyph[PARTICLE_MAX];
+static uint8_t part_under[PARTICLE_MAX];
+static uint8_t part_under_color[PARTICLE_MAX];
+static uint8_t part_count = 0;
+static uint8_t part_next = 0;
+
+// Open room cells only (no deck, plate or shape) and no other particle.
+static uint8_t particle_spare(uint8_t cx, uint8_t cy) {
+    uint8_t mx = (uint8_t)(cx >> 1);
+    uint8_t my = (uint8_t)(cy >> 1);
+    uint8_t i;
+
+    if (mx >= room_get_width() || my >= room_get_height() || cx >= 40u || cy >= 25u) {
+        return 0;
+    }
+    if (collision_cell(mx, my) || collision_plate(mx, my)) {
+        return 0;
+    }
+    for (i = 0; i < PARTICLE_MAX; ++i) {
+        if (part_rec[i] && part_cx[i] == cx && part_cy[i] == cy) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void particle_draw(uint8_t i) {
+    const uint8_t* rec = part_rec[i];
+    uint8_t cx = part_cx[i];
+    uint8_t cy = part_cy[i];
+
+    part_glyph[i] = rec[TSET_PARTICLE_OFS_CODES + part_frame[i]];
+    part_under[i] = render_get_char(cx, cy);
+    part_under_color[i] = render_get_color(cx, cy);
+    render_put_char(cx, cy, part_glyph[i], rec[TSET_PARTICLE_OFS_COLOR]);
+}
+
+// A room redraw or tile update may already have replaced the glyph; then
+// the screen is right as it is.
+static void particle_restore(uint8_t i) {
+    uint8_t cx = part_cx[i];
+    uint8_t cy = part_cy[i];
+
+    if (render_get_char(cx, cy) == part_glyph[i]) {
+        render_put_char(cx, cy, part_under[i], part_under_color[i]);
+    }
+}
+
+static void particle_free(uint8_t i) {
+    part_rec[i] = 0;
+    --part_count;
+}
+
+void particle_room_enter(void) {
+    uint8_t i;
+
+    for (i = 0; i < PARTICLE_MAX; ++i) {
+        part_rec[i] = 0;
+    }
+    part_count = 0;
+    part_next = 0;
+}
+
+void particle_spawn(uint8_t kind, uint8_t mx, uint8_t my, uint8_t n) {
+    const uint8_t* rec = metatile_get_particle(kind);
+    uint8_t i = 0;
+    uint8_t k;
+
+    if (!rec) {
+        return;
+    }
+    for (k = 0; k < n; ++k) {
+        uint8_t cx = (uint8_t)(mx * 2u + (k & 1u));
+        uint8_t cy = (uint8_t)(my * 2u + ((k >> 1) & 1u) - ((k >> 2) << 1));
+
+        while (i < PARTICLE_MAX && part_rec[i]) {
+            ++i;
+        }
+        if (i == PARTICLE_MAX) {
+            return;
+        }
+        if (!particle_spare(cx, cy)) {
+            continue;
+        }
+        part_rec[i] = rec;
+        part_cx[i] = cx;
+        part_cy[i] = cy;
+        part_dx[i] = rec[TSET_PARTICLE_OFS_SPREAD] ? ((k & 1u) ? 1 : -1) : 0;
+        part_frame[i] = 0;
+        part_hold[i] = rec[TSET_PARTICLE_OFS_HOLD];
+        part_tick[i] = rec[TSET_PARTICLE_OFS_MOVE];
+        ++part_count;
+        particle_draw(i);
+    }
+}
+
+// Moves one visited particle on by one visit. Returns 0 when it died: its
+// glyphs ran out or its next cell is not spare.
+static uint8_t particle_step(uint8_t i) {
+    const uint8_t* rec = part_rec[i];
+
+    if (!--part_hold[i]) {
+        if (++part_frame[i] == rec[TSET_PARTICLE_OFS_FRAMES]) {
+            return 0;
+        }
+        part_hold[i] = rec[TSET_PARTICLE_OFS_HOLD];
+    }
+    if (rec[TSET_PARTICLE_OFS_MOVE] && !--part_tick[i]) {
+        int8_t dy = (int8_t)rec[TSET_PARTICLE_OFS_DY];
+        uint8_t cx = (uint8_t)(part_cx[i] + part_dx[i]);
+        uint8_t cy = (uint8_t)(part_cy[i] + dy);
+
+        part_tick[i] = rec[TSET_PARTICLE_OFS_MOVE];
+        if (part_dx[i] || dy) {
+            if (!particle_spare(cx, cy)) {
+                return 0;
+            }
+            part_cx[i] = cx;
+            part_cy[i] = cy;
+        }
+    }
+    return 1;
+}
+
+// All restores of the batch go before all redraws, so a particle never
+// saves a neighbour's glyph as the char under it.
+void particle_update(void) {
+    uint8_t batch[PARTICLE_BATCH];
+    uint8_t n = 0;
+    uint8_t k;
+
+    if (!part_count) {
+        return;
+    }
+    for (k = 0; k < PARTICLE_MAX && n < PARTICLE_BATCH; ++k) {
+        uint8_t i = (uint8_t)((part_next + k) & (PARTICLE_MAX - 1u));
+
+        if (part_rec[i]) {
+            batch[n++] = i;
+        }
+    }
+    part_next = (uint8_t)((part_next + k) & (PARTICLE_MAX - 1u));
+    for (k = n; k--;) {
+        particle_restore(batch[k]);
+    }
+    for (k = 0; k < n; ++k) {
+        uint8_t i = batch[k];
+
+        if (particle_step(i)) {
+            particle_draw(i);
+        } else {
+            particle_free(i);
+        }
+    }
+}
@@ -0,0 +1,388 @@
+#include "physics.h"
+
+#include "collision.h"
+#include "input.h"
+#include "tile_flags.h"
+#include "wind.h"
+#include "physics_tables.h"
+
+// Landable from above. STANDABLE/FLOOR without SOLID are one-way platforms.
+#define PHYS_SUPPORT (TF_SOLID | TF_STANDABLE | TF_FLOOR)
+
+#define PHYS_BODY_CX ((PHYS_BODY_W) / 2)
+#define PHYS_BODY_CY ((PHYS_BODY_H) / 2)
+
+// Rises and drops of up to this many pixels are walked over (slopes, half
+// tiles); side probes stop this far above the feet.
+#define PHYS_STEP 4
+
+static uint16_t bound_w = COLL_MAX_W * 16u;
+static uint16_t bound_h = COLL_MAX_H * 16u;
+
+static void fx_add(uint16_t* pos, uint8_t* frac, int16_t v) {
+    uint16_t f = (uint16_t)*frac + (uint8_t)v;
+
+    *frac = (uint8_t)f;
+    *pos = (uint16_t)(*pos + (int8_t)((uint16_t)v >> 8) + (f >> 8));
+}
+
+// Probe both foot columns at row py. Returns the OR of their flags; when a
+// PHYS_SUPPORT flag was hit, foot_top is the highest surface among them.
+static uint16_t foot_top;
+
+static uint8_t foot_probe(const PhysBody* b, uint16_t py) {
+    uint8_t f = collision_at(b->x, py);
+    uint8_t g;
+
+    foot_top = 0xFFFFu;
+    if (f & PHYS_SUPPORT) {
+        foot_top = collision_top_y;
+    }
+    g = collision_at(b->x + (PHYS_BODY_W - 1), py);
+    if ((g & PHYS_SUPPORT) && collision_top_y < foot_top) {
+        foot_top = collision_top_y;
+    }
+    return (uint8_t)(f | g);
+}
+
+// The top of a ladder is walkable; cells further down are not.
+static uint8_t ladder_top(uint16_t px, uint16_t py) {
+    if (!(collision_at(px, py) & TF_LADDER)) {
+        return 0;
+    }
+    return (py < 16u || !(collision_at(px, py - 16u) & TF_LADDER)) ? 1 : 0;
+}
+
+static uint8_t supported(const PhysBody* b) {
+    uint16_t feet = b->y + PHYS_BODY_H;
+
+    if (feet >= bound_h) {
+        return 1;
+    }
+    if (foot_probe(b, feet) & PHYS_SUPPORT) {
+        return 1;
+    }
+    return ((feet & 15u) == 0) ? ladder_top(b->x + PHYS_BODY_CX, feet) : 0;
+}
+
+static void settle(PhysBody* b) {
+    b->state = supported(b) ? PHYS_GROUND : PHYS_FALL;
+    b->t = 0;
+}
+
+// Grounded bodies leave the lowest PHYS_STEP rows to follow_ground so they
+// can walk up slopes and lips; airborne bodies probe their full height.
+static uint8_t side_solid(const PhysBody* b, uint16_t px) {
+    uint16_t low = b->y + (PHYS_BODY_H - 1);
+
+    if (b->state == PHYS_GROUND) {
+        low -= PHYS_STEP;
+    }
+    return ((collision_at(px, b->y) | collision_at(px, low)) & TF_SOLID) ? 1 : 0;
+}
+
+// A blocked step is undone rather than snapped to a cell edge, since shaped
+// tiles have no edge there; the body stops within one step of the wall.
+static uint8_t move_x(PhysBody* b, int16_t vx) {
+    uint16_t old = b->x;
+    uint8_t old_fx = b->x_fx;
+    uint16_t edge;
+
+    if (vx == 0) {
+        return 0;
+    }
+    fx_add(&b->x, &b->x_fx, vx);
+    if (vx < 0) {
+        if (b->x > old || b->x == 0) {
+            b->x = 0;
+            b->x_fx = 0;
+            return PHYS_EDGE_L;
+        }
+        edge = b->x;
+    } else {
+        edge = b->x + (PHYS_BODY_W - 1);
+        if (edge >= bound_w - 1u) {
+            b->x = bound_w - PHYS_BODY_W;
+            b->x_fx = 0;
+            return PHYS_EDGE_R;
+        }
+    }
+    if (side_solid(b, edge)) {
+        b->x = old;
+        b->x_fx = old_fx;
+    }
+    return 0;
+}
+
+static uint8_t move_up(PhysBody* b, int16_t vy) {
+    uint16_t old = b->y;
+    uint16_t bottom = 0;
+
+    fx_add(&b->y, &b->y_fx, vy);
+    if (b->y > old || b->y == 0) {
+        b->y = 0;
+        b->y_fx = 0;
+        if (b->state == PHYS_JUMP) {
+            b->state = PHYS_FALL;
+            b->t = 0;
+        }
+        return PHYS_EDGE_U;
+    }
+    if (collision_at(b->x, b->y) & TF_SOLID) {
+        bottom = collision_bottom_y;
+    }
+    if ((collision_at(b->x + (PHYS_BODY_W - 1), b->y) & TF_SOLID) && collision_bottom_y > bottom) {
+        bottom = collision_bottom_y;
+    }
+    if (bottom) {
+        b->y = bottom;
+        b->y_fx = 0;
+        if (b->state == PHYS_JUMP) {
+            b->state = PHYS_FALL;
+            b->t = 0;
+        }
+    }
+    return 0;
+}
+
+static uint8_t land_on(PhysBody* b, uint16_t old_feet, uint16_t py) {
+    uint8_t f = foot_probe(b, py);
+
+    if ((f & PHYS_SUPPORT) && ((f & TF_SOLID) || old_feet < foot_top)) {
+        b->y = foot_top - PHYS_BODY_H;
+        b->y_fx = 0;
+        b->state = PHYS_GROUND;
+        return 1;
+    }
+    return 0;
+}
+
+// SOLID shapes always push the feet back onto their surface. STANDABLE/FLOOR
+// only catch feet that were above the surface last frame, which is what
+// makes them one-way. When the feet cross a cell row, the bottom row of the
+// old cell is probed first so a surface there (slope foot, half tile) is not
+// skipped in favour of the cell below.
+static uint8_t move_down(PhysBody* b, int16_t vy) {
+    uint16_t old_feet = b->y + (PHYS_BODY_H - 1);
+    uint16_t feet;
+
+    fx_add(&b->y, &b->y_fx, vy);
+    feet = b->y + (PHYS_BODY_H - 1);
+    if (feet >= bound_h - 1u) {
+        b->y = bound_h - PHYS_BODY_H;
+        b->y_fx = 0;
+        b->state = PHYS_GROUND;
+        return PHYS_EDGE_D;
+    }
+    if ((feet ^ old_feet) & 0xFFF0u) {
+        if (land_on(b, old_feet, old_feet | 15u)) {
+            return 0;
+        }
+        if (ladder_top(b->x + PHYS_BODY_CX, feet)) {
+            b->y = (uint16_t)((feet & 0xFFF0u) - PHYS_BODY_H);
+            b->y_fx = 0;
+            b->state = PHYS_GROUND;
+            return 0;
+        }
+    }
+    land_on(b, old_feet, feet);
+    return 0;
+}
+
+// Keep a walking body on the ground: climb rises of up to PHYS_STEP, stay on
+// flat ground, follow drops of up to PHYS_STEP, otherwise start falling.
+// The drop probe stays inside the feet's cell row so it cannot skip a
+// surface at the bottom of that cell; longer drops land on the next frame.
+static void follow_ground(PhysBody* b) {
+    uint16_t feet = b->y + PHYS_BODY_H;
+    uint16_t drop;
+
+    if (feet >= bound_h) {
+        return;
+    }
+    if ((foot_probe(b, feet - 1u) & PHYS_SUPPORT) && feet - foot_top <= PHYS_STEP) {
+        b->y = foot_top - PHYS_BODY_H;
+        b->y_fx = 0;
+        return;
+    }
+    if (supported(b)) {
+        return;
+    }
+    drop = feet + (PHYS_STEP - 1);
+    if ((drop ^ feet) & 0xFFF0u) {
+        drop = feet | 15u;
+    }
+    if (foot_probe(b, drop) & PHYS_SUPPORT) {
+        b->y = foot_top - PHYS_BODY_H;
+        b->y_fx = 0;
+        return;
+    }
+    b->state = PHYS_FALL;
+    b->t = 0;
+}
+
+static uint8_t try_grab_ladder(PhysBody* b, uint16_t probe_y) {
+    uint16_t cx = b->x + PHYS_BODY_CX;
+
+    if (!(collision_at(cx, probe_y) & TF_LADDER)) {
+        return 0;
+    }
+    b->x = (uint16_t)((cx & 0xFFF0u) + (16u - PHYS_BODY_W) / 2u);
+    b->x_fx = 0;
+    b->state = PHYS_CLIMB;
+    b->t = 0;
+    return 1;
+}
+
+static uint8_t step_climb(PhysBody* b, uint8_t down) {
+    uint16_t cx = b->x + PHYS_BODY_CX;
+    uint8_t below;
+    uint8_t edges;
+
+    if (down & (INPUT_LEFT | INPUT_RIGHT)) {
+        settle(b);
+        return 0;
+    }
+    if (down & INPUT_UP) {
+        edges = move_up(b, -PHYS_CLIMB_VY);
+        if (!(collision_at(cx, b->y + (PHYS_BODY_H - 1)) & TF_LADDER)) {
+            // Feet left the top rung: stand on the ladder top.
+            b->y = (uint16_t)(((b->y + (PHYS_BODY_H - 1)) | 15u) + 1u - PHYS_BODY_H);
+            b->y_fx = 0;
+            b->state = PHYS_GROUND;
+        }
+        return edges;
+    }
+    if (down & INPUT_DOWN) {
+        fx_add(&b->y, &b->y_fx, PHYS_CLIMB_VY);
+        if (b->y + PHYS_BODY_H >= bound_h) {
+            b->y = bound_h - PHYS_BODY_H;
+            b->y_fx = 0;
+            b->state = PHYS_GROUND;
+            return PHYS_EDGE_D;
+        }
+        below = collision_at(cx, b->y + PHYS_BODY_H);
+        if (!(below & TF_LADDER)) {
+            if (below & PHYS_SUPPORT) {
+                b->y = collision_top_y - PHYS_BODY_H;
+                b->y_fx = 0;
+                b->state = PHYS_GROUND;
+            } else if (!(collision_at(cx, b->y + (PHYS_BODY_H - 1)) & TF_LADDER)) {
+                b->state = PHYS_FALL;
+                b->t = 0;
+            }
+        }
+    }
+    return 0;
+}
+
+void physics_set_bounds(uint16_t w_px, uint16_t h_px) {
+    bound_w = w_px;
+    bound_h = h_px;
+}
+
+void physics_place(PhysBody* b, uint8_t mx, uint8_t my) {
+    b->x = (uint16_t)((uint16_t)mx * 16u + (16u - PHYS_BODY_W) / 2u);
+    b->y = (uint16_t)((uint16_t)my * 16u + (16u - PHYS_BODY_H));
+    b->x_fx = 0;
+    b->y_fx = 0;
+    settle(b);
+}
+
+// A deck under the feet moved by dx,dy this frame. dy is applied as is
+// (deck paths are open cells); dx walks like a run step so walls still stop
+// the rider.
+uint8_t physics_carry(PhysBody* b, int8_t dx, int8_t dy) {
+    b->y = (uint16_t)(b->y + dy);
+    return move_x(b, (int16_t)((uint16_t)(int16_t)dx << 8));
+}
+
+// The shove walks like a run step so walls still stop it; the hop joins the
+// jump table halfway, past its strongest frames.
+uint8_t physics_knockback(PhysBody* b, int8_t dx) {
+    b->state = PHYS_JUMP;
+    b->t = PHYS_JUMP_FRAMES / 2;
+    return move_x(b, (int16_t)((uint16_t)(int16_t)dx << 8));
+}
+
+// One frame. Worst-case collision_at calls per state: ground 2 walk +
+// 8 follow + 2 ladder = 12, fall 2 + 1 + 8 = 11, jump 2 + 1 + 2 = 5,
+// climb 4. Horizontal control is kept in the air.
+uint8_t physics_step(PhysBody* b, uint8_t down, uint8_t pressed) {
+    int16_t vx = 0;
+    int16_t vy;
+    uint8_t edges;
+
+    if (b->state == PHYS_CLIMB) {
+        if (pressed & INPUT_FIRE) {
+            b->state = PHYS_JUMP;
+            b->t = 0;
+            return 0;
+        }
+        return step_climb(b, down);
+    }
+
+    if (down & INPUT_LEFT) {
+        vx = -PHYS_WALK_VX;
+    } else if (down & INPUT_RIGHT) {
+        vx = PHYS_WALK_VX;
+    }
+    // Wind adds to the run speed on the ground and in the air; ladders hold.
+    if (wind_active && (uint8_t)((b->y + PHYS_BODY_CY) >> 4) < wind_h) {
+        vx += wind_vx[wind_code_at(b->x + PHYS_BODY_CX, b->y + PHYS_BODY_CY)];
+    }
+    edges = move_x(b, vx);
+
+    switch (b->state) {
+    case PHYS_GROUND:
+        follow_ground(b);
+        if (b->state != PHYS_GROUND) {
+            break;
+        }
+        if (pressed & INPUT_FIRE) {
+            b->state = PHYS_JUMP;
+            b->t = 0;
+            break;
+        }
+        if ((down & INPUT_UP) && try_grab_ladder(b, b->y + (PHYS_BODY_H - 1))) {
+            break;
+        }
+        if (down & INPUT_DOWN) {
+            try_grab_ladder(b, b->y + PHYS_BODY_H);
+        }
+        break;
+    case PHYS_JUMP:
+        if ((down & INPUT_UP) && try_grab_ladder(b, b->y + (PHYS_BODY_H - 1))) {
+            break;
+        }
+        vy = phys_jump_vy[b->t];
+        if (++b->t >= PHYS_JUMP_FRAMES) {
+            b->state = PHYS_FALL;
+            b->t = 0;
+        }
+        edges |= move_up(b, vy);
+        break;
+    default:
+        if ((down & INPUT_UP) && try_grab_ladder(b, b->y + (PHYS_BODY_H - 1))) {
+            break;
+        }
+        vy = phys_fall_vy[b->t];
+        if (b->t < PHYS_FALL_FRAMES - 1) {
+            ++b->t;
+        }
+        // Below the water line the body sinks slowly and Fire is a swim stroke.
+        if (collision_in_water(b->y + PHYS_BODY_CY)) {
+            if (pressed & INPUT_FIRE) {
+                b->state = PHYS_JUMP;
+                b->t = 0;
+                break;
+            }
+            if (vy > PHYS_SWIM_VY) {
+                vy = PHYS_SWIM_VY;
+            }
+        }
+        edges |= move_down(b, vy);
+        break;
+    }
+    return edges;
+}
@@ -0,0 +1,86 @@
+#include "plate.h"
+
+#include "collision.h"
+#include "level_runtime.h"
+#include "puzzle.h"
+#include "room.h"
+
+#include "level_format.h"
+
+#define PLATE_NONE 0xFF
+
+static uint8_t plate_cell_x[PLATE_PRESSERS];
+static uint8_t plate_cell_y[PLATE_PRESSERS];
+static uint8_t plate_held[PLATE_PRESSERS];  // flag id, PLATE_NONE = not on a plate
+
+static uint8_t plate_lookup(uint8_t mx, uint8_t my) {
+    const uint8_t* blob = level_get_blob();
+    uint16_t plates_ofs = lvl_plates_ofs(blob);
+    uint8_t room;
+    uint8_t i;
+    uint8_t end;
+
+    if (!plates_ofs) {
+        return PLATE_NONE;
+    }
+    room = room_get_id();
+    end = lvl_plates_first(blob, plates_ofs, (uint8_t)(room + 1u));
+    for (i = lvl_plates_first(blob, plates_ofs, room); i < end; ++i) {
+        uint16_t base = lvl_plate_base(blob, plates_ofs, i);
+
+        if (lvl_rd8(blob, (uint16_t)(base + LVL_PLATE_OFS_X)) == mx &&
+            lvl_rd8(blob, (uint16_t)(base + LVL_PLATE_OFS_Y)) == my) {
+            return lvl_rd8(blob, (uint16_t)(base + LVL_PLATE_OFS_FLAG));
+        }
+    }
+    return PLATE_NONE;
+}
+
+void plate_init(void) {
+    uint8_t i;
+
+    for (i = 0; i < PLATE_PRESSERS; ++i) {
+        plate_cell_x[i] = PLATE_NO_CELL;
+        plate_cell_y[i] = PLATE_NO_CELL;
+        plate_held[i] = PLATE_NONE;
+    }
+}
+
+void plate_room_enter(void) {
+    plate_release(PLATE_PLAYER);
+}
+
+void plate_release(uint8_t who) {
+    uint8_t flag = plate_held[who];
+
+    plate_cell_x[who] = PLATE_NO_CELL;
+    plate_cell_y[who] = PLATE_NO_CELL;
+    if (flag == PLATE_NONE) {
+        return;
+    }
+    plate_held[who] = PLATE_NONE;
+    // The other presser may be standing on the same plate.
+    if (plate_held[who ^ 1u] != flag) {
+        puzzle_flag_clear((FlagId)flag);
+    }
+}
+
+void plate_press(uint8_t who, uint8_t mx, uint8_t my) {
+    uint8_t flag = PLATE_NONE;
+
+    if (mx == plate_cell_x[who] && my == plate_cell_y[who]) {
+        return;
+    }
+    if (mx != PLATE_NO_CELL && collision_plate(mx, my)) {
+        flag = plate_lookup(mx, my);
+    }
+    if (flag != plate_held[who]) {
+        plate_release(who);
+        plate_held[who] = flag;
+        if (flag != PLATE_NONE) {
+            puzzle_flag_set((FlagId)flag);
+        }
+    }
+    plate_cell_x[who] = mx;
+    plate_cell_y[who] = my;
+}
@@ -0,0 +1,259 @@
+#include "platform.h"
+
+#include "collision.h"
+#include "level_runtime.h"
+#include "metatile.h"
+#include "puzzle.h"
+#include "render.h"
+#include "room.h"
+#include "tileset_format.h"
+#include "physics_tables.h"
+
+#include "level_format.h"
+
+#define PLATFORM_NOT_DRAWN 0xFF
+
+// Positions are room pixels of the deck's top-left along its axis (y for
+// lifts, x for horizontal kinds); `cross` is the fixed coordinate.
+static uint8_t plat_count = 0;
+static uint8_t plat_axis[LVL_PLATFORM_ROOM_MAX];
+static uint8_t plat_rsh[LVL_PLATFORM_ROOM_MAX];
+static const uint8_t* plat_table[LVL_PLATFORM_ROOM_MAX];
+static uint16_t plat_a[LVL_PLATFORM_ROOM_MAX];
+static uint16_t plat_b[LVL_PLATFORM_ROOM_MAX];
+static uint16_t plat_pos[LVL_PLATFORM_ROOM_MAX];
+static uint16_t plat_goal[LVL_PLATFORM_ROOM_MAX];
+static uint16_t plat_cross[LVL_PLATFORM_ROOM_MAX];
+static uint8_t plat_speed[LVL_PLATFORM_ROOM_MAX];
+static uint8_t plat_flag[LVL_PLATFORM_ROOM_MAX];
+static int8_t plat_delta[LVL_PLATFORM_ROOM_MAX];  // moved this frame, along the axis
+// Footprint on screen: first char along the axis, its length (2 or 3) and shift.
+static uint8_t plat_drawn[LVL_PLATFORM_ROOM_MAX];
+static uint8_t plat_drawn_n[LVL_PLATFORM_ROOM_MAX];
+static uint8_t plat_drawn_shift[LVL_PLATFORM_ROOM_MAX];
+
+static void platform_sync_deck(uint8_t i) {
+    if (plat_axis[i] == TSET_PLATFORM_AXIS_V) {
+        collision_deck_x[i] = plat_cross[i];
+        collision_deck_y[i] = plat_pos[i];
+    } else {
+        collision_deck_x[i] = plat_pos[i];
+        collision_deck_y[i] = plat_cross[i];
+    }
+}
+
+// Cells along the axis from `lo` to `hi` at the deck's cross cell.
+static void platform_cells(uint8_t i, uint8_t lo, uint8_t hi, uint8_t mark) {
+    uint8_t across = (uint8_t)(plat_cross[i] >> 4);
+
+    for (; lo <= hi; ++lo) {
+        uint8_t mx = plat_axis[i] == TSET_PLATFORM_AXIS_V ? across : lo;
+        uint8_t my = plat_axis[i] == TSET_PLATFORM_AXIS_V ? lo : across;
+
+        if (mark) {
+            collision_mark_deck(mx, my);
+        } else {
+            collision_refresh_cell(mx, my);
+        }
+    }
+}
+
+// The deck covers one or two cells along its axis; only cells it entered
+// or left since `old` change in the collision map.
+static void platform_collide(uint8_t i, uint16_t old) {
+    uint8_t lo = (uint8_t)(plat_pos[i] >> 4);
+    uint8_t hi = (uint8_t)((plat_pos[i] + 15u) >> 4);
+    uint8_t old_lo = (uint8_t)(old >> 4);
+    uint8_t old_hi = (uint8_t)((old + 15u) >> 4);
+
+    if (old_lo < lo) {
+        platform_cells(i, old_lo, (uint8_t)(lo - 1u), 0);
+    }
+    if (old_hi > hi) {
+        platform_cells(i, (uint8_t)(hi + 1u), old_hi, 0);
+    }
+    platform_cells(i, lo, hi, 1);
+}
+
+static void platform_restore(uint8_t i, uint8_t along, uint8_t across) {
+    if (plat_axis[i] == TSET_PLATFORM_AXIS_V) {
+        render_restore_char(across, along);
+    } else {
+        render_restore_char(along, across);
+    }
+}
+
+// Writes the footprint for the current shift and restores the chars the
+// deck no longer covers. A lift is 2 chars wide and 2-3 tall; a horizontal
+// kind the other way round. Nothing is written while the shift and cell
+// are unchanged (horizontal kinds only shift every 2 px).
+static void platform_draw(uint8_t i) {
+    uint16_t pos = plat_pos[i];
+    uint8_t first = (uint8_t)(pos >> 3);
+    uint8_t n = (pos & 7u) ? 3u : 2u;
+    uint8_t shift = (uint8_t)((pos & 7u) >> plat_rsh[i]);
+    uint8_t across = (uint8_t)(plat_cross[i] >> 3);
+    uint8_t old = plat_drawn[i];
+    const uint8_t* row;
+    uint8_t k;
+    uint8_t j;
+
+    if (old == first && plat_drawn_shift[i] == shift) {
+        return;
+    }
+    if (old != PLATFORM_NOT_DRAWN) {
+        for (k = old; k != (uint8_t)(old + plat_drawn_n[i]); ++k) {
+            if (k < first || k >= (uint8_t)(first + n)) {
+                platform_restore(i, k, across);
+                platform_restore(i, k, (uint8_t)(across + 1u));
+            }
+        }
+    }
+    row = plat_table[i] + (uint8_t)(shift * (TSET_PLATFORM_CELLS * 2u));
+    for (k = 0; k < n; ++k) {
+        for (j = 0; j < 2; ++j) {
+            uint8_t cell = plat_axis[i] == TSET_PLATFORM_AXIS_V ? (uint8_t)(k * 2u + j) : (uint8_t)(j * 3u + k);
+            uint8_t ch = row[cell];
+            uint8_t color = row[(uint8_t)(cell + TSET_PLATFORM_CELLS)];
+
+            if (plat_axis[i] == TSET_PLATFORM_AXIS_V) {
+                render_put_char((uint8_t)(across + j), (uint8_t)(first + k), ch, color);
+            } else {
+                render_put_char((uint8_t)(first + k), (uint8_t)(across + j), ch, color);
+            }
+        }
+    }
+    plat_drawn[i] = first;
+    plat_drawn_n[i] = n;
+    plat_drawn_shift[i] = shift;
+}
+
+void platform_room_enter(void) {
+    const uint8_t* blob = level_get_blob();
+    uint16_t ofs = lvl_platforms_ofs(blob);
+    uint8_t room;
+    uint8_t idx;
+    uint8_t end;
+
+    plat_count = 0;
+    collision_deck_count = 0;
+    if (!ofs) {
+        return;
+    }
+    room = room_get_id();
+    end = lvl_platforms_first(blob, ofs, (uint8_t)(room + 1u));
+    for (idx = lvl_platforms_first(blob, ofs, room); idx < end && plat_count < LVL_PLATFORM_ROOM_MAX; ++idx) {
+        uint16_t base = lvl_platform_base(blob, ofs, idx);
+        const uint8_t* kind = metatile_get_platform(lvl_rd8(blob, (uint16_t)(base + LVL_PLATFORM_OFS_KIND)));
+        uint8_t i = plat_count;
+        uint8_t x0 = lvl_rd8(blob, (uint16_t)(base + LVL_PLATFORM_OFS_X0));
+        uint8_t y0 = lvl_rd8(blob, (uint16_t)(base + LVL_PLATFORM_OFS_Y0));
+
+        if (!kind) {
+            continue;
+        }
+        plat_axis[i] = kind[TSET_PLATFORM_OFS_AXIS];
+        plat_rsh[i] = kind[TSET_PLATFORM_OFS_RSH];
+        plat_table[i] = metatile_get_platform_table(kind);
+        if (plat_axis[i] == TSET_PLATFORM_AXIS_V) {
+            plat_a[i] = (uint16_t)y0 << 4;
+            plat_b[i] = (uint16_t)lvl_rd8(blob, (uint16_t)(base + LVL_PLATFORM_OFS_Y1)) << 4;
+            plat_cross[i] = (uint16_t)x0 << 4;
+        } else {
+            plat_a[i] = (uint16_t)x0 << 4;
+            plat_b[i] = (uint16_t)lvl_rd8(blob, (uint16_t)(base + LVL_PLATFORM_OFS_X1)) << 4;
+            plat_cross[i] = (uint16_t)y0 << 4;
+        }
+        plat_speed[i] = lvl_rd8(blob, (uint16_t)(base + LVL_PLATFORM_OFS_SPEED));
+        plat_flag[i] = lvl_rd8(blob, (uint16_t)(base + LVL_PLATFORM_OFS_FLAG));
+        // A called lift is already where its flag sends it; a shuttle starts at x0,y0.
+        plat_pos[i] = plat_a[i];
+        if (plat_flag[i] != LVL_PLATFORM_NO_FLAG && puzzle_flag_get((FlagId)plat_flag[i])) {
+            plat_pos[i] = plat_b[i];
+        }
+        plat_goal[i] = plat_pos[i];
+        plat_delta[i] = 0;
+        plat_drawn[i] = PLATFORM_NOT_DRAWN;
+        platform_sync_deck(i);
+        platform_collide(i, plat_pos[i]);
+        ++plat_count;
+    }
+    collision_deck_count = plat_count;
+}
+
+void platform_redraw(void) {
+    uint8_t i;
+
+    for (i = 0; i < plat_count; ++i) {
+        plat_drawn[i] = PLATFORM_NOT_DRAWN;
+        platform_draw(i);
+    }
+}
+
+// Idle decks cost a flag test and a compare; a moving deck rewrites its
+// footprint and at most two vacated chars (see levelc CYC_PLATFORM_*).
+void platform_update(void) {
+    uint8_t i;
+
+    for (i = 0; i < plat_count; ++i) {
+        uint16_t pos = plat_pos[i];
+        uint16_t goal = plat_goal[i];
+        uint8_t step = plat_speed[i];
+
+        plat_delta[i] = 0;
+        if (plat_flag[i] != LVL_PLATFORM_NO_FLAG) {
+            goal = puzzle_flag_get((FlagId)plat_flag[i]) ? plat_b[i] : plat_a[i];
+        } else if (pos == goal) {
+            goal = goal == plat_a[i] ? plat_b[i] : plat_a[i];
+        }
+        plat_goal[i] = goal;
+        if (pos == goal) {
+            continue;
+        }
+        if (pos < goal) {
+            if (goal - pos < step) {
+                step = (uint8_t)(goal - pos);
+            }
+            plat_pos[i] = (uint16_t)(pos + step);
+            plat_delta[i] = (int8_t)step;
+        } else {
+            if (pos - goal < step) {
+                step = (uint8_t)(pos - goal);
+            }
+            plat_pos[i] = (uint16_t)(pos - step);
+            plat_delta[i] = (int8_t)-(int8_t)step;
+        }
+        platform_sync_deck(i);
+        platform_collide(i, pos);
+        platform_draw(i);
+    }
+}
+
+// A rider stood on the deck's old top: feet exactly on it and the boxes
+// overlapping horizontally.
+uint8_t platform_carry(PhysBody* b) {
+    uint8_t i;
+
+    if (b->state != PHYS_GROUND) {
+        return 0;
+    }
+    for (i = 0; i < plat_count; ++i) {
+        int8_t d = plat_delta[i];
+        uint16_t x = collision_deck_x[i];
+        uint16_t y = collision_deck_y[i];
+
+        if (!d) {
+            continue;
+        }
+        if (plat_axis[i] == TSET_PLATFORM_AXIS_V) {
+            y = (uint16_t)(y - d);
+        } else {
+            x = (uint16_t)(x - d);
+        }
+        if ((uint16_t)(b->y + PHYS_BODY_H) == y &&
+            (uint16_t)(b->x + (PHYS_BODY_W - 1) - x) < (uint16_t)(16u + (PHYS_BODY_W - 1))) {
+            return plat_axis[i] == TSET_PLATFORM_AXIS_V ? physics_carry(b, 0, d) : physics_carry(b, d, 0);
+        }
+    }
+    return 0;
+}
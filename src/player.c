@@ -1,12 +1,18 @@
 #include "player.h"
 
+#include "companion.h"
+#include "dialog.h"
+#include "entity.h"
 #include "input.h"
+#include "laser.h"
+#include "plate.h"
+#include "platform.h"
 #include "room.h"
-#include "metatile.h"
+#include "physics.h"
 #include "vic_mem.h"
-#include "tile_flags.h"
 #include "level_format.h"
 #include "npc_sprites_mc.h"
+#include "physics_tables.h"
 
 #include <c64/sprites.h>
 #include <c64/vic.h>
@@ -19,8 +25,7 @@ static uint8_t* const sprite_ptrs = (uint8_t*)SPRITE_PTR_ADDR;
 static const uint8_t sprite_offset_x = 24;
 static const uint8_t sprite_offset_y = 50;
 
-static uint8_t player_x = 0;
-static uint8_t player_y = 0;
+static PhysBody player_body;
 static uint8_t player_inited = 0;
 
 static void player_sprite_init(void) {
@@ -38,11 +43,12 @@ static void player_sprite_init(void) {
     spr_set(0, 1, 0, 0, player_sprite_index, NPC_TECH_COLOR, 1, 0, 0);
 }
 
-static void player_sprite_move(uint8_t mx, uint8_t my) {
-    uint16_t px = (uint16_t)mx * 16u + sprite_offset_x;
-    uint16_t py = (uint16_t)my * 16u + sprite_offset_y;
+// Sprite coordinates come straight from the integer part of the body position.
+static void player_sprite_move(void) {
+    int px = (int)(player_body.x - PHYS_SPRITE_OFS_X + sprite_offset_x);
+    int py = (int)(player_body.y - PHYS_SPRITE_OFS_Y + sprite_offset_y);
 
-    spr_move(0, (int)px, (int)py);
+    spr_move(0, px, py);
 }
 
 static void player_place_at_spawn(void) {
@@ -50,23 +56,8 @@ static void player_place_at_spawn(void) {
     uint8_t sy = 0;
     uint8_t spawn_id = room_get_spawn_id();
     room_get_spawn_xy(spawn_id, &sx, &sy);
-    player_x = sx;
-    player_y = sy;
-}
-
-static uint8_t map_is_solid(uint8_t mx, uint8_t my) {
-    const uint8_t* map = room_get_map();
-    uint8_t w = room_get_width();
-    uint8_t h = room_get_height();
-    uint8_t mt_id;
-    uint16_t flags;
-
-    if (!map || mx >= w || my >= h) {
-        return 1;
-    }
-    mt_id = map[(uint16_t)my * w + mx];
-    flags = metatile_get_flags(mt_id);
-    return (flags & TF_SOLID) ? 1 : 0;
+    physics_set_bounds((uint16_t)room_get_width() * 16u, (uint16_t)room_get_height() * 16u);
+    physics_place(&player_body, sx, sy);
 }
 
 static uint8_t try_exit(uint8_t edge) {
@@ -78,10 +69,12 @@ static uint8_t try_exit(uint8_t edge) {
         uint8_t dest_spawn;
         room_get_exit(i, &type, &dest_room, &dest_spawn);
         if (type == edge) {
-            room_load_with_spawn(dest_room, dest_spawn);
+            if (!room_load_with_spawn(dest_room, dest_spawn)) {
+                return 0;  // segment read failed: stay in this room
+            }
             room_render();
             player_place_at_spawn();
-            player_sprite_move(player_x, player_y);
+            player_sprite_move();
             return 1;
         }
     }
@@ -91,71 +84,58 @@ static uint8_t try_exit(uint8_t edge) {
 void player_init(void) {
     player_sprite_init();
     player_place_at_spawn();
-    player_sprite_move(player_x, player_y);
+    player_sprite_move();
     player_inited = 1;
 }
 
 void player_update(void) {
-    int8_t dx = 0;
-    int8_t dy = 0;
-    uint8_t next_x;
-    uint8_t next_y;
-    uint8_t w;
-    uint8_t h;
+    uint8_t edges;
+    int8_t push;
+    uint16_t cx;
+    uint16_t cy;
 
     if (!player_inited) {
         player_init();
         return;
     }
 
-    if (input_pressed & INPUT_LEFT) {
-        dx = -1;
-    } else if (input_pressed & INPUT_RIGHT) {
-        dx = 1;
-    } else if (input_pressed & INPUT_UP) {
-        dy = -1;
-    } else if (input_pressed & INPUT_DOWN) {
-        dy = 1;
+    edges = platform_carry(&player_body);
+    // An open dialog owns the joystick; the body still falls and rides decks.
+    if (dialog_active()) {
+        edges |= physics_step(&player_body, 0, 0);
     } else {
-        return;
+        edges |= physics_step(&player_body, input_down, input_pressed);
     }
-
-    w = room_get_width();
-    h = room_get_height();
-
-    next_x = (uint8_t)(player_x + dx);
-    next_y = (uint8_t)(player_y + dy);
-
-    if (dx < 0 && player_x == 0) {
-        if (try_exit(EXIT_L)) {
+    cx = (uint16_t)(player_body.x + PHYS_BODY_W / 2u);
+    cy = (uint16_t)(player_body.y + PHYS_BODY_H / 2u);
+    // entity_hit also tells FACE PLAYER where the player is, so it always runs.
+    push = entity_hit(cx, cy);
+    if (!push) {
+        push = laser_hit(cx, cy);
+    }
+    if (push) {
+        edges |= physics_knockback(&player_body, push);
+    }
+    if (edges) {
+        if ((edges & PHYS_EDGE_L) && try_exit(EXIT_L)) {
             return;
         }
-        return;
-    }
-    if (dx > 0 && player_x + 1 >= w) {
-        if (try_exit(EXIT_R)) {
+        if ((edges & PHYS_EDGE_R) && try_exit(EXIT_R)) {
             return;
         }
-        return;
-    }
-    if (dy < 0 && player_y == 0) {
-        if (try_exit(EXIT_U)) {
+        if ((edges & PHYS_EDGE_U) && try_exit(EXIT_U)) {
             return;
         }
-        return;
-    }
-    if (dy > 0 && player_y + 1 >= h) {
-        if (try_exit(EXIT_D)) {
+        if ((edges & PHYS_EDGE_D) && try_exit(EXIT_D)) {
             return;
         }
-        return;
     }
-
-    if (map_is_solid(next_x, next_y)) {
-        return;
+    companion_trail_push(player_body.x, player_body.y);
+    if (player_body.state == PHYS_GROUND) {
+        plate_press(PLATE_PLAYER, (uint8_t)((player_body.x + PHYS_BODY_W / 2u) >> 4),
+                    (uint8_t)((player_body.y + PHYS_BODY_H) >> 4));
+    } else {
+        plate_press(PLATE_PLAYER, PLATE_NO_CELL, PLATE_NO_CELL);
     }
-
-    player_x = next_x;
-    player_y = next_y;
-    player_sprite_move(player_x, player_y);
+    player_sprite_move();
 }
@@ -1,23 +1,37 @@
 #include "puzzle.h"
 
+#include "companion.h"
+#include "dialog.h"
 #include "inventory.h"
+#include "laser.h"
 #include "level_runtime.h"
+#include "particle.h"
 #include "room.h"
+#include "route.h"
 #include "textbox.h"
+#include "tilestate.h"
+#include "water.h"
+#include "wind.h"
 
 #include "level_format.h"
 
 enum {
     PUZZLE_MAX_FLAGS = 256,
     PUZZLE_MAX_VARS = 64,
-    PUZZLE_FLAG_BYTES = PUZZLE_MAX_FLAGS / 8
+    PUZZLE_FLAG_BYTES = PUZZLE_MAX_FLAGS / 8,
+    CAMPAIGN_FLAG_BYTES = LVL_CAMPAIGN_MAX_FLAGS / 8
 };
 
+// Level tier: sized by the blob header, cleared on every puzzle_init.
 static uint8_t puzzle_flags[PUZZLE_FLAG_BYTES];
 static uint8_t puzzle_vars[PUZZLE_MAX_VARS];
 static uint8_t puzzle_flag_count = 0;
 static uint8_t puzzle_var_count = 0;
 
+// Campaign tier: fixed size, survives level loads; only puzzle_campaign_reset clears it.
+static uint8_t campaign_flags[CAMPAIGN_FLAG_BYTES];
+static uint8_t campaign_vars[LVL_CAMPAIGN_MAX_VARS];
+
 static void puzzle_clear_state(void) {
     uint16_t i;
 
@@ -56,17 +70,37 @@ unsigned char puzzle_flag_get(FlagId flag_id) {
 }
 
 void puzzle_flag_set(FlagId flag_id) {
+    uint8_t mask;
+
     if (flag_id >= puzzle_flag_count) {
         return;
     }
-    puzzle_flags[flag_id >> 3] |= (uint8_t)(1u << (flag_id & 7u));
+    mask = (uint8_t)(1u << (flag_id & 7u));
+    if (puzzle_flags[flag_id >> 3] & mask) {
+        return;
+    }
+    puzzle_flags[flag_id >> 3] |= mask;
+    tilestate_flag_changed((uint8_t)flag_id, 1);
+    wind_flag_changed((uint8_t)flag_id);
+    laser_flag_changed((uint8_t)flag_id);
+    route_flag_changed((uint8_t)flag_id, 1);
 }
 
 void puzzle_flag_clear(FlagId flag_id) {
+    uint8_t mask;
+
     if (flag_id >= puzzle_flag_count) {
         return;
     }
-    puzzle_flags[flag_id >> 3] &= (uint8_t)~(1u << (flag_id & 7u));
+    mask = (uint8_t)(1u << (flag_id & 7u));
+    if (!(puzzle_flags[flag_id >> 3] & mask)) {
+        return;
+    }
+    puzzle_flags[flag_id >> 3] &= (uint8_t)~mask;
+    tilestate_flag_changed((uint8_t)flag_id, 0);
+    wind_flag_changed((uint8_t)flag_id);
+    laser_flag_changed((uint8_t)flag_id);
+    route_flag_changed((uint8_t)flag_id, 0);
 }
 
 unsigned char puzzle_var_get(VarId var_id) {
@@ -77,10 +111,86 @@ unsigned char puzzle_var_get(VarId var_id) {
 }
 
 void puzzle_var_set(VarId var_id, unsigned char value) {
-    if (var_id >= puzzle_var_count) {
+    if (var_id >= puzzle_var_count || puzzle_vars[var_id] == value) {
         return;
     }
     puzzle_vars[var_id] = value;
+    water_var_changed((uint8_t)var_id, value);
+}
+
+void puzzle_campaign_reset(void) {
+    uint16_t i;
+
+    for (i = 0; i < CAMPAIGN_FLAG_BYTES; ++i) {
+        campaign_flags[i] = 0;
+    }
+    for (i = 0; i < LVL_CAMPAIGN_MAX_VARS; ++i) {
+        campaign_vars[i] = 0;
+    }
+}
+
+unsigned char puzzle_campaign_flag_get(unsigned short flag_id) {
+    if (flag_id >= LVL_CAMPAIGN_MAX_FLAGS) {
+        return 0;
+    }
+    return (campaign_flags[flag_id >> 3] >> (flag_id & 7u)) & 1u;
+}
+
+void puzzle_campaign_flag_set(unsigned short flag_id) {
+    if (flag_id >= LVL_CAMPAIGN_MAX_FLAGS) {
+        return;
+    }
+    campaign_flags[flag_id >> 3] |= (uint8_t)(1u << (flag_id & 7u));
+}
+
+void puzzle_campaign_flag_clear(unsigned short flag_id) {
+    if (flag_id >= LVL_CAMPAIGN_MAX_FLAGS) {
+        return;
+    }
+    campaign_flags[flag_id >> 3] &= (uint8_t)~(1u << (flag_id & 7u));
+}
+
+unsigned char puzzle_campaign_var_get(unsigned char var_id) {
+    if (var_id >= LVL_CAMPAIGN_MAX_VARS) {
+        return 0;
+    }
+    return campaign_vars[var_id];
+}
+
+void puzzle_campaign_var_set(unsigned char var_id, unsigned char value) {
+    if (var_id >= LVL_CAMPAIGN_MAX_VARS) {
+        return;
+    }
+    campaign_vars[var_id] = value;
+}
+
+// Wide flag ids from the *_W opcodes: bit 15 picks the tier.
+static unsigned char puzzle_wide_flag_get(uint8_t lo, uint8_t hi) {
+    uint16_t id = (uint16_t)lo | ((uint16_t)hi << 8);
+
+    if (id & LVL_FLAG_WIDE_CAMPAIGN) {
+        return puzzle_campaign_flag_get(id & (uint16_t)~LVL_FLAG_WIDE_CAMPAIGN);
+    }
+    return id < 256u ? puzzle_flag_get((FlagId)id) : 0;
+}
+
+static void puzzle_wide_flag_write(uint8_t lo, uint8_t hi, unsigned char value) {
+    uint16_t id = (uint16_t)lo | ((uint16_t)hi << 8);
+
+    if (id & LVL_FLAG_WIDE_CAMPAIGN) {
+        id &= (uint16_t)~LVL_FLAG_WIDE_CAMPAIGN;
+        if (value) {
+            puzzle_campaign_flag_set(id);
+        } else {
+            puzzle_campaign_flag_clear(id);
+        }
+    } else if (id < 256u) {
+        if (value) {
+            puzzle_flag_set((FlagId)id);
+        } else {
+            puzzle_flag_clear((FlagId)id);
+        }
+    }
 }
 
 unsigned char puzzle_conditions_pass(unsigned short cond_ofs) {
@@ -125,6 +235,21 @@ unsigned char puzzle_conditions_pass(unsigned short cond_ofs) {
                     return 0;
                 }
                 break;
+            case C_FLAG_SET_W:
+                if (!puzzle_wide_flag_get(a, b)) {
+                    return 0;
+                }
+                break;
+            case C_FLAG_CLR_W:
+                if (puzzle_wide_flag_get(a, b)) {
+                    return 0;
+                }
+                break;
+            case C_VAR_EQ_C:
+                if (puzzle_campaign_var_get(a) != b) {
+                    return 0;
+                }
+                break;
             default:
                 return 0;
         }
@@ -169,10 +294,30 @@ void puzzle_run_actions(unsigned short act_ofs) {
             case A_SET_VAR:
                 puzzle_var_set(a, b);
                 break;
+            case A_SET_FLAG_W:
+                puzzle_wide_flag_write(a, b, 1);
+                break;
+            case A_CLR_FLAG_W:
+                puzzle_wide_flag_write(a, b, 0);
+                break;
+            case A_SET_VAR_C:
+                puzzle_campaign_var_set(a, b);
+                break;
             case A_SFX:
                 break;
+            case A_COMPANION:
+                companion_set_mode(a);
+                break;
+            case A_PARTICLES:
+                particle_spawn((uint8_t)(a >> 5), (uint8_t)(a & 31u), (uint8_t)(b & 15u), (uint8_t)((b >> 4) + 1u));
+                break;
+            case A_DIALOG:
+                dialog_start((uint16_t)a | ((uint16_t)b << 8));
+                break;
             case A_TRANSITION:
-                room_load_with_spawn(a, b);
+                if (!room_load_with_spawn(a, b) || level_is_segmented()) {
+                    return;  // the segment holding this script may have been replaced
+                }
                 break;
             default:
                 return;
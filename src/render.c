@@ -1,7 +1,9 @@
 #include "render.h"
 #include "room.h"
 #include "metatile.h"
+#include "platform.h"
 #include "vic_mem.h"
+#include "tileset_format.h"
 
 #include <c64/vic.h>
 #include <c64/charwin.h>
@@ -10,9 +12,38 @@
 static CharWin screen_win;
 static uint8_t render_ready = 0;
 
+// Cells changed since the last frame (tile states). Overflow falls back to a
+// full room redraw instead of dropping cells.
+#define RENDER_DIRTY_MAX 16
+#define RENDER_DIRTY_PER_FRAME 4
+static uint8_t dirty_x[RENDER_DIRTY_MAX];
+static uint8_t dirty_y[RENDER_DIRTY_MAX];
+static uint8_t dirty_head = 0;
+static uint8_t dirty_count = 0;
+static uint8_t dirty_overflow = 0;
+
+// Layer toggle: the room's diff list ([x, y, tile] records) is redrawn a few
+// cells per frame, reading tiles from the now-active map.
+#define RENDER_SWEEP_PER_FRAME 12
+static const uint8_t* sweep_cells = 0;
+static uint8_t sweep_left = 0;
+
 #define VIC_CTRL2_ADDR 0xd016u
 #define CIA2_PRA_ADDR  0xdd00u
 
+// Tileset glyphs (platform shifts) go over the loaded charset at their codes.
+static void render_load_glyphs(void) {
+    const uint8_t* g = metatile_get_glyphs();
+    uint8_t n;
+
+    if (!g) {
+        return;
+    }
+    for (n = *g++; n; --n, g += TSET_GLYPH_RECORD_SIZE) {
+        memcpy((uint8_t*)CHARSET_ADDR + (uint16_t)g[0] * 8u, g + 1, 8u);
+    }
+}
+
 static void render_load_charset(void) {
     const uint8_t* blob = metatile_get_charset_blob();
     uint32_t size = metatile_get_charset_size();
@@ -28,6 +59,7 @@ static void render_load_charset(void) {
     *cia2_pra = (uint8_t)((*cia2_pra & 0xFCu) | 0x02u); // VIC bank 1 ($4000-$7FFF)
 
     memcpy((void*)CHARSET_ADDR, blob, 2048u);
+    render_load_glyphs();
 
     screen_index = (uint8_t)((SCREEN_ADDR - VIC_BANK_BASE) >> 10);  // / 0x400
     charset_index = (uint8_t)((CHARSET_ADDR - VIC_BANK_BASE) >> 11); // / 0x800
@@ -57,6 +89,9 @@ void render_room(void) {
     uint8_t mx;
     uint8_t my;
 
+    dirty_count = 0;
+    dirty_overflow = 0;
+    sweep_left = 0;
     if (!render_ready || !map || w == 0 || h == 0) {
         return;
     }
@@ -73,7 +108,96 @@ void render_room(void) {
             render_metatile(mx, my, mt_id);
         }
     }
-    return;
+    platform_redraw();
+}
+
+void render_mark_dirty(uint8_t mx, uint8_t my) {
+    uint8_t i;
+
+    if (dirty_overflow) {
+        return;
+    }
+    if (dirty_count == RENDER_DIRTY_MAX) {
+        dirty_overflow = 1;
+        return;
+    }
+    i = (uint8_t)((dirty_head + dirty_count) & (RENDER_DIRTY_MAX - 1u));
+    dirty_x[i] = mx;
+    dirty_y[i] = my;
+    ++dirty_count;
+}
+
+// Arms the sweep over `count` [x, y, tile] records; render_update draws them.
+void render_sweep(const uint8_t* cells, uint8_t count) {
+    sweep_cells = cells;
+    sweep_left = cells ? count : 0;
+}
+
+// Redraws at most RENDER_SWEEP_PER_FRAME swept and RENDER_DIRTY_PER_FRAME
+// queued cells so a flag that flips many tiles spreads the screen writes
+// over a few frames.
+void render_update(void) {
+    const uint8_t* map;
+    uint8_t w;
+    uint8_t n;
+
+    if (dirty_overflow) {
+        render_room();
+        return;
+    }
+    if (dirty_count == 0 && sweep_left == 0) {
+        return;
+    }
+    map = room_get_map();
+    w = room_get_width();
+    for (n = 0; n < RENDER_SWEEP_PER_FRAME && sweep_left; ++n) {
+        uint8_t mx = sweep_cells[0];
+        uint8_t my = sweep_cells[1];
+
+        sweep_cells += 3;
+        --sweep_left;
+        render_metatile(mx, my, map[(uint16_t)my * w + mx]);
+    }
+    for (n = 0; n < RENDER_DIRTY_PER_FRAME && dirty_count; ++n) {
+        uint8_t mx = dirty_x[dirty_head];
+        uint8_t my = dirty_y[dirty_head];
+
+        dirty_head = (uint8_t)((dirty_head + 1u) & (RENDER_DIRTY_MAX - 1u));
+        --dirty_count;
+        render_metatile(mx, my, map[(uint16_t)my * w + mx]);
+    }
+}
+
+void render_put_char(uint8_t cx, uint8_t cy, uint8_t ch, uint8_t color) {
+    if (!render_ready || cx >= (uint8_t)screen_win.wx || cy >= (uint8_t)screen_win.wy) {
+        return;
+    }
+    render_write_char(cx, cy, ch, color);
+}
+
+// What is on screen now; particles save it before drawing over a cell.
+uint8_t render_get_char(uint8_t cx, uint8_t cy) {
+    return (uint8_t)screen_win.sp[(uint16_t)cy * 40u + cx];
+}
+
+uint8_t render_get_color(uint8_t cx, uint8_t cy) {
+    return (uint8_t)(screen_win.cp[(uint16_t)cy * 40u + cx] & 0x07u);
+}
+
+// One char cell of the room map, for movers that only touch part of a tile.
+void render_restore_char(uint8_t cx, uint8_t cy) {
+    const uint8_t* map = room_get_map();
+    uint8_t mt_id;
+    uint8_t q;
+    uint8_t color;
+
+    if (!map || (uint8_t)(cx >> 1) >= room_get_width() || (uint8_t)(cy >> 1) >= room_get_height()) {
+        return;
+    }
+    mt_id = map[(uint16_t)(cy >> 1) * room_get_width() + (cx >> 1)];
+    q = (uint8_t)(((cy & 1u) << 1) | (cx & 1u));
+    color = metatile_get_colors(mt_id)[metatile_get_color_mode(mt_id) ? q : 0];
+    render_put_char(cx, cy, metatile_get_chars(mt_id)[q], color);
 }
 
 void render_metatile(uint8_t mx, uint8_t my, uint8_t mt_id) {
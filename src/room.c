@@ -1,9 +1,23 @@
 #include "room.h"
 #include "render.h"
 #include "level_runtime.h"
+#include "metatile.h"
+#include "collision.h"
+#include "companion.h"
+#include "entity.h"
+#include "laser.h"
+#include "particle.h"
+#include "plate.h"
+#include "platform.h"
+#include "puzzle.h"
+#include "tilestate.h"
+#include "water.h"
+#include "wind.h"
 
 #include "level_format.h"
 
+#include <string.h>
+
 static uint8_t current_room_id = 0;
 static uint8_t current_spawn_id = 0;
 static const uint8_t* room_map = 0;
@@ -11,13 +25,53 @@ static uint16_t room_map_ofs = 0;
 static uint16_t room_spawns_ofs = 0;
 static uint16_t room_exits_ofs = 0;
 static uint16_t room_objects_ofs = 0;
+// RAM copies of the map, one per layer, so tile states and the layer toggle
+// can change cells; levels with more cells than this render straight from
+// the blob and cannot use STATES or ALTMAP.
+static uint8_t room_cells[2][ROOM_CELLS_MAX];
+static uint8_t room_writable = 0;
+static uint8_t room_layer = 0;
+static uint16_t room_diff_ofs = 0;  // 0 = both layers identical
+
+static uint8_t room_layer_flag_set(const uint8_t* blob) {
+    uint16_t layers_ofs = lvl_layers_ofs(blob);
+
+    return layers_ofs && puzzle_flag_get((FlagId)lvl_layer_flag(blob, layers_ofs));
+}
+
+static void room_build_layers(const uint8_t* blob, uint16_t cells) {
+    uint16_t layers_ofs = lvl_layers_ofs(blob);
+    uint16_t p;
+    uint8_t n;
+
+    memcpy(room_cells[0], blob + room_map_ofs, cells);
+    room_diff_ofs = layers_ofs ? lvl_layer_diff_ofs(blob, layers_ofs, current_room_id) : 0;
+    if (!room_diff_ofs) {
+        return;
+    }
+    memcpy(room_cells[1], room_cells[0], cells);
+    n = lvl_rd8(blob, room_diff_ofs);
+    for (p = (uint16_t)(room_diff_ofs + 1u); n; --n, p = (uint16_t)(p + LVL_LAYER_RECORD_SIZE)) {
+        room_cells[1][(uint16_t)lvl_rd8(blob, (uint16_t)(p + 1u)) * level_get_map_width() + lvl_rd8(blob, p)] =
+            lvl_rd8(blob, (uint16_t)(p + 2u));
+    }
+}
 
 void room_load(unsigned char room_id) {
     room_load_with_spawn(room_id, 0);
 }
 
-void room_load_with_spawn(unsigned char room_id, unsigned char spawn_id) {
-    const uint8_t* blob = level_get_blob();
+unsigned char room_load_with_spawn(unsigned char room_id, unsigned char spawn_id) {
+    const uint8_t* blob;
+    uint16_t pages_ofs;
+    uint16_t cells;
+
+    // Segmented levels: imported ids page in the destination segment first.
+    room_id = level_resolve_room(room_id);
+    if (room_id == LEVEL_ROOM_NONE) {
+        return 0;
+    }
+    blob = level_get_blob();
 
     current_room_id = room_id;
     current_spawn_id = spawn_id;
@@ -26,6 +80,50 @@ void room_load_with_spawn(unsigned char room_id, unsigned char spawn_id) {
     room_exits_ofs = lvl_room_exits_ofs(blob, room_id);
     room_objects_ofs = lvl_room_objects_ofs(blob, room_id);
     room_map = blob + room_map_ofs;
+    room_layer = 0;
+    room_diff_ofs = 0;
+    cells = (uint16_t)level_get_map_width() * level_get_map_height();
+    room_writable = cells <= ROOM_CELLS_MAX;
+    if (room_writable) {
+        room_build_layers(blob, cells);
+        tilestate_apply_room();
+        room_layer = (uint8_t)(room_diff_ofs && room_layer_flag_set(blob));
+        room_map = room_cells[room_layer];
+    }
+    render_sweep(0, 0);
+
+    pages_ofs = lvl_pages_ofs(blob);
+    if (pages_ofs) {
+        metatile_select_page(blob + lvl_page_list_ofs(blob, pages_ofs, lvl_room_page(blob, pages_ofs, room_id)));
+    } else {
+        metatile_select_page(0);
+    }
+    collision_build();
+    water_room_enter();
+    wind_room_enter();
+    plate_room_enter();
+    platform_room_enter();
+    laser_room_enter();
+    entity_room_enter();
+    particle_room_enter();
+    companion_room_enter();
+    return 1;
+}
+
+// Constant-time toggle: both layers and both collision planes are already
+// built, so this swaps pointers and hands the diff list to the renderer.
+void room_set_layer(unsigned char layer) {
+    const uint8_t* blob;
+
+    layer = layer ? 1u : 0u;
+    if (!room_diff_ofs || layer == room_layer) {
+        return;
+    }
+    blob = level_get_blob();
+    room_layer = layer;
+    room_map = room_cells[layer];
+    collision_select_layer(layer);
+    render_sweep(blob + room_diff_ofs + 1u, lvl_rd8(blob, room_diff_ofs));
 }
 
 void room_render(void) {
@@ -36,6 +134,63 @@ const unsigned char* room_get_map(void) {
     return room_map;
 }
 
+const unsigned char* room_get_layer_map(unsigned char layer) {
+    if (!room_writable || (layer && !room_diff_ofs)) {
+        return layer ? 0 : room_map;
+    }
+    return room_cells[layer ? 1 : 0];
+}
+
+unsigned char room_get_layer(void) {
+    return room_layer;
+}
+
+void room_put_cell(unsigned char mx, unsigned char my, unsigned char tile) {
+    uint16_t i;
+
+    if (!room_writable || mx >= level_get_map_width() || my >= level_get_map_height()) {
+        return;
+    }
+    i = (uint16_t)my * level_get_map_width() + mx;
+    room_cells[0][i] = tile;
+    room_cells[1][i] = tile;
+}
+
+void room_set_cell(unsigned char mx, unsigned char my, unsigned char tile) {
+    if (!room_writable || mx >= level_get_map_width() || my >= level_get_map_height()) {
+        return;
+    }
+    room_put_cell(mx, my, tile);
+    collision_refresh_cell(mx, my);
+    render_mark_dirty(mx, my);
+}
+
+void room_reset_cell(unsigned char mx, unsigned char my) {
+    const uint8_t* blob;
+    uint16_t i;
+    uint16_t p;
+    uint8_t n;
+
+    if (!room_writable || mx >= level_get_map_width() || my >= level_get_map_height()) {
+        return;
+    }
+    blob = level_get_blob();
+    i = (uint16_t)my * level_get_map_width() + mx;
+    room_cells[0][i] = lvl_rd8(blob, (uint16_t)(room_map_ofs + i));
+    room_cells[1][i] = room_cells[0][i];
+    if (room_diff_ofs) {
+        n = lvl_rd8(blob, room_diff_ofs);
+        for (p = (uint16_t)(room_diff_ofs + 1u); n; --n, p = (uint16_t)(p + LVL_LAYER_RECORD_SIZE)) {
+            if (lvl_rd8(blob, p) == mx && lvl_rd8(blob, (uint16_t)(p + 1u)) == my) {
+                room_cells[1][i] = lvl_rd8(blob, (uint16_t)(p + 2u));
+                break;
+            }
+        }
+    }
+    collision_refresh_cell(mx, my);
+    render_mark_dirty(mx, my);
+}
+
 unsigned char room_get_width(void) {
     return level_get_map_width();
 }
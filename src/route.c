@@ -0,0 +1,124 @@
+#include "route.h"
+
+#include "level_runtime.h"
+#include "puzzle.h"
+
+#include "level_format.h"
+
+// Live adjacency: bit j of route_adj[r][i] = edge i -> j present now.
+static uint8_t route_adj[LVL_ROUTE_MAX][LVL_ROUTE_MAX_NODES];
+
+static void route_set_edge(uint8_t r, uint8_t from, uint8_t to, uint8_t on) {
+    uint8_t src = (uint8_t)(from & LVL_ROUTE_NODE_MASK);
+
+    if (on) {
+        route_adj[r][src] |= (uint8_t)(1u << to);
+        if (!(from & LVL_ROUTE_EDGE_ONEWAY)) {
+            route_adj[r][to] |= (uint8_t)(1u << src);
+        }
+    } else {
+        route_adj[r][src] &= (uint8_t)~(1u << to);
+        if (!(from & LVL_ROUTE_EDGE_ONEWAY)) {
+            route_adj[r][to] &= (uint8_t)~(1u << src);
+        }
+    }
+}
+
+// Transitive closure of the route (Warshall on bit rows: node_count^2 steps
+// whatever changed), then one bit test per REACH to update its flag.
+static void route_solve(const uint8_t* blob, uint16_t base, uint8_t r) {
+    uint8_t reach[LVL_ROUTE_MAX_NODES];
+    uint8_t nodes = lvl_rd8(blob, base);
+    uint8_t count = lvl_rd8(blob, (uint16_t)(base + 2u));
+    uint8_t i;
+    uint8_t k;
+    uint16_t p;
+
+    for (i = 0; i < nodes; ++i) {
+        reach[i] = (uint8_t)(route_adj[r][i] | (1u << i));
+    }
+    for (k = 0; k < nodes; ++k) {
+        uint8_t bit = (uint8_t)(1u << k);
+
+        for (i = 0; i < nodes; ++i) {
+            if (reach[i] & bit) {
+                reach[i] |= reach[k];
+            }
+        }
+    }
+    p = (uint16_t)(base + 3u + nodes + (uint16_t)lvl_rd8(blob, (uint16_t)(base + 1u)) * LVL_ROUTE_RECORD_SIZE);
+    for (; count; --count, p = (uint16_t)(p + LVL_ROUTE_RECORD_SIZE)) {
+        FlagId flag = (FlagId)lvl_rd8(blob, (uint16_t)(p + 2u));
+
+        if ((reach[lvl_rd8(blob, p)] >> lvl_rd8(blob, (uint16_t)(p + 1u))) & 1u) {
+            puzzle_flag_set(flag);
+        } else {
+            puzzle_flag_clear(flag);
+        }
+    }
+}
+
+// Level start: fixed rows plus every switched edge whose flag says present.
+void route_init(void) {
+    const uint8_t* blob = level_get_blob();
+    uint16_t routes_ofs = lvl_routes_ofs(blob);
+    uint16_t base;
+    uint8_t routes;
+    uint8_t r;
+
+    if (!routes_ofs) {
+        return;
+    }
+    routes = lvl_rd8(blob, routes_ofs);
+    base = lvl_route_first(blob, routes_ofs);
+    for (r = 0; r < routes && r < LVL_ROUTE_MAX; ++r, base = lvl_route_next(blob, base)) {
+        uint8_t nodes = lvl_rd8(blob, base);
+        uint8_t edges = lvl_rd8(blob, (uint16_t)(base + 1u));
+        uint16_t p = (uint16_t)(base + 3u);
+        uint8_t i;
+
+        for (i = 0; i < nodes; ++i) {
+            route_adj[r][i] = lvl_rd8(blob, p++);
+        }
+        for (; edges; --edges, p = (uint16_t)(p + LVL_ROUTE_RECORD_SIZE)) {
+            uint8_t from = lvl_rd8(blob, (uint16_t)(p + 1u));
+            uint8_t on = puzzle_flag_get((FlagId)lvl_rd8(blob, p)) ^ ((from & LVL_ROUTE_EDGE_INVERT) ? 1u : 0u);
+
+            route_set_edge(r, from, lvl_rd8(blob, (uint16_t)(p + 2u)), on);
+        }
+        route_solve(blob, base, r);
+    }
+}
+
+void route_flag_changed(uint8_t flag_id, uint8_t is_set) {
+    const uint8_t* blob = level_get_blob();
+    uint16_t routes_ofs = lvl_routes_ofs(blob);
+    uint16_t base;
+    uint8_t mask;
+    uint8_t r;
+
+    if (!routes_ofs) {
+        return;
+    }
+    mask = lvl_route_switch_mask(blob, routes_ofs, flag_id);
+    base = lvl_route_first(blob, routes_ofs);
+    for (r = 0; mask; ++r, mask >>= 1, base = lvl_route_next(blob, base)) {
+        uint8_t edges;
+        uint16_t p;
+
+        if (!(mask & 1u)) {
+            continue;
+        }
+        edges = lvl_rd8(blob, (uint16_t)(base + 1u));
+        p = (uint16_t)(base + 3u + lvl_rd8(blob, base));
+        for (; edges; --edges, p = (uint16_t)(p + LVL_ROUTE_RECORD_SIZE)) {
+            if (lvl_rd8(blob, p) == flag_id) {
+                uint8_t from = lvl_rd8(blob, (uint16_t)(p + 1u));
+
+                route_set_edge(r, from, lvl_rd8(blob, (uint16_t)(p + 2u)),
+                               (uint8_t)(is_set ^ ((from & LVL_ROUTE_EDGE_INVERT) ? 1u : 0u)));
+            }
+        }
+        route_solve(blob, base, r);
+    }
+}
@@ -23,6 +23,15 @@ void textbox_show(const char* text) {
     }
 }
 
+void textbox_show_choice(const char* text) {
+    textbox_text = text;
+    cwin_clear(&textbox_win);
+    cwin_putat_char_raw(&textbox_win, 0, 0, '>', 1);
+    if (text) {
+        cwin_putat_string_raw(&textbox_win, 2, 0, text, 1);
+    }
+}
+
 const char* textbox_get_text(void) {
     return textbox_text;
 }
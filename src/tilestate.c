@@ -0,0 +1,76 @@
+#include "tilestate.h"
+
+#include "level_runtime.h"
+#include "puzzle.h"
+#include "room.h"
+
+#include "level_format.h"
+
+void tilestate_apply_room(void) {
+    const uint8_t* blob = level_get_blob();
+    uint16_t states_ofs = lvl_states_ofs(blob);
+    uint8_t flag_count;
+    uint8_t room;
+    uint8_t flag;
+    uint8_t i;
+    uint8_t end;
+
+    if (!states_ofs) {
+        return;
+    }
+    flag_count = lvl_rd8(blob, LVL_HDR_OFS_FLAGCOUNT);
+    room = room_get_id();
+    i = lvl_states_first(blob, states_ofs, 0);
+    for (flag = 0; flag < flag_count; ++flag) {
+        end = lvl_states_first(blob, states_ofs, (uint8_t)(flag + 1u));
+        if (i != end && puzzle_flag_get((FlagId)flag)) {
+            for (; i < end; ++i) {
+                uint16_t base = lvl_state_base(blob, states_ofs, i);
+
+                if (lvl_rd8(blob, (uint16_t)(base + LVL_STATE_OFS_ROOM)) == room) {
+                    room_put_cell(lvl_rd8(blob, (uint16_t)(base + LVL_STATE_OFS_X)),
+                                  lvl_rd8(blob, (uint16_t)(base + LVL_STATE_OFS_Y)),
+                                  lvl_rd8(blob, (uint16_t)(base + LVL_STATE_OFS_TILE)));
+                }
+            }
+        }
+        i = end;
+    }
+}
+
+void tilestate_flag_changed(uint8_t flag_id, uint8_t is_set) {
+    const uint8_t* blob = level_get_blob();
+    uint16_t states_ofs = lvl_states_ofs(blob);
+    uint16_t layers_ofs = lvl_layers_ofs(blob);
+    uint8_t room;
+    uint8_t i;
+    uint8_t end;
+
+    if (layers_ofs && flag_id == lvl_layer_flag(blob, layers_ofs)) {
+        room_set_layer(is_set);
+    }
+    if (!states_ofs) {
+        return;
+    }
+    room = room_get_id();
+    i = lvl_states_first(blob, states_ofs, flag_id);
+    end = lvl_states_first(blob, states_ofs, (uint8_t)(flag_id + 1u));
+    for (; i < end; ++i) {
+        uint16_t base = lvl_state_base(blob, states_ofs, i);
+        uint8_t mx;
+        uint8_t my;
+
+        // Bindings in other rooms need no work: room entry re-applies them.
+        if (lvl_rd8(blob, (uint16_t)(base + LVL_STATE_OFS_ROOM)) != room) {
+            continue;
+        }
+        mx = lvl_rd8(blob, (uint16_t)(base + LVL_STATE_OFS_X));
+        my = lvl_rd8(blob, (uint16_t)(base + LVL_STATE_OFS_Y));
+        if (is_set) {
+            room_set_cell(mx, my, lvl_rd8(blob, (uint16_t)(base + LVL_STATE_OFS_TILE)));
+        } else {
+            // The cell's only binding (levelc rejects a second one).
+            room_reset_cell(mx, my);
+        }
+    }
+}
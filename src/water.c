@@ -0,0 +1,129 @@
+#include "water.h"
+
+#include "collision.h"
+#include "irq.h"
+#include "level_runtime.h"
+#include "metatile.h"
+#include "puzzle.h"
+#include "room.h"
+
+#include "level_format.h"
+
+#include <c64/rasterirq.h>
+#include <c64/vic.h>
+
+// Raster line of room pixel row 0 (first text line), one line early so the
+// register writes land before the first water line is drawn.
+#define WATER_RASTER_TOP 0x32u
+// Below the last text line: the sky colors come back for the next frame.
+#define WATER_RASTER_RESTORE 0xFAu
+
+static RIRQCode4 water_split;
+static RIRQCode4 water_restore;
+static uint8_t water_cur = LVL_WATER_DRY;
+static uint8_t water_target = LVL_WATER_DRY;
+static uint8_t water_active = 0;
+
+// Lowest room pixel row; water drains out below it.
+static uint8_t water_bottom(void) {
+    uint8_t h = room_get_height();
+
+    return (uint8_t)((h > COLL_MAX_H ? COLL_MAX_H : h) * 16u);
+}
+
+static uint8_t water_line_for(uint8_t value) {
+    const uint8_t* blob = level_get_blob();
+    uint16_t water_ofs = lvl_water_ofs(blob);
+
+    if (!water_ofs) {
+        return LVL_WATER_DRY;
+    }
+    return lvl_water_line(blob, water_ofs, room_get_id(), value);
+}
+
+static void water_apply(void) {
+    if (water_cur == LVL_WATER_DRY) {
+        collision_water_y = COLL_NO_WATER;
+        if (water_active) {
+            rirq_clear(IRQ_SLOT_WATER_SPLIT);
+            rirq_clear(IRQ_SLOT_WATER_RESTORE);
+            rirq_sort();
+            water_active = 0;
+        }
+        return;
+    }
+    collision_water_y = water_cur;
+    if (!water_active) {
+        irq_raster_start();
+        rirq_set(IRQ_SLOT_WATER_SPLIT, (uint8_t)(WATER_RASTER_TOP + water_cur), &water_split.c);
+        rirq_set(IRQ_SLOT_WATER_RESTORE, WATER_RASTER_RESTORE, &water_restore.c);
+        water_active = 1;
+    } else {
+        rirq_move(IRQ_SLOT_WATER_SPLIT, (uint8_t)(WATER_RASTER_TOP + water_cur));
+    }
+    rirq_sort();
+}
+
+void water_init(void) {
+    rirq_build(&water_split.c, 3);
+    rirq_write(&water_split.c, 0, &vic.color_back, 0);
+    rirq_write(&water_split.c, 1, &vic.color_back1, 0);
+    rirq_write(&water_split.c, 2, &vic.color_back2, 0);
+    rirq_build(&water_restore.c, 3);
+    rirq_write(&water_restore.c, 0, &vic.color_back, 0);
+    rirq_write(&water_restore.c, 1, &vic.color_back1, 0);
+    rirq_write(&water_restore.c, 2, &vic.color_back2, 0);
+    water_cur = LVL_WATER_DRY;
+    water_target = LVL_WATER_DRY;
+    water_active = 0;
+}
+
+void water_room_enter(void) {
+    const uint8_t* blob = level_get_blob();
+    uint16_t water_ofs = lvl_water_ofs(blob);
+
+    if (water_ofs) {
+        rirq_data(&water_split.c, 0, lvl_rd8(blob, (uint16_t)(water_ofs + LVL_WATER_OFS_BG)));
+        rirq_data(&water_split.c, 1, lvl_rd8(blob, (uint16_t)(water_ofs + LVL_WATER_OFS_MC1)));
+        rirq_data(&water_split.c, 2, lvl_rd8(blob, (uint16_t)(water_ofs + LVL_WATER_OFS_MC2)));
+        rirq_data(&water_restore.c, 0, metatile_get_bg_color());
+        rirq_data(&water_restore.c, 1, metatile_get_mc1_color());
+        rirq_data(&water_restore.c, 2, metatile_get_mc2_color());
+        water_target = water_line_for(puzzle_var_get((VarId)lvl_rd8(blob, (uint16_t)(water_ofs + LVL_WATER_OFS_VAR))));
+    } else {
+        water_target = LVL_WATER_DRY;
+    }
+    water_cur = water_target;
+    water_apply();
+}
+
+void water_var_changed(uint8_t var_id, uint8_t value) {
+    const uint8_t* blob = level_get_blob();
+    uint16_t water_ofs = lvl_water_ofs(blob);
+
+    if (!water_ofs || var_id != lvl_rd8(blob, (uint16_t)(water_ofs + LVL_WATER_OFS_VAR))) {
+        return;
+    }
+    water_target = water_line_for(value);
+    // Flooding a dry room starts at the bottom; draining ends there.
+    if (water_cur == LVL_WATER_DRY && water_target != LVL_WATER_DRY) {
+        water_cur = water_bottom();
+        water_apply();
+    }
+}
+
+void water_update(void) {
+    if (water_cur == water_target) {
+        return;
+    }
+    if (water_target == LVL_WATER_DRY) {
+        if (++water_cur >= water_bottom()) {
+            water_cur = LVL_WATER_DRY;
+        }
+    } else if (water_cur < water_target) {
+        ++water_cur;
+    } else {
+        --water_cur;
+    }
+    water_apply();
+}
@@ -0,0 +1,79 @@
+#include "wind.h"
+
+#include "level_runtime.h"
+#include "puzzle.h"
+#include "room.h"
+
+#include "level_format.h"
+
+uint8_t wind_map[WIND_MAP_MAX];
+uint8_t wind_stride;
+uint8_t wind_h;
+uint8_t wind_active;
+int16_t wind_vx[4];
+
+static uint16_t wind_room_ofs;
+static uint8_t wind_size;
+
+// Base map with the lanes of every set shield flag masked out.
+static void wind_build(const uint8_t* blob) {
+    uint16_t ofs = (uint16_t)(wind_room_ofs + LVL_WIND_OFS_MAP);
+    uint8_t shields;
+    uint8_t i;
+
+    for (i = 0; i < wind_size; ++i) {
+        wind_map[i] = lvl_rd8(blob, (uint16_t)(ofs + i));
+    }
+    ofs = (uint16_t)(ofs + wind_size);
+    shields = lvl_rd8(blob, ofs++);
+    for (; shields; --shields) {
+        if (puzzle_flag_get((FlagId)lvl_rd8(blob, ofs))) {
+            for (i = 0; i < wind_size; ++i) {
+                wind_map[i] &= (uint8_t)~lvl_rd8(blob, (uint16_t)(ofs + 1u + i));
+            }
+        }
+        ofs = (uint16_t)(ofs + 1u + wind_size);
+    }
+}
+
+void wind_room_enter(void) {
+    const uint8_t* blob = level_get_blob();
+    uint16_t wind_ofs = lvl_wind_ofs(blob);
+    uint8_t i;
+
+    wind_active = 0;
+    wind_room_ofs = wind_ofs ? lvl_wind_room_ofs(blob, wind_ofs, room_get_id()) : 0;
+    if (!wind_room_ofs) {
+        return;
+    }
+    wind_stride = (uint8_t)((level_get_map_width() + 3u) >> 2);
+    wind_h = level_get_map_height();
+    wind_size = (uint8_t)(wind_stride * wind_h);
+    if (wind_size > WIND_MAP_MAX) {
+        return;
+    }
+    for (i = 0; i < 4; ++i) {
+        wind_vx[i] = (int16_t)lvl_rd16(blob, (uint16_t)(wind_room_ofs + i * 2u));
+    }
+    wind_build(blob);
+    wind_active = 1;
+}
+
+void wind_flag_changed(uint8_t flag_id) {
+    const uint8_t* blob = level_get_blob();
+    uint16_t ofs;
+    uint8_t shields;
+
+    if (!wind_active) {
+        return;
+    }
+    ofs = (uint16_t)(wind_room_ofs + LVL_WIND_OFS_MAP + wind_size);
+    shields = lvl_rd8(blob, ofs++);
+    for (; shields; --shields) {
+        if (lvl_rd8(blob, ofs) == flag_id) {
+            wind_build(blob);
+            return;
+        }
+        ofs = (uint16_t)(ofs + 1u + wind_size);
+    }
+}
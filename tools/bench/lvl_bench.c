@@ -0,0 +1,174 @@
+// Host-side benchmark for LVL1 runtime lookups (see tools/stresslevel.py).
+//
+// Build: cc -O2 -I include -o lvl_bench tools/bench/lvl_bench.c
+// Usage: lvl_bench <level.bin>
+//
+// Replays the lookups the engine performs (room_load_with_spawn, object
+// scans, exit scans, message lookups, COND/ACT stream walks) over every room
+// of a compiled blob and prints one JSON object with ns per operation.
+// Absolute numbers are host numbers; use them for scaling curves only.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "level_format.h"
+
+static uint8_t* blob;
+static volatile uint32_t sink;
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static void room_load(uint8_t room_id) {
+    sink += lvl_room_map_ofs(blob, room_id);
+    sink += lvl_room_spawns_ofs(blob, room_id);
+    sink += lvl_room_exits_ofs(blob, room_id);
+    sink += lvl_room_objects_ofs(blob, room_id);
+}
+
+// Worst case: the probed cell holds no object, so every record is read.
+static void object_find(uint8_t room_id, uint8_t x, uint8_t y) {
+    uint16_t objs = lvl_room_objects_ofs(blob, room_id);
+    uint8_t count = lvl_objects_count(blob, objs);
+    uint8_t i;
+
+    for (i = 0; i < count; ++i) {
+        uint16_t base = lvl_object_base(blob, objs, i);
+        if (lvl_rd8(blob, base + LVL_OBJ_OFS_X) == x && lvl_rd8(blob, base + LVL_OBJ_OFS_Y) == y) {
+            sink += i;
+            return;
+        }
+    }
+}
+
+static void exit_find(uint8_t room_id, uint8_t edge) {
+    uint16_t exits = lvl_room_exits_ofs(blob, room_id);
+    uint8_t count = lvl_exits_count(blob, exits);
+    uint8_t i;
+
+    for (i = 0; i < count; ++i) {
+        uint8_t type, dest_room, dest_spawn;
+        lvl_exit(blob, exits, i, &type, &dest_room, &dest_spawn);
+        if (type == edge) {
+            sink += dest_room;
+            return;
+        }
+    }
+}
+
+static void message_lookup(uint8_t msg_id) {
+    uint16_t table = lvl_msgtable_ofs(blob);
+    if (msg_id < lvl_rd8(blob, table)) {
+        sink += lvl_rd16(blob, (uint16_t)(table + 1u + (uint16_t)msg_id * 2u));
+    }
+}
+
+static uint32_t stream_walk(uint16_t stream, uint16_t ofs) {
+    uint16_t base = (uint16_t)(stream + ofs);
+    uint32_t ops = 0;
+
+    if (ofs == 0) {
+        return 0;
+    }
+    while (lvl_rd8(blob, base) != 0) {
+        sink += lvl_rd8(blob, base + 1) + lvl_rd8(blob, base + 2);
+        base = (uint16_t)(base + 3u);
+        ++ops;
+    }
+    return ops;
+}
+
+// Walk the COND and every ACT slot of each object in a room.
+static uint32_t room_scripts(uint8_t room_id) {
+    uint16_t objs = lvl_room_objects_ofs(blob, room_id);
+    uint8_t count = lvl_objects_count(blob, objs);
+    uint16_t conds = lvl_condstream_ofs(blob);
+    uint16_t acts = lvl_actstream_ofs(blob);
+    uint32_t ops = 0;
+    uint8_t i, slot;
+
+    for (i = 0; i < count; ++i) {
+        uint16_t base = lvl_object_base(blob, objs, i);
+        ops += stream_walk(conds, lvl_rd16(blob, base + LVL_OBJ_OFS_CONDS));
+        for (slot = LVL_OBJ_OFS_LOOK; slot <= LVL_OBJ_OFS_ALT1; slot += 2) {
+            ops += stream_walk(acts, lvl_rd16(blob, base + slot));
+        }
+    }
+    return ops;
+}
+
+int main(int argc, char** argv) {
+    FILE* f;
+    long size;
+    uint8_t rooms, msgs;
+    uint32_t objects = 0, walk_ops = 0, reps, r, rep;
+    double t0, t_room, t_obj, t_exit, t_msg, t_walk;
+
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <level.bin>\n", argv[0]);
+        return 2;
+    }
+    f = fopen(argv[1], "rb");
+    if (!f) {
+        perror(argv[1]);
+        return 1;
+    }
+    fseek(f, 0, SEEK_END);
+    size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    blob = (uint8_t*)malloc((size_t)size);
+    if (!blob || fread(blob, 1, (size_t)size, f) != (size_t)size) {
+        fprintf(stderr, "read failed\n");
+        return 1;
+    }
+    fclose(f);
+
+    if (blob[0] != LVL_MAGIC_0 || blob[3] != LVL_MAGIC_3 || lvl_rd8(blob, LVL_HDR_OFS_VERSION) != LVL_VERSION) {
+        fprintf(stderr, "not an LVL1 blob\n");
+        return 1;
+    }
+    rooms = lvl_rd8(blob, LVL_HDR_OFS_ROOMCOUNT);
+    msgs = lvl_rd8(blob, LVL_HDR_OFS_MSGCOUNT);
+    for (r = 0; r < rooms; ++r) {
+        objects += lvl_objects_count(blob, lvl_room_objects_ofs(blob, (uint8_t)r));
+    }
+    reps = rooms ? 200000u / rooms + 1u : 1u;
+
+    t0 = now_ns();
+    for (rep = 0; rep < reps; ++rep)
+        for (r = 0; r < rooms; ++r) room_load((uint8_t)r);
+    t_room = (now_ns() - t0) / ((double)reps * rooms);
+
+    t0 = now_ns();
+    for (rep = 0; rep < reps; ++rep)
+        for (r = 0; r < rooms; ++r) object_find((uint8_t)r, 0xFF, 0xFF);
+    t_obj = (now_ns() - t0) / ((double)reps * rooms);
+
+    t0 = now_ns();
+    for (rep = 0; rep < reps; ++rep)
+        for (r = 0; r < rooms; ++r) exit_find((uint8_t)r, EXIT_D);
+    t_exit = (now_ns() - t0) / ((double)reps * rooms);
+
+    t0 = now_ns();
+    for (rep = 0; rep < reps; ++rep)
+        for (r = 0; r < 256; ++r) message_lookup((uint8_t)r);
+    t_msg = (now_ns() - t0) / ((double)reps * 256);
+
+    for (r = 0; r < rooms; ++r) walk_ops += room_scripts((uint8_t)r);
+    reps = reps / 16u + 1u;
+    t0 = now_ns();
+    for (rep = 0; rep < reps; ++rep)
+        for (r = 0; r < rooms; ++r) room_scripts((uint8_t)r);
+    t_walk = walk_ops ? (now_ns() - t0) / ((double)reps * walk_ops) : 0.0;
+
+    printf("{\"blob_size\": %ld, \"rooms\": %u, \"objects\": %u, \"messages\": %u, \"script_ops\": %u, "
+           "\"ns_room_load\": %.2f, \"ns_object_find\": %.2f, \"ns_exit_find\": %.2f, "
+           "\"ns_msg_lookup\": %.2f, \"ns_act_walk\": %.3f}\n",
+           size, rooms, objects, msgs, walk_ops, t_room, t_obj, t_exit, t_msg, t_walk);
+    return 0;
+}
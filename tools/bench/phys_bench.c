@@ -0,0 +1,188 @@
+// Host-side benchmark for the platformer controller (src/physics.c).
+//
+// Build: cc -O2 -I include -I gen/include -o phys_bench tools/bench/phys_bench.c src/physics.c
+// Usage: phys_bench [frames]
+//
+// Drives physics_step over a synthetic 20x12 room (floor, one-way ledge,
+// ladder, slope, half tiles, wall) with a seeded input stream. src/collision.c
+// is compiled in as-is against stubbed room/metatile lookups; collision_at
+// wraps it so every probe is counted, and the box is checked never to cover a
+// SOLID pixel. The second half of each pass floods the room below y=120 (water
+// swim path). Prints one JSON object; exits 1 if a frame exceeds PHYS_MAX_PROBES.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+// The engine's probe, renamed so the counting wrapper below can take its name.
+#define collision_at collision_at_src
+#include "../../src/collision.c"
+#undef collision_at
+
+#include "input.h"
+#include "physics.h"
+#include "physics_tables.h"
+#include "wind.h"
+
+enum { SH_FULL, SH_BOTTOM_HALF, SH_ONEWAY_TOP, SH_SLOPE_R, SH_COUNT };
+enum { MT_AIR, MT_FLOOR, MT_SOLID, MT_ONEWAY, MT_HALF, MT_SLOPE, MT_LADDER, MT_COUNT };
+
+static const uint16_t mt_flags[MT_COUNT] = {
+    0,
+    TF_SOLID | TF_FLOOR,
+    TF_SOLID,
+    TF_STANDABLE | ((uint16_t)SH_ONEWAY_TOP << TSET_SHAPE_SHIFT),
+    TF_SOLID | ((uint16_t)SH_BOTTOM_HALF << TSET_SHAPE_SHIFT),
+    TF_SOLID | ((uint16_t)SH_SLOPE_R << TSET_SHAPE_SHIFT),
+    TF_LADDER,
+};
+static uint8_t shapes[SH_COUNT * 16];
+static uint8_t room[COLL_MAX_H][COLL_MAX_W];
+static uint32_t probes;
+
+// Calm air: the wind lookup in physics_step is skipped.
+uint8_t wind_map[WIND_MAP_MAX];
+uint8_t wind_stride;
+uint8_t wind_h;
+uint8_t wind_active;
+int16_t wind_vx[4];
+
+// Room and tileset lookups collision_build reads; one layer, no ALTMAP.
+const unsigned char* room_get_layer_map(unsigned char layer) {
+    return layer ? 0 : &room[0][0];
+}
+
+unsigned char room_get_layer(void) {
+    return 0;
+}
+
+unsigned char room_get_width(void) {
+    return COLL_MAX_W;
+}
+
+unsigned char room_get_height(void) {
+    return COLL_MAX_H;
+}
+
+uint16_t metatile_get_flags(uint8_t mt_id) {
+    return mt_id < MT_COUNT ? mt_flags[mt_id] : 0;
+}
+
+const uint8_t* metatile_get_shape_tables(uint8_t* out_count) {
+    *out_count = SH_COUNT;
+    return shapes;
+}
+
+uint8_t collision_at(uint16_t px, uint16_t py) {
+    ++probes;
+    return collision_at_src(px, py);
+}
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static void build_room(void) {
+    uint8_t x, y;
+
+    for (x = 0; x < 16; ++x) {
+        shapes[SH_BOTTOM_HALF * 16 + x] = 8;
+        shapes[SH_ONEWAY_TOP * 16 + x] = TSET_SHAPE_CEIL | 4u;
+        shapes[SH_SLOPE_R * 16 + x] = (uint8_t)(15u - x);
+    }
+    for (x = 0; x < COLL_MAX_W; ++x) {
+        room[COLL_MAX_H - 1][x] = MT_FLOOR;
+    }
+    for (x = 3; x < 9; ++x) {
+        room[7][x] = MT_ONEWAY;
+    }
+    room[10][1] = MT_HALF;
+    room[10][14] = MT_SLOPE;
+    room[10][15] = MT_SOLID;
+    room[10][16] = MT_SOLID;
+    for (y = 4; y < COLL_MAX_H - 1; ++y) {
+        room[y][12] = MT_LADDER;
+    }
+    for (x = 10; x < 15; ++x) {
+        if (x != 12) {
+            room[4][x] = MT_FLOOR;
+        }
+    }
+    room[9][17] = MT_SOLID;
+    room[10][17] = MT_SOLID;
+    collision_build();
+}
+
+static uint8_t overlaps_solid(const PhysBody* b) {
+    uint16_t x, y;
+
+    for (y = b->y; y < b->y + PHYS_BODY_H; ++y) {
+        for (x = b->x; x < b->x + PHYS_BODY_W; ++x) {
+            if (collision_at_src(x, y) & TF_SOLID) {
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    static const uint8_t moves[] = {
+        INPUT_RIGHT, INPUT_LEFT, INPUT_RIGHT | INPUT_FIRE, INPUT_LEFT | INPUT_FIRE,
+        INPUT_UP, INPUT_DOWN, INPUT_FIRE, 0
+    };
+    uint32_t frames = argc > 1 ? (uint32_t)strtoul(argv[1], 0, 10) : 1000000u;
+    uint32_t seed = 12345u, f, before, worst = 0, bad = 0, state_frames[4] = {0, 0, 0, 0};
+    uint8_t down = 0, prev = 0, edges = 0;
+    PhysBody body;
+    double t0, t_step, t_total = 0.0;
+
+    build_room();
+    physics_set_bounds(COLL_MAX_W * 16u, COLL_MAX_H * 16u);
+    physics_place(&body, 1, 9);
+
+    // Correctness pass: count probes and overlaps per frame.
+    for (f = 0; f < frames; ++f) {
+        collision_water_y = f < frames / 2u ? COLL_NO_WATER : 120u;
+        if ((f & 31u) == 0) {
+            seed = seed * 1103515245u + 12345u;
+            down = moves[(seed >> 16) & 7u];
+        }
+        before = probes;
+        edges |= physics_step(&body, down, (uint8_t)(down & ~prev));
+        prev = down;
+        if (probes - before > worst) {
+            worst = probes - before;
+        }
+        bad += overlaps_solid(&body);
+        ++state_frames[body.state & 3u];
+    }
+
+    // Timing pass over the same input stream.
+    seed = 12345u;
+    prev = 0;
+    physics_place(&body, 1, 9);
+    t0 = now_ns();
+    for (f = 0; f < frames; ++f) {
+        collision_water_y = f < frames / 2u ? COLL_NO_WATER : 120u;
+        if ((f & 31u) == 0) {
+            seed = seed * 1103515245u + 12345u;
+            down = moves[(seed >> 16) & 7u];
+        }
+        physics_step(&body, down, (uint8_t)(down & ~prev));
+        prev = down;
+    }
+    t_total = now_ns() - t0;
+    t_step = frames ? t_total / frames : 0.0;
+
+    printf("{\"frames\": %u, \"ns_step\": %.2f, \"probes_per_frame\": %.2f, \"max_probes\": %u, "
+           "\"probe_bound\": %u, \"solid_overlaps\": %u, \"edges\": %u, "
+           "\"ground\": %u, \"jump\": %u, \"fall\": %u, \"climb\": %u}\n",
+           frames, t_step, frames ? (double)probes / frames : 0.0, worst, (unsigned)PHYS_MAX_PROBES, bad,
+           edges, state_frames[PHYS_GROUND], state_frames[PHYS_JUMP], state_frames[PHYS_FALL],
+           state_frames[PHYS_CLIMB]);
+    return (worst > PHYS_MAX_PROBES || bad) ? 1 : 0;
+}
@@ -15,16 +15,25 @@ Outputs:
 """
 
 import argparse
+import hashlib
+import inspect
 import json
 import os
 import re
+import sys
+import time
 from collections import Counter
+from concurrent.futures import ProcessPoolExecutor
 from pathlib import Path
+from typing import Optional
 
 import numpy as np
 from PIL import Image
 
-from gen_paths import ANALYSIS_ROOT
+import levelc
+import tilesetc
+from gen_paths import ANALYSIS_ROOT, GEN_ROOT
+from tset_parser import FIXED_FLAGBITS, TileSet
 C64 = {
     0: ("black", (0, 0, 0)),
     1: ("white", (255, 255, 255)),
@@ -46,44 +55,122 @@ C64 = {
 PAL = np.array([C64[i][1] for i in range(16)], dtype=np.uint8)
 
 
-def load_kla(path: Path) -> np.ndarray:
-    data = path.read_bytes()
-    if len(data) == 10003:
+KLA_LOAD_ADDR = 0x6000
+KLA_SIZE = 10001  # bitmap 8000 + screen 1000 + color 1000 + bg 1
+KLA_SHIFTS = np.array([6, 4, 2, 0], dtype=np.uint8)
+TMAP_PIXELS = 12 * 16 * 20 * 16  # the 20x12 metatile area the tmap covers
+
+
+def _kla_payload(data: bytes, path: Path) -> bytes:
+    if len(data) == KLA_SIZE + 2:
         data = data[2:]
-    if len(data) != 10001:
+    if len(data) != KLA_SIZE:
         raise ValueError(f"Unexpected Koala size {len(data)} bytes: {path}")
+    return data
+
+
+def decode_kla(data: bytes) -> np.ndarray:
+    """Koala payload -> 200x320 color indices.
+
+    Every cell gets a 4-entry table (bg, screen hi, screen lo, color RAM) and
+    the 2-bit codes of all 8000 bitmap bytes index it in one gather.
+    """
+    bitmap = np.frombuffer(data, dtype=np.uint8, count=8000).reshape(1000, 8)
+    screen = np.frombuffer(data, dtype=np.uint8, count=1000, offset=8000)
+    color = np.frombuffer(data, dtype=np.uint8, count=1000, offset=9000)
+    lut = np.empty((1000, 4), dtype=np.uint8)
+    lut[:, 0] = data[10000]
+    lut[:, 1] = screen >> 4
+    lut[:, 2] = screen & 0x0F
+    lut[:, 3] = color & 0x0F
+    codes = (bitmap[:, :, None] >> KLA_SHIFTS) & 3
+    pairs = lut[np.arange(1000)[:, None, None], codes]
+    cells = np.repeat(pairs, 2, axis=2)
+    return cells.reshape(25, 40, 8, 8).transpose(0, 2, 1, 3).reshape(200, 320)
+
+
+def encode_kla(idx_img: np.ndarray, bg: int) -> bytes:
+    """200x320 color indices -> Koala payload (inverse of decode_kla).
+
+    Each cell keeps its three most used non-bg colors (ties to the lower
+    index) in screen hi, screen lo, color RAM; unused slots are 0. The left
+    pixel of each pair is encoded, and a color that does not fit the cell
+    takes the nearest of its four by RGB distance.
+    """
+    cells = idx_img.reshape(25, 8, 40, 8).transpose(0, 2, 1, 3).reshape(1000, 8, 8)
+    pairs = cells[:, :, 0::2].astype(np.intp)
+    cell_ids = np.arange(1000)[:, None, None]
+    hist = np.bincount((cell_ids * 16 + pairs).ravel(), minlength=16000).reshape(1000, 16)
+    hist[:, bg] = 0
+    order = np.argsort(-hist, axis=1, kind="stable")[:, :3]
+    used = np.take_along_axis(hist, order, axis=1) > 0
+    slots = np.where(used, order, 0)
+
+    choices = np.concatenate([np.full((1000, 1), bg), slots], axis=1)
+    pal = PAL.astype(np.int32)
+    dist = ((pal[None, :, None, :] - pal[choices][:, None, :, :]) ** 2).sum(axis=3)
+    dist[:, :, 1:][~np.broadcast_to(used[:, None, :], (1000, 16, 3))] = 1 << 30
+    code_lut = dist.argmin(axis=2).astype(np.uint8)
+
+    codes = code_lut[cell_ids, pairs]
+    bitmap = (codes << KLA_SHIFTS).sum(axis=2, dtype=np.uint8)
+    screen = (slots[:, 0] << 4 | slots[:, 1]).astype(np.uint8)
+    color = slots[:, 2].astype(np.uint8)
+    return bitmap.tobytes() + screen.tobytes() + color.tobytes() + bytes([bg])
+
+
+def load_kla(path: Path) -> np.ndarray:
+    return decode_kla(_kla_payload(path.read_bytes(), path))
+
+
+def save_kla(path: Path, idx_img: np.ndarray, bg: int) -> None:
+    path.parent.mkdir(parents=True, exist_ok=True)
+    path.write_bytes(KLA_LOAD_ADDR.to_bytes(2, "little") + encode_kla(idx_img, bg))
+
+
+def _decode_kla_reference(data: bytes) -> np.ndarray:
+    """Per-pixel decoder kept as the reference for --verify-kla."""
     bitmap = data[0:8000]
     screen = data[8000:9000]
     color = data[9000:10000]
     bg = data[10000]
-
     idx = np.zeros((200, 320), dtype=np.uint8)
     for cy in range(25):
         for cx in range(40):
             sc = screen[cy * 40 + cx]
-            c1 = (sc >> 4) & 0x0F
-            c2 = sc & 0x0F
-            c3 = color[cy * 40 + cx] & 0x0F
+            lut = (bg, (sc >> 4) & 0x0F, sc & 0x0F, color[cy * 40 + cx] & 0x0F)
             cell_base = (cy * 40 + cx) * 8
             for y in range(8):
                 b = bitmap[cell_base + y]
                 for xmc in range(4):
-                    code = (b >> (6 - 2 * xmc)) & 3
-                    if code == 0:
-                        col = bg
-                    elif code == 1:
-                        col = c1
-                    elif code == 2:
-                        col = c2
-                    else:
-                        col = c3
-                    px = cx * 8 + xmc * 2
-                    py = cy * 8 + y
-                    idx[py, px] = col
-                    idx[py, px + 1] = col
+                    col = lut[(b >> (6 - 2 * xmc)) & 3]
+                    idx[cy * 8 + y, cx * 8 + xmc * 2:cx * 8 + xmc * 2 + 2] = col
     return idx
 
 
+def verify_kla(path: Path) -> bool:
+    """Decode against the reference, then check encode/decode round trips."""
+    data = _kla_payload(path.read_bytes(), path)
+    t0 = time.perf_counter()
+    ref = _decode_kla_reference(data)
+    t1 = time.perf_counter()
+    idx = decode_kla(data)
+    t2 = time.perf_counter()
+    enc = encode_kla(idx, data[10000])
+    t3 = time.perf_counter()
+
+    checks = [
+        ("decode matches reference", np.array_equal(ref, idx)),
+        ("decode(encode(pixels)) == pixels", np.array_equal(decode_kla(enc), idx)),
+        ("encode(decode(encoded)) == encoded", encode_kla(decode_kla(enc), data[10000]) == enc),
+    ]
+    print(f"{path.name}: reference decode {1000 * (t1 - t0):.1f} ms, "
+          f"decode {1000 * (t2 - t1):.2f} ms, encode {1000 * (t3 - t2):.2f} ms")
+    for label, ok in checks:
+        print(f"  {'ok  ' if ok else 'FAIL'} {label}")
+    return all(ok for _label, ok in checks)
+
+
 def idx_to_rgb(idx_img: np.ndarray) -> Image.Image:
     rgb = PAL[idx_img].astype(np.uint8)
     return Image.fromarray(rgb, mode="RGB")
@@ -131,7 +218,69 @@ def encode_mc_char_best(cell8x8: np.ndarray, bg: int, mc1: int, mc2: int):
     return best_bytes, best_lc, best_err
 
 
-def choose_mc_colors(cells: list[np.ndarray], bg: int, fast: bool = False) -> tuple[int, int]:
+CELL_CACHE_MAGIC = b"KCC1"
+CELL_CACHE_VERSION = 1  # bump when the meaning of a cached result changes
+CELL_CACHE_KEY = 64 + 3  # cell pixels, bg, mc1, mc2
+CELL_CACHE_REC = CELL_CACHE_KEY + 8 + 2  # + char bytes, local color, error
+
+
+class CellCache:
+    """encode_mc_char_best results kept on disk between runs.
+
+    Keyed by (cell bytes, bg, mc1, mc2). The file header holds a hash of
+    CELL_CACHE_VERSION and the encoder's source, so an encoder change drops
+    the whole file on the next load. Only entries used by the run are saved.
+    """
+
+    def __init__(self, path: Optional[Path]):
+        self.path = path
+        self.entries: dict[bytes, tuple[bytes, int, int]] = {}
+        self.used: set[bytes] = set()
+        self.hits = 0
+        self.misses = 0
+        if path is not None and path.exists():
+            self._load(path.read_bytes())
+
+    @staticmethod
+    def stamp() -> bytes:
+        src = inspect.getsource(encode_mc_char_best)
+        return CELL_CACHE_MAGIC + hashlib.sha1(f"{CELL_CACHE_VERSION}\n{src}".encode()).digest()
+
+    def _load(self, data: bytes) -> None:
+        stamp = self.stamp()
+        body = data[len(stamp):]
+        if not data.startswith(stamp) or len(body) % CELL_CACHE_REC:
+            return
+        for i in range(0, len(body), CELL_CACHE_REC):
+            rec = body[i:i + CELL_CACHE_REC]
+            self.entries[rec[:CELL_CACHE_KEY]] = (rec[CELL_CACHE_KEY:CELL_CACHE_KEY + 8], rec[-2], rec[-1])
+
+    def encode(self, cell8x8: np.ndarray, bg: int, mc1: int, mc2: int):
+        key = cell8x8.tobytes() + bytes((bg, mc1, mc2))
+        self.used.add(key)
+        hit = self.entries.get(key)
+        if hit is not None:
+            self.hits += 1
+            return hit
+        self.misses += 1
+        hit = encode_mc_char_best(cell8x8, bg, mc1, mc2)
+        self.entries[key] = hit
+        return hit
+
+    def save(self) -> None:
+        if self.path is None or (not self.misses and len(self.used) == len(self.entries)):
+            return
+        out = bytearray(self.stamp())
+        for key in sorted(self.used):
+            chars, lc, err = self.entries[key]
+            out += key + chars + bytes((lc, err))
+        self.path.parent.mkdir(parents=True, exist_ok=True)
+        tmp = self.path.with_suffix(".tmp")
+        tmp.write_bytes(bytes(out))
+        os.replace(tmp, self.path)
+
+
+def choose_mc_colors(cells: list[np.ndarray], bg: int, fast: bool = False, cache: Optional[CellCache] = None) -> tuple[int, int]:
     colors = [c for c in range(16) if c != bg]
     if fast:
         counts = np.bincount(np.concatenate([c.flatten() for c in cells]), minlength=16)
@@ -147,6 +296,7 @@ def choose_mc_colors(cells: list[np.ndarray], bg: int, fast: bool = False) -> tu
     best_mc1 = colors[0]
     best_mc2 = colors[1]
     best_err = 10**9
+    encode = cache.encode if cache is not None else encode_mc_char_best
     err_cache = {}
     for i, mc1 in enumerate(colors):
         for mc2 in colors[i + 1:]:
@@ -156,7 +306,7 @@ def choose_mc_colors(cells: list[np.ndarray], bg: int, fast: bool = False) -> tu
                 if key in err_cache:
                     e = err_cache[key]
                 else:
-                    _, _, e = encode_mc_char_best(cell, bg, mc1, mc2)
+                    _, _, e = encode(cell, bg, mc1, mc2)
                     err_cache[key] = e
                 err += e * weight
             if err < best_err:
@@ -320,19 +470,53 @@ def tile_distance(a, b) -> int:
     return d
 
 
-def main() -> None:
-    ap = argparse.ArgumentParser()
-    ap.add_argument("spec", help="Spec JSON")
-    ap.add_argument("--kla", default="", help="Koala file (defaults to match spec name)")
-    ap.add_argument("--out-dir", default="", help="Output directory (defaults to debug/<spec name>)")
-    ap.add_argument("--charset", default="", help="Output charset bin (defaults to assets/<spec name>_chargen.bin)")
-    ap.add_argument("--tset", default="", help="Output tileset (defaults to levels/<spec name>.tset)")
-    ap.add_argument("--tmap", default="", help="Output full map (defaults to debug/<spec name>/<spec name>_tmap.bin)")
-    ap.add_argument("--tile-map", default="", help="Output tile location map (defaults to debug/<spec name>/<spec name>_tile_locations.png)")
-    ap.add_argument("--info", default="", help="Output info (defaults to debug/<spec name>/<spec name>_info.txt)")
-    ap.add_argument("--fast", action="store_true", help="Use fast MC1/MC2 selection")
-    args = ap.parse_args()
-
+def tile_distance_matrix(a_tiles: list, b_tiles: list) -> np.ndarray:
+    """tile_distance for every (a, b) pair, as a len(a) x len(b) array."""
+    char_ids: dict[bytes, int] = {}
+
+    def codes(tiles: list) -> np.ndarray:
+        rows = [[char_ids.setdefault(ch, len(char_ids)) for ch in chars] + list(cols) for chars, cols in tiles]
+        return np.array(rows, dtype=np.int32).reshape(-1, 8)
+
+    a = codes(a_tiles)
+    b = codes(b_tiles)
+    return (a[:, None, :] != b[None, :, :]).sum(axis=2)
+
+
+def merge_tiles(tiles: list[dict], threshold: int, target: int = 0) -> dict[int, tuple[int, int]]:
+    """Near-duplicate reduction over tiles with equal flags.
+
+    Merges the closest pair first with complete linkage, so every member of a
+    group stays within `threshold` of every other one. Stops when no pair is
+    within `threshold` or, with `target`, once `target` tiles remain. Returns
+    {index: (kept index, distance)}; the lower index of a pair is kept.
+    """
+    n = len(tiles)
+    dist = tile_distance_matrix([e["tile"] for e in tiles], [e["tile"] for e in tiles])
+    flags = np.array([e["flags"] for e in tiles])
+    far = np.iinfo(np.int32).max
+    link = np.where(flags[:, None] == flags[None, :], dist, far).astype(np.int32)
+    np.fill_diagonal(link, far)
+    keep_of = np.arange(n)
+    alive = n
+    while n and (not target or alive > target):
+        i, j = divmod(int(link.argmin()), n)
+        if link[i, j] > threshold:
+            break
+        keep, drop = min(i, j), max(i, j)
+        link[keep] = np.maximum(link[keep], link[drop])
+        link[:, keep] = link[keep]
+        link[keep, keep] = far
+        link[drop, :] = far
+        link[:, drop] = far
+        keep_of[keep_of == drop] = keep
+        alive -= 1
+    return {k: (int(keep_of[k]), int(dist[k, keep_of[k]])) for k in range(n) if keep_of[k] != k}
+
+
+def compile_spec(args: argparse.Namespace) -> dict:
+    """Compile one spec; returns the written paths and summary stats."""
+    t0 = time.perf_counter()
     root = Path(__file__).resolve().parent.parent
     spec_path = (root / args.spec).resolve()
     base_name = spec_path.stem
@@ -372,7 +556,8 @@ def main() -> None:
         for cx in range(40):
             cell = idx[cy * 8:(cy + 1) * 8, cx * 8:(cx + 1) * 8]
             cells.append(cell)
-    mc1, mc2 = choose_mc_colors(cells, bg, fast=args.fast)
+    cache = CellCache(None if args.no_cache else root / GEN_ROOT / "cache" / "koala" / f"{base_name}.cells")
+    mc1, mc2 = choose_mc_colors(cells, bg, fast=args.fast, cache=cache)
 
     def extract_tile(px: int, py: int):
         if px < 0 or py < 0 or px + 15 >= 320 or py + 15 >= 200:
@@ -382,7 +567,7 @@ def main() -> None:
         for dy in (0, 8):
             for dx in (0, 8):
                 cell = idx[py + dy:py + dy + 8, px + dx:px + dx + 8]
-                p, lc, _err = encode_mc_char_best(cell, bg, mc1, mc2)
+                p, lc, _err = cache.encode(cell, bg, mc1, mc2)
                 chars.append(p)
                 cols.append(lc)
         return tuple(chars), tuple(cols)
@@ -398,9 +583,19 @@ def main() -> None:
             raise SystemExit(f"{e['name']}: {exc}") from exc
         tiles.append(e)
 
+    # Optional tile budget: near-duplicates become `alias=` lines and drop out of the charset.
+    if args.merge_threshold >= 0 or args.max_tiles:
+        threshold = args.merge_threshold if args.merge_threshold >= 0 else 8
+        for k, (keep, dist) in merge_tiles(tiles, threshold, args.max_tiles).items():
+            tiles[k]["alias_of"] = tiles[keep]
+            tiles[k]["alias_dist"] = dist
+    merged = [e for e in tiles if "alias_of" in e]
+
     # Build charset from selected tiles only
     char_patterns = []
     for e in tiles:
+        if "alias_of" in e:
+            continue
         chars, _cols = e["tile"]
         char_patterns.extend(list(chars))
     uniq_chars, charset, char_index = build_charset(char_patterns)
@@ -416,6 +611,13 @@ def main() -> None:
         f'TSET name="{base_name}" tileSize=2x2 bgColor={color_name(bg)} mc1Color={color_name(mc1)} '
         f'mc2Color={color_name(mc2)} charset={args.charset}\n\n'
     )
+    # The same tileset as a TileSet, built alongside the text for in-memory handoff.
+    ts = TileSet(
+        name=base_name, tile_w=2, tile_h=2, declared_count=0, bg_color=bg, mc1_color=mc1,
+        mc2_color=mc2, charset_path=args.charset, flagbits=dict(FIXED_FLAGBITS),
+    )
+    ts_binds: list[tuple[str, str]] = []
+    ts_errors: list[str] = []
     charmap_seed = {
         "WALL": "#",
         "FLOOR": "=",
@@ -454,6 +656,7 @@ def main() -> None:
         name = name_override or e["name"]
         ch = pick_char(name.upper())
         taken.add(ch)
+        ts_binds.append((ch, name))
         variant = e.get("variant_of", "")
         if variant.upper() == "NONE":
             variant = ""
@@ -516,6 +719,7 @@ def main() -> None:
                 role_bits.append(e["object_desc"])
             role_override = " - ".join(role_bits) or e.get("role", "")
             lines.append(charmap_line(e, name_override=type_name, role_override=role_override))
+            e["emit_name"] = type_name
             alias = dict(e)
             alias["name"] = type_name
             alias["role"] = role_override
@@ -537,6 +741,7 @@ def main() -> None:
         og["obj_name"] = obj_name
         suffix = f" ; {obj_desc}" if obj_desc else " ; object stamp"
         lines.append(f"{ch} {obj_name}{suffix}\n")
+        ts_binds.append((ch, obj_name))
     lines.append("END\n\n")
 
     if object_groups:
@@ -568,12 +773,21 @@ def main() -> None:
             tiles_str = ",".join(tiles_list)
             obj_name = og.get("obj_name") or sanitize_tile_name(og.get("type", "") or "OBJECT")
             lines.append(f"{obj_name} size={ow}x{oh} tiles={tiles_str}\n")
+            ts.add_object(obj_name, ow, oh, tiles_list)
         lines.append("END\n\n")
 
     tile_output = []
 
     def emit_tile(e, include_role=False):
         name = e["name"]
+        if "alias_of" in e:
+            keep = e["alias_of"]
+            lines.append(f"{name} alias={keep.get('emit_name', keep['name'])} ; distance {e['alias_dist']}\n")
+            try:
+                ts.add_alias(name, keep.get("emit_name", keep["name"]))
+            except ValueError as exc:
+                ts_errors.append(str(exc))
+            return
         chars, cols = e["tile"]
         mapped = tuple(uniq_chars[char_index[p]] for p in chars)
         e["tile_rep"] = (mapped, cols)
@@ -585,6 +799,10 @@ def main() -> None:
             lines.append(f"; {role}\n")
         lines.append(f"{name} chars={ch} colors={co} flags={flags}\n")
         tile_output.append(e)
+        try:
+            ts.add_tile(name, [char_index[p] for p in chars], list(cols), flags)
+        except ValueError as exc:
+            ts_errors.append(str(exc))
 
     lines.append("TILES\n")
     if non_obj:
@@ -613,25 +831,31 @@ def main() -> None:
         for e in alias_tiles:
             emit_tile(e)
     lines.append("\nEND\n\nEND\n")
+    for ch, name in ts_binds:
+        message = ts.bind_char(ch, name)
+        if message:
+            ts_errors.append(message)
+    if not ts_errors:
+        ts.finish()
     tset_path.parent.mkdir(parents=True, exist_ok=True)
     tset_path.write_text("".join(lines), encoding="utf-8")
 
     # Build full-image tmap using nearest tile
     tile_defs = [e["tile_rep"] for e in tile_output]
-    tmap = np.zeros((12, 20), dtype=np.uint8)
-    for my in range(12):
-        for mx in range(20):
-            tile = extract_tile(mx * 16, my * 16)
-            best_i = 0
-            best_d = 10**9
-            for i, cand in enumerate(tile_defs):
-                d = tile_distance(tile, cand)
-                if d < best_d:
-                    best_d = d
-                    best_i = i
-                    if d == 0:
-                        break
-            tmap[my, mx] = best_i
+    image_tiles = [extract_tile(mx * 16, my * 16) for my in range(12) for mx in range(20)]
+    tmap = tile_distance_matrix(image_tiles, tile_defs).argmin(axis=1).astype(np.uint8).reshape(12, 20)
+
+    # Reconstruction error: pixels where the tmap render differs from the image.
+    def render_tile(rep) -> np.ndarray:
+        chars, cols = rep
+        img = np.empty((16, 16), dtype=np.uint8)
+        for k in range(4):
+            img[(k // 2) * 8:(k // 2) * 8 + 8, (k % 2) * 8:(k % 2) * 8 + 8] = render_mc_char(chars[k], cols[k], bg, mc1, mc2)
+        return img
+
+    tile_imgs = np.stack([render_tile(rep) for rep in tile_defs])
+    recon = tile_imgs[tmap].transpose(0, 2, 1, 3).reshape(192, 320)
+    error_px = int(np.count_nonzero(recon != idx[:192]))
 
     out_dir.mkdir(parents=True, exist_ok=True)
     tmap_path.parent.mkdir(parents=True, exist_ok=True)
@@ -708,9 +932,16 @@ def main() -> None:
             f"| ![]({{tiles}}/{img_name}) | {name} | {flags} | {grid_str} | {role} | {variant} | {ch_idx} | {col_str} | {reuse} |\n"
         )
 
+    if merged:
+        md_tiles.append("\n## Merged tiles\n\n| Tile | Alias of | Distance |\n| --- | --- | --- |\n")
+        for e in merged:
+            keep = e["alias_of"]
+            md_tiles.append(f"| {e['name']} | {keep.get('emit_name', keep['name'])} | {e['alias_dist']} |\n")
     tiles_md.write_text("".join(md_tiles).replace("{tiles}", "tiles"), encoding="utf-8")
     tile_map_path.parent.mkdir(parents=True, exist_ok=True)
     idx_to_rgb(tile_loc).resize((640, 400), resample=Image.NEAREST).save(tile_map_path)
+    tile_kla_path = tile_map_path.with_suffix(".kla")
+    save_kla(tile_kla_path, tile_loc, bg)
 
     if object_tiles:
         md_obj = []
@@ -749,15 +980,140 @@ def main() -> None:
         "",
         f"Chars used: {len(uniq_chars)}",
         f"Tiles used: {len(tile_defs)}",
+        f"Tiles merged: {len(merged)}",
+        f"Tile map error: {error_px} px ({100.0 * error_px / TMAP_PIXELS:.2f}%)",
     ])
     info_path.write_text(info, encoding="utf-8")
+    cache.save()
+
+    return {
+        "name": base_name,
+        "written": [
+            ("charset", charset_path),
+            ("tileset", tset_path),
+            ("tmap", tmap_path),
+            ("tiles", tiles_dir),
+            ("tiles md", tiles_md),
+            ("tile map", tile_map_path),
+            ("tile map kla", tile_kla_path),
+        ],
+        "chars": len(uniq_chars),
+        "tiles": len(tile_defs),
+        "merged": len(merged),
+        "tileset": ts,
+        "tileset_errors": ts_errors,
+        "error_px": error_px,
+        "cache_hits": cache.hits,
+        "cache_misses": cache.misses,
+        "seconds": time.perf_counter() - t0,
+    }
+
+
+def _batch_job(args: argparse.Namespace) -> dict:
+    try:
+        return compile_spec(args)
+    except (SystemExit, ValueError, OSError) as exc:
+        return {"name": Path(args.spec).stem, "error": str(exc)}
+
+
+def collect_specs(inputs: list[str], root: Path) -> list[Path]:
+    """Spec files from the arguments; a directory adds every *.json with a sibling .kla."""
+    specs: list[Path] = []
+    for item in inputs:
+        path = (root / item).resolve()
+        if path.is_dir():
+            specs.extend(p for p in sorted(path.glob("*.json")) if p.with_suffix(".kla").exists())
+        else:
+            specs.append(path)
+    return list(dict.fromkeys(specs))
+
+
+def print_summary(results: list[dict], seconds: float, jobs: int) -> None:
+    print(f"{'level':<24} {'chars':>5} {'tiles':>5} {'error px':>9} {'error %':>8} {'cached':>7} {'time':>8}")
+    for r in results:
+        if "error" in r:
+            print(f"{r['name']:<24} error: {r['error']}")
+            continue
+        pct = 100.0 * r["error_px"] / TMAP_PIXELS
+        total = r["cache_hits"] + r["cache_misses"]
+        cached = 100.0 * r["cache_hits"] / total if total else 0.0
+        print(f"{r['name']:<24} {r['chars']:>5} {r['tiles']:>5} {r['error_px']:>9} {pct:>7.2f}% {cached:>6.1f}% {r['seconds']:>7.2f}s")
+    print(f"{len(results)} level(s) in {seconds:.2f}s with {jobs} worker(s)")
+
+
+def run_pipeline(res: dict, levels: list[str]) -> None:
+    """Hand the compiled TileSet to tilesetc and levelc without re-parsing the .tset."""
+    if res["tileset_errors"]:
+        raise SystemExit("Tileset not usable in memory: " + "; ".join(res["tileset_errors"]))
+    tset_path = str(dict(res["written"])["tileset"])
+    t0 = time.perf_counter()
+    tilesetc.write_tileset(res["tileset"], tilesetc.make_arg_parser().parse_args([tset_path]))
+    t1 = time.perf_counter()
+    for lvl in levels:
+        levelc.run(levelc.make_arg_parser().parse_args([lvl]), tilesets={tset_path: res["tileset"]})
+    t2 = time.perf_counter()
+    print(
+        f"Pipeline: image -> tileset {res['seconds']:.2f}s, TSET blob {t1 - t0:.3f}s, "
+        f"{len(levels)} level(s) {t2 - t1:.3f}s, total {res['seconds'] + t2 - t0:.2f}s"
+    )
 
-    print(f"Wrote charset: {charset_path}")
-    print(f"Wrote tileset: {tset_path}")
-    print(f"Wrote tmap: {tmap_path}")
-    print(f"Wrote tiles: {tiles_dir}")
-    print(f"Wrote tiles md: {tiles_md}")
-    print(f"Wrote tile map: {tile_map_path}")
+
+def main() -> None:
+    ap = argparse.ArgumentParser()
+    ap.add_argument("spec", nargs="*", help="Spec JSON files or directories (a directory takes every spec with a .kla)")
+    ap.add_argument("--kla", default="", help="Koala file (defaults to match spec name)")
+    ap.add_argument("--out-dir", default="", help="Output directory (defaults to debug/<spec name>)")
+    ap.add_argument("--charset", default="", help="Output charset bin (defaults to assets/<spec name>_chargen.bin)")
+    ap.add_argument("--tset", default="", help="Output tileset (defaults to levels/<spec name>.tset)")
+    ap.add_argument("--tmap", default="", help="Output full map (defaults to debug/<spec name>/<spec name>_tmap.bin)")
+    ap.add_argument("--tile-map", default="", help="Output tile location map (defaults to debug/<spec name>/<spec name>_tile_locations.png)")
+    ap.add_argument("--info", default="", help="Output info (defaults to debug/<spec name>/<spec name>_info.txt)")
+    ap.add_argument("--fast", action="store_true", help="Use fast MC1/MC2 selection")
+    ap.add_argument("--merge-threshold", type=int, default=-1, help="Alias tiles within this tile_distance (0..8) of a kept tile with the same flags")
+    ap.add_argument("--max-tiles", type=int, default=0, help="Merge closest tiles until at most N remain (within --merge-threshold if set)")
+    ap.add_argument("--no-cache", action="store_true", help="Ignore and do not write the per-cell encoding cache")
+    ap.add_argument("--levels", nargs="+", default=[], help="Also compile the TSET blob and these .lvl files from the in-memory tileset")
+    ap.add_argument("--jobs", type=int, default=0, help="Worker processes in batch mode (default: all cores)")
+    ap.add_argument("--verify-kla", default="", help="Check decode/encode round trips on a Koala file and exit")
+    args = ap.parse_args()
+
+    root = Path(__file__).resolve().parent.parent
+    if args.verify_kla:
+        sys.exit(0 if verify_kla((root / args.verify_kla).resolve()) else 1)
+    if not args.spec:
+        ap.error("spec is required")
+    specs = collect_specs(args.spec, root)
+    batch = len(specs) != 1 or (root / args.spec[0]).is_dir()
+    if not specs:
+        raise SystemExit("No specs found")
+
+    if not batch:
+        args.spec = str(specs[0])
+        res = compile_spec(args)
+        for label, path in res["written"]:
+            print(f"Wrote {label}: {path}")
+        print(f"Cell cache: {res['cache_hits']} hits, {res['cache_misses']} encoded, {res['seconds']:.2f}s")
+        if args.levels:
+            run_pipeline(res, [str((root / lvl).resolve()) for lvl in args.levels])
+        return
+    if args.levels:
+        ap.error("--levels needs a single spec")
+
+    fixed = [name for name in ("kla", "out_dir", "charset", "tset", "tmap", "tile_map", "info") if getattr(args, name)]
+    if fixed:
+        ap.error(f"--{fixed[0].replace('_', '-')} names one output and cannot be used with several specs")
+    jobs = max(1, min(args.jobs or os.cpu_count() or 1, len(specs)))
+    per_spec = [argparse.Namespace(**{**vars(args), "spec": str(p)}) for p in specs]
+    t0 = time.perf_counter()
+    # Each level is independent and map() keeps spec order, so output is the same for any --jobs.
+    if jobs == 1:
+        results = [_batch_job(a) for a in per_spec]
+    else:
+        with ProcessPoolExecutor(max_workers=jobs) as pool:
+            results = list(pool.map(_batch_job, per_spec))
+    print_summary(results, time.perf_counter() - t0, jobs)
+    if any("error" in r for r in results):
+        sys.exit(1)
 
 
 if __name__ == "__main__":
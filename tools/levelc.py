@@ -5,7 +5,8 @@ levelc.py - LVLTEXT -> packed binary level blob + generated C headers/C blob + .
 Outputs:
   - .bin           Packed binary level blob (offset-based)
   - *_ids.h        Enums for flags/vars/items/messages + ObjType constants
-  - .sym           Human-readable symbol map (offsets, rooms, objects, scripts, messages)
+  - .sym           Human-readable symbol map (offsets, rooms, objects, scripts, messages,
+                   cycle estimates)
   - .json          Optional debug summary (enabled by default)
   - .c/.h          Embeds blob as C unsigned char[] + exports size
   - level_format.h Inline accessors/constants when --format-h is provided
@@ -20,19 +21,24 @@ Notes:
 - Comments start with ';' (so '#' is safe for tiles).
 - MAP rows must match w,h exactly, and all chars must exist in TILES mapping.
 - Conditions are AND-only bytecode. Actions are linear bytecode.
+- Scripts/messages/flags/vars/items that nothing references are removed (one
+  warning each) and the remaining IDs are renumbered densely; --keep-unused
+  disables this.
 - Approach A routing:
     * LOCKER_KEYPAD: p0/p1 = code (hundreds, remainder); alt0=ok script; alt1=bad script
     * BREAKER_PANEL: p0 = varId to write; p1 = expectedBits (0..7) from expect=; alt0=ok; alt1=bad
-    * HATCH_PANEL: alt0=fuse script, alt1=badge script, use=reject script (optional)
+    * HATCH_PANEL: alt0=fuse script, alt1=badge script, use=reject script (optional);
+      p0/p1 = fuse_item/badge_item ids
 
 LVLTEXT format summary (minimal):
-  LEVEL name="..." w=20 h=12 start=R0:S0 tset=tileset.tset
+  LEVEL name="..." w=20 h=12 start=R0:S0 tset=tileset.tset goal=COND_NAME campaign=campaign.cmp layer=FLAG
+        water=VAR water_colors=BLUE,LIGHT_BLUE,CYAN wind=0.5,1.5 companion=R2:S1
   TILES
     . FLOOR_A
     # WALL
   END
   FLAGS ... END
-  VARS  ... END
+  VARS  ... END            ; names from the campaign file compile to the wide ops
   ITEMS ... END
   MESSAGES
     MSGID = "text"
@@ -42,18 +48,57 @@ LVLTEXT format summary (minimal):
   END
   ACT NAME
     MSG ID | SETFLAG X | CLRFLAG X | GIVE ITEM | TAKE ITEM | SETVAR VAR value | SFX n | TRANSITION Rn Sn
+    COMPANION FOLLOW|STAY
+    PARTICLES KIND x,y [n]  ; burst of n (default 4) tset PARTICLES near map cell x,y
+    DIALOG NAME             ; opens a DIALOG at its first NODE
   END
-  ROOM R0 name="..."
+  NPC NAME image=SOLDIER_L speed=1   ; behaviour script shared by every NPCS placement of this type
+    top:                   ; label; IFSET/IFCLR/GOTO jump to it
+    MOVETO x,y | WAIT n | FACE LEFT|RIGHT|PLAYER | FIRE range push | ANIM IMAGE
+    IFSET FLAG label | IFCLR FLAG label | GOTO label | YIELD | STOP
+  END
+  DIALOG NAME              ; conversation graph walked in the textbox
+    NODE HELLO MSGID [next=NODE]   ; message; without CHOICEs, Fire goes to next= (or ends)
+    CHOICE MSGID [cond=COND] [act=ACT] [next=NODE]   ; up to 4 per NODE; hidden while cond fails
+  END
+  ROUTE NAME               ; switchable node graph; REACH flags follow connectivity
+    NODES BUS_A J1 LIFT_MOTOR
+    EDGE BUS_A-J1            ; always connected ('>' = one-way)
+    EDGE J1-LIFT_MOTOR switch=CABLE_3   ; present while CABLE_3 is set ('!CABLE_3' = while clear)
+    REACH BUS_A-LIFT_MOTOR flag=LIFT_POWERED
+  END
+  ROOM R0 name="..." water=120,160   ; water surface (room px) for water VAR = 0, 1, ...; '-' = dry
     SPAWNS ... END
     EXITS  ... END
     OBJECTS ... END
+    STATES                 ; cell or object shows `tile` while `flag` is set
+      3,4 flag=DOOR_OPEN tile=FLOOR_A
+    END
     MAP ... END
+    ALTMAP ... END         ; optional: the room while the LEVEL layer= flag is set
+    WIND                   ; lanes of cells that push the player; shield= flag cancels the lane
+      2,3-17,4 push=LEFT|RIGHT|STRONG_LEFT|STRONG_RIGHT shield=FLAG
+    END
+    PLATES                 ; PLATE tiles: `flag` is set while the player or companion stands on it
+      9,10 flag=PEDAL_DOWN
+    END
+    PLATFORMS              ; tset PLATFORMS kind along a straight path of open cells
+      LIFT 9,10-9,3 speed=1 flag=LIFT_CALL   ; at the far end while flag is set; no flag = shuttles
+    END
+    LASERS                 ; sprite beam sweeping between two cells; touching it knocks the player back
+      V 3,1-16,1 sprites=2 steps=64 rate=2 push=4 color=RED off=FLAG   ; H beams sweep x0,y0-x0,y1
+    END
+    NPCS                   ; NPC types standing on map cells; sprites come out of the LASERS budget
+      SENTRY 4,8 face=LEFT image=TURRET speed=2
+    END
   ENDROOM
 """
 
 from __future__ import annotations
 import argparse
+import copy
 import json
+import math
 import os
 import re
 import struct
@@ -62,7 +107,7 @@ from dataclasses import dataclass, field
 from typing import Dict, List, Optional, Tuple
 
 from gen_paths import GEN_ROOT, ANALYSIS_ROOT
-from tset_parser import parse_tset as parse_tset_shared
+from tset_parser import parse_tset as parse_tset_shared, parse_color, TileSet
 
 
 # ----------------------------
@@ -93,14 +138,16 @@ class ErrorCollector:
         }
         self.errors.append(entry)
 
+    def add_warning(self, message: str, file: Optional[str] = None, line: Optional[int] = None, col: Optional[int] = None):
+        self.add_error(message, file=file, line=line, col=col, severity="warning")
+
     def has_errors(self) -> bool:
-        """Check if any errors have been collected."""
-        return len(self.errors) > 0
+        """Check if any errors (not warnings) have been collected."""
+        return any(e["severity"] == "error" for e in self.errors)
 
     def report_and_exit(self):
-        """Report all collected errors and exit if any exist."""
-        if not self.has_errors():
-            return
+        """Report all collected diagnostics and exit if any of them are errors."""
+        has_errors = self.has_errors()
         for entry in self.errors:
             path = os.path.abspath(entry["file"])
             line = entry["line"]
@@ -108,7 +155,9 @@ class ErrorCollector:
             sev = entry["severity"]
             msg = entry["message"]
             print(f"{path}:{line}:{col}: {sev}: {msg}", file=sys.stderr)
-        sys.exit(1)
+        self.errors = []
+        if has_errors:
+            sys.exit(1)
 
 
 # ----------------------------
@@ -122,6 +171,10 @@ C_FLAG_SET = 2
 C_FLAG_CLR = 3
 C_HAS_ITEM = 4
 C_VAR_EQ = 5
+# Wide forms, emitted instead of the ops above when the name is a campaign flag/var.
+C_FLAG_SET_W = 6  # [op, id lo, id hi]
+C_FLAG_CLR_W = 7
+C_VAR_EQ_C = 8  # [op, campaign var, value]
 
 COND_OPS = {
     "END": C_END,
@@ -142,6 +195,16 @@ A_TAKE_ITEM = 5
 A_SET_VAR = 6
 A_SFX = 7
 A_TRANSITION = 8
+A_SET_FLAG_W = 9  # [op, id lo, id hi]
+A_CLR_FLAG_W = 10
+A_SET_VAR_C = 11  # [op, campaign var, value]
+A_COMPANION = 12  # [op, mode]
+A_PARTICLES = 13  # [op, x | kind << 5, y | (n - 1) << 4]
+A_DIALOG = 14  # [op, node lo, node hi]: node offset in the dialog block
+
+COMPANION_MODES = {"STAY": 0, "FOLLOW": 1}
+PARTICLE_KINDS_MAX = 8  # 3 bits next to the cell x
+PARTICLE_BURST_MAX = 8  # PARTICLE_MAX in particle.h
 
 ACT_OPS = {
     "END": A_END,
@@ -153,8 +216,25 @@ ACT_OPS = {
     "SETVAR": A_SET_VAR,
     "SFX": A_SFX,
     "TRANSITION": A_TRANSITION,
+    "COMPANION": A_COMPANION,
+    "PARTICLES": A_PARTICLES,
+    "DIALOG": A_DIALOG,
 }
 
+# Single-byte op -> wide op used for campaign flags/vars.
+COND_WIDE_OPS = {C_FLAG_SET: C_FLAG_SET_W, C_FLAG_CLR: C_FLAG_CLR_W, C_VAR_EQ: C_VAR_EQ_C}
+ACT_WIDE_OPS = {A_SET_FLAG: A_SET_FLAG_W, A_CLR_FLAG: A_CLR_FLAG_W, A_SET_VAR: A_SET_VAR_C}
+
+# Wide flag ids: bit 15 selects the campaign tier, the rest is the index in that tier.
+FLAG_WIDE_CAMPAIGN = 0x8000
+
+# Tier capacities; keep in sync with PUZZLE_MAX_* in src/puzzle.c and
+# LVL_CAMPAIGN_MAX_* in level_format.h.
+LEVEL_MAX_FLAGS = 256
+LEVEL_MAX_VARS = 64
+CAMPAIGN_MAX_FLAGS = 1024
+CAMPAIGN_MAX_VARS = 64
+
 VERB_BITS = {
     "LOOK": 1 << 0,
     "TAKE": 1 << 1,
@@ -178,11 +258,11 @@ OBJ_TYPES = {
 
 # Binary format constants
 LEVEL_MAGIC = b"LVL1"
-LEVEL_VERSION = 1
+LEVEL_VERSION = 12
 
 # Header layout (packed):
-# <4s 10B 4H = 22 bytes
-HEADER_SIZE = 22
+# <4s 10B 9H 2B 6H = 46 bytes
+HEADER_SIZE = 46
 
 # Offsets in header (bytes)
 HDR_OFS_MAGIC = 0
@@ -200,10 +280,137 @@ HDR_OFS_ROOMDIR = 14  # uint16_t
 HDR_OFS_CONDSTREAM = 16  # uint16_t
 HDR_OFS_ACTSTREAM = 18  # uint16_t
 HDR_OFS_MSGTABLE = 20  # uint16_t
+HDR_OFS_PAGES = 22  # uint16_t, 0 = map bytes are tileset ids
+HDR_OFS_STATES = 24  # uint16_t, 0 = no flag-bound tile states
+HDR_OFS_LAYERS = 26  # uint16_t, 0 = no alternate layer
+HDR_OFS_WATER = 28  # uint16_t, 0 = no water
+HDR_OFS_WIND = 30  # uint16_t, 0 = no wind
+HDR_OFS_COMPANION_ROOM = 32  # 0xFF = no companion
+HDR_OFS_COMPANION_SPAWN = 33
+HDR_OFS_PLATES = 34  # uint16_t, 0 = no pressure plates
+HDR_OFS_ROUTES = 36  # uint16_t, 0 = no routing graphs
+HDR_OFS_PLATFORMS = 38  # uint16_t, 0 = no moving platforms
+HDR_OFS_LASERS = 40  # uint16_t, 0 = no sweeping lasers
+HDR_OFS_DIALOGS = 42  # uint16_t, 0 = no dialogue graphs
+HDR_OFS_NPCS = 44  # uint16_t, 0 = no scripted NPCs
+
+ROOM_TILES_MAX = 256  # distinct metatiles one room (one page) can address
+STATE_RECORD_SIZE = 4  # room, x, y, tile
+LAYER_DIFF_RECORD_SIZE = 3  # x, y, tile
+PLATE_RECORD_SIZE = 3  # x, y, flag
+PLATES_MAX = 255
+COMPANION_NONE = 0xFF
+TF_PLATE = 1 << 12  # tset flag bit PLATE (tile_flags.h)
+TF_SHAPED = (1 << 0) | (1 << 2) | (1 << 6)  # SOLID | STANDABLE | FLOOR (COLL_SHAPED_FLAGS)
+PLATFORM_RECORD_SIZE = 7  # kind, x0, y0, x1, y1, speed, flag
+PLATFORM_ROOM_MAX = 4  # COLL_DECKS in collision.h
+PLATFORM_MAX_SPEED = 4  # px/frame: at most one char row or column per frame
+PLATFORM_NO_FLAG = 0xFF
+# Sweeping lasers. A beam is 1..3 expanded hires sprites: a V beam is 2 px
+# wide and 42 px per sprite, an H beam 2 px tall and 48 px per sprite.
+LASER_RECORD_SIZE = 11  # axis, sprites, color, rate, steps, push, cross lo/hi, off flag, u16 steps ofs
+LASER_STEP_SIZE = 6  # x lo, x hi | reverse, y, 24-bit covered-cell mask along the sweep
+LASER_ROOM_MAX = 3
+LASER_SPRITES = 6  # hardware sprites 2..7; 0 is the player, 1 the companion
+LASER_SPRITE_LEN = {"V": 42, "H": 48}
+LASER_AXES = {"V": 0, "H": 1}
+LASER_MAX_STEPS = 128
+LASER_MAX_RATE = 8
+LASER_MAX_PUSH = 8  # px, one knockback step never crosses more than one cell edge
+LASER_REVERSE = 0x80  # step x hi bit: beam moving toward lower cells, push flips
+LASER_NO_FLAG = 0xFF
+LASER_MAP_MAX = (20, 12)  # the mask covers 24 cells along the sweep
+SPRITE_OFS_X = 24  # room pixel -> VIC sprite coordinate (player.c sprite_offset_x/y)
+SPRITE_OFS_Y = 50
+# Dialogue nodes are addressed by offset in the dialog block (byte 0 is the
+# dialog count, so offset 0 can mean "end"); the runtime keeps no tables.
+DIALOG_CHOICES_MAX = 4
+DIALOG_CHOICE_SIZE = 7  # label msg, u16 cond, u16 act, u16 next node
+DIALOG_END = 0
+# Scripted NPCs. Behaviour scripts are [op,a,b] triples like ACTs, one copy
+# per NPC type; jump targets are op indexes in the script.
+NPC_RECORD_SIZE = 7  # x, y, image, speed, face, u16 script ofs
+NPC_OP_SIZE = 3
+NPC_ROOM_MAX = 3  # hardware sprites 7 downward, shared with LASER_SPRITES
+NPC_MAX_OPS = 256  # u8 jump targets
+NPC_MAX_SPEED = 4  # px/frame, like PLATFORM_MAX_SPEED
+NPC_MAX_RANGE = 20  # FIRE reach in cells
+NPC_OPS_PER_FRAME = 4  # keep in sync with entity.h
+# Sprite images in include/npc_sprites_mc.h order (NPC_*_OFF / 64).
+NPC_IMAGES = ["TECH", "ROBOT", "JANITOR", "SCIENTIST", "NINJA", "SOLDIER_L", "SOLDIER_R", "TURRET", "ELECTRO_L", "ELECTRO_R"]
+NPC_FACES = {"LEFT": 0, "RIGHT": 1, "PLAYER": 2}
+N_STOP = 0
+N_YIELD = 1
+N_WAIT = 2  # [op, frames]
+N_MOVETO = 3  # [op, x, y]: walk to map cell x,y at the NPC's speed
+N_FACE = 4  # [op, face]
+N_FIRE = 5  # [op, range cells, push px]
+N_ANIM = 6  # [op, image]
+N_IFSET = 7  # [op, flag, target]
+N_IFCLR = 8  # [op, flag, target]
+N_GOTO = 9  # [op, target]
+NPC_OPS = {
+    "STOP": N_STOP,
+    "YIELD": N_YIELD,
+    "WAIT": N_WAIT,
+    "MOVETO": N_MOVETO,
+    "FACE": N_FACE,
+    "FIRE": N_FIRE,
+    "ANIM": N_ANIM,
+    "IFSET": N_IFSET,
+    "IFCLR": N_IFCLR,
+    "GOTO": N_GOTO,
+}
+ROUTE_MAX = 8  # routes per level: one bit each in the per-flag switch mask
+ROUTE_MAX_NODES = 8  # one adjacency byte per node
+ROUTE_MAX_EDGES = 32
+ROUTE_EDGE_INVERT = 0x80  # edge present while the switch flag is clear
+ROUTE_EDGE_ONEWAY = 0x40
+WATER_DRY = 0xFF  # water line table entry: no water in this room at this level
+WATER_MAX_LEVELS = 8
+WATER_MAX_Y = 192  # room pixel rows visible in the 40x24 char window
+# Wind force codes, 2 bits per cell. STRONG pushes in the room's one strong direction.
+WIND_NONE, WIND_LEFT, WIND_RIGHT, WIND_STRONG = 0, 1, 2, 3
+WIND_PUSH = {
+    "LEFT": (WIND_LEFT, 0),
+    "RIGHT": (WIND_RIGHT, 0),
+    "STRONG_LEFT": (WIND_STRONG, -1),
+    "STRONG_RIGHT": (WIND_STRONG, 1),
+}
+WIND_DEFAULT_SPEEDS = "0.5,1.5"  # weak,strong px/frame
+# Added to the run speed, so a pushed body still moves less than its width per frame.
+WIND_MAX_FX = 4 * 256
+WIND_MAP_MAX = 5 * 12  # bytes of src/wind.c's RAM map (20x12 cells, 4 per byte)
+STATES_MAX = 255  # record count and flag index entries are u8
+ROOM_CELLS_MAX = 240  # RAM copy of the room map in src/room.c (20x12)
 
 ROOM_DIRENTRY_SIZE = 8  # 4x uint16_t
 OBJ_RECORD_SIZE = 22  # fixed in this tool
 
+# LVL2 segmented container: resident index + LVL1-format segments (see docs/lvl_format.md)
+LEVEL2_MAGIC = b"LVL2"
+LEVEL2_VERSION = 2
+
+# <4s 8B H H B B H H H H = 26 bytes
+HEADER2_SIZE = 26
+HDR2_OFS_VERSION = 4
+HDR2_OFS_MAPW = 5
+HDR2_OFS_MAPH = 6
+HDR2_OFS_FLAGCOUNT = 7
+HDR2_OFS_VARCOUNT = 8
+HDR2_OFS_ITEMCOUNT = 9
+HDR2_OFS_MSGCOUNT = 10
+HDR2_OFS_SEGCOUNT = 11
+HDR2_OFS_ROOMCOUNT = 12  # uint16_t
+HDR2_OFS_STARTROOM = 14  # uint16_t
+HDR2_OFS_STARTSPAWN = 16
+HDR2_OFS_SEGTABLE = 18  # uint16_t
+HDR2_OFS_ROOMTABLE = 20  # uint16_t
+HDR2_OFS_NAME = 22  # uint16_t
+SEG_ENTRY_SIZE = 8  # pack offset u24, size u16, local room count u8, imports ofs u16
+ROOM2_ENTRY_SIZE = 2  # segment u8, local room u8
+SEGMENT_SIZE_DEFAULT = 0x1000  # keep in sync with LEVEL_SEGMENT_MAX in src/level_runtime.c
+
 
 # ----------------------------
 # Data models
@@ -238,17 +445,165 @@ class ObjDef:
     alt1: str = ""  # keypad/breaker bad, hatch badge
 
 
+@dataclass
+class StateDef:
+    """STATES line: the cell (or object's cell) shows `tile` while `flag` is set."""
+
+    target: str  # "x,y" or an object name in the same room
+    flag: str
+    tile_token: str
+    line_no: int
+    tile: Optional[int] = None  # resolved tileset id
+
+
+@dataclass
+class WindDef:
+    """WIND lane: cells x0..x1, y0..y1 push the player; `shield` set cancels the lane."""
+
+    x0: int
+    y0: int
+    x1: int
+    y1: int
+    push: str
+    shield: str
+    line_no: int
+
+
+@dataclass
+class PlateDef:
+    """PLATES line: `flag` is set while the player or the companion stands on cell x,y."""
+
+    x: int
+    y: int
+    flag: str
+    line_no: int
+
+
+@dataclass
+class PlatformDef:
+    """PLATFORMS line: a tset platform kind moving between cells x0,y0 and x1,y1."""
+
+    kind: str
+    x0: int
+    y0: int
+    x1: int
+    y1: int
+    speed: int
+    flag: str
+    line_no: int
+
+
+@dataclass
+class LaserDef:
+    """LASERS line: a V beam hangs from row y0 and sweeps between columns x0 and
+    x1; an H beam starts at column x0 and sweeps between rows y0 and y1."""
+
+    axis: str
+    x0: int
+    y0: int
+    x1: int
+    y1: int
+    sprites: int
+    steps: int
+    rate: int
+    push: int
+    color: str
+    off: str
+    line_no: int
+
+
+@dataclass
+class NpcDef:
+    """NPC block: a behaviour script and the defaults of the NPCS lines naming it."""
+
+    name: str
+    image: str
+    speed: int
+    line_no: int
+    lines: List[Tuple[int, str]] = field(default_factory=list)
+
+
+@dataclass
+class NpcPlacement:
+    """NPCS line: an NPC of type `kind` standing on map cell x,y."""
+
+    kind: str
+    x: int
+    y: int
+    image: str  # "" = the type's
+    speed: int  # 0 = the type's
+    face: str  # "" = from the image
+    line_no: int
+
+
+@dataclass
+class RouteDef:
+    """ROUTE block: a node graph whose switchable edges follow level flags; each
+    REACH keeps a derived flag equal to "dst is reachable from src"."""
+
+    name: str
+    line_no: int
+    nodes: List[str] = field(default_factory=list)
+    edges: List[Tuple[str, str, bool, str, int]] = field(default_factory=list)  # (src, dst, one-way, switch, line)
+    reaches: List[Tuple[str, str, str, int]] = field(default_factory=list)  # (src, dst, flag, line)
+
+
+@dataclass
+class DialogChoice:
+    msg: str
+    cond: str
+    act: str
+    next: str
+    line_no: int
+
+
+@dataclass
+class DialogNode:
+    name: str
+    msg: str
+    next: str
+    line_no: int
+    choices: List[DialogChoice] = field(default_factory=list)
+
+
+@dataclass
+class DialogDef:
+    """DIALOG block: message nodes linked by choices; the first NODE is the entry."""
+
+    name: str
+    line_no: int
+    nodes: Dict[str, DialogNode] = field(default_factory=dict)
+
+
 @dataclass
 class RoomDef:
     room_id: str
     name: str
     line_no: int
+    group: str = ""  # LVL2: rooms with the same group share a segment
     spawns: Dict[str, Tuple[int, int, int]] = field(default_factory=dict)  # "S0" -> (x,y,line)
     exits: List[Tuple[str, str, str, int]] = field(
         default_factory=list
     )  # (edge "L", destRoomId, destSpawnId, line)
     objects: List[ObjDef] = field(default_factory=list)
     map_lines: List[Tuple[int, str]] = field(default_factory=list)
+    alt_lines: List[Tuple[int, str]] = field(default_factory=list)  # ALTMAP: the room on the alternate layer
+    states: List[StateDef] = field(default_factory=list)
+    water: str = ""  # ROOM water=: surface y per water VAR value, "-" = dry
+    wind: List[WindDef] = field(default_factory=list)
+    plates: List[PlateDef] = field(default_factory=list)
+    platforms: List[PlatformDef] = field(default_factory=list)
+    lasers: List[LaserDef] = field(default_factory=list)
+    npcs: List[NpcPlacement] = field(default_factory=list)
+
+
+@dataclass
+class SegmentPlan:
+    """One LVL2 segment: an LVL1 blob holding `rooms` (local ids 0..) plus scripts/messages they reach."""
+
+    rooms: List[str]
+    imports: List[str] = field(default_factory=list)  # rooms in other segments, local ids len(rooms)..
+    live: set = field(default_factory=set)  # _live_refs() of `rooms`
 
 
 @dataclass
@@ -259,6 +614,7 @@ class LevelDef:
     start_room: str
     start_spawn: str
     line_no: int
+    goal: str = ""  # COND that marks the level complete (analysis only)
     tiles: Dict[str, int] = field(default_factory=dict)
     object_stamps: Dict[str, dict] = field(default_factory=dict)
     flags: List[str] = field(default_factory=list)
@@ -268,6 +624,22 @@ class LevelDef:
     conds: Dict[str, ScriptDef] = field(default_factory=dict)
     acts: Dict[str, ScriptDef] = field(default_factory=dict)
     rooms: Dict[str, RoomDef] = field(default_factory=dict)
+    decl_lines: Dict[Tuple[str, str], int] = field(default_factory=dict)  # ("FLAG", name) -> line
+    # Campaign tier (LEVEL campaign=): shared by every level, never renumbered or stripped
+    campaign_file: str = ""
+    campaign_flags: List[str] = field(default_factory=list)
+    campaign_vars: List[str] = field(default_factory=list)
+    layer_flag: str = ""  # LEVEL layer=: level flag that shows every room's ALTMAP
+    water_var: str = ""  # LEVEL water=: level var selecting each room's water line
+    water_colors: str = ""  # LEVEL water_colors=: bg,mc1,mc2 below the line
+    wind_speeds: str = WIND_DEFAULT_SPEEDS  # LEVEL wind=: weak,strong push in px/frame
+    companion: str = ""  # LEVEL companion=: "R:S" where the companion waits at level start
+    tile_flags: Dict[int, int] = field(default_factory=dict)  # tset id -> flags (PLATES checks)
+    routes: Dict[str, RouteDef] = field(default_factory=dict)
+    dialogs: Dict[str, DialogDef] = field(default_factory=dict)
+    npcs: Dict[str, NpcDef] = field(default_factory=dict)
+    platform_kinds: Dict[str, str] = field(default_factory=dict)  # tset PLATFORMS name -> axis, kind id order
+    particle_kinds: List[str] = field(default_factory=list)  # tset PARTICLES names, kind id order
 
 
 # ----------------------------
@@ -305,19 +677,25 @@ def _parse_kv(line: str) -> Dict[str, str]:
     return out
 
 
-def _load_tset_tiles(path: str, errors: ErrorCollector) -> Tuple[Dict[str, int], Dict[str, int], Dict[str, dict]]:
+def _load_tset_tiles(
+    path: str, errors: ErrorCollector, ts: Optional[TileSet] = None
+) -> Tuple[Dict[str, int], Dict[str, int], Dict[str, dict], Dict[int, int], Dict[str, str], List[str]]:
+    """Tile names, CHARMAP, stamps, flags, platform and particle kinds of a tileset; `ts` skips the parse."""
     def err_cb(message: str, line: int, col: int) -> None:
         errors.add_error(message, file=path, line=line, col=col)
 
-    try:
-        ts = parse_tset_shared(path, error_cb=err_cb)
-    except FileNotFoundError:
-        errors.add_error(f"TSET file not found: {path}", file=path, line=1, col=1)
-        return {}, {}, {}
+    if ts is None:
+        try:
+            ts = parse_tset_shared(path, error_cb=err_cb)
+        except FileNotFoundError:
+            errors.add_error(f"TSET file not found: {path}", file=path, line=1, col=1)
+            return {}, {}, {}, {}, {}, []
     tiles = dict(ts.tiles_by_name)
     charmap = dict(ts.charmap_tiles)
     objects = dict(ts.object_stamps)
-    return tiles, charmap, objects
+    flags = {tid: t.flags for tid, t in ts.tiles.items()}
+    platforms = {name: p.axis for name, p in ts.platforms.items()}
+    return tiles, charmap, objects, flags, platforms, list(ts.particles)
 
 
 def _resolve_tile_id(token: str, tset_tiles: Dict[str, int]) -> Optional[int]:
@@ -330,7 +708,53 @@ def _resolve_tile_id(token: str, tset_tiles: Dict[str, int]) -> Optional[int]:
         return tset_tiles.get(key)
 
 
-def parse_lvltext(path: str, errors: ErrorCollector) -> Optional[LevelDef]:
+def parse_campaign(path: str, errors: ErrorCollector) -> Tuple[List[str], List[str]]:
+    """
+    Parse a campaign file: FLAGS/VARS sections in LVLTEXT syntax, shared by all levels.
+    Order is the id order, so only ever append to it once levels ship.
+    """
+    try:
+        with open(path, "r", encoding="utf-8") as f:
+            raw_lines = f.readlines()
+    except (OSError, UnicodeDecodeError) as e:
+        errors.add_error(f"Error reading campaign file: {e}", file=path, line=1, col=1)
+        return [], []
+
+    flags: List[str] = []
+    vars_: List[str] = []
+    mode: Optional[str] = None
+    for line_no, ln in enumerate(raw_lines, 1):
+        line = _strip_comment(ln).strip()
+        if not line:
+            continue
+        if line == "END":
+            mode = None
+            continue
+        if line in ("FLAGS", "VARS"):
+            mode = line
+            continue
+        name = line.split()[0]
+        table = flags if mode == "FLAGS" else vars_ if mode == "VARS" else None
+        if table is None:
+            errors.add_error(f"Unexpected line in campaign file: {line}", file=path, line=line_no, col=1)
+            continue
+        if name in table:
+            errors.add_error(f"Duplicate campaign {mode[:-1]}: {name}", file=path, line=line_no, col=1)
+            continue
+        table.append(name)
+
+    if len(flags) > CAMPAIGN_MAX_FLAGS:
+        errors.add_error(f"Too many campaign FLAGs: {len(flags)} (max {CAMPAIGN_MAX_FLAGS})", file=path, line=1)
+    if len(vars_) > CAMPAIGN_MAX_VARS:
+        errors.add_error(f"Too many campaign VARs: {len(vars_)} (max {CAMPAIGN_MAX_VARS})", file=path, line=1)
+    return flags, vars_
+
+
+def parse_lvltext(
+    path: str, errors: ErrorCollector, tilesets: Optional[Dict[str, TileSet]] = None
+) -> Optional[LevelDef]:
+    """Parse a .lvl file. `tilesets` maps absolute .tset paths to TileSets
+    already in memory; those are used instead of parsing the file."""
     try:
         with open(path, "r", encoding="utf-8") as f:
             raw_lines = f.readlines()
@@ -360,10 +784,17 @@ def parse_lvltext(path: str, errors: ErrorCollector) -> Optional[LevelDef]:
     tset_tiles: Dict[str, int] = {}
     tset_charmap: Dict[str, int] = {}
     tset_objects: Dict[str, dict] = {}
+    tset_flags: Dict[int, int] = {}
+    tset_platforms: Dict[str, str] = {}
+    tset_particles: List[str] = []
     saw_tiles_section = False
     cur_room: Optional[RoomDef] = None
     mode: Optional[str] = None
     cur_script: Optional[ScriptDef] = None
+    cur_route: Optional[RouteDef] = None
+    cur_dialog: Optional[DialogDef] = None
+    cur_node: Optional[DialogNode] = None
+    cur_npc: Optional[NpcDef] = None
     level_found = False
 
     i = 0
@@ -379,6 +810,18 @@ def parse_lvltext(path: str, errors: ErrorCollector) -> Optional[LevelDef]:
                 else:
                     level.acts[cur_script.name] = cur_script
                 cur_script = None
+            if cur_route:
+                level.routes[cur_route.name] = cur_route
+                cur_route = None
+            if cur_dialog:
+                if not cur_dialog.nodes:
+                    err(f"DIALOG {cur_dialog.name} has no NODE", cur_dialog.line_no)
+                level.dialogs[cur_dialog.name] = cur_dialog
+                cur_dialog = None
+                cur_node = None
+            if cur_npc:
+                level.npcs[cur_npc.name] = cur_npc
+                cur_npc = None
             mode = None
             continue
 
@@ -395,11 +838,15 @@ def parse_lvltext(path: str, errors: ErrorCollector) -> Optional[LevelDef]:
             cur_script.lines.append((line_no, line))
             continue
 
-        if mode == "MAP":
+        if cur_npc is not None:
+            cur_npc.lines.append((line_no, line))
+            continue
+
+        if mode in ("MAP", "ALTMAP"):
             if not cur_room:
-                err("MAP outside ROOM", line_no, _col_for_token(raw_line, "MAP"))
+                err(f"{mode} outside ROOM", line_no, _col_for_token(raw_line, mode))
                 continue
-            cur_room.map_lines.append((line_no, line))
+            (cur_room.map_lines if mode == "MAP" else cur_room.alt_lines).append((line_no, line))
             continue
 
         parts = line.split()
@@ -419,10 +866,13 @@ def parse_lvltext(path: str, errors: ErrorCollector) -> Optional[LevelDef]:
                     tset_path = kv["tset"]
                     if not os.path.isabs(tset_path):
                         tset_path = os.path.join(os.path.dirname(path), tset_path)
-                    if not os.path.isfile(tset_path):
+                    preloaded = (tilesets or {}).get(os.path.abspath(tset_path))
+                    if preloaded is None and not os.path.isfile(tset_path):
                         err(f"TSET file not found: {tset_path}", line_no, _col_for_token(raw_line, "tset"))
                     else:
-                        tset_tiles, tset_charmap, tset_objects = _load_tset_tiles(tset_path, errors)
+                        (
+                            tset_tiles, tset_charmap, tset_objects, tset_flags, tset_platforms, tset_particles
+                        ) = _load_tset_tiles(tset_path, errors, preloaded)
                 level = LevelDef(
                     name=kv.get("name", "UNNAMED"),
                     w=int(kv["w"]),
@@ -430,7 +880,25 @@ def parse_lvltext(path: str, errors: ErrorCollector) -> Optional[LevelDef]:
                     start_room=start_room,
                     start_spawn=start_spawn,
                     line_no=line_no,
+                    goal=kv.get("goal", ""),
+                    layer_flag=kv.get("layer", ""),
+                    water_var=kv.get("water", ""),
+                    water_colors=kv.get("water_colors", ""),
+                    wind_speeds=kv.get("wind", WIND_DEFAULT_SPEEDS),
+                    companion=kv.get("companion", ""),
+                    tile_flags=tset_flags,
+                    platform_kinds=tset_platforms,
+                    particle_kinds=tset_particles,
                 )
+                if "campaign" in kv:
+                    campaign_path = kv["campaign"]
+                    if not os.path.isabs(campaign_path):
+                        campaign_path = os.path.join(os.path.dirname(path), campaign_path)
+                    if not os.path.isfile(campaign_path):
+                        err(f"Campaign file not found: {campaign_path}", line_no, _col_for_token(raw_line, "campaign"))
+                    else:
+                        level.campaign_file = campaign_path
+                        level.campaign_flags, level.campaign_vars = parse_campaign(campaign_path, errors)
                 level.object_stamps = {
                     obj["char"]: obj
                     for obj in tset_objects.values()
@@ -461,6 +929,7 @@ def parse_lvltext(path: str, errors: ErrorCollector) -> Optional[LevelDef]:
                 err(f"Duplicate COND: {parts[1]}", line_no, _col_for_token(raw_line, parts[1]))
                 continue
             cur_script = ScriptDef(name=parts[1], kind="COND")
+            level.decl_lines[("COND", parts[1])] = line_no
             continue
 
         if head == "ACT":
@@ -471,6 +940,47 @@ def parse_lvltext(path: str, errors: ErrorCollector) -> Optional[LevelDef]:
                 err(f"Duplicate ACT: {parts[1]}", line_no, _col_for_token(raw_line, parts[1]))
                 continue
             cur_script = ScriptDef(name=parts[1], kind="ACT")
+            level.decl_lines[("ACT", parts[1])] = line_no
+            continue
+
+        if head == "ROUTE":
+            if len(parts) < 2:
+                err(f"ROUTE missing name: {line}", line_no, _col_for_token(raw_line, "ROUTE"))
+                continue
+            if parts[1] in level.routes:
+                err(f"Duplicate ROUTE: {parts[1]}", line_no, _col_for_token(raw_line, parts[1]))
+                continue
+            cur_route = RouteDef(name=parts[1], line_no=line_no)
+            mode = "ROUTE"
+            continue
+
+        if head == "DIALOG" and mode != "DIALOG":
+            if len(parts) < 2:
+                err(f"DIALOG missing name: {line}", line_no, _col_for_token(raw_line, "DIALOG"))
+                continue
+            if parts[1] in level.dialogs:
+                err(f"Duplicate DIALOG: {parts[1]}", line_no, _col_for_token(raw_line, parts[1]))
+                continue
+            cur_dialog = DialogDef(name=parts[1], line_no=line_no)
+            level.decl_lines[("DIALOG", parts[1])] = line_no
+            mode = "DIALOG"
+            continue
+
+        if head == "NPC":
+            kv = _parse_kv(line)
+            if len(parts) < 2 or "=" in parts[1]:
+                err(f"NPC missing name: {line}", line_no, _col_for_token(raw_line, "NPC"))
+                continue
+            if parts[1] in level.npcs:
+                err(f"Duplicate NPC: {parts[1]}", line_no, _col_for_token(raw_line, parts[1]))
+                continue
+            try:
+                speed = int(kv.get("speed", "1"))
+            except ValueError:
+                err(f"NPC speed must be an integer: {kv['speed']}", line_no, _col_for_token(raw_line, kv["speed"]))
+                continue
+            cur_npc = NpcDef(name=parts[1], image=kv.get("image", "TECH").upper(), speed=speed, line_no=line_no)
+            level.decl_lines[("NPC", parts[1])] = line_no
             continue
 
         if head == "ROOM":
@@ -482,11 +992,13 @@ def parse_lvltext(path: str, errors: ErrorCollector) -> Optional[LevelDef]:
             if rid in level.rooms:
                 err(f"Duplicate ROOM: {rid}", line_no, _col_for_token(raw_line, rid))
                 continue
-            cur_room = RoomDef(room_id=rid, name=kv.get("name", rid), line_no=line_no)
+            cur_room = RoomDef(
+                room_id=rid, name=kv.get("name", rid), line_no=line_no, group=kv.get("group", ""), water=kv.get("water", "")
+            )
             mode = None
             continue
 
-        if head in ("SPAWNS", "EXITS", "OBJECTS", "MAP"):
+        if head in ("SPAWNS", "EXITS", "OBJECTS", "STATES", "WIND", "PLATES", "PLATFORMS", "LASERS", "NPCS", "MAP", "ALTMAP"):
             if not cur_room:
                 err(f"{head} outside ROOM", line_no, _col_for_token(raw_line, head))
                 continue
@@ -518,14 +1030,22 @@ def parse_lvltext(path: str, errors: ErrorCollector) -> Optional[LevelDef]:
             if parts[0] in level.flags:
                 err(f"Duplicate FLAG: {parts[0]}", line_no, _col_for_token(raw_line, parts[0]))
                 continue
+            if parts[0] in level.campaign_flags:
+                err(f"FLAG {parts[0]} shadows a campaign flag", line_no, _col_for_token(raw_line, parts[0]))
+                continue
             level.flags.append(parts[0])
+            level.decl_lines[("FLAG", parts[0])] = line_no
             continue
 
         if mode == "VARS":
             if parts[0] in level.vars:
                 err(f"Duplicate VAR: {parts[0]}", line_no, _col_for_token(raw_line, parts[0]))
                 continue
+            if parts[0] in level.campaign_vars:
+                err(f"VAR {parts[0]} shadows a campaign var", line_no, _col_for_token(raw_line, parts[0]))
+                continue
             level.vars.append(parts[0])
+            level.decl_lines[("VAR", parts[0])] = line_no
             continue
 
         if mode == "ITEMS":
@@ -533,6 +1053,7 @@ def parse_lvltext(path: str, errors: ErrorCollector) -> Optional[LevelDef]:
                 err(f"Duplicate ITEM: {parts[0]}", line_no, _col_for_token(raw_line, parts[0]))
                 continue
             level.items.append(parts[0])
+            level.decl_lines[("ITEM", parts[0])] = line_no
             continue
 
         if mode == "MESSAGES":
@@ -544,6 +1065,7 @@ def parse_lvltext(path: str, errors: ErrorCollector) -> Optional[LevelDef]:
                 err(f"Duplicate MESSAGE: {m.group(1)}", line_no, _col_for_token(raw_line, m.group(1)))
                 continue
             level.messages[m.group(1)] = m.group(2)
+            level.decl_lines[("MSG", m.group(1))] = line_no
             continue
 
         if mode == "SPAWNS":
@@ -663,6 +1185,137 @@ def parse_lvltext(path: str, errors: ErrorCollector) -> Optional[LevelDef]:
             cur_room.objects.append(obj)
             continue
 
+        if mode == "STATES":
+            # 3,4 flag=DOOR_OPEN tile=FLOOR_A   |   O2 flag=LIGHTS tile=LAMP_ON
+            kv = _parse_kv(line)
+            if "=" in parts[0] or "flag" not in kv or "tile" not in kv:
+                err(f"Bad STATES line (expected '<x,y|OBJECT> flag=FLAG tile=TILE'): {line}", line_no)
+                continue
+            cur_room.states.append(StateDef(target=parts[0], flag=kv["flag"], tile_token=kv["tile"], line_no=line_no))
+            continue
+
+        if mode == "WIND":
+            # 2,3-17,4 push=LEFT shield=LANE2_SHIELD
+            kv = _parse_kv(line)
+            m = re.match(r"^(\d+),(\d+)-(\d+),(\d+)$", parts[0])
+            if not m or "push" not in kv:
+                err(f"Bad WIND line (expected 'x0,y0-x1,y1 push=DIR [shield=FLAG]'): {line}", line_no)
+                continue
+            push = kv["push"].upper()
+            if push not in WIND_PUSH:
+                err(f"WIND unknown push {kv['push']} (use {'|'.join(WIND_PUSH)})", line_no, _col_for_token(raw_line, kv["push"]))
+                continue
+            x0, y0, x1, y1 = (int(v) for v in m.groups())
+            cur_room.wind.append(
+                WindDef(min(x0, x1), min(y0, y1), max(x0, x1), max(y0, y1), push, kv.get("shield", ""), line_no)
+            )
+            continue
+
+        if mode == "ROUTE" and cur_route is not None:
+            # NODES A B C   |   EDGE A-B [switch=[!]FLAG]   |   REACH A-C flag=FLAG
+            kv = _parse_kv(line)
+            m = re.match(r"^(\w+)([->])(\w+)$", parts[1]) if len(parts) > 1 else None
+            if head == "NODES":
+                cur_route.nodes.extend(parts[1:])
+            elif head == "EDGE" and m:
+                cur_route.edges.append((m.group(1), m.group(3), m.group(2) == ">", kv.get("switch", ""), line_no))
+            elif head == "REACH" and m and m.group(2) == "-" and "flag" in kv:
+                cur_route.reaches.append((m.group(1), m.group(3), kv["flag"], line_no))
+            else:
+                err(f"Bad ROUTE line (expected NODES, EDGE A-B|A>B [switch=FLAG], REACH A-B flag=FLAG): {line}", line_no)
+            continue
+
+        if mode == "DIALOG" and cur_dialog is not None:
+            # NODE HELLO MIRA_HELLO [next=NODE]   |   CHOICE MIRA_ASK [cond=C] [act=A] [next=NODE]
+            kv = _parse_kv(line)
+            pos = [t for t in parts[1:] if "=" not in t]
+            if head == "NODE" and len(pos) == 2:
+                if pos[0] in cur_dialog.nodes:
+                    err(f"DIALOG {cur_dialog.name}: duplicate NODE {pos[0]}", line_no, _col_for_token(raw_line, pos[0]))
+                    continue
+                cur_node = DialogNode(pos[0], pos[1], kv.get("next", ""), line_no)
+                cur_dialog.nodes[pos[0]] = cur_node
+            elif head == "CHOICE" and len(pos) == 1 and cur_node is not None:
+                if len(cur_node.choices) == DIALOG_CHOICES_MAX:
+                    err(f"NODE {cur_node.name}: more than {DIALOG_CHOICES_MAX} CHOICEs", line_no, 1)
+                    continue
+                cur_node.choices.append(
+                    DialogChoice(pos[0], kv.get("cond", ""), kv.get("act", ""), kv.get("next", ""), line_no)
+                )
+            else:
+                err(f"Bad DIALOG line (expected NODE NAME MSG [next=NODE], CHOICE MSG [cond=] [act=] [next=]): {line}", line_no)
+            continue
+
+        if mode == "PLATES":
+            # 9,10 flag=PEDAL_DOWN
+            kv = _parse_kv(line)
+            m = re.match(r"^(\d+),(\d+)$", parts[0])
+            if not m or "flag" not in kv:
+                err(f"Bad PLATES line (expected 'x,y flag=FLAG'): {line}", line_no)
+                continue
+            cur_room.plates.append(PlateDef(int(m.group(1)), int(m.group(2)), kv["flag"], line_no))
+            continue
+
+        if mode == "PLATFORMS":
+            # LIFT 9,10-9,3 speed=1 flag=LIFT_CALL
+            kv = _parse_kv(line)
+            m = re.match(r"^(\d+),(\d+)-(\d+),(\d+)$", parts[1]) if len(parts) > 1 else None
+            if not m:
+                err(f"Bad PLATFORMS line (expected 'KIND x0,y0-x1,y1 [speed=N] [flag=FLAG]'): {line}", line_no)
+                continue
+            try:
+                speed = int(kv.get("speed", "1"))
+            except ValueError:
+                err(f"PLATFORMS speed must be an integer: {kv['speed']}", line_no, _col_for_token(raw_line, kv["speed"]))
+                continue
+            x0, y0, x1, y1 = (int(v) for v in m.groups())
+            cur_room.platforms.append(PlatformDef(parts[0].upper(), x0, y0, x1, y1, speed, kv.get("flag", ""), line_no))
+            continue
+
+        if mode == "LASERS":
+            # V 3,1-16,1 sprites=2 steps=64 rate=2 push=4 color=RED off=LASER_OFF
+            kv = _parse_kv(line)
+            m = re.match(r"^(\d+),(\d+)-(\d+),(\d+)$", parts[1]) if len(parts) > 1 else None
+            if not m or parts[0].upper() not in LASER_AXES:
+                err(f"Bad LASERS line (expected 'V|H x0,y0-x1,y1 [sprites=N] [steps=N] [rate=N] [push=N] [color=C] [off=FLAG]'): {line}", line_no)
+                continue
+            nums = {}
+            for key, default in (("sprites", "2"), ("steps", "64"), ("rate", "2"), ("push", "4")):
+                try:
+                    nums[key] = int(kv.get(key, default))
+                except ValueError:
+                    err(f"LASERS {key} must be an integer: {kv[key]}", line_no, _col_for_token(raw_line, kv[key]))
+            if len(nums) != 4:
+                continue
+            x0, y0, x1, y1 = (int(v) for v in m.groups())
+            cur_room.lasers.append(
+                LaserDef(
+                    parts[0].upper(), x0, y0, x1, y1, nums["sprites"], nums["steps"], nums["rate"], nums["push"],
+                    kv.get("color", "RED"), kv.get("off", ""), line_no,
+                )
+            )
+            continue
+
+        if mode == "NPCS":
+            # SENTRY 4,8 face=LEFT image=TURRET speed=2
+            kv = _parse_kv(line)
+            m = re.match(r"^(\d+),(\d+)$", parts[1]) if len(parts) > 1 else None
+            if not m:
+                err(f"Bad NPCS line (expected 'NPC x,y [face=LEFT|RIGHT] [image=IMAGE] [speed=N]'): {line}", line_no)
+                continue
+            try:
+                speed = int(kv.get("speed", "0"))
+            except ValueError:
+                err(f"NPCS speed must be an integer: {kv['speed']}", line_no, _col_for_token(raw_line, kv["speed"]))
+                continue
+            cur_room.npcs.append(
+                NpcPlacement(
+                    parts[0], int(m.group(1)), int(m.group(2)), kv.get("image", "").upper(), speed,
+                    kv.get("face", "").upper(), line_no,
+                )
+            )
+            continue
+
         err(f"Unexpected line: {line}", line_no, 1)
 
     if level is None:
@@ -681,6 +1334,16 @@ def parse_lvltext(path: str, errors: ErrorCollector) -> Optional[LevelDef]:
         elif not saw_tiles_section and not tset_charmap:
             err("No TILES section and no CHARMAP found in tset", level.line_no)
 
+        # STATES tiles may name a TILES char, a tset tile, or a raw id; resolved once TILES is final
+        for room in level.rooms.values():
+            for st in room.states:
+                if len(st.tile_token) == 1 and st.tile_token in level.tiles:
+                    st.tile = level.tiles[st.tile_token]
+                else:
+                    st.tile = _resolve_tile_id(st.tile_token, tset_tiles)
+                if st.tile is None:
+                    err(f"STATES unknown tile: {st.tile_token}", st.line_no)
+
     # Don't return None here - let compilation run to find more errors
     # The error collector will handle reporting all errors at the end
 
@@ -705,6 +1368,30 @@ def _ascii_bytes(s: str) -> bytes:
     return s.encode("ascii", errors="replace") + b"\x00"
 
 
+def assign_tile_pages(room_tiles: List[set]) -> Tuple[List[int], List[List[int]]]:
+    """
+    Pack rooms into tile pages of at most ROOM_TILES_MAX tileset ids, largest rooms
+    first, each into the page it grows least (ties: lowest page). Rooms sharing a page
+    share one window, so page switches on room entry are rarer. Returns (page per room,
+    sorted tile ids per page).
+    """
+    order = sorted(range(len(room_tiles)), key=lambda r: (-len(room_tiles[r]), r))
+    pages: List[set] = []
+    room_page = [0] * len(room_tiles)
+    for r in order:
+        best = None
+        for p_idx, page in enumerate(pages):
+            grow = len(room_tiles[r] - page)
+            if len(page) + grow <= ROOM_TILES_MAX and (best is None or grow < best[0]):
+                best = (grow, p_idx)
+        if best is None:
+            pages.append(set())
+            best = (0, len(pages) - 1)
+        pages[best[1]] |= room_tiles[r]
+        room_page[r] = best[1]
+    return room_page, [sorted(page) for page in pages]
+
+
 def _pack_enum_header(name: str, entries: List[str]) -> str:
     out = ["typedef enum {\n"]
     for idx, e in enumerate(entries):
@@ -731,12 +1418,20 @@ def _resolve_id(
     return table[name]
 
 
+def _is_campaign(name: str, level_ids: Dict[str, int], campaign_ids: Optional[Dict[str, int]]) -> bool:
+    """True for a campaign name. The namespaces are disjoint (a level name may not shadow a
+    campaign one), so this only picks the wide ops for campaign names."""
+    return name not in level_ids and bool(campaign_ids) and name in campaign_ids
+
+
 def compile_cond_script(
     lines: List[Tuple[int, str]],
     flag_ids: Dict[str, int],
     var_ids: Dict[str, int],
     item_ids: Dict[str, int],
     errors: ErrorCollector,
+    campaign_flag_ids: Optional[Dict[str, int]] = None,
+    campaign_var_ids: Optional[Dict[str, int]] = None,
 ) -> bytes:
     b = bytearray()
     for line_no, raw in lines:
@@ -762,7 +1457,11 @@ def compile_cond_script(
                     col=_col_for_token(raw, op),
                 )
                 continue
-            a = _resolve_id(parts[1], flag_ids, "FLAG", errors, line_no)
+            if _is_campaign(parts[1], flag_ids, campaign_flag_ids):
+                wide = campaign_flag_ids[parts[1]] | FLAG_WIDE_CAMPAIGN
+                code, a, c = COND_WIDE_OPS[code], wide & 0xFF, wide >> 8
+            else:
+                a = _resolve_id(parts[1], flag_ids, "FLAG", errors, line_no)
         elif code == C_HAS_ITEM:
             if len(parts) < 2:
                 errors.add_error(
@@ -780,7 +1479,10 @@ def compile_cond_script(
                     col=_col_for_token(raw, op),
                 )
                 continue
-            a = _resolve_id(parts[1], var_ids, "VAR", errors, line_no)
+            if _is_campaign(parts[1], var_ids, campaign_var_ids):
+                code, a = C_VAR_EQ_C, campaign_var_ids[parts[1]]
+            else:
+                a = _resolve_id(parts[1], var_ids, "VAR", errors, line_no)
             try:
                 c = int(parts[2], 0) & 0xFF
             except ValueError:
@@ -807,6 +1509,10 @@ def compile_act_script(
     room_ids: Dict[str, int],
     spawn_ids_by_room: Dict[str, Dict[str, int]],
     errors: ErrorCollector,
+    campaign_flag_ids: Optional[Dict[str, int]] = None,
+    campaign_var_ids: Optional[Dict[str, int]] = None,
+    particle_ids: Optional[Dict[str, int]] = None,
+    dialog_ofs: Optional[Dict[str, int]] = None,
 ) -> bytes:
     b = bytearray()
     for line_no, raw in lines:
@@ -842,7 +1548,11 @@ def compile_act_script(
                     col=_col_for_token(raw, op),
                 )
                 continue
-            a = _resolve_id(parts[1], flag_ids, "FLAG", errors, line_no)
+            if _is_campaign(parts[1], flag_ids, campaign_flag_ids):
+                wide = campaign_flag_ids[parts[1]] | FLAG_WIDE_CAMPAIGN
+                code, a, c = ACT_WIDE_OPS[code], wide & 0xFF, wide >> 8
+            else:
+                a = _resolve_id(parts[1], flag_ids, "FLAG", errors, line_no)
         elif code in (A_GIVE_ITEM, A_TAKE_ITEM):
             if len(parts) < 2:
                 errors.add_error(
@@ -860,7 +1570,10 @@ def compile_act_script(
                     col=_col_for_token(raw, op),
                 )
                 continue
-            a = _resolve_id(parts[1], var_ids, "VAR", errors, line_no)
+            if _is_campaign(parts[1], var_ids, campaign_var_ids):
+                code, a = A_SET_VAR_C, campaign_var_ids[parts[1]]
+            else:
+                a = _resolve_id(parts[1], var_ids, "VAR", errors, line_no)
             try:
                 c = int(parts[2], 0) & 0xFF
             except ValueError:
@@ -907,6 +1620,57 @@ def compile_act_script(
                 )
             else:
                 c = spawn_ids_by_room[dest_room][dest_spawn] & 0xFF
+        elif code == A_COMPANION:
+            mode = parts[1].upper() if len(parts) > 1 else ""
+            if mode not in COMPANION_MODES:
+                errors.add_error(
+                    f"ACT op {op} requires {'|'.join(COMPANION_MODES)}",
+                    line=line_no,
+                    col=_col_for_token(raw, parts[1] if len(parts) > 1 else op),
+                )
+                continue
+            a = COMPANION_MODES[mode]
+        elif code == A_PARTICLES:
+            m = re.match(r"^(\d+),(\d+)$", parts[2]) if len(parts) > 2 else None
+            if not m:
+                errors.add_error(
+                    f"ACT op {op} requires a kind and a cell: PARTICLES KIND x,y [n]",
+                    line=line_no,
+                    col=_col_for_token(raw, op),
+                )
+                continue
+            kind = parts[1].upper()
+            if kind not in (particle_ids or {}):
+                errors.add_error(
+                    f"ACT op {op}: unknown particle kind {parts[1]} (declare it in the tset PARTICLES)",
+                    line=line_no,
+                    col=_col_for_token(raw, parts[1]),
+                )
+                continue
+            x, y = int(m.group(1)), int(m.group(2))
+            try:
+                n = int(parts[3]) if len(parts) > 3 else 4
+            except ValueError:
+                n = 0
+            if x > 31 or y > 15 or not (1 <= n <= PARTICLE_BURST_MAX):
+                errors.add_error(
+                    f"ACT op {op}: cell must be within 31,15 and n 1..{PARTICLE_BURST_MAX}",
+                    line=line_no,
+                    col=_col_for_token(raw, parts[2]),
+                )
+                continue
+            a = x | particle_ids[kind] << 5
+            c = y | (n - 1) << 4
+        elif code == A_DIALOG:
+            if len(parts) < 2 or parts[1] not in (dialog_ofs or {}):
+                errors.add_error(
+                    f"ACT op {op}: unknown DIALOG {parts[1] if len(parts) > 1 else ''}".rstrip(),
+                    line=line_no,
+                    col=_col_for_token(raw, parts[1] if len(parts) > 1 else op),
+                )
+                continue
+            a = dialog_ofs[parts[1]] & 0xFF
+            c = dialog_ofs[parts[1]] >> 8
         elif code == A_END:
             break
 
@@ -915,38 +1679,519 @@ def compile_act_script(
     return bytes(b)
 
 
-# ----------------------------
-# C generation helpers
-# ----------------------------
+def compile_npc_script(
+    npc: NpcDef,
+    level: LevelDef,
+    flag_ids: Dict[str, int],
+    campaign_flag_ids: Dict[str, int],
+    errors: ErrorCollector,
+) -> bytes:
+    """NPC behaviour ops; a script that can run off its end gets a trailing STOP."""
+    where = f"NPC {npc.name}"
+    ops: List[Tuple[int, str, List[str]]] = []
+    labels: Dict[str, int] = {}
+    for line_no, raw in npc.lines:
+        parts = raw.strip().split()
+        if len(parts) == 1 and parts[0].endswith(":"):
+            label = parts[0][:-1]
+            if label in labels:
+                errors.add_error(f"{where}: duplicate label {label}", line=line_no, col=_col_for_token(raw, label))
+            labels[label] = len(ops)
+            continue
+        ops.append((line_no, raw, parts))
+    if len(ops) >= NPC_MAX_OPS:
+        errors.add_error(f"{where}: more than {NPC_MAX_OPS - 1} ops", line=npc.line_no)
 
+    def target(name: str, line_no: int, raw: str) -> int:
+        if name not in labels:
+            errors.add_error(f"{where}: unknown label {name}", line=line_no, col=_col_for_token(raw, name))
+            return 0
+        return labels[name]
 
-def blob_to_c_array(blob: bytes, array_name: str) -> str:
-    # 12 bytes per line is readable
-    lines: List[str] = []
-    lines.append(f"unsigned char {array_name}[] = {{\n")
-    for i in range(0, len(blob), 12):
-        chunk = blob[i : i + 12]
-        hexes = ",".join(f"0x{b:02X}" for b in chunk)
-        lines.append(f"  {hexes},\n")
-    lines.append("};\n")
-    lines.append(f"unsigned long {array_name}_size = (unsigned long)sizeof({array_name});\n")
-    return "".join(lines)
+    def number(token: str, lo: int, hi: int, what: str, line_no: int, raw: str) -> int:
+        try:
+            v = int(token)
+        except ValueError:
+            v = lo - 1
+        if not (lo <= v <= hi):
+            errors.add_error(f"{where}: {what} must be {lo}..{hi}: {token}", line=line_no, col=_col_for_token(raw, token))
+            return lo
+        return v
 
+    b = bytearray()
+    for line_no, raw, parts in ops:
+        op = parts[0].upper()
+        if op not in NPC_OPS:
+            errors.add_error(f"Unknown NPC op: {op}", line=line_no, col=_col_for_token(raw, parts[0]))
+            continue
+        code = NPC_OPS[op]
+        need = {N_WAIT: 2, N_MOVETO: 2, N_FACE: 2, N_FIRE: 3, N_ANIM: 2, N_IFSET: 3, N_IFCLR: 3, N_GOTO: 2}.get(code, 1)
+        if len(parts) != need:
+            errors.add_error(f"{where}: {op} takes {need - 1} argument(s): {raw.strip()}", line=line_no)
+            continue
+        a = 0
+        c = 0
+        if code == N_WAIT:
+            a = number(parts[1], 1, 255, "WAIT frames", line_no, raw)
+        elif code == N_MOVETO:
+            m = re.match(r"^(\d+),(\d+)$", parts[1])
+            if not m or int(m.group(1)) >= level.w or int(m.group(2)) >= level.h:
+                errors.add_error(f"{where}: MOVETO needs a map cell x,y: {parts[1]}", line=line_no, col=_col_for_token(raw, parts[1]))
+                continue
+            a, c = int(m.group(1)), int(m.group(2))
+        elif code == N_FACE:
+            if parts[1].upper() not in NPC_FACES:
+                errors.add_error(f"{where}: FACE LEFT|RIGHT|PLAYER: {parts[1]}", line=line_no, col=_col_for_token(raw, parts[1]))
+                continue
+            a = NPC_FACES[parts[1].upper()]
+        elif code == N_FIRE:
+            a = number(parts[1], 1, NPC_MAX_RANGE, "FIRE range", line_no, raw)
+            c = number(parts[2], 1, LASER_MAX_PUSH, "FIRE push", line_no, raw)
+        elif code == N_ANIM:
+            if parts[1].upper() not in NPC_IMAGES:
+                errors.add_error(f"{where}: unknown image {parts[1]}", line=line_no, col=_col_for_token(raw, parts[1]))
+                continue
+            a = NPC_IMAGES.index(parts[1].upper())
+        elif code in (N_IFSET, N_IFCLR):
+            if parts[1] in campaign_flag_ids:
+                errors.add_error(f"{where}: {parts[1]} is a campaign flag (only level flags)", line=line_no, col=_col_for_token(raw, parts[1]))
+                continue
+            a = _resolve_id(parts[1], flag_ids, "FLAG", errors, line_no)
+            c = target(parts[2], line_no, raw)
+        elif code == N_GOTO:
+            a = target(parts[1], line_no, raw)
+        b += bytes([code, a & 0xFF, c & 0xFF])
+    if not b or b[-NPC_OP_SIZE] not in (N_STOP, N_GOTO) or len(ops) in labels.values():
+        b += bytes([N_STOP, 0, 0])
+    return bytes(b)
 
-def blob_to_c_embed(bin_path: str, array_name: str) -> str:
-    return (
-        f"unsigned char {array_name}[] = {{\n"
-        f"#embed \"{bin_path}\"\n"
-        f"}};\n"
-        f"unsigned long {array_name}_size = (unsigned long)sizeof({array_name});\n"
-    )
 
+# ----------------------------
+# Dead-data elimination
+# ----------------------------
 
-def make_blob_h(array_name: str) -> str:
-    guard = array_name.upper() + "_H"
-    return (
-        f"#pragma once\n"
-        f"extern unsigned char {array_name}[];\n"
+# Which declaration table an op argument refers to.
+_COND_ARG_KIND = {C_FLAG_SET: "FLAG", C_FLAG_CLR: "FLAG", C_HAS_ITEM: "ITEM", C_VAR_EQ: "VAR"}
+_ACT_ARG_KIND = {
+    A_SHOW_MSG: "MSG",
+    A_SET_FLAG: "FLAG",
+    A_CLR_FLAG: "FLAG",
+    A_GIVE_ITEM: "ITEM",
+    A_TAKE_ITEM: "ITEM",
+    A_SET_VAR: "VAR",
+    A_TRANSITION: "ROOM",
+    A_DIALOG: "DIALOG",
+}
+_NPC_ARG_KIND = {N_IFSET: "FLAG", N_IFCLR: "FLAG"}
+
+# Object properties that name a declaration (resolved into p0/p1 by compile_level).
+_OBJ_PROP_KIND = {
+    ("PICKUP", "item"): "ITEM",
+    ("BREAKER_PANEL", "var"): "VAR",
+    ("HATCH_PANEL", "fuse_item"): "ITEM",
+    ("HATCH_PANEL", "badge_item"): "ITEM",
+}
+
+
+def _script_refs(sdef: ScriptDef | NpcDef, ops: Dict[str, int], arg_kind: Dict[int, str]) -> List[Tuple[str, str]]:
+    refs: List[Tuple[str, str]] = []
+    for _line_no, raw in sdef.lines:
+        parts = raw.split()
+        if len(parts) < 2:
+            continue
+        code = ops.get(parts[0].upper())
+        if code in arg_kind:
+            refs.append((arg_kind[code], parts[1]))
+    return refs
+
+
+def _dialog_refs(dialog: DialogDef) -> List[Tuple[str, str]]:
+    refs: List[Tuple[str, str]] = []
+    for node in dialog.nodes.values():
+        refs.append(("MSG", node.msg))
+        for ch in node.choices:
+            refs.append(("MSG", ch.msg))
+            if ch.cond:
+                refs.append(("COND", ch.cond))
+            if ch.act:
+                refs.append(("ACT", ch.act))
+    return refs
+
+
+def _live_refs(level: LevelDef, rooms: List[str], include_goal: bool = True) -> set:
+    """(kind, name) pairs reachable from the objects and exits of `rooms` (and the LEVEL goal)."""
+    live: set = set()
+    if level.goal and include_goal:
+        live.add(("COND", level.goal))
+    for rid in rooms:
+        room = level.rooms[rid]
+        for _edge, dest_room, _dest_spawn, _line_no in room.exits:
+            live.add(("ROOM", dest_room))
+        for obj in room.objects:
+            live.add(("COND", obj.cond_name))
+            for name in (obj.look, obj.take, obj.use, obj.talk, obj.operate, obj.alt0, obj.alt1):
+                if name:
+                    live.add(("ACT", name))
+            for key, value in obj.props.items():
+                kind = _OBJ_PROP_KIND.get((obj.type_name, key))
+                if kind:
+                    live.add((kind, value))
+        for st in room.states:
+            live.add(("FLAG", st.flag))
+        if room.alt_lines and level.layer_flag:
+            live.add(("FLAG", level.layer_flag))
+        if room.water and level.water_var:
+            live.add(("VAR", level.water_var))
+        for lane in room.wind:
+            if lane.shield:
+                live.add(("FLAG", lane.shield))
+        for plate in room.plates:
+            live.add(("FLAG", plate.flag))
+        for plat in room.platforms:
+            if plat.flag:
+                live.add(("FLAG", plat.flag))
+        for laser in room.lasers:
+            if laser.off:
+                live.add(("FLAG", laser.off))
+        for placed in room.npcs:
+            live.add(("NPC", placed.kind))
+
+    # An NPC type is compiled once for every segment holding one of its placements.
+    for name, npc in level.npcs.items():
+        if ("NPC", name) in live:
+            live.update(_script_refs(npc, NPC_OPS, _NPC_ARG_KIND))
+
+    # Routes are level-wide: their switches and derived flags live in every segment.
+    for route in level.routes.values():
+        for _src, _dst, _oneway, switch, _line in route.edges:
+            if switch:
+                live.add(("FLAG", switch.lstrip("!")))
+        for _src, _dst, flag, _line in route.reaches:
+            live.add(("FLAG", flag))
+
+    # ACTs open DIALOGs and choices run ACTs, so follow both until nothing new turns up.
+    size = -1
+    while size != len(live):
+        size = len(live)
+        for name, dialog in level.dialogs.items():
+            if ("DIALOG", name) in live:
+                live.update(_dialog_refs(dialog))
+        for name, sdef in level.acts.items():
+            if ("ACT", name) in live:
+                live.update(_script_refs(sdef, ACT_OPS, _ACT_ARG_KIND))
+    for name, sdef in level.conds.items():
+        if ("COND", name) in live:
+            live.update(_script_refs(sdef, COND_OPS, _COND_ARG_KIND))
+    return live
+
+
+def eliminate_dead_data(level: LevelDef, errors: ErrorCollector) -> dict:
+    """
+    Drop COND/ACT scripts that no object (or the LEVEL goal) references, then drop
+    flags/vars/items/messages that no surviving script or object references.
+    Remaining IDs keep file order, so they are renumbered densely and the generated
+    ID header stays in sync. Emits one warning per removed declaration.
+    """
+    live = _live_refs(level, list(level.rooms))
+    removed: Dict[str, List[str]] = {}
+
+    def keep(kind: str, names: List[str]) -> List[str]:
+        dead = [n for n in names if (kind, n) not in live]
+        for n in dead:
+            line_no = level.decl_lines.get((kind, n))
+            if line_no is not None:  # the implicit ALWAYS cond is dropped silently
+                errors.add_warning(f"Unused {kind} {n} removed", line=line_no)
+        removed[kind.lower() + "s"] = [n for n in dead if (kind, n) in level.decl_lines]
+        return [n for n in names if (kind, n) in live]
+
+    level.conds = {n: level.conds[n] for n in keep("COND", list(level.conds))}
+    level.acts = {n: level.acts[n] for n in keep("ACT", list(level.acts))}
+    level.dialogs = {n: level.dialogs[n] for n in keep("DIALOG", list(level.dialogs))}
+    level.npcs = {n: level.npcs[n] for n in keep("NPC", list(level.npcs))}
+    level.flags = keep("FLAG", level.flags)
+    level.vars = keep("VAR", level.vars)
+    level.items = keep("ITEM", level.items)
+    level.messages = {n: level.messages[n] for n in keep("MSG", list(level.messages))}
+
+    return {"removed": removed}
+
+
+# ----------------------------
+# Cycle estimates
+# ----------------------------
+
+# Rough worst-case 6502 cycle costs of the runtime interpreters (src/puzzle.c,
+# src/render.c). Only meant to rank interactions; update when the engine changes.
+CYC_OP_FETCH = 58  # 3x lvl_rd8 + base advance + switch dispatch
+COND_CYCLES = {
+    C_END: 12,
+    C_TRUE: 0,
+    C_FLAG_SET: 70,
+    C_FLAG_CLR: 70,
+    C_HAS_ITEM: 30 + 22 * 8,  # inventory_has scans all INVENTORY_MAX slots
+    C_VAR_EQ: 45,
+    C_FLAG_SET_W: 96,  # tier select + 16-bit index split
+    C_FLAG_CLR_W: 96,
+    C_VAR_EQ_C: 40,  # fixed-size table, no count check
+}
+ACT_CYCLES = {
+    A_END: 12,
+    A_SHOW_MSG: 820,  # message lookup + cwin_clear of the 40-char textbox; plus CYC_MSG_CHAR per char
+    A_SET_FLAG: 70 + 60,  # + tilestate_flag_changed index lookup (bound cells are queued, drawn by render_update)
+    A_CLR_FLAG: 70 + 60,
+    A_GIVE_ITEM: 30 + 22 * 8 + 40,
+    A_TAKE_ITEM: 22 * 8 + 60,
+    A_SET_VAR: 40,
+    A_SFX: 6,
+    A_TRANSITION: 340,  # room_load_with_spawn: 4 room dir reads; redraw is counted separately
+    A_SET_FLAG_W: 96,
+    A_CLR_FLAG_W: 96,
+    A_SET_VAR_C: 36,
+    A_COMPANION: 30,  # mode store + trail reset
+    A_PARTICLES: 320,  # claim n slots; drawing is paid by particle_update
+    A_DIALOG: 900,  # node header + A_SHOW_MSG; choice conds run on the next Fire
+}
+CYC_MSG_CHAR = 45  # cwin_putat_string_raw per character
+# src/dialog.c: opening a node's choice list tests every choice COND and
+# shows the first pick; choosing closes the textbox before the choice ACT.
+CYC_DIALOG_LIST = 820  # dialog_show_pick: textbox clear + pick marker; plus CYC_MSG_CHAR per char
+CYC_DIALOG_CHOICE = 110  # lvl_dialog_choice_base + COND offset read + shown bit
+CYC_DIALOG_CHOOSE = 260  # choice record reads + textbox_show(0) + dialog_goto
+CYC_REDRAW_SETUP = 120
+CYC_REDRAW_METATILE = 600  # 3 metatile lookups + 4 cwin_putat_char_raw
+REDRAW_MAX_W = 20  # render_room clips to the 40x25 char window
+REDRAW_MAX_H = 12
+# src/platform.c, per moving deck per frame: step + flag test, the 6-cell
+# footprint, up to 2 vacated chars restored from the map and up to 2 cells
+# entering/leaving the collision map. The rider carry is paid once per room.
+CYC_PLATFORM_STEP = 110
+CYC_PLATFORM_CHAR = 70  # render_put_char: screen + color RAM
+CYC_PLATFORM_RESTORE = 260  # render_restore_char: map byte, 2 record lookups, put
+CYC_PLATFORM_COLL = 210  # collision_refresh_cell / collision_mark_deck
+CYC_PLATFORM_MOVE = CYC_PLATFORM_STEP + 6 * CYC_PLATFORM_CHAR + 2 * CYC_PLATFORM_RESTORE + 2 * CYC_PLATFORM_COLL
+CYC_PLATFORM_CARRY = 420  # rider box test + physics_carry side probes
+# src/laser.c, per beam per frame: tick, and on a step frame the table read
+# plus one spr_move per sprite; the hit test is one mask bit at the player's
+# cell. Knockback is paid at most once per LASER_COOLDOWN frames.
+CYC_LASER_TICK = 40
+CYC_LASER_STEP = 90
+CYC_LASER_SPRITE = 120  # spr_move: x lo, msb bit, y
+CYC_LASER_HIT = 110  # cell, cross range compare, mask byte and bit
+# src/entity.c, per scripted NPC per frame: at most NPC_OPS_PER_FRAME ops,
+# of which at most one swaps the sprite image (the swap ends the slice),
+# one spr_move and its share of entity_hit. Independent of how many NPC
+# types the level defines.
+CYC_NPC_OP = CYC_OP_FETCH + 150  # worst plain op: a MOVETO step on both axes
+CYC_NPC_IMAGE = 1150  # 64-byte image copy + spr_color
+CYC_NPC_SPRITE = 120
+CYC_NPC_HIT = 90  # shot row and range compare
+CYC_NPC_FRAME = (NPC_OPS_PER_FRAME - 1) * CYC_NPC_OP + CYC_NPC_IMAGE + CYC_NPC_SPRITE + CYC_NPC_HIT
+
+# PAL frame (63 cycles x 312 lines) minus 25 badlines x 40 cycles.
+FRAME_BUDGET_CYCLES = 63 * 312 - 25 * 40
+
+
+def _script_cycles(sdef: ScriptDef, ops: Dict[str, int], costs: Dict[int, int], level: LevelDef) -> Tuple[int, List[str]]:
+    """Worst case: every op executes (CONDs fail late, ACTs run to the end)."""
+    total = costs[0]
+    transitions: List[str] = []
+    for _line_no, raw in sdef.lines:
+        parts = raw.split()
+        code = ops.get(parts[0].upper()) if parts else None
+        if code is None:
+            continue
+        if code == 0:
+            break
+        wide_ops = COND_WIDE_OPS if ops is COND_OPS else ACT_WIDE_OPS
+        if code in wide_ops and len(parts) > 1 and parts[1] in level.campaign_flags + level.campaign_vars:
+            code = wide_ops[code]  # campaign names never shadow level names (parse error)
+        total += CYC_OP_FETCH + costs[code]
+        if ops is ACT_OPS and code == A_SHOW_MSG and len(parts) > 1:
+            total += CYC_MSG_CHAR * len(level.messages.get(parts[1], ""))
+        if ops is ACT_OPS and code == A_TRANSITION and len(parts) > 1:
+            transitions.append(parts[1])
+    return total, transitions
+
+
+def estimate_cycles(level: LevelDef, errors: ErrorCollector, budget: int = FRAME_BUDGET_CYCLES) -> dict:
+    """
+    Estimate worst-case cycles per COND, per ACT (including the costliest COND guarding
+    it, i.e. one full interaction), per DIALOG frame and per room redraw. Warns once
+    per ACT whose interaction, and once per DIALOG whose choice-list or choose frame,
+    exceeds the frame budget. Room redraws after TRANSITION are reported but not
+    warned about, since a room change always spans several frames.
+    """
+    redraw_tiles = min(level.w, REDRAW_MAX_W) * min(level.h, REDRAW_MAX_H)
+    redraw = CYC_REDRAW_SETUP + redraw_tiles * CYC_REDRAW_METATILE
+    rooms = {rid: redraw for rid in level.rooms}
+
+    conds = {name: _script_cycles(sdef, COND_OPS, COND_CYCLES, level)[0] for name, sdef in level.conds.items()}
+
+    guard: Dict[str, int] = {}
+    for room in level.rooms.values():
+        for obj in room.objects:
+            c = conds.get(obj.cond_name, 0)
+            for name in (obj.look, obj.take, obj.use, obj.talk, obj.operate, obj.alt0, obj.alt1):
+                if name:
+                    guard[name] = max(guard.get(name, 0), c)
+
+    acts: Dict[str, dict] = {}
+    for name, sdef in level.acts.items():
+        cycles, transitions = _script_cycles(sdef, ACT_OPS, ACT_CYCLES, level)
+        interaction = cycles + guard.get(name, 0)
+        entry = {"cycles": cycles, "interaction": interaction}
+        if transitions:
+            entry["with_redraw"] = interaction + max(rooms.get(r, redraw) for r in transitions)
+        acts[name] = entry
+        if interaction > budget:
+            errors.add_warning(
+                f"ACT {name}: ~{interaction} cycles per interaction exceeds frame budget {budget}",
+                line=level.decl_lines.get(("ACT", name)),
+            )
+
+    # Dialogs: a choice list tests every choice COND in one frame; picking a
+    # choice runs its ACT in another. An ACT that opens a dialog reports the
+    # worst frame of every dialog it can lead to (next= and nested DIALOG ops).
+    dialogs: Dict[str, dict] = {}
+    for name, dialog in level.dialogs.items():
+        lists = [0]
+        chooses = [0]
+        for node in dialog.nodes.values():
+            if not node.choices:
+                continue
+            longest = max(len(level.messages.get(ch.msg, "")) for ch in node.choices)
+            lists.append(
+                CYC_DIALOG_LIST
+                + CYC_MSG_CHAR * longest
+                + sum(CYC_DIALOG_CHOICE + conds.get(ch.cond, 0) for ch in node.choices)
+            )
+            chooses += [CYC_DIALOG_CHOOSE + acts[ch.act]["cycles"] for ch in node.choices if ch.act in acts]
+        dialogs[name] = {"choice_list": max(lists), "choose": max(chooses)}
+        worst = max(lists + chooses)
+        if worst > budget:
+            errors.add_warning(
+                f"DIALOG {name}: ~{worst} cycles in one frame exceeds frame budget {budget}",
+                line=dialog.line_no,
+            )
+
+    def opened(sdef: ScriptDef) -> List[str]:
+        lines = (raw.split() for _l, raw in sdef.lines)
+        return [parts[1] for parts in lines if len(parts) > 1 and parts[0].upper() == "DIALOG"]
+
+    for name, sdef in level.acts.items():
+        todo, seen = opened(sdef), set()
+        while todo:
+            d = todo.pop()
+            if d in seen or d not in level.dialogs:
+                continue
+            seen.add(d)
+            for node in level.dialogs[d].nodes.values():
+                todo += [n for ch in node.choices if ch.act in level.acts for n in opened(level.acts[ch.act])]
+        if seen:
+            acts[name]["dialog"] = max(max(dialogs[d].values()) for d in seen)
+
+    # Moving platforms: every deck moving in the same frame is the worst case.
+    platforms = {
+        rid: len(room.platforms) * CYC_PLATFORM_MOVE + CYC_PLATFORM_CARRY
+        for rid, room in level.rooms.items()
+        if room.platforms
+    }
+    for rid, c in platforms.items():
+        if c > budget // 4:
+            errors.add_warning(
+                f"{rid}: ~{c} cycles per frame of moving platforms exceeds a quarter of the frame budget",
+                line=level.rooms[rid].platforms[0].line_no,
+            )
+
+    # Lasers: every beam stepping in the same frame.
+    lasers = {
+        rid: sum(CYC_LASER_TICK + CYC_LASER_STEP + laser.sprites * CYC_LASER_SPRITE + CYC_LASER_HIT for laser in room.lasers)
+        for rid, room in level.rooms.items()
+        if room.lasers
+    }
+
+    # Scripted NPCs: every NPC using its whole slice.
+    npcs = {rid: len(room.npcs) * CYC_NPC_FRAME for rid, room in level.rooms.items() if room.npcs}
+
+    return {
+        "frame_budget": budget,
+        "conds": conds,
+        "acts": acts,
+        "dialogs": dialogs,
+        "room_redraw": rooms,
+        "platforms": platforms,
+        "lasers": lasers,
+        "npcs": npcs,
+    }
+
+
+def state_cost(level: LevelDef, errors: ErrorCollector) -> dict:
+    """
+    RAM and per-access cycles of the two flag/var tiers in src/puzzle.c. The level
+    tier is cleared by puzzle_init; the campaign tier persists across levels.
+    Warns when the level declares more vars than the runtime keeps.
+    """
+    if len(level.vars) > LEVEL_MAX_VARS:
+        errors.add_warning(
+            f"{len(level.vars)} VARs declared; the runtime keeps {LEVEL_MAX_VARS} (move shared ones to the campaign file)",
+            line=level.line_no,
+        )
+
+    def tier(flags: int, vars_: int, max_flags: int, max_vars: int, flag_op: int, var_op: int) -> dict:
+        return {
+            "flags": flags,
+            "vars": vars_,
+            "bytes_used": (flags + 7) // 8 + vars_,
+            "bytes_reserved": max_flags // 8 + max_vars,
+            "cyc_flag": CYC_OP_FETCH + COND_CYCLES[flag_op],
+            "cyc_var": CYC_OP_FETCH + COND_CYCLES[var_op],
+        }
+
+    return {
+        "level": tier(len(level.flags), len(level.vars), LEVEL_MAX_FLAGS, LEVEL_MAX_VARS, C_FLAG_SET, C_VAR_EQ),
+        "campaign": tier(
+            len(level.campaign_flags),
+            len(level.campaign_vars),
+            CAMPAIGN_MAX_FLAGS,
+            CAMPAIGN_MAX_VARS,
+            C_FLAG_SET_W,
+            C_VAR_EQ_C,
+        ),
+    }
+
+
+# ----------------------------
+# C generation helpers
+# ----------------------------
+
+
+def blob_to_c_array(blob: bytes, array_name: str) -> str:
+    # 12 bytes per line is readable
+    lines: List[str] = []
+    lines.append(f"unsigned char {array_name}[] = {{\n")
+    for i in range(0, len(blob), 12):
+        chunk = blob[i : i + 12]
+        hexes = ",".join(f"0x{b:02X}" for b in chunk)
+        lines.append(f"  {hexes},\n")
+    lines.append("};\n")
+    lines.append(f"unsigned long {array_name}_size = (unsigned long)sizeof({array_name});\n")
+    return "".join(lines)
+
+
+def blob_to_c_embed(bin_path: str, array_name: str) -> str:
+    return (
+        f"unsigned char {array_name}[] = {{\n"
+        f"#embed \"{bin_path}\"\n"
+        f"}};\n"
+        f"unsigned long {array_name}_size = (unsigned long)sizeof({array_name});\n"
+    )
+
+
+def make_blob_h(array_name: str) -> str:
+    guard = array_name.upper() + "_H"
+    return (
+        f"#pragma once\n"
+        f"extern unsigned char {array_name}[];\n"
         f"extern unsigned long {array_name}_size;\n"
     )
 
@@ -963,7 +2208,7 @@ def make_format_h() -> str:
 #define LVL_MAGIC_1 'V'
 #define LVL_MAGIC_2 'L'
 #define LVL_MAGIC_3 '1'
-#define LVL_VERSION 1
+#define LVL_VERSION {LEVEL_VERSION}
 
 #define LVL_HEADER_SIZE {HEADER_SIZE}
 #define LVL_ROOM_DIRENTRY_SIZE {ROOM_DIRENTRY_SIZE}
@@ -984,6 +2229,19 @@ def make_format_h() -> str:
 #define LVL_HDR_OFS_CONDSTREAM   {HDR_OFS_CONDSTREAM}
 #define LVL_HDR_OFS_ACTSTREAM    {HDR_OFS_ACTSTREAM}
 #define LVL_HDR_OFS_MSGTABLE     {HDR_OFS_MSGTABLE}
+#define LVL_HDR_OFS_PAGES        {HDR_OFS_PAGES}   /* 0 = unpaged */
+#define LVL_HDR_OFS_STATES       {HDR_OFS_STATES}   /* 0 = no tile states */
+#define LVL_HDR_OFS_LAYERS       {HDR_OFS_LAYERS}   /* 0 = no alternate layer */
+#define LVL_HDR_OFS_WATER        {HDR_OFS_WATER}   /* 0 = no water */
+#define LVL_HDR_OFS_WIND         {HDR_OFS_WIND}   /* 0 = no wind */
+#define LVL_HDR_OFS_COMPANION_ROOM  {HDR_OFS_COMPANION_ROOM}  /* LVL_COMPANION_NONE = no companion */
+#define LVL_HDR_OFS_COMPANION_SPAWN {HDR_OFS_COMPANION_SPAWN}
+#define LVL_HDR_OFS_PLATES       {HDR_OFS_PLATES}   /* 0 = no pressure plates */
+#define LVL_HDR_OFS_ROUTES       {HDR_OFS_ROUTES}   /* 0 = no routing graphs */
+#define LVL_HDR_OFS_PLATFORMS    {HDR_OFS_PLATFORMS}   /* 0 = no moving platforms */
+#define LVL_HDR_OFS_LASERS       {HDR_OFS_LASERS}   /* 0 = no sweeping lasers */
+#define LVL_HDR_OFS_DIALOGS      {HDR_OFS_DIALOGS}   /* 0 = no dialogue graphs */
+#define LVL_HDR_OFS_NPCS         {HDR_OFS_NPCS}   /* 0 = no scripted NPCs */
 
 /* Object record field offsets (byte offsets relative to object record base) */
 #define LVL_OBJ_OFS_X        0
@@ -1008,6 +2266,9 @@ def make_format_h() -> str:
 #define C_FLAG_CLR  {C_FLAG_CLR}
 #define C_HAS_ITEM  {C_HAS_ITEM}
 #define C_VAR_EQ    {C_VAR_EQ}
+#define C_FLAG_SET_W {C_FLAG_SET_W}  /* [op, id lo, id hi] wide flag id */
+#define C_FLAG_CLR_W {C_FLAG_CLR_W}
+#define C_VAR_EQ_C   {C_VAR_EQ_C}  /* [op, campaign var, value] */
 
 /* Action opcodes (bytecode triples [op,a,b]) */
 #define A_END        {A_END}
@@ -1019,6 +2280,29 @@ def make_format_h() -> str:
 #define A_SET_VAR    {A_SET_VAR}
 #define A_SFX        {A_SFX}
 #define A_TRANSITION {A_TRANSITION}
+#define A_SET_FLAG_W {A_SET_FLAG_W}  /* [op, id lo, id hi] wide flag id */
+#define A_CLR_FLAG_W {A_CLR_FLAG_W}
+#define A_SET_VAR_C  {A_SET_VAR_C}  /* [op, campaign var, value] */
+#define A_COMPANION  {A_COMPANION}  /* [op, mode]: 0 = stay, 1 = follow */
+#define A_PARTICLES  {A_PARTICLES}  /* [op, x | kind << 5, y | (n - 1) << 4]: burst at map cell x,y */
+#define A_DIALOG     {A_DIALOG}  /* [op, node lo, node hi]: open a dialog node */
+
+/* NPC behaviour opcodes (bytecode triples [op,a,b]; targets are op indexes) */
+#define N_STOP   {N_STOP}
+#define N_YIELD  {N_YIELD}
+#define N_WAIT   {N_WAIT}  /* [op, frames] */
+#define N_MOVETO {N_MOVETO}  /* [op, x, y]: walk to map cell x,y */
+#define N_FACE   {N_FACE}  /* [op, LVL_NPC_FACE_*] */
+#define N_FIRE   {N_FIRE}  /* [op, range cells, push px] */
+#define N_ANIM   {N_ANIM}  /* [op, image] */
+#define N_IFSET  {N_IFSET}  /* [op, flag, target] */
+#define N_IFCLR  {N_IFCLR}  /* [op, flag, target] */
+#define N_GOTO   {N_GOTO}  /* [op, target] */
+
+/* Wide flag ids: bit 15 selects the campaign tier (persists across levels) */
+#define LVL_FLAG_WIDE_CAMPAIGN  0x{FLAG_WIDE_CAMPAIGN:04X}u
+#define LVL_CAMPAIGN_MAX_FLAGS  {CAMPAIGN_MAX_FLAGS}
+#define LVL_CAMPAIGN_MAX_VARS   {CAMPAIGN_MAX_VARS}
 
 /* Verbs bitmask */
 #define VB_LOOK    (1<<0)
@@ -1095,6 +2379,340 @@ static inline uint8_t lvl_objects_count(const uint8_t* b, uint16_t objsOfs) {{
 static inline uint16_t lvl_object_base(const uint8_t* b, uint16_t objsOfs, uint8_t idx) {{
   return (uint16_t)(objsOfs + 1 + (uint16_t)idx * LVL_OBJ_RECORD_SIZE);
 }}
+
+/* Tile pages (tilesets with more than 256 metatiles): map bytes index the
+   room's page, a list of up to 256 tileset ids.
+   u8 page_count, u8 room_page[room_count], u16 list_ofs[page_count];
+   each list: u16 count, u16 tile_id[count]. */
+static inline uint16_t lvl_pages_ofs(const uint8_t* b) {{
+  return lvl_rd16(b, LVL_HDR_OFS_PAGES);
+}}
+static inline uint8_t lvl_room_page(const uint8_t* b, uint16_t pagesOfs, uint8_t roomId) {{
+  return lvl_rd8(b, (uint16_t)(pagesOfs + 1u + roomId));
+}}
+static inline uint16_t lvl_page_list_ofs(const uint8_t* b, uint16_t pagesOfs, uint8_t page) {{
+  uint16_t table = (uint16_t)(pagesOfs + 1u + lvl_rd8(b, LVL_HDR_OFS_ROOMCOUNT));
+  return lvl_rd16(b, (uint16_t)(table + (uint16_t)page * 2u));
+}}
+
+/* Flag-bound tile states: u8 count, u8 start[flag_count + 1], then records
+   sorted by flag. Records start[f]..start[f+1]-1 belong to flag f; while it
+   is set, cell x,y of room shows tile (a map byte, page-local when paged). */
+#define LVL_STATE_RECORD_SIZE 4
+#define LVL_STATE_OFS_ROOM 0
+#define LVL_STATE_OFS_X    1
+#define LVL_STATE_OFS_Y    2
+#define LVL_STATE_OFS_TILE 3
+
+static inline uint16_t lvl_states_ofs(const uint8_t* b) {{
+  return lvl_rd16(b, LVL_HDR_OFS_STATES);
+}}
+static inline uint8_t lvl_states_count(const uint8_t* b, uint16_t statesOfs) {{
+  return lvl_rd8(b, statesOfs);
+}}
+static inline uint8_t lvl_states_first(const uint8_t* b, uint16_t statesOfs, uint8_t flagId) {{
+  return lvl_rd8(b, (uint16_t)(statesOfs + 1u + flagId));
+}}
+static inline uint16_t lvl_state_base(const uint8_t* b, uint16_t statesOfs, uint8_t index) {{
+  return (uint16_t)(statesOfs + 2u + lvl_rd8(b, LVL_HDR_OFS_FLAGCOUNT) + (uint16_t)index * LVL_STATE_RECORD_SIZE);
+}}
+
+/* Alternate layer (ALTMAP): u8 layer_flag, u16 diff_ofs[room_count]
+   (0 = room identical on both layers); each diff: u8 count, then
+   [x, y, tile] records in row-major order. */
+#define LVL_LAYER_RECORD_SIZE {LAYER_DIFF_RECORD_SIZE}
+
+static inline uint16_t lvl_layers_ofs(const uint8_t* b) {{
+  return lvl_rd16(b, LVL_HDR_OFS_LAYERS);
+}}
+static inline uint8_t lvl_layer_flag(const uint8_t* b, uint16_t layersOfs) {{
+  return lvl_rd8(b, layersOfs);
+}}
+static inline uint16_t lvl_layer_diff_ofs(const uint8_t* b, uint16_t layersOfs, uint8_t roomId) {{
+  return lvl_rd16(b, (uint16_t)(layersOfs + 1u + (uint16_t)roomId * 2u));
+}}
+
+/* Water: u8 var, u8 bg, u8 mc1, u8 mc2, u8 level_count, then
+   u8 line[room_count][level_count]: room pixel y of the surface for each
+   value of var, LVL_WATER_DRY = no water. */
+#define LVL_WATER_DRY 0x{WATER_DRY:02X}
+#define LVL_WATER_OFS_VAR    0
+#define LVL_WATER_OFS_BG     1
+#define LVL_WATER_OFS_MC1    2
+#define LVL_WATER_OFS_MC2    3
+#define LVL_WATER_OFS_LEVELS 4
+#define LVL_WATER_OFS_TABLE  5
+
+static inline uint16_t lvl_water_ofs(const uint8_t* b) {{
+  return lvl_rd16(b, LVL_HDR_OFS_WATER);
+}}
+static inline uint8_t lvl_water_line(const uint8_t* b, uint16_t waterOfs, uint8_t roomId, uint8_t level) {{
+  uint8_t levels = lvl_rd8(b, (uint16_t)(waterOfs + LVL_WATER_OFS_LEVELS));
+  if (level >= levels) {{
+    level = (uint8_t)(levels - 1u);
+  }}
+  return lvl_rd8(b, (uint16_t)(waterOfs + LVL_WATER_OFS_TABLE + (uint16_t)roomId * levels + level));
+}}
+
+/* Wind: u16 room_ofs[room_count] (0 = calm room); each room: int16 vx[4]
+   (8.8 px/frame per force code), u8 map[map_h][(map_w + 3) / 4] with 2 bits
+   per cell (cell x in bits (x & 3) * 2), u8 shield_count, then per shield
+   u8 flag and a mask of the same size (3 = cell in the shielded lane). */
+#define LVL_WIND_NONE   {WIND_NONE}
+#define LVL_WIND_LEFT   {WIND_LEFT}
+#define LVL_WIND_RIGHT  {WIND_RIGHT}
+#define LVL_WIND_STRONG {WIND_STRONG}
+#define LVL_WIND_OFS_MAP 8
+
+static inline uint16_t lvl_wind_ofs(const uint8_t* b) {{
+  return lvl_rd16(b, LVL_HDR_OFS_WIND);
+}}
+static inline uint16_t lvl_wind_room_ofs(const uint8_t* b, uint16_t windOfs, uint8_t roomId) {{
+  return lvl_rd16(b, (uint16_t)(windOfs + (uint16_t)roomId * 2u));
+}}
+
+/* Pressure plates: u8 count, u8 first[room_count + 1], then [x, y, flag]
+   records grouped by room; records first[r]..first[r+1]-1 belong to room r.
+   The flag is set while the player or the companion stands on the cell. */
+#define LVL_COMPANION_NONE 0x{COMPANION_NONE:02X}
+#define LVL_PLATE_RECORD_SIZE {PLATE_RECORD_SIZE}
+#define LVL_PLATE_OFS_X    0
+#define LVL_PLATE_OFS_Y    1
+#define LVL_PLATE_OFS_FLAG 2
+
+static inline uint16_t lvl_plates_ofs(const uint8_t* b) {{
+  return lvl_rd16(b, LVL_HDR_OFS_PLATES);
+}}
+static inline uint8_t lvl_plates_first(const uint8_t* b, uint16_t platesOfs, uint8_t roomId) {{
+  return lvl_rd8(b, (uint16_t)(platesOfs + 1u + roomId));
+}}
+static inline uint16_t lvl_plate_base(const uint8_t* b, uint16_t platesOfs, uint8_t index) {{
+  return (uint16_t)(platesOfs + 2u + lvl_rd8(b, LVL_HDR_OFS_ROOMCOUNT) + (uint16_t)index * LVL_PLATE_RECORD_SIZE);
+}}
+
+/* Moving platforms: u8 count, u8 first[room_count + 1], then [kind, x0, y0,
+   x1, y1, speed, flag] records grouped by room like plates. kind indexes the
+   tileset's platform kinds; the path is in cells along the kind's axis and
+   speed in px/frame. With a flag the deck sits at x1,y1 while it is set and
+   at x0,y0 while it is clear; LVL_PLATFORM_NO_FLAG shuttles end to end. */
+#define LVL_PLATFORM_RECORD_SIZE {PLATFORM_RECORD_SIZE}
+#define LVL_PLATFORM_ROOM_MAX {PLATFORM_ROOM_MAX}
+#define LVL_PLATFORM_NO_FLAG 0x{PLATFORM_NO_FLAG:02X}
+#define LVL_PLATFORM_OFS_KIND  0
+#define LVL_PLATFORM_OFS_X0    1
+#define LVL_PLATFORM_OFS_Y0    2
+#define LVL_PLATFORM_OFS_X1    3
+#define LVL_PLATFORM_OFS_Y1    4
+#define LVL_PLATFORM_OFS_SPEED 5
+#define LVL_PLATFORM_OFS_FLAG  6
+
+static inline uint16_t lvl_platforms_ofs(const uint8_t* b) {{
+  return lvl_rd16(b, LVL_HDR_OFS_PLATFORMS);
+}}
+static inline uint8_t lvl_platforms_first(const uint8_t* b, uint16_t platformsOfs, uint8_t roomId) {{
+  return lvl_rd8(b, (uint16_t)(platformsOfs + 1u + roomId));
+}}
+static inline uint16_t lvl_platform_base(const uint8_t* b, uint16_t platformsOfs, uint8_t index) {{
+  return (uint16_t)(platformsOfs + 2u + lvl_rd8(b, LVL_HDR_OFS_ROOMCOUNT) + (uint16_t)index * LVL_PLATFORM_RECORD_SIZE);
+}}
+
+/* Sweeping lasers: u8 count, u8 first[room_count + 1], then [axis, sprites,
+   color, rate, steps, push, cross_lo, cross_hi, off_flag, u16 steps_ofs]
+   records and their step tables. A step is [x lo, x hi | REVERSE, y] (VIC
+   position of the first beam sprite; the others follow at
+   LVL_LASER_SPRITE_LEN_V/H along the beam) and a 24-bit mask of the cells
+   the beam covers along the sweep: columns for a V beam, rows for an H beam.
+   cross_lo..cross_hi are the cells it covers the other way. */
+#define LVL_LASER_RECORD_SIZE {LASER_RECORD_SIZE}
+#define LVL_LASER_STEP_SIZE {LASER_STEP_SIZE}
+#define LVL_LASER_ROOM_MAX {LASER_ROOM_MAX}
+#define LVL_LASER_SPRITES {LASER_SPRITES}
+#define LVL_LASER_SPRITE_LEN_V {LASER_SPRITE_LEN["V"]}
+#define LVL_LASER_SPRITE_LEN_H {LASER_SPRITE_LEN["H"]}
+#define LVL_LASER_AXIS_V {LASER_AXES["V"]}
+#define LVL_LASER_AXIS_H {LASER_AXES["H"]}
+#define LVL_LASER_REVERSE 0x{LASER_REVERSE:02X}
+#define LVL_LASER_NO_FLAG 0x{LASER_NO_FLAG:02X}
+#define LVL_LASER_OFS_AXIS     0
+#define LVL_LASER_OFS_SPRITES  1
+#define LVL_LASER_OFS_COLOR    2
+#define LVL_LASER_OFS_RATE     3
+#define LVL_LASER_OFS_STEPS    4
+#define LVL_LASER_OFS_PUSH     5
+#define LVL_LASER_OFS_CROSS_LO 6
+#define LVL_LASER_OFS_CROSS_HI 7
+#define LVL_LASER_OFS_FLAG     8
+#define LVL_LASER_OFS_TABLE    9
+#define LVL_LASER_STEP_OFS_XLO  0
+#define LVL_LASER_STEP_OFS_XHI  1
+#define LVL_LASER_STEP_OFS_Y    2
+#define LVL_LASER_STEP_OFS_MASK 3
+
+static inline uint16_t lvl_lasers_ofs(const uint8_t* b) {{
+  return lvl_rd16(b, LVL_HDR_OFS_LASERS);
+}}
+static inline uint8_t lvl_lasers_first(const uint8_t* b, uint16_t lasersOfs, uint8_t roomId) {{
+  return lvl_rd8(b, (uint16_t)(lasersOfs + 1u + roomId));
+}}
+static inline uint16_t lvl_laser_base(const uint8_t* b, uint16_t lasersOfs, uint8_t index) {{
+  return (uint16_t)(lasersOfs + 2u + lvl_rd8(b, LVL_HDR_OFS_ROOMCOUNT) + (uint16_t)index * LVL_LASER_RECORD_SIZE);
+}}
+
+/* Dialogs: u8 dialog_count, then nodes addressed by their offset from the
+   block (A_DIALOG and choice `next`; 0 = end). A node is [msg, choice_count]
+   followed by u16 next when it has no choices, else by choice_count
+   [label msg, u16 cond, u16 act, u16 next] records. cond/act are stream
+   offsets like an object's. */
+#define LVL_DIALOG_CHOICES_MAX {DIALOG_CHOICES_MAX}
+#define LVL_DIALOG_CHOICE_SIZE {DIALOG_CHOICE_SIZE}
+#define LVL_DIALOG_END         {DIALOG_END}
+#define LVL_DIALOG_OFS_MSG     0
+#define LVL_DIALOG_OFS_COUNT   1
+#define LVL_DIALOG_OFS_NEXT    2
+#define LVL_DIALOG_OFS_CHOICES 2
+#define LVL_DIALOG_CHOICE_OFS_MSG  0
+#define LVL_DIALOG_CHOICE_OFS_COND 1
+#define LVL_DIALOG_CHOICE_OFS_ACT  3
+#define LVL_DIALOG_CHOICE_OFS_NEXT 5
+
+static inline uint16_t lvl_dialogs_ofs(const uint8_t* b) {{
+  return lvl_rd16(b, LVL_HDR_OFS_DIALOGS);
+}}
+static inline uint16_t lvl_dialog_choice_base(uint16_t nodeBase, uint8_t index) {{
+  return (uint16_t)(nodeBase + LVL_DIALOG_OFS_CHOICES + (uint16_t)index * LVL_DIALOG_CHOICE_SIZE);
+}}
+
+/* Scripted NPCs: u8 count, u8 first[room_count + 1], then [x, y, image,
+   speed, face, u16 script_ofs] records and the behaviour scripts, one per
+   NPC type. x,y is the spawn cell, image an include/npc_sprites_mc.h index
+   (NPC_*_OFF / 64) and script_ofs the blob offset of op 0. */
+#define LVL_NPC_RECORD_SIZE {NPC_RECORD_SIZE}
+#define LVL_NPC_OP_SIZE     {NPC_OP_SIZE}
+#define LVL_NPC_ROOM_MAX    {NPC_ROOM_MAX}
+#define LVL_NPC_IMAGES      {len(NPC_IMAGES)}
+#define LVL_NPC_FACE_LEFT   {NPC_FACES["LEFT"]}
+#define LVL_NPC_FACE_RIGHT  {NPC_FACES["RIGHT"]}
+#define LVL_NPC_FACE_PLAYER {NPC_FACES["PLAYER"]}
+#define LVL_NPC_OFS_X      0
+#define LVL_NPC_OFS_Y      1
+#define LVL_NPC_OFS_IMAGE  2
+#define LVL_NPC_OFS_SPEED  3
+#define LVL_NPC_OFS_FACE   4
+#define LVL_NPC_OFS_SCRIPT 5
+
+static inline uint16_t lvl_npcs_ofs(const uint8_t* b) {{
+  return lvl_rd16(b, LVL_HDR_OFS_NPCS);
+}}
+static inline uint8_t lvl_npcs_first(const uint8_t* b, uint16_t npcsOfs, uint8_t roomId) {{
+  return lvl_rd8(b, (uint16_t)(npcsOfs + 1u + roomId));
+}}
+static inline uint16_t lvl_npc_base(const uint8_t* b, uint16_t npcsOfs, uint8_t index) {{
+  return (uint16_t)(npcsOfs + 2u + lvl_rd8(b, LVL_HDR_OFS_ROOMCOUNT) + (uint16_t)index * LVL_NPC_RECORD_SIZE);
+}}
+
+/* Routes: u8 route_count, u8 switch_routes[flag_count] (bit r = the flag
+   switches an edge of route r), then per route: u8 node_count, u8 edge_count,
+   u8 reach_count, u8 fixed[node_count] (bit j of fixed[i] = edge i -> j),
+   edge_count [flag, from | INVERT | ONEWAY, to] records and reach_count
+   [from, to, flag] records. REACH flags are derived: set while `to` is
+   reachable from `from`. */
+#define LVL_ROUTE_MAX        {ROUTE_MAX}
+#define LVL_ROUTE_MAX_NODES  {ROUTE_MAX_NODES}
+#define LVL_ROUTE_EDGE_INVERT 0x{ROUTE_EDGE_INVERT:02X}
+#define LVL_ROUTE_EDGE_ONEWAY 0x{ROUTE_EDGE_ONEWAY:02X}
+#define LVL_ROUTE_NODE_MASK   0x07
+#define LVL_ROUTE_RECORD_SIZE 3
+
+static inline uint16_t lvl_routes_ofs(const uint8_t* b) {{
+  return lvl_rd16(b, LVL_HDR_OFS_ROUTES);
+}}
+static inline uint8_t lvl_route_switch_mask(const uint8_t* b, uint16_t routesOfs, uint8_t flagId) {{
+  return lvl_rd8(b, (uint16_t)(routesOfs + 1u + flagId));
+}}
+/* First route record; the next one follows the previous route's reach list. */
+static inline uint16_t lvl_route_first(const uint8_t* b, uint16_t routesOfs) {{
+  return (uint16_t)(routesOfs + 1u + lvl_rd8(b, LVL_HDR_OFS_FLAGCOUNT));
+}}
+static inline uint16_t lvl_route_next(const uint8_t* b, uint16_t routeBase) {{
+  return (uint16_t)(routeBase + 3u + lvl_rd8(b, routeBase) +
+                    (uint16_t)(lvl_rd8(b, (uint16_t)(routeBase + 1u)) + lvl_rd8(b, (uint16_t)(routeBase + 2u))) *
+                        LVL_ROUTE_RECORD_SIZE);
+}}
+
+/* LVL2 segmented container: a resident index; each segment is an LVL1 blob.
+   Segment-local room ids >= the segment's room count are imports (rooms in
+   other segments), resolved through the segment's import list. */
+#define LVL2_MAGIC_3 '2'
+#define LVL2_VERSION 2
+
+#define LVL2_HEADER_SIZE 26
+#define LVL2_SEG_ENTRY_SIZE 8
+#define LVL2_ROOM_ENTRY_SIZE 2
+
+#define LVL2_HDR_OFS_VERSION     4
+#define LVL2_HDR_OFS_MAPW        5
+#define LVL2_HDR_OFS_MAPH        6
+#define LVL2_HDR_OFS_FLAGCOUNT   7
+#define LVL2_HDR_OFS_VARCOUNT    8
+#define LVL2_HDR_OFS_ITEMCOUNT   9
+#define LVL2_HDR_OFS_MSGCOUNT    10
+#define LVL2_HDR_OFS_SEGCOUNT    11
+#define LVL2_HDR_OFS_ROOMCOUNT   12  /* uint16_t */
+#define LVL2_HDR_OFS_STARTROOM   14  /* uint16_t */
+#define LVL2_HDR_OFS_STARTSPAWN  16
+#define LVL2_HDR_OFS_SEGTABLE    18  /* uint16_t */
+#define LVL2_HDR_OFS_ROOMTABLE   20  /* uint16_t */
+#define LVL2_HDR_OFS_NAME        22  /* uint16_t, NUL-terminated disk name prefix */
+
+/* Segment table entry field offsets */
+#define LVL2_SEG_OFS_PACK     0  /* uint24_t offset into the segment pack */
+#define LVL2_SEG_OFS_SIZE     3  /* uint16_t */
+#define LVL2_SEG_OFS_ROOMS    5
+#define LVL2_SEG_OFS_IMPORTS  6  /* uint16_t: u8 count + uint16_t global room ids */
+
+static inline uint8_t lvl2_segment_count(const uint8_t* b) {{
+  return lvl_rd8(b, LVL2_HDR_OFS_SEGCOUNT);
+}}
+static inline uint16_t lvl2_room_count(const uint8_t* b) {{
+  return lvl_rd16(b, LVL2_HDR_OFS_ROOMCOUNT);
+}}
+static inline uint16_t lvl2_start_room(const uint8_t* b) {{
+  return lvl_rd16(b, LVL2_HDR_OFS_STARTROOM);
+}}
+static inline const char* lvl2_name(const uint8_t* b) {{
+  return (const char*)(b + lvl_rd16(b, LVL2_HDR_OFS_NAME));
+}}
+
+static inline uint16_t lvl2_seg_entry_base(const uint8_t* b, uint8_t seg) {{
+  return (uint16_t)(lvl_rd16(b, LVL2_HDR_OFS_SEGTABLE) + (uint16_t)seg * LVL2_SEG_ENTRY_SIZE);
+}}
+static inline uint32_t lvl2_segment_pack_ofs(const uint8_t* b, uint8_t seg) {{
+  uint16_t e = lvl2_seg_entry_base(b, seg);
+  return (uint32_t)lvl_rd16(b, e + LVL2_SEG_OFS_PACK) | ((uint32_t)lvl_rd8(b, e + LVL2_SEG_OFS_PACK + 2) << 16);
+}}
+static inline uint16_t lvl2_segment_size(const uint8_t* b, uint8_t seg) {{
+  return lvl_rd16(b, lvl2_seg_entry_base(b, seg) + LVL2_SEG_OFS_SIZE);
+}}
+static inline uint8_t lvl2_segment_room_count(const uint8_t* b, uint8_t seg) {{
+  return lvl_rd8(b, lvl2_seg_entry_base(b, seg) + LVL2_SEG_OFS_ROOMS);
+}}
+static inline uint8_t lvl2_segment_import_count(const uint8_t* b, uint8_t seg) {{
+  return lvl_rd8(b, lvl_rd16(b, lvl2_seg_entry_base(b, seg) + LVL2_SEG_OFS_IMPORTS));
+}}
+static inline uint16_t lvl2_segment_import(const uint8_t* b, uint8_t seg, uint8_t idx) {{
+  uint16_t list = lvl_rd16(b, lvl2_seg_entry_base(b, seg) + LVL2_SEG_OFS_IMPORTS);
+  return lvl_rd16(b, (uint16_t)(list + 1 + (uint16_t)idx * 2));
+}}
+
+static inline uint16_t lvl2_room_entry_base(const uint8_t* b, uint16_t room) {{
+  return (uint16_t)(lvl_rd16(b, LVL2_HDR_OFS_ROOMTABLE) + room * LVL2_ROOM_ENTRY_SIZE);
+}}
+static inline uint8_t lvl2_room_segment(const uint8_t* b, uint16_t room) {{
+  return lvl_rd8(b, lvl2_room_entry_base(b, room) + 0);
+}}
+static inline uint8_t lvl2_room_local(const uint8_t* b, uint16_t room) {{
+  return lvl_rd8(b, lvl2_room_entry_base(b, room) + 1);
+}}
 """
 
 
@@ -1117,7 +2735,61 @@ def make_c_identifier(name: str) -> str:
 # ----------------------------
 
 
-def write_sym(path: str, level: LevelDef, debug: dict) -> None:
+def _write_sym_analysis(f, debug: dict) -> None:
+    # Cycle estimates
+    cyc = debug.get("cycles")
+    if cyc:
+        budget = cyc["frame_budget"]
+        f.write(f"CYCLES frame_budget={budget}\n")
+        for rid, c in cyc["room_redraw"].items():
+            f.write(f"  REDRAW {rid} ~{c} ({c / budget:.1f} frames)\n")
+        for rid, c in cyc.get("platforms", {}).items():
+            f.write(f"  PLATFORMS {rid} ~{c} per frame ({100.0 * c / budget:.0f}% of the frame)\n")
+        for rid, c in cyc.get("lasers", {}).items():
+            f.write(f"  LASERS {rid} ~{c} per frame ({100.0 * c / budget:.0f}% of the frame)\n")
+        for rid, c in cyc.get("npcs", {}).items():
+            f.write(f"  NPCS {rid} ~{c} per frame ({100.0 * c / budget:.0f}% of the frame)\n")
+        for name, c in cyc["conds"].items():
+            f.write(f"  COND {name} ~{c}\n")
+        for name, a in cyc["acts"].items():
+            line = f'  ACT {name} ~{a["cycles"]} interaction=~{a["interaction"]}'
+            if "with_redraw" in a:
+                line += f' with_redraw=~{a["with_redraw"]}'
+            if "dialog" in a:
+                line += f' dialog=~{a["dialog"]}'
+            if a["interaction"] > budget:
+                line += " OVER_BUDGET"
+            f.write(line + "\n")
+        for name, d in cyc.get("dialogs", {}).items():
+            line = f'  DIALOG {name} choice_list=~{d["choice_list"]} choose=~{d["choose"]}'
+            if max(d.values()) > budget:
+                line += " OVER_BUDGET"
+            f.write(line + "\n")
+        f.write("\n")
+
+    # Flag/var tiers
+    state = debug.get("state")
+    if state:
+        f.write("STATE\n")
+        for name, t in state.items():
+            f.write(
+                f'  {name.upper()} flags={t["flags"]} vars={t["vars"]} '
+                f'bytes={t["bytes_used"]}/{t["bytes_reserved"]} '
+                f'cyc_flag=~{t["cyc_flag"]} cyc_var=~{t["cyc_var"]}\n'
+            )
+        f.write("\n")
+
+    # Dead-data elimination
+    dead = debug.get("dead_data")
+    if dead:
+        f.write(f'DEADDATA bytes_saved={dead["bytes_saved"]}\n')
+        for kind, names in dead["removed"].items():
+            if names:
+                f.write(f'  {kind.upper()} {",".join(names)}\n')
+        f.write("\n")
+
+
+def write_sym(path: str, level: LevelDef, debug: dict, mode: str = "w") -> None:
     def verb_str(mask: int) -> str:
         parts = []
         for n, b in [
@@ -1131,21 +2803,45 @@ def write_sym(path: str, level: LevelDef, debug: dict) -> None:
                 parts.append(n)
         return "|".join(parts) if parts else "NONE"
 
-    with open(path, "w", encoding="utf-8") as f:
+    with open(path, mode, encoding="utf-8") as f:
         f.write(f'LEVEL name="{level.name}" blob_size={debug["blob_size"]}\n')
         f.write(
             "HDR "
             f'room_dir={debug["offsets"]["room_dir"]} '
             f'cond_stream={debug["offsets"]["cond_stream"]} '
             f'act_stream={debug["offsets"]["act_stream"]} '
-            f'msg_table={debug["offsets"]["msg_table"]}\n'
+            f'msg_table={debug["offsets"]["msg_table"]} '
+            f'pages={debug["offsets"]["pages"]} '
+            f'states={debug["offsets"]["states"]} '
+            f'layers={debug["offsets"]["layers"]} '
+            f'water={debug["offsets"]["water"]} '
+            f'wind={debug["offsets"]["wind"]} '
+            f'plates={debug["offsets"]["plates"]} '
+            f'routes={debug["offsets"]["routes"]} '
+            f'platforms={debug["offsets"]["platforms"]} '
+            f'lasers={debug["offsets"]["lasers"]} '
+            f'dialogs={debug["offsets"]["dialogs"]} '
+            f'npcs={debug["offsets"]["npcs"]}\n'
         )
+        for name, node_ofs in debug.get("dialogs", {}).items():
+            f.write(f"DIALOG {name} node={node_ofs}\n")
+        for name, npc in debug.get("npcs", {}).items():
+            f.write(f'NPC {name} script={npc["script"]} ops={npc["ops"]}\n')
+        for name, route in debug.get("routes", {}).items():
+            f.write(
+                f'ROUTE {name} nodes={",".join(route["nodes"])} edges={route["edges"]} '
+                f'reach={",".join(route["reach"]) or "-"}\n'
+            )
+        for p_idx, page in enumerate(debug["pages"]):
+            f.write(f"PAGE[{p_idx}] tiles={len(page)} ids={page[0]}..{page[-1]}\n")
         f.write("\n")
 
         # Rooms
         for r_idx, r in enumerate(debug["room_sym"]):
             f.write(f'ROOM[{r_idx}] id={r["rid"]} name="{r["name"]}"\n')
-            f.write(f'  MAP ofs={r["ofs_map"]} size={r["map_size"]}\n')
+            page = f' page={r["page"]}' if "page" in r else ""
+            layer = f' layer_diff={r["layer_diff"]}' if "layer_diff" in r else ""
+            f.write(f'  MAP ofs={r["ofs_map"]} size={r["map_size"]}{page}{layer}\n')
             f.write(
                 f'  SPAWNS ofs={r["ofs_spawns"]} count={len(r["spawn_keys"])} keys={",".join(r["spawn_keys"])}\n'
             )
@@ -1173,6 +2869,21 @@ def write_sym(path: str, level: LevelDef, debug: dict) -> None:
                     f'alt0={o["alt0"]}@{o["ofs_alt0"]} '
                     f'alt1={o["alt1"]}@{o["ofs_alt1"]}\n'
                 )
+            if "wind" in r:
+                f.write(f'  WIND lanes={r["wind"]["lanes"]} shields={",".join(r["wind"]["shields"]) or "-"}\n')
+            for st in r.get("states", []):
+                f.write(f'  STATE {st["x"]},{st["y"]} flag={st["flag"]} tile={st["tile"]}\n')
+            for pl in r.get("plates", []):
+                f.write(f'  PLATE {pl["x"]},{pl["y"]} flag={pl["flag"]}\n')
+            for pf in r.get("platforms", []):
+                f.write(f'  PLATFORM {pf["kind"]} {pf["path"]} speed={pf["speed"]} flag={pf["flag"]}\n')
+            for ls in r.get("lasers", []):
+                f.write(
+                    f'  LASER {ls["axis"]} {ls["path"]} cross={ls["cross"]} steps={ls["steps"]} rate={ls["rate"]} '
+                    f'sprites={ls["sprites"]} off={ls["off"]}\n'
+                )
+            for npc in r.get("npcs", []):
+                f.write(f'  NPC {npc["kind"]} {npc["at"]} image={npc["image"]} speed={npc["speed"]} face={npc["face"]}\n')
             f.write("\n")
 
         # Scripts
@@ -1183,6 +2894,8 @@ def write_sym(path: str, level: LevelDef, debug: dict) -> None:
             f.write(f"  ACT@{ofs} {name}\n")
         f.write("\n")
 
+        _write_sym_analysis(f, debug)
+
         # Messages
         f.write("MESSAGES\n")
         msg_names = debug.get("msg_names", [])
@@ -1196,16 +2909,294 @@ def write_sym(path: str, level: LevelDef, debug: dict) -> None:
 # ----------------------------
 
 
-def compile_level(level: LevelDef, errors: ErrorCollector) -> Tuple[Optional[bytes], str, dict]:
+def _compile_map(
+    level: LevelDef, rid: str, room_line_no: int, map_lines: List[Tuple[int, str]], errors: ErrorCollector, label: str
+) -> List[int]:
+    """Resolve MAP (or ALTMAP) rows to w*h tileset ids, expanding object stamps."""
+    if len(map_lines) != level.h:
+        errors.add_error(
+            f"{rid}: {label} has {len(map_lines)} lines, expected {level.h}",
+            line=room_line_no,
+        )
+    map_tiles: List[int] = []
+    grid: List[List[str]] = []
+    line_nos: List[int] = []
+    for y, (map_line_no, row) in enumerate(map_lines):
+        if len(row) != level.w:
+            errors.add_error(
+                f"{rid}: {label} line {y} length {len(row)}, expected {level.w}",
+                line=map_line_no,
+            )
+            continue
+        grid.append(list(row))
+        line_nos.append(map_line_no)
+
+    tile_grid: List[List[Optional[int]]] = [[None for _ in range(level.w)] for _ in range(level.h)]
+    object_stamps = level.object_stamps or {}
+
+    for y in range(level.h):
+        if y >= len(grid):
+            continue
+        for x in range(level.w):
+            if tile_grid[y][x] is not None:
+                continue
+            ch = grid[y][x]
+            if ch in object_stamps:
+                spec = object_stamps[ch]
+                ow = spec["w"]
+                oh = spec["h"]
+                if ch in level.tiles:
+                    errors.add_error(
+                        f"{rid}: {label} char '{ch}' is both a tile and an object stamp",
+                        line=line_nos[y],
+                    )
+                if x + ow > level.w or y + oh > level.h:
+                    errors.add_error(
+                        f"{rid}: OBJECT stamp '{ch}' out of bounds at {x},{y}",
+                        line=line_nos[y],
+                    )
+                    continue
+                # Validate block and fill
+                for dy in range(oh):
+                    for dx in range(ow):
+                        ty = y + dy
+                        tx = x + dx
+                        if ty >= len(grid):
+                            continue
+                        if grid[ty][tx] != ch:
+                            errors.add_error(
+                                f"{rid}: OBJECT stamp '{ch}' is not a solid {ow}x{oh} block at {x},{y}",
+                                line=line_nos[ty],
+                            )
+                tiles = spec["tiles"]
+                for dy in range(oh):
+                    for dx in range(ow):
+                        ty = y + dy
+                        tx = x + dx
+                        if ty >= level.h or tx >= level.w:
+                            continue
+                        if tile_grid[ty][tx] is not None:
+                            errors.add_error(
+                                f"{rid}: OBJECT stamp '{ch}' overlaps another tile at {tx},{ty}",
+                                line=line_nos[ty],
+                            )
+                            continue
+                        tile_grid[ty][tx] = tiles[dy * ow + dx]
+                continue
+
+            if ch not in level.tiles:
+                errors.add_error(
+                    f"{rid}: {label} uses char '{ch}' with no TILES mapping",
+                    line=line_nos[y] if y < len(line_nos) else room_line_no,
+                )
+                tile_grid[y][x] = 0
+            else:
+                tile_grid[y][x] = level.tiles[ch]
+
+    for y in range(level.h):
+        for x in range(level.w):
+            tid = tile_grid[y][x]
+            if tid is None:
+                errors.add_error(
+                    f"{rid}: {label} unresolved tile at {x},{y}",
+                    line=line_nos[y] if y < len(line_nos) else room_line_no,
+                )
+                tid = 0
+            map_tiles.append(tid)
+
+    return map_tiles
+
+
+def _layout_dialogs(dialogs: List[DialogDef]) -> Dict[Tuple[str, str], int]:
+    """Offset of every (dialog, node) in the dialog block; sizes don't depend on the scripts."""
+    ofs = 1
+    nodes: Dict[Tuple[str, str], int] = {}
+    for dialog in dialogs:
+        for node in dialog.nodes.values():
+            nodes[(dialog.name, node.name)] = ofs
+            ofs += 2 + (len(node.choices) * DIALOG_CHOICE_SIZE if node.choices else 2)
+    return nodes
+
+
+def _compile_dialogs(
+    level: LevelDef,
+    dialogs: List[DialogDef],
+    nodes: Dict[Tuple[str, str], int],
+    blob: bytearray,
+    msg_ids: Dict[str, int],
+    cond_offset,
+    act_offset,
+    errors: ErrorCollector,
+) -> int:
+    """Append the dialog block to `blob`; returns its offset."""
+    def node_ofs(dialog: DialogDef, name: str, line_no: int) -> int:
+        if not name:
+            return DIALOG_END
+        if (dialog.name, name) not in nodes:
+            errors.add_error(f"DIALOG {dialog.name}: unknown NODE {name}", line=line_no)
+            return DIALOG_END
+        return nodes[(dialog.name, name)]
+
+    def transitions(act: str) -> bool:
+        sdef = level.acts.get(act)
+        return bool(sdef) and any(raw.split()[0].upper() == "TRANSITION" for _l, raw in sdef.lines)
+
+    ofs = len(blob)
+    blob.append(len(dialogs) & 0xFF)
+    for dialog in dialogs:
+        for node in dialog.nodes.values():
+            blob += bytes([_resolve_id(node.msg, msg_ids, "MSG", errors, node.line_no) & 0xFF, len(node.choices)])
+            if not node.choices:
+                blob += struct.pack("<H", node_ofs(dialog, node.next, node.line_no))
+                continue
+            if node.next:
+                errors.add_error(f"NODE {node.name}: next= is for nodes without CHOICEs", line=node.line_no)
+            for ch in node.choices:
+                # A TRANSITION may load another segment, so the node after it could be gone.
+                if ch.next and ch.act and transitions(ch.act):
+                    errors.add_error(f"CHOICE {ch.msg}: ACT {ch.act} has a TRANSITION, so it must end the dialog (no next=)", line=ch.line_no)
+                blob.append(_resolve_id(ch.msg, msg_ids, "MSG", errors, ch.line_no) & 0xFF)
+                blob += struct.pack(
+                    "<HHH",
+                    cond_offset(ch.cond, ch.line_no),
+                    act_offset(ch.act, ch.line_no),
+                    node_ofs(dialog, ch.next, ch.line_no),
+                )
+    return ofs
+
+
+def _compile_routes(
+    level: LevelDef,
+    blob: bytearray,
+    flag_ids: Dict[str, int],
+    campaign_flag_ids: Dict[str, int],
+    errors: ErrorCollector,
+) -> int:
+    """Append the routes block to `blob`; returns its offset."""
+    routes = list(level.routes.values())
+    if len(routes) > ROUTE_MAX:
+        errors.add_error(f"Too many ROUTEs: {len(routes)} (max {ROUTE_MAX})", line=routes[ROUTE_MAX].line_no)
+        routes = routes[:ROUTE_MAX]
+
+    def level_flag(name: str, what: str, line_no: int) -> Optional[int]:
+        if name in campaign_flag_ids:
+            errors.add_error(f"ROUTE {what} {name} is a campaign flag (only level flags)", line=line_no)
+            return None
+        if name not in flag_ids:
+            errors.add_error(f"ROUTE {what} unknown FLAG {name}", line=line_no)
+            return None
+        return flag_ids[name]
+
+    # Derived flags belong to the router: scripts and other bindings may only read them.
+    derived: Dict[str, int] = {}
+    for route in routes:
+        for _src, _dst, flag, line_no in route.reaches:
+            if flag in derived:
+                errors.add_error(f"ROUTE REACH flag {flag} already derived on line {derived[flag]}", line=line_no)
+            derived[flag] = line_no
+    for sdef in level.acts.values():
+        for line_no, raw in sdef.lines:
+            parts = raw.split()
+            if len(parts) > 1 and parts[0].upper() in ("SETFLAG", "CLRFLAG") and parts[1] in derived:
+                errors.add_error(f"ACT {sdef.name} writes {parts[1]}, which ROUTE REACH derives", line=line_no)
+    for room in level.rooms.values():
+        for plate in room.plates:
+            if plate.flag in derived:
+                errors.add_error(f"PLATES flag {plate.flag} is derived by ROUTE REACH", line=plate.line_no)
+
+    switch_mask = [0] * len(level.flags)
+    body = bytearray()
+    for r_idx, route in enumerate(routes):
+        node_ids = {n: i for i, n in enumerate(route.nodes)}
+        if not route.nodes or len(route.nodes) > ROUTE_MAX_NODES or len(node_ids) != len(route.nodes):
+            errors.add_error(
+                f"ROUTE {route.name} needs 1..{ROUTE_MAX_NODES} distinct NODES (has {len(route.nodes)})", line=route.line_no
+            )
+        if len(route.edges) > ROUTE_MAX_EDGES:
+            errors.add_error(f"ROUTE {route.name} has {len(route.edges)} EDGEs (max {ROUTE_MAX_EDGES})", line=route.line_no)
+
+        def node(name: str, line_no: int) -> Optional[int]:
+            if name not in node_ids:
+                errors.add_error(f"ROUTE {route.name} unknown node {name}", line=line_no)
+                return None
+            return node_ids[name]
+
+        fixed = [0] * len(route.nodes)
+        switched: List[Tuple[int, int, int]] = []
+        # Each directed pair has one owner, so a switch can flip its bits without a rebuild.
+        owner: Dict[Tuple[int, int], int] = {}
+        for src, dst, oneway, switch, line_no in route.edges:
+            a, b = node(src, line_no), node(dst, line_no)
+            if a is None or b is None:
+                continue
+            pairs = [(a, b)] if oneway else [(a, b), (b, a)]
+            clash = next((owner[pair] for pair in pairs if pair in owner), None)
+            if a == b:
+                errors.add_error(f"ROUTE {route.name} edge {src}-{dst} loops on one node", line=line_no)
+                continue
+            if clash is not None:
+                errors.add_error(f"ROUTE {route.name} edge {src}-{dst} duplicates line {clash}", line=line_no)
+                continue
+            owner.update({pair: line_no for pair in pairs})
+            if not switch:
+                fixed[a] |= 1 << b
+                if not oneway:
+                    fixed[b] |= 1 << a
+                continue
+            invert = switch.startswith("!")
+            fid = level_flag(switch.lstrip("!"), "switch", line_no)
+            if fid is None:
+                continue
+            if switch.lstrip("!") in derived:
+                errors.add_error(f"ROUTE switch {switch.lstrip('!')} is a REACH flag (no chained routes)", line=line_no)
+                continue
+            switch_mask[fid] |= 1 << r_idx
+            switched.append(
+                (fid, a | (ROUTE_EDGE_INVERT if invert else 0) | (ROUTE_EDGE_ONEWAY if oneway else 0), b)
+            )
+        reaches: List[Tuple[int, int, int]] = []
+        for src, dst, flag, line_no in route.reaches:
+            a, b, fid = node(src, line_no), node(dst, line_no), level_flag(flag, "REACH", line_no)
+            if a is not None and b is not None and fid is not None:
+                reaches.append((a, b, fid))
+        body += bytes([len(route.nodes) & 0xFF, len(switched) & 0xFF, len(reaches) & 0xFF])
+        body += bytes(fixed)
+        for rec in switched + reaches:
+            body += bytes(rec)
+
+    ofs = len(blob)
+    blob.append(len(routes) & 0xFF)
+    blob += bytes(switch_mask)
+    blob += body
+    return ofs
+
+
+def compile_level(
+    level: LevelDef, errors: ErrorCollector, segment: Optional[SegmentPlan] = None
+) -> Tuple[Optional[bytes], str, dict]:
+    """
+    Compile a whole level into one LVL1 blob, or, with `segment`, only that segment's
+    rooms. Segment blobs keep global flag/var/item/message ids; rooms in other
+    segments get local ids after the segment's own rooms (resolved via the LVL2 index).
+    """
     # IDs in file order
     flag_ids = {n: i for i, n in enumerate(level.flags)}
     var_ids = {n: i for i, n in enumerate(level.vars)}
     item_ids = {n: i for i, n in enumerate(level.items)}
     msg_names = list(level.messages.keys())
     msg_ids = {n: i for i, n in enumerate(msg_names)}
+    campaign_flag_ids = {n: i for i, n in enumerate(level.campaign_flags)}
+    campaign_var_ids = {n: i for i, n in enumerate(level.campaign_vars)}
 
-    room_names = list(level.rooms.keys())
-    room_ids = {rid: i for i, rid in enumerate(room_names)}
+    if segment is None:
+        room_names = list(level.rooms.keys())
+        room_ids = {rid: i for i, rid in enumerate(room_names)}
+    else:
+        room_names = list(segment.rooms)
+        room_ids = {rid: i for i, rid in enumerate(segment.rooms + segment.imports)}
+
+    def in_segment(kind: str, name: str) -> bool:
+        return segment is None or (kind, name) in segment.live
 
     # Spawn index per room (order in file)
     spawn_ids_by_room: Dict[str, Dict[str, int]] = {}
@@ -1216,8 +3207,17 @@ def compile_level(level: LevelDef, errors: ErrorCollector) -> Tuple[Optional[byt
     cond_stream = bytearray()
     cond_ofs: Dict[str, int] = {}
     for name, sdef in level.conds.items():
+        if not in_segment("COND", name):
+            continue
         cond_ofs[name] = len(cond_stream)
-        cond_stream += compile_cond_script(sdef.lines, flag_ids, var_ids, item_ids, errors)
+        cond_stream += compile_cond_script(
+            sdef.lines, flag_ids, var_ids, item_ids, errors, campaign_flag_ids, campaign_var_ids
+        )
+
+    # Dialog node offsets come first: ACTs name dialogs and choices name ACTs.
+    dialogs = [d for name, d in level.dialogs.items() if in_segment("DIALOG", name)]
+    dialog_nodes = _layout_dialogs(dialogs)
+    dialog_ofs = {d.name: dialog_nodes[(d.name, next(iter(d.nodes)))] for d in dialogs if d.nodes}
 
     act_stream = bytearray()
     act_ofs: Dict[str, int] = {}
@@ -1227,6 +3227,8 @@ def compile_level(level: LevelDef, errors: ErrorCollector) -> Tuple[Optional[byt
     act_stream += bytes([A_END, 0, 0])
 
     for name, sdef in level.acts.items():
+        if not in_segment("ACT", name):
+            continue
         act_ofs[name] = len(act_stream)
         act_stream += compile_act_script(
             sdef.lines,
@@ -1237,6 +3239,10 @@ def compile_level(level: LevelDef, errors: ErrorCollector) -> Tuple[Optional[byt
             room_ids,
             spawn_ids_by_room,
             errors,
+            campaign_flag_ids,
+            campaign_var_ids,
+            {name: k for k, name in enumerate(level.particle_kinds)},
+            dialog_ofs,
         )
 
     def act_offset(name: str, line_no: Optional[int] = None) -> int:
@@ -1260,11 +3266,14 @@ def compile_level(level: LevelDef, errors: ErrorCollector) -> Tuple[Optional[byt
 
     # Room directory placeholder
     room_dir_ofs = len(blob)
-    room_count = len(level.rooms)
+    room_count = len(room_names)
     blob += b"\x00" * (room_count * ROOM_DIRENTRY_SIZE)
 
     room_dir_entries: List[Tuple[int, int, int, int]] = []
     room_sym: List[dict] = []
+    room_maps: List[Tuple[int, List[int]]] = []
+    states: List[Tuple[int, int, int, int, int]] = []  # (flag id, room index, x, y, tileset id)
+    layer_diffs: List[List[Tuple[int, int, int]]] = []  # per room: (x, y, tileset id) where ALTMAP differs
 
     for rid in room_names:
         room = level.rooms[rid]
@@ -1283,100 +3292,29 @@ def compile_level(level: LevelDef, errors: ErrorCollector) -> Tuple[Optional[byt
         }
 
         # Map
-        if len(room.map_lines) != level.h:
-            errors.add_error(
-                f"{rid}: MAP has {len(room.map_lines)} lines, expected {level.h}",
-                line=room.line_no,
-            )
-        map_bytes = bytearray()
-        grid: List[List[str]] = []
-        line_nos: List[int] = []
-        for y, (map_line_no, row) in enumerate(room.map_lines):
-            if len(row) != level.w:
-                errors.add_error(
-                    f"{rid}: MAP line {y} length {len(row)}, expected {level.w}",
-                    line=map_line_no,
-                )
-                continue
-            grid.append(list(row))
-            line_nos.append(map_line_no)
-
-        tile_grid: List[List[Optional[int]]] = [[None for _ in range(level.w)] for _ in range(level.h)]
-        object_stamps = level.object_stamps or {}
-
-        for y in range(level.h):
-            if y >= len(grid):
-                continue
-            for x in range(level.w):
-                if tile_grid[y][x] is not None:
-                    continue
-                ch = grid[y][x]
-                if ch in object_stamps:
-                    spec = object_stamps[ch]
-                    ow = spec["w"]
-                    oh = spec["h"]
-                    if ch in level.tiles:
-                        errors.add_error(
-                            f"{rid}: MAP char '{ch}' is both a tile and an object stamp",
-                            line=line_nos[y],
-                        )
-                    if x + ow > level.w or y + oh > level.h:
-                        errors.add_error(
-                            f"{rid}: OBJECT stamp '{ch}' out of bounds at {x},{y}",
-                            line=line_nos[y],
-                        )
-                        continue
-                    # Validate block and fill
-                    for dy in range(oh):
-                        for dx in range(ow):
-                            ty = y + dy
-                            tx = x + dx
-                            if ty >= len(grid):
-                                continue
-                            if grid[ty][tx] != ch:
-                                errors.add_error(
-                                    f"{rid}: OBJECT stamp '{ch}' is not a solid {ow}x{oh} block at {x},{y}",
-                                    line=line_nos[ty],
-                                )
-                    tiles = spec["tiles"]
-                    for dy in range(oh):
-                        for dx in range(ow):
-                            ty = y + dy
-                            tx = x + dx
-                            if ty >= level.h or tx >= level.w:
-                                continue
-                            if tile_grid[ty][tx] is not None:
-                                errors.add_error(
-                                    f"{rid}: OBJECT stamp '{ch}' overlaps another tile at {tx},{ty}",
-                                    line=line_nos[ty],
-                                )
-                                continue
-                            tile_grid[ty][tx] = tiles[dy * ow + dx]
-                    continue
-
-                if ch not in level.tiles:
-                    errors.add_error(
-                        f"{rid}: MAP uses char '{ch}' with no TILES mapping",
-                        line=line_nos[y] if y < len(line_nos) else room.line_no,
-                    )
-                    tile_grid[y][x] = 0
-                else:
-                    tile_grid[y][x] = level.tiles[ch] & 0xFF
-
-        for y in range(level.h):
-            for x in range(level.w):
-                tid = tile_grid[y][x]
-                if tid is None:
-                    errors.add_error(
-                        f"{rid}: MAP unresolved tile at {x},{y}",
-                        line=line_nos[y] if y < len(line_nos) else room.line_no,
-                    )
-                    tid = 0
-                map_bytes.append(tid & 0xFF)
-
+        map_tiles = _compile_map(level, rid, room.line_no, room.map_lines, errors, "MAP")
+        map_bytes = bytes(tid & 0xFF for tid in map_tiles)  # rewritten to page-local ids if the level is paged
         ofs_map = len(blob)
         room_sym_entry["ofs_map"] = ofs_map
         blob += map_bytes
+        room_maps.append((ofs_map, map_tiles))
+
+        # Alternate layer: only the cells that differ are stored
+        diff: List[Tuple[int, int, int]] = []
+        if room.alt_lines:
+            alt_tiles = _compile_map(level, rid, room.line_no, room.alt_lines, errors, "ALTMAP")
+            for i, (base, alt) in enumerate(zip(map_tiles, alt_tiles)):
+                if base != alt:
+                    diff.append((i % level.w, i // level.w, alt))
+            if not level.layer_flag:
+                errors.add_error(f"{rid}: ALTMAP needs LEVEL layer=<FLAG>", line=room.alt_lines[0][0])
+            if level.w * level.h > ROOM_CELLS_MAX:
+                errors.add_error(
+                    f"{rid}: ALTMAP needs a map of at most {ROOM_CELLS_MAX} cells (level is {level.w}x{level.h})",
+                    line=room.line_no,
+                )
+            room_sym_entry["layer_diff"] = len(diff)
+        layer_diffs.append(diff)
 
         # Spawns
         ofs_spawns = len(blob)
@@ -1464,6 +3402,13 @@ def compile_level(level: LevelDef, errors: ErrorCollector) -> Tuple[Optional[byt
                     except ValueError:
                         errors.add_error(f"{rid}: invalid breaker expect value: {obj.props['expect']}", line=obj.line_no)
 
+            # HATCH_PANEL fuse_item=ITEM -> p0=itemId; badge_item=ITEM -> p1=itemId (engine routes USE by item)
+            if obj.type_name == "HATCH_PANEL":
+                if "fuse_item" in obj.props:
+                    p0 = _resolve_id(obj.props["fuse_item"], item_ids, "ITEM", errors, obj.line_no) & 0xFF
+                if "badge_item" in obj.props:
+                    p1 = _resolve_id(obj.props["badge_item"], item_ids, "ITEM", errors, obj.line_no) & 0xFF
+
             ofs_conds = cond_offset(obj.cond_name, obj.line_no)
 
             ofs_look = act_offset(obj.look, obj.line_no)
@@ -1517,6 +3462,52 @@ def compile_level(level: LevelDef, errors: ErrorCollector) -> Tuple[Optional[byt
                 }
             )
 
+        # Flag-bound tile states (emitted after the pages so tile ids can be page-local)
+        room_sym_entry["states"] = []
+        bound: Dict[Tuple[int, int], int] = {}
+        for st in room.states:
+            if "," in st.target:
+                try:
+                    sx, sy = (int(v) for v in st.target.split(","))
+                except ValueError:
+                    errors.add_error(f"{rid}: STATES bad position {st.target}", line=st.line_no)
+                    continue
+            else:
+                obj = next((o for o in room.objects if o.name == st.target), None)
+                if obj is None:
+                    errors.add_error(f"{rid}: STATES unknown object {st.target}", line=st.line_no)
+                    continue
+                sx, sy = obj.x, obj.y
+            if not (0 <= sx < level.w and 0 <= sy < level.h):
+                errors.add_error(f"{rid}: STATES cell {sx},{sy} outside the map", line=st.line_no)
+                continue
+            if st.flag in campaign_flag_ids:
+                errors.add_error(
+                    f"{rid}: STATES flag {st.flag} is a campaign flag (only level flags are indexed)",
+                    line=st.line_no,
+                )
+                continue
+            if st.flag not in flag_ids:
+                errors.add_error(f"{rid}: STATES unknown FLAG {st.flag}", line=st.line_no)
+                continue
+            if (sx, sy) in bound:
+                # One binding per cell: room_reset_cell restores the MAP/ALTMAP tile when a
+                # flag clears, so a second binding would win or lose by clearing order.
+                errors.add_error(
+                    f"{rid}: STATES cell {sx},{sy} already bound on line {bound[(sx, sy)]}",
+                    line=st.line_no,
+                )
+                continue
+            bound[(sx, sy)] = st.line_no
+            tid = st.tile if st.tile is not None else 0
+            states.append((flag_ids[st.flag], len(room_maps) - 1, sx, sy, tid))
+            room_sym_entry["states"].append({"x": sx, "y": sy, "flag": st.flag, "tile": tid})
+        if room.states and level.w * level.h > ROOM_CELLS_MAX:
+            errors.add_error(
+                f"{rid}: STATES need a map of at most {ROOM_CELLS_MAX} cells (level is {level.w}x{level.h})",
+                line=room.line_no,
+            )
+
         room_dir_entries.append((ofs_map, ofs_spawns, ofs_exits, ofs_objects))
         room_sym.append(room_sym_entry)
 
@@ -1534,13 +3525,557 @@ def compile_level(level: LevelDef, errors: ErrorCollector) -> Tuple[Optional[byt
     blob += b"\x00" * (2 * len(msg_names))
 
     msg_string_offsets: List[int] = []
+    empty_ofs: Optional[int] = None
     for mid in msg_names:
+        if not in_segment("MSG", mid):
+            # Ids stay global; messages another segment uses share one empty string here.
+            if empty_ofs is None:
+                empty_ofs = len(blob)
+                blob += b"\x00"
+            msg_string_offsets.append(empty_ofs)
+            continue
         msg_string_offsets.append(len(blob))
         blob += _ascii_bytes(level.messages[mid])
 
     # Patch message offsets
     for idx, sofs in enumerate(msg_string_offsets):
-        struct.pack_into("<H", blob, msg_ofs_pos + idx * 2, sofs)
+        struct.pack_into("<H", blob, msg_ofs_pos + idx * 2, sofs & 0xFFFF)
+
+    # Tile pages: only when some room uses a tileset id past 255
+    ofs_pages = 0
+    pages: List[List[int]] = []
+    room_local: List[Dict[int, int]] = [{} for _ in room_maps]  # tileset id -> map byte, paged levels only
+    if (
+        any(tid > 0xFF for _ofs, tiles in room_maps for tid in tiles)
+        or any(st[4] > 0xFF for st in states)
+        or any(tid > 0xFF for diff in layer_diffs for _x, _y, tid in diff)
+    ):
+        room_tiles = [set(tiles) for _ofs, tiles in room_maps]
+        for _flag, r_idx, _x, _y, tid in states:
+            room_tiles[r_idx].add(tid)  # state tiles share the room's page
+        for r_idx, diff in enumerate(layer_diffs):
+            room_tiles[r_idx].update(tid for _x, _y, tid in diff)  # so do alternate layer tiles
+        for rid, used in zip(room_names, room_tiles):
+            if len(used) > ROOM_TILES_MAX:
+                errors.add_error(
+                    f"{rid}: uses {len(used)} distinct tiles (max {ROOM_TILES_MAX} per room)",
+                    line=level.rooms[rid].line_no,
+                )
+        room_page, pages = assign_tile_pages(room_tiles)
+        for r_idx, (ofs_map, tiles) in enumerate(room_maps):
+            local = {tid: i for i, tid in enumerate(pages[room_page[r_idx]])}
+            room_local[r_idx] = local
+            for i, tid in enumerate(tiles):
+                blob[ofs_map + i] = local.get(tid, 0) & 0xFF
+            room_sym[r_idx]["page"] = room_page[r_idx]
+
+        ofs_pages = len(blob)
+        blob.append(len(pages) & 0xFF)
+        blob += bytes(p & 0xFF for p in room_page)
+        list_pos = len(blob)
+        blob += b"\x00" * (2 * len(pages))
+        for p_idx, page in enumerate(pages):
+            struct.pack_into("<H", blob, list_pos + p_idx * 2, len(blob) & 0xFFFF)
+            blob += _u16(len(page))
+            for tid in page:
+                blob += _u16(tid)
+        if len(pages) > 255:
+            errors.add_error(f"Too many tile pages: {len(pages)} (max 255)", line=level.line_no)
+
+    # Tile states: records sorted by flag plus a flag -> first record index, so a
+    # flag change touches only its own records.
+    ofs_states = 0
+    if states:
+        if len(states) > STATES_MAX:
+            errors.add_error(f"Too many STATES bindings: {len(states)} (max {STATES_MAX})", line=level.line_no)
+        states.sort(key=lambda st: (st[0], st[1], st[3], st[2]))
+        ofs_states = len(blob)
+        blob.append(len(states) & 0xFF)
+        start = 0
+        for fid in range(len(level.flags) + 1):
+            while start < len(states) and states[start][0] < fid:
+                start += 1
+            blob.append(start & 0xFF)
+        for _flag, r_idx, x, y, tid in states:
+            local = room_local[r_idx]
+            blob += bytes([r_idx & 0xFF, x & 0xFF, y & 0xFF, (local.get(tid, 0) if local else tid) & 0xFF])
+
+    # Water: the selecting var, the colors below the line and a room x level
+    # table of surface y values, so a level change is one table read per room.
+    ofs_water = 0
+    water_rows: List[List[int]] = []
+    for rid in room_names:
+        room = level.rooms[rid]
+        row: List[int] = []
+        for tok in room.water.split(",") if room.water else []:
+            tok = tok.strip()
+            if tok == "-":
+                row.append(WATER_DRY)
+                continue
+            try:
+                y = int(tok, 0)
+            except ValueError:
+                errors.add_error(f"{rid}: bad water= entry {tok!r} (room pixel y or '-')", line=room.line_no)
+                continue
+            if not (0 <= y <= WATER_MAX_Y):
+                errors.add_error(f"{rid}: water line {y} outside 0..{WATER_MAX_Y}", line=room.line_no)
+                continue
+            row.append(y)
+        water_rows.append(row)
+    if any(water_rows):
+        water_levels = max(len(row) for row in water_rows)
+        if not level.water_var:
+            errors.add_error("ROOM water= needs LEVEL water=<VAR>", line=level.line_no)
+        elif level.water_var in campaign_var_ids:
+            errors.add_error(f"LEVEL water={level.water_var} is a campaign var (only level vars)", line=level.line_no)
+        if water_levels > WATER_MAX_LEVELS:
+            errors.add_error(f"water= has {water_levels} levels (max {WATER_MAX_LEVELS})", line=level.line_no)
+        for rid, row in zip(room_names, water_rows):
+            if row and len(row) != water_levels:
+                errors.add_error(
+                    f"{rid}: water= has {len(row)} levels, other rooms have {water_levels}",
+                    line=level.rooms[rid].line_no,
+                )
+        colors = [c for c in level.water_colors.split(",") if c.strip()]
+        if len(colors) != 3:
+            errors.add_error("LEVEL water_colors= needs bg,mc1,mc2", line=level.line_no)
+            colors = ["0", "0", "0"]
+        try:
+            color_bytes = [parse_color(c) & 0x0F for c in colors]
+        except ValueError:
+            errors.add_error(f"LEVEL water_colors= has an unknown color: {level.water_colors}", line=level.line_no)
+            color_bytes = [0, 0, 0]
+        water_var_id = _resolve_id(level.water_var, var_ids, "VAR", errors, level.line_no) if level.water_var else 0
+        ofs_water = len(blob)
+        blob += bytes([water_var_id & 0xFF] + color_bytes + [water_levels & 0xFF])
+        for row in water_rows:
+            blob += bytes((row[i] if i < len(row) else WATER_DRY) for i in range(water_levels))
+
+    # Wind: per room a 2-bit force map (4 cells per byte, row-major), the
+    # velocity of each force code, and one cell mask per shield flag, so the
+    # controller does a single lookup and a shield toggle is a masked copy.
+    ofs_wind = 0
+    if any(level.rooms[rid].wind for rid in room_names):
+        try:
+            weak, strong = (int(round(float(v) * 256.0)) for v in level.wind_speeds.split(","))
+            if not (0 < weak <= WIND_MAX_FX and 0 < strong <= WIND_MAX_FX):
+                raise ValueError
+        except ValueError:
+            errors.add_error(f"LEVEL wind= must be weak,strong px/frame in (0, 4]: {level.wind_speeds}", line=level.line_no)
+            weak, strong = 128, 384
+        stride = (level.w + 3) // 4
+        ofs_wind = len(blob)
+        wind_pos = len(blob)
+        blob += b"\x00" * (2 * room_count)
+        for r_idx, rid in enumerate(room_names):
+            room = level.rooms[rid]
+            if not room.wind:
+                continue
+            if stride * level.h > WIND_MAP_MAX:
+                errors.add_error(
+                    f"{rid}: WIND needs a map of at most 20x12 cells (level is {level.w}x{level.h})", line=room.line_no
+                )
+            cells = [WIND_NONE] * (level.w * level.h)
+            strong_dir = 0
+            shields: Dict[str, set] = {}
+            for lane in room.wind:
+                if lane.x1 >= level.w or lane.y1 >= level.h:
+                    errors.add_error(f"{rid}: WIND lane {lane.x0},{lane.y0}-{lane.x1},{lane.y1} outside the map", line=lane.line_no)
+                    continue
+                code, direction = WIND_PUSH[lane.push]
+                if direction:
+                    if strong_dir and direction != strong_dir:
+                        errors.add_error(f"{rid}: WIND mixes STRONG_LEFT and STRONG_RIGHT (one strong direction per room)", line=lane.line_no)
+                    strong_dir = direction
+                if lane.shield:
+                    if lane.shield not in flag_ids:
+                        errors.add_error(f"{rid}: WIND shield= unknown level FLAG {lane.shield}", line=lane.line_no)
+                        continue
+                    if lane.shield not in shields and len(shields) == 255:
+                        errors.add_error(f"{rid}: too many WIND shields (max 255)", line=lane.line_no)
+                        continue
+                shield_cells = shields.setdefault(lane.shield, set()) if lane.shield else None
+                for y in range(lane.y0, lane.y1 + 1):
+                    for x in range(lane.x0, lane.x1 + 1):
+                        cells[y * level.w + x] = code
+                        if shield_cells is not None:
+                            shield_cells.add(y * level.w + x)
+
+            def pack(values: List[int]) -> bytes:
+                out = bytearray(stride * level.h)
+                for i, v in enumerate(values):
+                    y, x = divmod(i, level.w)
+                    out[y * stride + (x >> 2)] |= (v & 3) << ((x & 3) * 2)
+                return bytes(out)
+
+            struct.pack_into("<H", blob, wind_pos + r_idx * 2, len(blob) & 0xFFFF)
+            blob += struct.pack("<hhhh", 0, -weak, weak, strong if strong_dir >= 0 else -strong)
+            blob += pack(cells)
+            blob.append(len(shields) & 0xFF)
+            for name, members in shields.items():
+                blob.append(flag_ids[name] & 0xFF)
+                blob += pack([3 if i in members else 0 for i in range(level.w * level.h)])
+            room_sym[r_idx]["wind"] = {"lanes": len(room.wind), "shields": list(shields)}
+
+    # Pressure plates: records grouped by room plus a room -> first record
+    # index. The runtime only looks a cell up when a body steps onto a PLATE
+    # tile, so standing still costs one collision byte compare per frame.
+    ofs_plates = 0
+    plates: List[Tuple[int, int, int, int]] = []  # (room index, x, y, flag id)
+    for r_idx, rid in enumerate(room_names):
+        room = level.rooms[rid]
+        pressed: Dict[Tuple[int, int], int] = {}
+        for plate in room.plates:
+            if not (0 <= plate.x < level.w and 0 <= plate.y < level.h):
+                errors.add_error(f"{rid}: PLATES cell {plate.x},{plate.y} outside the map", line=plate.line_no)
+                continue
+            if plate.flag in campaign_flag_ids:
+                errors.add_error(f"{rid}: PLATES flag {plate.flag} is a campaign flag (only level flags)", line=plate.line_no)
+                continue
+            if plate.flag not in flag_ids:
+                errors.add_error(f"{rid}: PLATES unknown FLAG {plate.flag}", line=plate.line_no)
+                continue
+            if (plate.x, plate.y) in pressed:
+                errors.add_error(
+                    f"{rid}: PLATES cell {plate.x},{plate.y} already bound on line {pressed[(plate.x, plate.y)]}",
+                    line=plate.line_no,
+                )
+                continue
+            tid = room_maps[r_idx][1][plate.y * level.w + plate.x]
+            if level.tile_flags and not (level.tile_flags.get(tid, 0) & TF_PLATE):
+                errors.add_error(
+                    f"{rid}: PLATES cell {plate.x},{plate.y} is tile {tid} without the PLATE flag", line=plate.line_no
+                )
+                continue
+            pressed[(plate.x, plate.y)] = plate.line_no
+            plates.append((r_idx, plate.x, plate.y, flag_ids[plate.flag]))
+            room_sym[r_idx].setdefault("plates", []).append({"x": plate.x, "y": plate.y, "flag": plate.flag})
+    if plates:
+        if len(plates) > PLATES_MAX:
+            errors.add_error(f"Too many PLATES: {len(plates)} (max {PLATES_MAX})", line=level.line_no)
+        ofs_plates = len(blob)
+        blob.append(len(plates) & 0xFF)
+        start = 0
+        for r_idx in range(room_count + 1):
+            while start < len(plates) and plates[start][0] < r_idx:
+                start += 1
+            blob.append(start & 0xFF)
+        for _room, x, y, fid in plates:
+            blob += bytes([x & 0xFF, y & 0xFF, fid & 0xFF])
+
+    # Moving platforms: records grouped by room like plates. The runtime keeps
+    # at most PLATFORM_ROOM_MAX decks and redraws only the cells a deck moved
+    # through, so each path must cross open cells that no other deck uses.
+    ofs_platforms = 0
+    platforms: List[Tuple[int, int, int, int, int, int, int, int]] = []  # (room index, kind, x0, y0, x1, y1, speed, flag id)
+    kind_ids = {name: k for k, name in enumerate(level.platform_kinds)}
+    for r_idx, rid in enumerate(room_names):
+        room = level.rooms[rid]
+        swept: Dict[Tuple[int, int], int] = {}
+        count = 0
+        for plat in room.platforms:
+            where = f"{rid}: PLATFORMS {plat.kind} {plat.x0},{plat.y0}-{plat.x1},{plat.y1}"
+            if plat.kind not in kind_ids:
+                errors.add_error(f"{rid}: PLATFORMS unknown kind {plat.kind} (declare it in the tset PLATFORMS)", line=plat.line_no)
+                continue
+            axis = level.platform_kinds[plat.kind]
+            if not all(0 <= v < lim for v, lim in ((plat.x0, level.w), (plat.x1, level.w), (plat.y0, level.h), (plat.y1, level.h))):
+                errors.add_error(f"{where} leaves the map", line=plat.line_no)
+                continue
+            if (axis == "V" and (plat.x0 != plat.x1 or plat.y0 == plat.y1)) or (
+                axis == "H" and (plat.y0 != plat.y1 or plat.x0 == plat.x1)
+            ):
+                errors.add_error(f"{where}: a {axis} kind needs a {'vertical' if axis == 'V' else 'horizontal'} path", line=plat.line_no)
+                continue
+            if not (1 <= plat.speed <= PLATFORM_MAX_SPEED):
+                errors.add_error(f"{where}: speed must be 1..{PLATFORM_MAX_SPEED} px/frame", line=plat.line_no)
+                continue
+            fid = PLATFORM_NO_FLAG
+            if plat.flag:
+                if plat.flag in campaign_flag_ids:
+                    errors.add_error(f"{where}: flag {plat.flag} is a campaign flag (only level flags)", line=plat.line_no)
+                    continue
+                if plat.flag not in flag_ids:
+                    errors.add_error(f"{where}: unknown FLAG {plat.flag}", line=plat.line_no)
+                    continue
+                fid = flag_ids[plat.flag]
+            cells = [
+                (x, y)
+                for x in range(min(plat.x0, plat.x1), max(plat.x0, plat.x1) + 1)
+                for y in range(min(plat.y0, plat.y1), max(plat.y0, plat.y1) + 1)
+            ]
+            alt = {(x, y): tid for x, y, tid in layer_diffs[r_idx]}
+            blocked = [
+                (x, y)
+                for x, y in cells
+                if level.tile_flags.get(room_maps[r_idx][1][y * level.w + x], 0) & TF_SHAPED
+                or level.tile_flags.get(alt.get((x, y), -1), 0) & TF_SHAPED
+            ]
+            if blocked:
+                x, y = blocked[0]
+                errors.add_error(f"{where}: path cell {x},{y} is SOLID/STANDABLE/FLOOR (paths cross open cells)", line=plat.line_no)
+                continue
+            shared = [c for c in cells if c in swept]
+            if shared:
+                x, y = shared[0]
+                errors.add_error(f"{where}: path cell {x},{y} is also swept by line {swept[shared[0]]}", line=plat.line_no)
+                continue
+            count += 1
+            if count > PLATFORM_ROOM_MAX:
+                errors.add_error(f"{rid}: more than {PLATFORM_ROOM_MAX} PLATFORMS in one room", line=plat.line_no)
+                continue
+            for c in cells:
+                swept[c] = plat.line_no
+            platforms.append((r_idx, kind_ids[plat.kind], plat.x0, plat.y0, plat.x1, plat.y1, plat.speed, fid))
+            room_sym[r_idx].setdefault("platforms", []).append(
+                {
+                    "kind": plat.kind,
+                    "path": f"{plat.x0},{plat.y0}-{plat.x1},{plat.y1}",
+                    "speed": plat.speed,
+                    "flag": plat.flag or "-",
+                }
+            )
+    if platforms:
+        ofs_platforms = len(blob)
+        blob.append(len(platforms) & 0xFF)
+        start = 0
+        for r_idx in range(room_count + 1):
+            while start < len(platforms) and platforms[start][0] < r_idx:
+                start += 1
+            blob.append(start & 0xFF)
+        for _room, *rec in platforms:
+            blob += bytes(v & 0xFF for v in rec)
+
+    # Sweeping lasers: the whole beam geometry is compiled here. Each step of
+    # a sweep cycle (out and back, cosine eased) stores the first sprite's VIC
+    # position and a mask of the cells the beam covers along the sweep, so the
+    # runtime advances an index and tests one mask bit at the player's cell.
+    ofs_lasers = 0
+    lasers: List[Tuple[int, bytes, bytes]] = []  # (room index, record less steps ofs, step table)
+    for r_idx, rid in enumerate(room_names):
+        room = level.rooms[rid]
+        used = 0
+        count = 0
+        for laser in room.lasers:
+            where = f"{rid}: LASERS {laser.axis} {laser.x0},{laser.y0}-{laser.x1},{laser.y1}"
+            if level.w > LASER_MAP_MAX[0] or level.h > LASER_MAP_MAX[1]:
+                errors.add_error(f"{rid}: LASERS need a map of at most {LASER_MAP_MAX[0]}x{LASER_MAP_MAX[1]} cells", line=laser.line_no)
+                break
+            if not all(0 <= v < lim for v, lim in ((laser.x0, level.w), (laser.x1, level.w), (laser.y0, level.h), (laser.y1, level.h))):
+                errors.add_error(f"{where} leaves the map", line=laser.line_no)
+                continue
+            vertical = laser.axis == "V"
+            if (vertical and (laser.y0 != laser.y1 or laser.x0 == laser.x1)) or (
+                not vertical and (laser.x0 != laser.x1 or laser.y0 == laser.y1)
+            ):
+                errors.add_error(
+                    f"{where}: a {laser.axis} beam sweeps {'between columns on one row' if vertical else 'between rows in one column'}",
+                    line=laser.line_no,
+                )
+                continue
+            if not (1 <= laser.sprites <= 3):
+                errors.add_error(f"{where}: sprites must be 1..3", line=laser.line_no)
+                continue
+            if not (2 <= laser.steps <= LASER_MAX_STEPS) or laser.steps % 2:
+                errors.add_error(f"{where}: steps must be even and 2..{LASER_MAX_STEPS}", line=laser.line_no)
+                continue
+            if not (1 <= laser.rate <= LASER_MAX_RATE):
+                errors.add_error(f"{where}: rate must be 1..{LASER_MAX_RATE} frames per step", line=laser.line_no)
+                continue
+            if not (1 <= abs(laser.push) <= LASER_MAX_PUSH) or (vertical and laser.push < 0):
+                errors.add_error(
+                    f"{where}: push must be 1..{LASER_MAX_PUSH} px (negative only on H beams; V beams push along the sweep)",
+                    line=laser.line_no,
+                )
+                continue
+            try:
+                color = parse_color(laser.color) & 0x0F
+            except ValueError:
+                errors.add_error(f"{where}: unknown color {laser.color}", line=laser.line_no)
+                continue
+            fid = LASER_NO_FLAG
+            if laser.off:
+                if laser.off in campaign_flag_ids:
+                    errors.add_error(f"{where}: off flag {laser.off} is a campaign flag (only level flags)", line=laser.line_no)
+                    continue
+                if laser.off not in flag_ids:
+                    errors.add_error(f"{where}: unknown FLAG {laser.off}", line=laser.line_no)
+                    continue
+                fid = flag_ids[laser.off]
+            # Fixed extent across the sweep: rows for V, columns for H.
+            length = laser.sprites * LASER_SPRITE_LEN[laser.axis]
+            if vertical:
+                top = laser.y0 * 16
+                if top + SPRITE_OFS_Y + (laser.sprites - 1) * LASER_SPRITE_LEN["V"] > 255:
+                    errors.add_error(f"{where}: beam sprites run past the bottom of the screen", line=laser.line_no)
+                    continue
+                cross = (laser.y0, min(level.h - 1, (top + length - 1) >> 4))
+                p0, p1 = laser.x0 * 16 + 7, laser.x1 * 16 + 7
+            else:
+                left = laser.x0 * 16
+                cross = (laser.x0, min(level.w - 1, (left + length - 1) >> 4))
+                p0, p1 = laser.y0 * 16 + 7, laser.y1 * 16 + 7
+            used += laser.sprites
+            count += 1
+            if count > LASER_ROOM_MAX or used > LASER_SPRITES:
+                errors.add_error(
+                    f"{rid}: LASERS use more than {LASER_ROOM_MAX} beams or {LASER_SPRITES} sprites in one room",
+                    line=laser.line_no,
+                )
+                continue
+            table = bytearray()
+            half = laser.steps // 2
+            for k in range(laser.steps):
+                p = p0 + round((p1 - p0) * (1 - math.cos(math.pi * k / half)) / 2)
+                # V beams push along their motion; H beams always push by `push`.
+                reverse = vertical and (p1 < p0) != (k >= half)
+                mask = 0
+                for cell in range(p >> 4, ((p + 1) >> 4) + 1):
+                    mask |= 1 << cell
+                if vertical:
+                    sx, sy = p + SPRITE_OFS_X, top + SPRITE_OFS_Y
+                else:
+                    sx, sy = left + SPRITE_OFS_X, p + SPRITE_OFS_Y
+                table += bytes([sx & 0xFF, (sx >> 8) | (LASER_REVERSE if reverse else 0), sy & 0xFF])
+                table += mask.to_bytes(3, "little")
+            record = bytes(
+                [LASER_AXES[laser.axis], laser.sprites, color, laser.rate, laser.steps, laser.push & 0xFF, cross[0], cross[1], fid]
+            )
+            lasers.append((r_idx, record, bytes(table)))
+            room_sym[r_idx].setdefault("lasers", []).append(
+                {
+                    "axis": laser.axis,
+                    "path": f"{laser.x0},{laser.y0}-{laser.x1},{laser.y1}",
+                    "cross": f"{cross[0]}-{cross[1]}",
+                    "steps": laser.steps,
+                    "rate": laser.rate,
+                    "sprites": laser.sprites,
+                    "off": laser.off or "-",
+                }
+            )
+    if lasers:
+        ofs_lasers = len(blob)
+        blob.append(len(lasers) & 0xFF)
+        start = 0
+        for r_idx in range(room_count + 1):
+            while start < len(lasers) and lasers[start][0] < r_idx:
+                start += 1
+            blob.append(start & 0xFF)
+        steps_ofs = len(blob) + len(lasers) * LASER_RECORD_SIZE
+        for _room, record, table in lasers:
+            blob += record + struct.pack("<H", steps_ofs & 0xFFFF)
+            steps_ofs += len(table)
+        for _room, _record, table in lasers:
+            blob += table
+
+    # Routes: per flag a mask of the routes it switches, then per route the
+    # fixed adjacency rows, the switchable edges and the REACH queries. A
+    # switch change flips its edges' bits and re-closes that route only.
+    ofs_routes = 0
+    if level.routes:
+        ofs_routes = _compile_routes(level, blob, flag_ids, campaign_flag_ids, errors)
+
+    # Dialogs: nodes in file order, read straight from the blob as they are walked.
+    ofs_dialogs = 0
+    if dialogs:
+        ofs_dialogs = _compile_dialogs(level, dialogs, dialog_nodes, blob, msg_ids, cond_offset, act_offset, errors)
+
+    # Scripted NPCs: placements per room, then one behaviour script per NPC
+    # type that the placements share. The sprites come out of the ones the
+    # room's LASERS leave free, counted from sprite 7 down.
+    ofs_npcs = 0
+    npc_records: List[Tuple[int, str, bytes]] = []  # (room index, type, record less script ofs)
+    for r_idx, rid in enumerate(room_names):
+        room = level.rooms[rid]
+        if not room.npcs:
+            continue
+        if len(room.npcs) > NPC_ROOM_MAX or len(room.npcs) + sum(las.sprites for las in room.lasers) > LASER_SPRITES:
+            errors.add_error(
+                f"{rid}: NPCS use more than {NPC_ROOM_MAX} NPCs or more sprites than LASERS leave ({LASER_SPRITES} shared)",
+                line=room.npcs[0].line_no,
+            )
+        for placed in room.npcs:
+            where = f"{rid}: NPCS {placed.kind} {placed.x},{placed.y}"
+            npc = level.npcs.get(placed.kind)
+            if npc is None:
+                errors.add_error(f"{where}: unknown NPC {placed.kind}", line=placed.line_no)
+                continue
+            if not (0 <= placed.x < level.w and 0 <= placed.y < level.h):
+                errors.add_error(f"{where} leaves the map", line=placed.line_no)
+                continue
+            image = placed.image or npc.image
+            if image not in NPC_IMAGES:
+                errors.add_error(f"{where}: unknown image {image} (one of {', '.join(NPC_IMAGES)})", line=placed.line_no)
+                continue
+            speed = placed.speed or npc.speed
+            if not (1 <= speed <= NPC_MAX_SPEED):
+                errors.add_error(f"{where}: speed must be 1..{NPC_MAX_SPEED} px per frame", line=placed.line_no)
+                continue
+            face = placed.face or ("LEFT" if image.endswith("_L") else "RIGHT")
+            if face not in ("LEFT", "RIGHT"):
+                errors.add_error(f"{where}: face must be LEFT or RIGHT", line=placed.line_no)
+                continue
+            npc_records.append(
+                (r_idx, placed.kind, bytes([placed.x, placed.y, NPC_IMAGES.index(image), speed, NPC_FACES[face]]))
+            )
+            room_sym[r_idx].setdefault("npcs", []).append(
+                {"kind": placed.kind, "at": f"{placed.x},{placed.y}", "image": image, "speed": speed, "face": face}
+            )
+    npc_scripts: Dict[str, bytes] = {}
+    npc_sym: Dict[str, dict] = {}
+    if len(npc_records) > 255:
+        errors.add_error(f"Too many NPCS placements: {len(npc_records)} (max 255)", line=level.line_no)
+    if npc_records:
+        for _room, kind, _record in npc_records:
+            if kind not in npc_scripts:
+                npc_scripts[kind] = compile_npc_script(level.npcs[kind], level, flag_ids, campaign_flag_ids, errors)
+        ofs_npcs = len(blob)
+        blob.append(len(npc_records) & 0xFF)
+        start = 0
+        for r_idx in range(room_count + 1):
+            while start < len(npc_records) and npc_records[start][0] < r_idx:
+                start += 1
+            blob.append(start & 0xFF)
+        script_ofs = len(blob) + len(npc_records) * NPC_RECORD_SIZE
+        for kind, script in npc_scripts.items():
+            npc_sym[kind] = {"script": script_ofs, "ops": len(script) // NPC_OP_SIZE}
+            script_ofs += len(script)
+        for _room, kind, record in npc_records:
+            blob += record + struct.pack("<H", npc_sym[kind]["script"] & 0xFFFF)
+        for script in npc_scripts.values():
+            blob += script
+
+    # Companion: waits at its LEVEL companion= spawn until a COMPANION FOLLOW action.
+    companion_room_idx = COMPANION_NONE
+    companion_spawn_idx = 0
+    if level.companion:
+        c_room, _, c_spawn = level.companion.partition(":")
+        if c_room not in spawn_ids_by_room or c_spawn not in spawn_ids_by_room[c_room]:
+            errors.add_error(f"LEVEL companion= unknown spawn: {level.companion}", line=level.line_no)
+        elif segment is None or c_room in segment.rooms:
+            # Segmented levels: only the segment holding the room carries the start.
+            companion_room_idx = room_ids[c_room]
+            companion_spawn_idx = spawn_ids_by_room[c_room][c_spawn]
+
+    # Alternate layer: the layer flag plus, per room, its diff list (cells in
+    # row-major order), so a toggle redraws exactly the cells that change.
+    ofs_layers = 0
+    if any(room.alt_lines for room in level.rooms.values()) and level.layer_flag:
+        if level.layer_flag in campaign_flag_ids:
+            errors.add_error(f"LEVEL layer={level.layer_flag} is a campaign flag (only level flags)", line=level.line_no)
+        layer_flag_id = _resolve_id(level.layer_flag, flag_ids, "FLAG", errors, level.line_no)
+        ofs_layers = len(blob)
+        blob.append(layer_flag_id & 0xFF)
+        diff_pos = len(blob)
+        blob += b"\x00" * (2 * room_count)
+        for r_idx, diff in enumerate(layer_diffs):
+            if not diff:
+                continue  # 0: this room looks the same on both layers
+            struct.pack_into("<H", blob, diff_pos + r_idx * 2, len(blob) & 0xFFFF)
+            local = room_local[r_idx]
+            blob.append(len(diff) & 0xFF)
+            for x, y, tid in diff:
+                blob += bytes([x & 0xFF, y & 0xFF, (local.get(tid, 0) if local else tid) & 0xFF])
 
     # Patch room directory
     for rindex, (ofs_map, ofs_spawns, ofs_exits, ofs_objects) in enumerate(
@@ -1548,11 +4083,20 @@ def compile_level(level: LevelDef, errors: ErrorCollector) -> Tuple[Optional[byt
     ):
         base = room_dir_ofs + rindex * ROOM_DIRENTRY_SIZE
         struct.pack_into(
-            "<HHHH", blob, base, ofs_map, ofs_spawns, ofs_exits, ofs_objects
+            "<HHHH",
+            blob,
+            base,
+            ofs_map & 0xFFFF,
+            ofs_spawns & 0xFFFF,
+            ofs_exits & 0xFFFF,
+            ofs_objects & 0xFFFF,
         )
 
     # Patch header
-    start_room_idx = _resolve_id(level.start_room, room_ids, "ROOM", errors, level.line_no)
+    if segment is None or level.start_room in segment.rooms:
+        start_room_idx = _resolve_id(level.start_room, room_ids, "ROOM", errors, level.line_no)
+    else:
+        start_room_idx = 0  # the LVL2 index holds the real start room
     if (
         level.start_room not in spawn_ids_by_room
         or level.start_spawn not in spawn_ids_by_room[level.start_room]
@@ -1565,11 +4109,32 @@ def compile_level(level: LevelDef, errors: ErrorCollector) -> Tuple[Optional[byt
     else:
         start_spawn_idx = spawn_ids_by_room[level.start_room][level.start_spawn]
 
+    # LVL1 stores counts as u8 and offsets as u16; fail loudly instead of wrapping
+    for kind, count in (
+        ("ROOM", len(room_ids)),
+        ("FLAG", len(level.flags)),
+        ("VAR", len(level.vars)),
+        ("ITEM", len(level.items)),
+        ("MESSAGE", len(msg_names)),
+    ):
+        if count > 255:
+            errors.add_error(f"Too many {kind}s: {count} (max 255, count stored as u8)", line=level.line_no)
+    for rid in room_names:
+        room = level.rooms[rid]
+        for kind, count in (("SPAWN", len(room.spawns)), ("EXIT", len(room.exits)), ("OBJECT", len(room.objects))):
+            if count > 255:
+                errors.add_error(f"{rid}: too many {kind}s: {count} (max 255)", line=room.line_no)
+    if len(blob) > 0xFFFF:
+        errors.add_error(f"Level blob is {len(blob)} bytes; LVL1 offsets are u16 (max 65535)", line=level.line_no)
+
+    if segment is None and level.goal and level.goal not in cond_ofs:
+        errors.add_error(f"LEVEL goal refers to unknown COND: {level.goal}", line=level.line_no)
+
     # Don't return None here - continue so all errors can be collected and reported
     # If there are errors, we'll create a minimal output but let error reporting handle it
 
     header = struct.pack(
-        "<4sBBBBBBBBBBHHHH",
+        "<4sBBBBBBBBBBHHHHHHHHHBBHHHHHH",
         LEVEL_MAGIC,
         LEVEL_VERSION,
         room_count & 0xFF,
@@ -1585,6 +4150,19 @@ def compile_level(level: LevelDef, errors: ErrorCollector) -> Tuple[Optional[byt
         ofs_cond_stream & 0xFFFF,
         ofs_act_stream & 0xFFFF,
         ofs_msg_table & 0xFFFF,
+        ofs_pages & 0xFFFF,
+        ofs_states & 0xFFFF,
+        ofs_layers & 0xFFFF,
+        ofs_water & 0xFFFF,
+        ofs_wind & 0xFFFF,
+        companion_room_idx & 0xFF,
+        companion_spawn_idx & 0xFF,
+        ofs_plates & 0xFFFF,
+        ofs_routes & 0xFFFF,
+        ofs_platforms & 0xFFFF,
+        ofs_lasers & 0xFFFF,
+        ofs_dialogs & 0xFFFF,
+        ofs_npcs & 0xFFFF,
     )
     if len(header) != HEADER_SIZE:
         errors.add_error(
@@ -1602,6 +4180,12 @@ def compile_level(level: LevelDef, errors: ErrorCollector) -> Tuple[Optional[byt
     header_c.append(_pack_enum_header("VarId", level.vars))
     header_c.append(_pack_enum_header("ItemId", level.items))
     header_c.append(_pack_enum_header("MsgId", msg_names))
+    if level.campaign_file:
+        # Identical in every level header built from the same campaign file.
+        header_c.append("#ifndef CAMPAIGN_IDS_DEFINED\n#define CAMPAIGN_IDS_DEFINED\n")
+        header_c.append(_pack_enum_header("CampaignFlagId", level.campaign_flags))
+        header_c.append(_pack_enum_header("CampaignVarId", level.campaign_vars))
+        header_c.append("#endif\n\n")
     header_c.append("typedef enum {\n")
     for k, v in OBJ_TYPES.items():
         header_c.append(f"  OBJ_{k} = {v},\n")
@@ -1613,22 +4197,43 @@ def compile_level(level: LevelDef, errors: ErrorCollector) -> Tuple[Optional[byt
         "w": level.w,
         "h": level.h,
         "rooms": room_names,
+        "goal": level.goal,
         "ids": {
             "flags": flag_ids,
             "vars": var_ids,
             "items": item_ids,
             "msgs": msg_ids,
             "rooms": room_ids,
+            "campaign_flags": campaign_flag_ids,
+            "campaign_vars": campaign_var_ids,
         },
         "offsets": {
             "room_dir": room_dir_ofs,
             "cond_stream": ofs_cond_stream,
             "act_stream": ofs_act_stream,
             "msg_table": ofs_msg_table,
+            "pages": ofs_pages,
+            "states": ofs_states,
+            "layers": ofs_layers,
+            "water": ofs_water,
+            "wind": ofs_wind,
+            "plates": ofs_plates,
+            "routes": ofs_routes,
+            "platforms": ofs_platforms,
+            "lasers": ofs_lasers,
+            "dialogs": ofs_dialogs,
+            "npcs": ofs_npcs,
         },
+        "pages": pages,
         "cond_offsets": cond_ofs,
         "act_offsets": act_ofs,
         "room_sym": room_sym,
+        "routes": {
+            name: {"nodes": r.nodes, "edges": len(r.edges), "reach": [flag for _s, _d, flag, _l in r.reaches]}
+            for name, r in level.routes.items()
+        },
+        "dialogs": dialog_ofs,
+        "npcs": npc_sym,
         "msg_names": msg_names,
         "msg_string_offsets": msg_string_offsets,
         "blob_size": len(blob),
@@ -1637,12 +4242,187 @@ def compile_level(level: LevelDef, errors: ErrorCollector) -> Tuple[Optional[byt
     return bytes(blob), header_c_str, debug
 
 
+def _finish_plan(level: LevelDef, plan: SegmentPlan) -> SegmentPlan:
+    plan.live = _live_refs(level, plan.rooms, include_goal=False)
+    plan.imports = [rid for rid in level.rooms if ("ROOM", rid) in plan.live and rid not in plan.rooms]
+    return plan
+
+
+def plan_segments(level: LevelDef, segment_size: int) -> List[SegmentPlan]:
+    """
+    Rooms with group= share a segment (ordered by first appearance). Rooms without a
+    group are packed in file order while the compiled segment (rooms plus the scripts
+    and messages they reach) stays within segment_size.
+    """
+    plans: List[SegmentPlan] = []
+    by_group: Dict[str, SegmentPlan] = {}
+    auto: Optional[SegmentPlan] = None
+    for rid, room in level.rooms.items():
+        if room.group:
+            if room.group not in by_group:
+                by_group[room.group] = SegmentPlan(rooms=[])
+                plans.append(by_group[room.group])
+            by_group[room.group].rooms.append(rid)
+            continue
+        if auto is not None:
+            trial = _finish_plan(level, SegmentPlan(rooms=auto.rooms + [rid]))
+            blob, _, _ = compile_level(level, ErrorCollector(), trial)
+            if len(blob) <= segment_size:
+                auto.rooms.append(rid)
+                continue
+        auto = SegmentPlan(rooms=[rid])
+        plans.append(auto)
+
+    return [_finish_plan(level, plan) for plan in plans]
+
+
+def compile_level_v2(
+    level: LevelDef, errors: ErrorCollector, segment_size: int = SEGMENT_SIZE_DEFAULT
+) -> Tuple[bytes, List[bytes], str, dict]:
+    """
+    Compile a level into an LVL2 resident index plus LVL1-format segment blobs.
+    Returns (index, segments, ids_h, debug).
+    """
+    plans = plan_segments(level, segment_size)
+    if len(plans) > 255:
+        errors.add_error(f"Too many segments: {len(plans)} (max 255)", line=level.line_no)
+
+    segments: List[bytes] = []
+    seg_debug: List[dict] = []
+    ids_h = ""
+    for s_idx, plan in enumerate(plans):
+        blob, ids_h, debug = compile_level(level, errors, plan)
+        if len(blob) > segment_size:
+            errors.add_warning(
+                f"Segment {s_idx} ({','.join(plan.rooms)}) is {len(blob)} bytes; segment size is {segment_size}",
+                line=level.rooms[plan.rooms[0]].line_no,
+            )
+        debug["imports"] = plan.imports
+        segments.append(blob)
+        seg_debug.append(debug)
+
+    room_names = list(level.rooms.keys())
+    room_loc: Dict[str, Tuple[int, int]] = {}
+    for s_idx, plan in enumerate(plans):
+        for local, rid in enumerate(plan.rooms):
+            room_loc[rid] = (s_idx, local)
+
+    index = bytearray(b"\x00" * HEADER2_SIZE)
+    ofs_segtable = len(index)
+    index += b"\x00" * (SEG_ENTRY_SIZE * len(plans))
+    ofs_roomtable = len(index)
+    for rid in room_names:
+        s_idx, local = room_loc[rid]
+        index += bytes([s_idx & 0xFF, local & 0xFF])
+
+    # Import lists: u8 count + u16 global room ids (local id = segment room count + i)
+    global_ids = {rid: i for i, rid in enumerate(room_names)}
+    pack_ofs = 0
+    seg_entries: List[dict] = []
+    for s_idx, plan in enumerate(plans):
+        ofs_imports = len(index)
+        index.append(len(plan.imports) & 0xFF)
+        for rid in plan.imports:
+            index += _u16(global_ids[rid])
+        size = len(segments[s_idx])
+        struct.pack_into(
+            "<HBHBH",
+            index,
+            ofs_segtable + s_idx * SEG_ENTRY_SIZE,
+            pack_ofs & 0xFFFF,
+            (pack_ofs >> 16) & 0xFF,
+            size & 0xFFFF,
+            len(plan.rooms) & 0xFF,
+            ofs_imports & 0xFFFF,
+        )
+        seg_entries.append(
+            {"pack_ofs": pack_ofs, "size": size, "rooms": plan.rooms, "imports": plan.imports, "ofs_imports": ofs_imports}
+        )
+        pack_ofs += size
+    if pack_ofs > 0xFFFFFF:
+        errors.add_error(f"Segment pack is {pack_ofs} bytes; LVL2 pack offsets are u24", line=level.line_no)
+
+    # Disk name prefix for segment files: <NAME>.Snn
+    ofs_name = len(index)
+    disk_name = sanitize_level_name(level.name).upper()[:12]
+    index += _ascii_bytes(disk_name)
+
+    start_spawn_idx = 0
+    if level.start_room in level.rooms:
+        spawns = list(level.rooms[level.start_room].spawns.keys())
+        if level.start_spawn in spawns:
+            start_spawn_idx = spawns.index(level.start_spawn)
+
+    header = struct.pack(
+        "<4sBBBBBBBBHHBBHHHH",
+        LEVEL2_MAGIC,
+        LEVEL2_VERSION,
+        level.w & 0xFF,
+        level.h & 0xFF,
+        len(level.flags) & 0xFF,
+        len(level.vars) & 0xFF,
+        len(level.items) & 0xFF,
+        len(level.messages) & 0xFF,
+        len(plans) & 0xFF,
+        len(room_names) & 0xFFFF,
+        global_ids.get(level.start_room, 0) & 0xFFFF,
+        start_spawn_idx & 0xFF,
+        0,
+        ofs_segtable,
+        ofs_roomtable,
+        ofs_name,
+        0,
+    )
+    index[0:HEADER2_SIZE] = header
+    if len(room_names) > 0xFFFF:
+        errors.add_error(f"Too many ROOMs: {len(room_names)} (max 65535 in LVL2)", line=level.line_no)
+
+    debug = {
+        "name": level.name,
+        "format": 2,
+        "disk_name": disk_name,
+        "rooms": room_names,
+        "index_size": len(index),
+        "pack_size": pack_ofs,
+        "segment_size": segment_size,
+        "offsets": {"segtable": ofs_segtable, "roomtable": ofs_roomtable, "name": ofs_name},
+        "segments": seg_entries,
+        "segment_debug": seg_debug,
+    }
+    return bytes(index), segments, ids_h, debug
+
+
+def write_sym_v2(path: str, level: LevelDef, debug: dict) -> None:
+    with open(path, "w", encoding="utf-8") as f:
+        f.write(
+            f'LEVEL2 name="{level.name}" index_size={debug["index_size"]} pack_size={debug["pack_size"]} '
+            f'segments={len(debug["segments"])} rooms={len(debug["rooms"])}\n'
+        )
+        o = debug["offsets"]
+        f.write(f'HDR segtable={o["segtable"]} roomtable={o["roomtable"]} name={o["name"]} disk_name={debug["disk_name"]}\n\n')
+        for s_idx, seg in enumerate(debug["segments"]):
+            f.write(
+                f'SEG[{s_idx}] file={debug["disk_name"]}.S{s_idx:02X} pack_ofs={seg["pack_ofs"]} size={seg["size"]} '
+                f'rooms={",".join(seg["rooms"])}\n'
+            )
+            if seg["imports"]:
+                base = len(seg["rooms"])
+                f.write("  IMPORTS " + " ".join(f"{base + i}={rid}" for i, rid in enumerate(seg["imports"])) + "\n")
+        f.write("\n")
+        _write_sym_analysis(f, debug)
+
+    for s_idx, seg in enumerate(debug["segment_debug"]):
+        with open(path, "a", encoding="utf-8") as f:
+            f.write(f"; ---- SEG[{s_idx}] ----\n")
+        write_sym(path, level, seg, mode="a")
+
+
 # ----------------------------
 # CLI
 # ----------------------------
 
 
-def main():
+def make_arg_parser() -> argparse.ArgumentParser:
     ap = argparse.ArgumentParser()
     ap.add_argument("input", help="Input LVLTEXT file (.lvl)")
     ap.add_argument("-o", "--output", default="", help="Output binary (.bin)")
@@ -1682,23 +4462,71 @@ def main():
     ap.add_argument(
         "--format-h", default="", help="Output level_format.h (accessors/constants)"
     )
+    ap.add_argument(
+        "--frame-budget",
+        type=int,
+        default=FRAME_BUDGET_CYCLES,
+        help="Cycles per frame used for interaction cost warnings",
+    )
+    ap.add_argument(
+        "--segmented",
+        action="store_true",
+        help="Emit an LVL2 index + per-room-group segments instead of one LVL1 blob",
+    )
+    ap.add_argument(
+        "--segment-size",
+        type=lambda v: int(v, 0),
+        default=SEGMENT_SIZE_DEFAULT,
+        help="Target segment size in bytes for --segmented (runtime buffer size)",
+    )
+    ap.add_argument(
+        "--keep-unused",
+        action="store_true",
+        help="Keep unreferenced scripts/messages/flags/vars/items (no dead-data elimination)",
+    )
+
+    return ap
+
+
+def main():
+    run(make_arg_parser().parse_args())
 
-    args = ap.parse_args()
+
+def run(args: argparse.Namespace, tilesets: Optional[Dict[str, TileSet]] = None) -> None:
+    """Compile args.input and write its outputs; `tilesets` as for parse_lvltext."""
     project_root = os.path.abspath(os.path.join(os.path.dirname(__file__), ".."))
 
     # Create error collector
     errors = ErrorCollector(default_file=args.input)
 
     # Parse input file
-    level = parse_lvltext(args.input, errors)
+    level = parse_lvltext(args.input, errors, tilesets)
 
     # Don't exit after parsing errors - continue to compilation to find more errors
     if level is None:
         # If parsing completely failed, we can't continue
         errors.report_and_exit()
 
-    # Compile the level (may add more errors)
-    blob, ids_h, debug = compile_level(level, errors)
+    def compiled_size(lvl: LevelDef, errs: ErrorCollector) -> Tuple[int, tuple]:
+        if args.segmented:
+            index, segments, ids_h, debug = compile_level_v2(lvl, errs, args.segment_size)
+            return len(index) + sum(len(b) for b in segments), (index, segments, ids_h, debug)
+        blob, ids_h, debug = compile_level(lvl, errs)
+        return len(blob), (blob, [], ids_h, debug)
+
+    # Strip unreferenced data; compile an untouched copy first to measure the saving
+    dead = None
+    if not args.keep_unused:
+        full_size, _ = compiled_size(copy.deepcopy(level), ErrorCollector(default_file=args.input))
+        dead = eliminate_dead_data(level, errors)
+
+    # Compile the level (may add more errors). With --segmented, blob is the LVL2 index.
+    size, (blob, segments, ids_h, debug) = compiled_size(level, errors)
+    if dead is not None:
+        dead["bytes_saved"] = full_size - size
+        debug["dead_data"] = dead
+    debug["cycles"] = estimate_cycles(level, errors, args.frame_budget)
+    debug["state"] = state_cost(level, errors)
 
     # Report ALL errors (both parsing and compilation) together
     errors.report_and_exit()
@@ -1760,6 +4588,22 @@ def main():
         print(f"Error writing binary file {args.output}: {e}", file=sys.stderr)
         sys.exit(1)
 
+    # LVL2 segments: one file per segment (disk streaming) + concatenated pack (u24 offsets)
+    if segments:
+        seg_base = os.path.splitext(args.output)[0]
+        try:
+            for s_idx, seg in enumerate(segments):
+                seg_path = f"{seg_base}_s{s_idx:02x}.bin"
+                with open(seg_path, "wb") as f:
+                    f.write(seg)
+                print(f"Wrote {seg_path} ({len(seg)} bytes)")
+            with open(f"{seg_base}.pak", "wb") as f:
+                f.write(b"".join(segments))
+            print(f"Wrote {seg_base}.pak")
+        except Exception as e:
+            print(f"Error writing segment files for {args.output}: {e}", file=sys.stderr)
+            sys.exit(1)
+
     # ids header
     try:
         with open(args.ids, "w", encoding="utf-8") as f:
@@ -1780,7 +4624,10 @@ def main():
 
     # .sym
     try:
-        write_sym(args.sym, level, debug)
+        if segments:
+            write_sym_v2(args.sym, level, debug)
+        else:
+            write_sym(args.sym, level, debug)
         print(f"Wrote {args.sym}")
     except Exception as e:
         print(f"Error writing symbol file {args.sym}: {e}", file=sys.stderr)
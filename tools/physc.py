@@ -0,0 +1,182 @@
+#!/usr/bin/env python3
+"""
+physc.py - Precompute player physics tables (jump arc, fall curve, speeds).
+
+Outputs:
+  - physics_tables.h   8.8 fixed-point velocity tables + body constants
+  - .sym               Human-readable arc dump (frame, vy, height)
+
+Usage:
+  python tools/physc.py
+  python tools/physc.py --jump-height 40 --gravity 0.25 --terminal 4 \
+      -o gen/include/physics_tables.h
+
+Units:
+  Positions are pixels with an 8-bit fraction; velocities are signed 8.8
+  pixels per frame (0x0100 = 1 px/frame). Negative vy moves up.
+
+The jump table is the frame-by-frame difference of a quantized parabola, so
+the summed table is exactly --jump-height pixels and the apex lands on a
+whole pixel. The fall table ramps by --gravity until --terminal and the
+runtime repeats its last entry.
+"""
+
+from __future__ import annotations
+import argparse
+import math
+import os
+import sys
+from typing import List
+
+from gen_paths import GEN_ROOT, ANALYSIS_ROOT
+
+TILE_PX = 16
+
+# The runtime probes two corners per edge and moves at most one tile edge per
+# frame, so the body and every per-frame step must fit inside a metatile.
+MAX_BODY_PX = TILE_PX
+MAX_STEP_FX = TILE_PX * 256 - 1
+
+
+def fx(value: float) -> int:
+    return int(round(value * 256.0))
+
+
+def jump_table(height: float, gravity: float) -> List[int]:
+    """Upward vy per frame (negative) for a parabola peaking at `height` px."""
+    frames = max(1, int(math.ceil(math.sqrt(2.0 * height / gravity))))
+    total = fx(height)
+    prev = 0
+    out: List[int] = []
+    for t in range(1, frames + 1):
+        u = 1.0 - t / frames
+        cur = int(round(total * (1.0 - u * u)))
+        out.append(-(cur - prev))
+        prev = cur
+    return out
+
+
+def fall_table(gravity: float, terminal: float) -> List[int]:
+    """Downward vy per frame, ending on the terminal velocity."""
+    step = fx(gravity)
+    cap = fx(terminal)
+    out: List[int] = []
+    v = 0
+    while v < cap:
+        v = min(v + step, cap)
+        out.append(v)
+    return out
+
+
+def emit_array(name: str, values: List[int]) -> str:
+    rows = []
+    for i in range(0, len(values), 8):
+        rows.append("    " + ", ".join(f"{v:d}" for v in values[i:i + 8]))
+    return f"static const int16_t {name}[{len(values)}] = {{\n" + ",\n".join(rows) + "\n};\n"
+
+
+def make_header(args: argparse.Namespace, jump: List[int], fall: List[int]) -> str:
+    return (
+        "// Generated by physc.py - do not edit.\n"
+        "#pragma once\n\n"
+        "#include <stdint.h>\n\n"
+        f"#define PHYS_BODY_W        {args.body_w}\n"
+        f"#define PHYS_BODY_H        {args.body_h}\n"
+        f"#define PHYS_SPRITE_OFS_X  {args.sprite_ofs_x}\n"
+        f"#define PHYS_SPRITE_OFS_Y  {args.sprite_ofs_y}\n"
+        f"#define PHYS_WALK_VX       {fx(args.walk)}\n"
+        f"#define PHYS_CLIMB_VY      {fx(args.climb)}\n"
+        f"#define PHYS_SWIM_VY       {fx(args.swim)}\n"
+        f"#define PHYS_JUMP_FRAMES   {len(jump)}\n"
+        f"#define PHYS_FALL_FRAMES   {len(fall)}\n\n"
+        + emit_array("phys_jump_vy", jump)
+        + "\n"
+        + emit_array("phys_fall_vy", fall)
+    )
+
+
+def make_sym(args: argparse.Namespace, jump: List[int], fall: List[int]) -> str:
+    lines = [
+        f"BODY w={args.body_w} h={args.body_h} sprite_ofs={args.sprite_ofs_x},{args.sprite_ofs_y}",
+        f"WALK vx=${fx(args.walk):04X} CLIMB vy=${fx(args.climb):04X} SWIM vy=${fx(args.swim):04X}",
+        f"JUMP frames={len(jump)} height={-sum(jump) / 256.0:.2f}px",
+    ]
+    h = 0
+    for t, v in enumerate(jump):
+        h -= v
+        lines.append(f"  [{t:2d}] vy={v:6d} h={h / 256.0:6.2f}")
+    lines.append(f"FALL frames={len(fall)} terminal={fall[-1] / 256.0:.2f}px/f")
+    d = 0
+    for t, v in enumerate(fall):
+        d += v
+        lines.append(f"  [{t:2d}] vy={v:6d} d={d / 256.0:6.2f}")
+    # Level design hint: widest gap crossable by a running jump back to the same height.
+    air = len(jump) * 2
+    lines.append(f"REACH up={-sum(jump) // 256}px gap={air * fx(args.walk) // 256}px")
+    return "\n".join(lines) + "\n"
+
+
+def validate(args: argparse.Namespace, jump: List[int], fall: List[int]) -> List[str]:
+    errs: List[str] = []
+    if not (1 <= args.body_w <= MAX_BODY_PX) or not (1 <= args.body_h <= MAX_BODY_PX):
+        errs.append(f"body must be 1..{MAX_BODY_PX} px on each axis")
+    if args.gravity <= 0 or args.jump_height <= 0 or args.terminal <= 0:
+        errs.append("gravity, jump height and terminal velocity must be positive")
+        return errs
+    for name, v in (("walk", fx(args.walk)), ("climb", fx(args.climb)), ("swim", fx(args.swim))):
+        if not (0 < v <= MAX_STEP_FX):
+            errs.append(f"{name} speed must be in (0, {TILE_PX}) px/frame")
+    if jump and max(-v for v in jump) > MAX_STEP_FX:
+        errs.append("jump take-off speed reaches a full tile per frame; lower --jump-height or raise --gravity")
+    if fall and fall[-1] > MAX_STEP_FX:
+        errs.append(f"terminal velocity must be below {TILE_PX} px/frame")
+    if len(jump) > 255 or len(fall) > 255:
+        errs.append("velocity tables exceed 255 frames")
+    return errs
+
+
+def main() -> None:
+    ap = argparse.ArgumentParser()
+    ap.add_argument("-o", "--output", default="", help="Output physics_tables.h")
+    ap.add_argument("--sym", default="AUTO", help="Output .sym")
+    ap.add_argument("--jump-height", type=float, default=40.0, help="Jump apex in pixels")
+    ap.add_argument("--gravity", type=float, default=0.25, help="Gravity in px/frame^2")
+    ap.add_argument("--terminal", type=float, default=4.0, help="Terminal fall speed in px/frame")
+    ap.add_argument("--walk", type=float, default=1.25, help="Run speed in px/frame")
+    ap.add_argument("--climb", type=float, default=1.0, help="Ladder speed in px/frame")
+    ap.add_argument("--swim", type=float, default=0.5, help="Sink speed below the water line in px/frame")
+    ap.add_argument("--body-w", type=int, default=10, help="Collision box width in pixels")
+    ap.add_argument("--body-h", type=int, default=16, help="Collision box height in pixels")
+    ap.add_argument("--sprite-ofs-x", type=int, default=7, help="Box left edge inside the sprite")
+    ap.add_argument("--sprite-ofs-y", type=int, default=5, help="Box top edge inside the sprite")
+    args = ap.parse_args()
+
+    jump = jump_table(args.jump_height, args.gravity) if args.gravity > 0 and args.jump_height > 0 else []
+    fall = fall_table(args.gravity, args.terminal) if args.gravity > 0 and args.terminal > 0 else []
+    errs = validate(args, jump, fall)
+    if errs:
+        for e in errs:
+            print(f"physc: error: {e}", file=sys.stderr)
+        sys.exit(1)
+
+    project_root = os.path.abspath(os.path.join(os.path.dirname(__file__), ".."))
+    if not args.output:
+        args.output = os.path.join(GEN_ROOT, "include", "physics_tables.h")
+    if args.sym == "AUTO":
+        args.sym = os.path.join(ANALYSIS_ROOT, "physics.sym")
+    if not os.path.isabs(args.output):
+        args.output = os.path.join(project_root, args.output)
+    if args.sym and not os.path.isabs(args.sym):
+        args.sym = os.path.join(project_root, args.sym)
+
+    os.makedirs(os.path.dirname(args.output), exist_ok=True)
+    with open(args.output, "w", encoding="utf-8") as f:
+        f.write(make_header(args, jump, fall))
+    if args.sym:
+        os.makedirs(os.path.dirname(args.sym), exist_ok=True)
+        with open(args.sym, "w", encoding="utf-8") as f:
+            f.write(make_sym(args, jump, fall))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,929 @@
+#!/usr/bin/env python3
+"""
+puzzlecheck.py - Prove .lvl levels completable with a breadth-first search over game state.
+
+The checker compiles each level with levelc.py and interprets the resulting
+COND/ACT bytecode exactly like src/puzzle.c does, so what it proves is what
+the engine will run.
+
+State = current room + flag bitset + inventory bitset + tested var values
+(+ plate and companion bodies when a plate flag is tested), packed into a
+single int key so the visited set stays compact.
+
+Reports:
+  - shortest solution (sequence of interactions/room walks) to the goal
+  - softlocks: reachable states from which the goal can no longer be reached
+  - unreachable rooms and objects (cond never passes while the room is visited)
+  - ACT scripts that can never run
+
+Goal:
+  - LEVEL goal=<COND> in the .lvl (or --goal <COND>): the COND passes
+  - otherwise: operating any EXIT_TRIGGER object
+
+Pruning:
+  - flags never tested by a COND (or the goal) are write-only and dropped from the state
+  - vars never tested by VAREQ are dropped; breaker writes only try one value per
+    equivalence class (expected value, each VAREQ literal, one "other" value)
+  - plates whose flag is never tested are dropped, and with them the companion
+
+Plates and companion (room granularity, like objects):
+  - the player can step onto any plate of its room, or off it; walking out lifts it
+  - a FOLLOWing companion in the player's room can be led onto or off a plate,
+    and follows the player out of the room, lifting its plate
+  - after COMPANION STAY it keeps its room and plate; FOLLOW pulls it into the
+    player's room (off its plate when that is another room)
+
+Usage:
+  python tools/puzzlecheck.py                    ; all levels/*.lvl
+  python tools/puzzlecheck.py levels/boot_audit.lvl --json gen/analysis/levels/boot_audit.solve.json
+  python tools/puzzlecheck.py levels/boot_audit.lvl --campaign MET_MIRA=1,LOG_TAPES_FOUND=2
+"""
+
+from __future__ import annotations
+
+import argparse
+import json
+import os
+import sys
+import time
+from collections import deque
+from dataclasses import dataclass, field
+from typing import Dict, List, Optional, Set, Tuple
+
+from levelc import (
+    A_CLR_FLAG,
+    A_CLR_FLAG_W,
+    A_COMPANION,
+    A_DIALOG,
+    A_END,
+    A_GIVE_ITEM,
+    A_SET_FLAG,
+    A_SET_FLAG_W,
+    A_SET_VAR,
+    A_SET_VAR_C,
+    A_TAKE_ITEM,
+    A_TRANSITION,
+    C_END,
+    C_FLAG_CLR,
+    C_FLAG_CLR_W,
+    C_FLAG_SET,
+    C_FLAG_SET_W,
+    C_HAS_ITEM,
+    C_TRUE,
+    C_VAR_EQ,
+    C_VAR_EQ_C,
+    COMPANION_MODES,
+    COMPANION_NONE,
+    DIALOG_CHOICE_SIZE,
+    DIALOG_END,
+    FLAG_WIDE_CAMPAIGN,
+    HDR_OFS_ACTSTREAM,
+    HDR_OFS_COMPANION_ROOM,
+    HDR_OFS_CONDSTREAM,
+    HDR_OFS_DIALOGS,
+    HDR_OFS_FLAGCOUNT,
+    HDR_OFS_ROUTES,
+    ROUTE_EDGE_INVERT,
+    ROUTE_EDGE_ONEWAY,
+    VERB_BITS,
+    ErrorCollector,
+    compile_level,
+    parse_lvltext,
+)
+
+# Keep in sync with src/inventory.c
+INVENTORY_MAX = 8
+
+GOAL = -1  # sentinel successor for "level complete"
+
+# Campaign vars are keyed after every possible level var id.
+CAMPAIGN_VAR_BASE = 0x100
+
+# Bodies field: player plate | companion plate << 8 | companion room << 16 | FOLLOW << 24,
+# plates numbered from 1 (0 = not on a plate).
+BODY_COMP_PLATE = 8
+BODY_COMP_ROOM = 16
+BODY_FOLLOW = 1 << 24
+
+
+# ----------------------------
+# Data models
+# ----------------------------
+
+
+@dataclass
+class Interaction:
+    room: int
+    obj_index: int
+    obj_name: str
+    label: str
+    cond_ofs: int
+    act_ofs: int
+    item: Optional[int] = None  # None: no item, -1: any held item, else required item id
+    var_write: Optional[Tuple[int, List[int]]] = None  # (var_id, candidate values) written before the script
+    is_exit: bool = False
+
+
+@dataclass
+class DialogNode:
+    next: int  # node after Fire when there are no choices; DIALOG_END closes
+    choices: List[Tuple[str, int, int, int]]  # (label msg name, cond, act, next node)
+
+
+@dataclass
+class LevelModel:
+    name: str
+    path: str
+    line_no: int
+    blob: bytes
+    cond_base: int
+    act_base: int
+    room_names: List[str]
+    room_exits: List[List[int]]
+    interactions: List[List[Interaction]]
+    objects: List[List[Tuple[str, int]]]  # per room: (name, cond_ofs)
+    flag_names: List[str]  # level flags, then campaign flags
+    var_names: List[str]
+    item_names: List[str]
+    act_names: Dict[int, str]
+    start_room: int
+    goal_cond: Optional[int] = None
+    goal_label: str = ""
+    level_flags: int = 0
+    live_flags: int = 0
+    live_vars: List[int] = field(default_factory=list)
+    var_tests: Dict[int, Set[int]] = field(default_factory=dict)
+    routes: List["Route"] = field(default_factory=list)
+    route_flags: int = 0  # REACH flags, recomputed after every script
+    plates: List[Tuple[int, str, int]] = field(default_factory=list)  # (room, "x,y", flag) of live plates
+    companion_room: int = COMPANION_NONE  # start room; COMPANION_NONE when absent or no live plate
+    start_flags: int = 0  # campaign flags carried in from earlier levels (--campaign)
+    start_vars: Dict[int, int] = field(default_factory=dict)  # var id (campaign: CAMPAIGN_VAR_BASE + n) -> value
+    campaign_reads: List[str] = field(default_factory=list)  # campaign flags/vars some COND tests
+    dialogs: Dict[int, DialogNode] = field(default_factory=dict)  # node offset -> node, for nodes an ACT opens
+
+
+@dataclass
+class Route:
+    fixed: List[int]
+    edges: List[Tuple[int, int, int, bool, bool]]  # (flag, from, to, invert, oneway)
+    reaches: List[Tuple[int, int, int]]  # (from, to, flag)
+
+
+@dataclass
+class CheckResult:
+    name: str
+    completable: bool
+    solution: List[str]
+    states: int
+    edges: int
+    softlocks: int
+    softlock_path: List[str]
+    unreachable_rooms: List[str]
+    unreachable_objects: List[str]
+    dead_scripts: List[str]
+    pruned_flags: List[str]
+    seconds: float
+    truncated: bool
+
+
+# ----------------------------
+# Bytecode helpers
+# ----------------------------
+
+
+# Wide (campaign) ops -> the plain op the interpreter below handles.
+_COND_WIDE = {C_FLAG_SET_W: C_FLAG_SET, C_FLAG_CLR_W: C_FLAG_CLR, C_VAR_EQ_C: C_VAR_EQ}
+_ACT_WIDE = {A_SET_FLAG_W: A_SET_FLAG, A_CLR_FLAG_W: A_CLR_FLAG, A_SET_VAR_C: A_SET_VAR}
+
+
+def _script_ops(blob: bytes, base: int, end_op: int, wide: Optional[Dict[int, int]] = None, level_flags: int = 0):
+    """Yield (op, a, b); with `wide`, campaign flags map to bit level_flags+n and vars to CAMPAIGN_VAR_BASE+n."""
+    ofs = base
+    while ofs + 2 < len(blob):
+        op, a, b = blob[ofs], blob[ofs + 1], blob[ofs + 2]
+        if op == end_op:
+            return
+        if wide and op in wide:
+            if wide[op] in (C_VAR_EQ, A_SET_VAR):
+                a = CAMPAIGN_VAR_BASE + a
+            else:
+                fid = a | (b << 8)
+                a = level_flags + (fid & ~FLAG_WIDE_CAMPAIGN) if fid & FLAG_WIDE_CAMPAIGN else fid
+            op = wide[op]
+        yield op, a, b
+        ofs += 3
+
+
+def _rd16(blob: bytes, ofs: int) -> int:
+    return blob[ofs] | (blob[ofs + 1] << 8)
+
+
+def _read_dialogs(blob: bytes, act_roots: Set[int], act_base: int, msg_names: List[str]) -> Dict[int, DialogNode]:
+    """Every dialog node reachable from the given ACT offsets, through `next=` and choice ACTs."""
+    base = _rd16(blob, HDR_OFS_DIALOGS)
+    nodes: Dict[int, DialogNode] = {}
+    if not base:
+        return nodes
+    acts = list(act_roots)
+    seen_acts: Set[int] = set()
+    todo: List[int] = []
+    while acts or todo:
+        if acts:
+            ofs = acts.pop()
+            if ofs and ofs not in seen_acts:
+                seen_acts.add(ofs)
+                todo += [a | (b << 8) for op, a, b in _script_ops(blob, act_base + ofs, A_END) if op == A_DIALOG]
+            continue
+        node = todo.pop()
+        if node == DIALOG_END or node in nodes:
+            continue
+        p = base + node
+        choices = []
+        for i in range(blob[p + 1]):
+            c = p + 2 + i * DIALOG_CHOICE_SIZE
+            choices.append((msg_names[blob[c]], _rd16(blob, c + 1), _rd16(blob, c + 3), _rd16(blob, c + 5)))
+            acts.append(_rd16(blob, c + 3))
+            todo.append(_rd16(blob, c + 5))
+        nodes[node] = DialogNode(next=_rd16(blob, p + 2) if not choices else DIALOG_END, choices=choices)
+        todo.append(nodes[node].next)
+    return nodes
+
+
+def _read_routes(blob: bytes) -> List[Route]:
+    ofs = _rd16(blob, HDR_OFS_ROUTES)
+    if not ofs:
+        return []
+    count = blob[ofs]
+    p = ofs + 1 + blob[HDR_OFS_FLAGCOUNT]  # skip the per-flag switch masks
+    routes: List[Route] = []
+    for _ in range(count):
+        nodes, nedges, nreach = blob[p], blob[p + 1], blob[p + 2]
+        p += 3
+        fixed = list(blob[p:p + nodes])
+        p += nodes
+        edges = []
+        for _ in range(nedges):
+            flag, frm, to = blob[p], blob[p + 1], blob[p + 2]
+            edges.append((flag, frm & 0x07, to, bool(frm & ROUTE_EDGE_INVERT), bool(frm & ROUTE_EDGE_ONEWAY)))
+            p += 3
+        reaches = []
+        for _ in range(nreach):
+            reaches.append((blob[p], blob[p + 1], blob[p + 2]))
+            p += 3
+        routes.append(Route(fixed, edges, reaches))
+    return routes
+
+
+# ----------------------------
+# Model building
+# ----------------------------
+
+
+def build_model(
+    level, blob: bytes, debug: dict, path: str, goal_override: str = "", campaign: Optional[Dict[str, int]] = None
+) -> LevelModel:
+    room_names: List[str] = debug["rooms"]
+    room_ids: Dict[str, int] = debug["ids"]["rooms"]
+    act_offsets: Dict[str, int] = debug["act_offsets"]
+    cond_offsets: Dict[str, int] = debug["cond_offsets"]
+
+    model = LevelModel(
+        name=level.name,
+        path=path,
+        line_no=level.line_no,
+        blob=blob,
+        cond_base=_rd16(blob, HDR_OFS_CONDSTREAM),
+        act_base=_rd16(blob, HDR_OFS_ACTSTREAM),
+        room_names=room_names,
+        room_exits=[],
+        interactions=[],
+        objects=[],
+        flag_names=list(level.flags) + list(level.campaign_flags),
+        var_names=list(level.vars),
+        item_names=list(level.items),
+        act_names={ofs: name for name, ofs in act_offsets.items() if name != "NOOP"},
+        start_room=room_ids.get(level.start_room, 0),
+        level_flags=len(level.flags),
+        routes=_read_routes(blob),
+    )
+    for route in model.routes:
+        for _a, _b, flag in route.reaches:
+            model.route_flags |= 1 << flag
+
+    goal_name = goal_override or level.goal
+    if goal_name:
+        model.goal_cond = cond_offsets.get(goal_name)
+        model.goal_label = f"COND {goal_name}"
+
+    level_objs = [level.rooms[rid].objects for rid in room_names]
+    for r_idx, rs in enumerate(debug["room_sym"]):
+        model.room_exits.append([room_ids[dr] for (_e, dr, _ds) in rs["exits"] if dr in room_ids])
+        inters: List[Interaction] = []
+        objs: List[Tuple[str, int]] = []
+        for o_idx, o in enumerate(rs["objects"]):
+            objs.append((o["name"], o["ofs_conds"]))
+            verbs = o["verbs"]
+            tname = o["type_name"]
+
+            def add(label: str, act: int, **kw) -> None:
+                inters.append(
+                    Interaction(
+                        room=r_idx,
+                        obj_index=o_idx,
+                        obj_name=o["name"],
+                        label=f'{rs["rid"]}.{o["name"]} {label}',
+                        cond_ofs=o["ofs_conds"],
+                        act_ofs=act,
+                        **kw,
+                    )
+                )
+
+            # Engine routing (Approach A): type-specific outcomes replace the plain verb script.
+            if tname == "LOCKER_KEYPAD" and verbs & VERB_BITS["OPERATE"]:
+                add("OPERATE code=ok", o["ofs_alt0"])
+                add("OPERATE code=bad", o["ofs_alt1"])
+            elif tname == "BREAKER_PANEL" and verbs & VERB_BITS["OPERATE"]:
+                var_id, expect = o["p0"], o["p1"]
+                add(f"OPERATE bits={expect}", o["ofs_alt0"], var_write=(var_id, [expect]))
+                add("OPERATE bits=other", o["ofs_alt1"], var_write=(var_id, []))
+            elif tname == "EXIT_TRIGGER" and verbs & VERB_BITS["OPERATE"]:
+                add("OPERATE", o["ofs_op"], is_exit=True)
+            elif verbs & VERB_BITS["OPERATE"]:
+                add("OPERATE", o["ofs_op"])
+
+            if verbs & VERB_BITS["LOOK"]:
+                add("LOOK", o["ofs_look"])
+            if verbs & VERB_BITS["TAKE"]:
+                add("TAKE", o["ofs_take"])
+            if verbs & VERB_BITS["TALK"]:
+                add("TALK", o["ofs_talk"])
+            if verbs & VERB_BITS["USE"]:
+                if tname == "HATCH_PANEL":
+                    # fuse_item=/badge_item= pin the item; without them any held item is assumed to fit.
+                    props = level_objs[r_idx][o_idx].props
+                    if o["alt0"]:
+                        add("USE fuse", o["ofs_alt0"], item=o["p0"] if "fuse_item" in props else -1)
+                    if o["alt1"]:
+                        add("USE badge", o["ofs_alt1"], item=o["p1"] if "badge_item" in props else -1)
+                add("USE", o["ofs_use"], item=-1)
+        model.interactions.append(inters)
+        model.objects.append(objs)
+
+    act_roots = {it.act_ofs for room in model.interactions for it in room} | set(model.act_names)
+    model.dialogs = _read_dialogs(blob, act_roots, model.act_base, debug["msg_names"])
+
+    if model.goal_cond is None and not goal_name:
+        if any(i.is_exit for room in model.interactions for i in room):
+            model.goal_label = "EXIT_TRIGGER"
+
+    # Campaign state the level starts from; anything not given starts clear.
+    for name, value in (campaign or {}).items():
+        if name in level.campaign_flags and value:
+            model.start_flags |= 1 << (model.level_flags + level.campaign_flags.index(name))
+        elif name in level.campaign_vars:
+            model.start_vars[CAMPAIGN_VAR_BASE + level.campaign_vars.index(name)] = value
+
+    _compute_liveness(model)
+    model.start_flags &= model.live_flags
+
+    # Plates only matter through a tested flag; the companion only through plates.
+    flag_ids = {n: i for i, n in enumerate(model.flag_names)}
+    for r_idx, rs in enumerate(debug["room_sym"]):
+        for pl in rs.get("plates", []):
+            fid = flag_ids[pl["flag"]]
+            if model.live_flags >> fid & 1:
+                model.plates.append((r_idx, f'{pl["x"]},{pl["y"]}', fid))
+    if model.plates:
+        model.companion_room = blob[HDR_OFS_COMPANION_ROOM]
+    model.campaign_reads = [
+        n for i, n in enumerate(level.campaign_flags) if model.live_flags >> (model.level_flags + i) & 1
+    ] + [n for i, n in enumerate(level.campaign_vars) if CAMPAIGN_VAR_BASE + i in model.var_tests]
+    return model
+
+
+def _compute_liveness(model: LevelModel) -> None:
+    blob = model.blob
+    read_flags = 0
+    tested_vars: Dict[int, Set[int]] = {}
+
+    cond_roots: Set[int] = {c for room in model.objects for (_n, c) in room}
+    cond_roots |= {cond for node in model.dialogs.values() for (_m, cond, _a, _n) in node.choices}
+    if model.goal_cond is not None:
+        cond_roots.add(model.goal_cond)
+    for ofs in cond_roots:
+        if ofs == 0:
+            continue
+        for op, a, b in _script_ops(blob, model.cond_base + ofs, C_END, _COND_WIDE, model.level_flags):
+            if op in (C_FLAG_SET, C_FLAG_CLR):
+                read_flags |= 1 << a
+            elif op == C_VAR_EQ:
+                tested_vars.setdefault(a, set()).add(b)
+
+    # A live REACH flag keeps every switch of its route live.
+    for route in model.routes:
+        if any(read_flags >> flag & 1 for _a, _b, flag in route.reaches):
+            for flag, *_rest in route.edges:
+                read_flags |= 1 << flag
+
+    model.live_flags = read_flags
+    model.live_vars = sorted(tested_vars.keys())
+    model.var_tests = tested_vars
+
+    # Wrong breaker settings: one representative value per class the conditions can tell apart.
+    for room in model.interactions:
+        for it in room:
+            if it.var_write is None or it.var_write[1]:
+                continue
+            var_id = it.var_write[0]
+            expect = next(
+                o.var_write[1][0]
+                for o in room
+                if o.obj_index == it.obj_index and o.var_write and o.var_write[1]
+            )
+            tests = tested_vars.get(var_id, set())
+            values = sorted(v for v in tests if v <= 7 and v != expect)
+            # A BITS var whose tests cover every other 0..7 value has no spare class.
+            other = next((v for v in range(8) if v != expect and v not in tests), None)
+            if other is not None:
+                values.append(other)
+            it.var_write = (var_id, values)
+
+
+def route_update(model: LevelModel, flags: int) -> int:
+    """Recompute REACH flags from the switch flags (mirrors src/route.c)."""
+    if not model.routes:
+        return flags
+    flags &= ~model.route_flags
+    for route in model.routes:
+        adj = list(route.fixed)
+        for flag, a, b, invert, oneway in route.edges:
+            if bool(flags >> flag & 1) != invert:
+                adj[a] |= 1 << b
+                if not oneway:
+                    adj[b] |= 1 << a
+        reach = [row | (1 << i) for i, row in enumerate(adj)]
+        for k in range(len(reach)):
+            for i in range(len(reach)):
+                if reach[i] >> k & 1:
+                    reach[i] |= reach[k]
+        for a, b, flag in route.reaches:
+            if reach[a] >> b & 1:
+                flags |= 1 << flag
+    return flags & model.live_flags
+
+
+# ----------------------------
+# State packing
+# ----------------------------
+
+
+class StatePacker:
+    """Packs (room, flags, inventory, vars, bodies, open dialog node) into one int:
+    room:8 | dialog:16 | flags:F | items:I | vars:8*V | bodies."""
+
+    def __init__(self, model: LevelModel):
+        self.nflags = len(model.flag_names)
+        self.nitems = len(model.item_names)
+        self.var_slots = {v: i for i, v in enumerate(model.live_vars)}
+        self.flag_shift = 24
+        self.item_shift = self.flag_shift + self.nflags
+        self.var_shift = self.item_shift + self.nitems
+        self.body_shift = self.var_shift + 8 * len(self.var_slots)
+        self.flag_mask = (1 << self.nflags) - 1
+        self.item_mask = (1 << self.nitems) - 1
+
+    def pack(self, room: int, flags: int, items: int, vars_: Tuple[int, ...], bodies: int, dialog: int = 0) -> int:
+        key = room | (dialog << 8) | (flags << self.flag_shift) | (items << self.item_shift) | (bodies << self.body_shift)
+        shift = self.var_shift
+        for v in vars_:
+            key |= v << shift
+            shift += 8
+        return key
+
+    def unpack(self, key: int) -> Tuple[int, int, int, List[int], int, int]:
+        room = key & 0xFF
+        dialog = (key >> 8) & 0xFFFF
+        flags = (key >> self.flag_shift) & self.flag_mask
+        items = (key >> self.item_shift) & self.item_mask
+        vars_ = []
+        rest = key >> self.var_shift
+        for _ in self.var_slots:
+            vars_.append(rest & 0xFF)
+            rest >>= 8
+        return room, flags, items, vars_, rest, dialog
+
+
+# ----------------------------
+# Plates and companion (mirrors src/plate.c, src/companion.c)
+# ----------------------------
+
+
+def plate_set(model: LevelModel, flags: int, bodies: int, comp: bool, plate: int) -> Tuple[int, int]:
+    """Player (or companion) moves onto `plate` (0 = off any plate); returns (flags, bodies)."""
+    shift = BODY_COMP_PLATE if comp else 0
+    held = bodies >> shift & 0xFF
+    other = bodies >> (shift ^ BODY_COMP_PLATE) & 0xFF
+    if held == plate:
+        return flags, bodies
+    if held:
+        flag = model.plates[held - 1][2]
+        if not other or model.plates[other - 1][2] != flag:
+            flags &= ~(1 << flag)
+    if plate:
+        flags |= 1 << model.plates[plate - 1][2]
+    return flags, (bodies & ~(0xFF << shift)) | (plate << shift)
+
+
+def bodies_room_change(model: LevelModel, flags: int, bodies: int, dest: int) -> Tuple[int, int]:
+    """The player leaves for room `dest`: its plate lifts and a following companion comes along."""
+    flags, bodies = plate_set(model, flags, bodies, False, 0)
+    if bodies & BODY_FOLLOW:
+        flags, bodies = plate_set(model, flags, bodies, True, 0)
+        bodies = (bodies & ~(0xFF << BODY_COMP_ROOM)) | (dest << BODY_COMP_ROOM)
+    return flags, bodies
+
+
+# ----------------------------
+# Interpreter (mirrors src/puzzle.c)
+# ----------------------------
+
+
+class Machine:
+    def __init__(self, model: LevelModel, packer: StatePacker):
+        self.m = model
+        self.p = packer
+        self.cond_cache: Dict[Tuple[int, int, int, Tuple[int, ...]], bool] = {}
+        self.act_cache: Dict[
+            Tuple[int, int, int, int, Tuple[int, ...], int], Tuple[int, int, int, Tuple[int, ...], int, int]
+        ] = {}
+
+    def cond(self, ofs: int, flags: int, items: int, vars_: List[int]) -> bool:
+        if ofs == 0:
+            return True
+        key = (ofs, flags, items, tuple(vars_))
+        hit = self.cond_cache.get(key)
+        if hit is not None:
+            return hit
+        ok = True
+        for op, a, b in _script_ops(self.m.blob, self.m.cond_base + ofs, C_END, _COND_WIDE, self.m.level_flags):
+            if op == C_TRUE:
+                continue
+            if op == C_FLAG_SET:
+                ok = bool(flags >> a & 1)
+            elif op == C_FLAG_CLR:
+                ok = not (flags >> a & 1)
+            elif op == C_HAS_ITEM:
+                ok = bool(items >> a & 1)
+            elif op == C_VAR_EQ:
+                slot = self.p.var_slots.get(a)
+                ok = slot is not None and vars_[slot] == b
+            else:
+                ok = False
+            if not ok:
+                break
+        self.cond_cache[key] = ok
+        return ok
+
+    def act(self, ofs: int, room: int, flags: int, items: int, vars_: List[int], bodies: int):
+        key = (ofs, room, flags, items, tuple(vars_), bodies)
+        hit = self.act_cache.get(key)
+        if hit is not None:
+            return hit
+        vars_ = list(vars_)
+        start_room = room
+        dialog = DIALOG_END
+        if ofs != 0:
+            for op, a, b in _script_ops(self.m.blob, self.m.act_base + ofs, A_END, _ACT_WIDE, self.m.level_flags):
+                if op == A_SET_FLAG:
+                    flags |= (1 << a) & self.m.live_flags
+                elif op == A_CLR_FLAG:
+                    flags &= ~(1 << a)
+                elif op == A_GIVE_ITEM:
+                    if not (items >> a & 1) and bin(items).count("1") < INVENTORY_MAX:
+                        items |= 1 << a
+                elif op == A_TAKE_ITEM:
+                    items &= ~(1 << a)
+                elif op == A_SET_VAR:
+                    slot = self.p.var_slots.get(a)
+                    if slot is not None:
+                        vars_[slot] = b
+                elif op == A_TRANSITION:
+                    room = a
+                elif op == A_DIALOG:
+                    dialog = a | (b << 8)
+                elif op == A_COMPANION and self.m.companion_room != COMPANION_NONE:
+                    if a == COMPANION_MODES["FOLLOW"]:
+                        # The first crumb after FOLLOW is in the player's room.
+                        if bodies >> BODY_COMP_ROOM & 0xFF != room:
+                            flags, bodies = plate_set(self.m, flags, bodies, True, 0)
+                            bodies = (bodies & ~(0xFF << BODY_COMP_ROOM)) | (room << BODY_COMP_ROOM)
+                        bodies |= BODY_FOLLOW
+                    else:
+                        bodies &= ~BODY_FOLLOW
+        if room != start_room and self.m.plates:
+            flags, bodies = bodies_room_change(self.m, flags, bodies, room)
+        out = (room, route_update(self.m, flags), items, tuple(vars_), bodies, dialog)
+        self.act_cache[key] = out
+        return out
+
+
+# ----------------------------
+# Search
+# ----------------------------
+
+
+def check_level(model: LevelModel, max_states: int) -> CheckResult:
+    t0 = time.perf_counter()
+    packer = StatePacker(model)
+    mach = Machine(model, packer)
+
+    start_vars = tuple(model.start_vars.get(v, 0) for v in model.live_vars)
+    start_bodies = model.companion_room << BODY_COMP_ROOM if model.plates else 0
+    start = packer.pack(model.start_room, route_update(model, model.start_flags), 0, start_vars, start_bodies)
+    room_plates: Dict[int, List[int]] = {}
+    for p_idx, (p_room, _cell, _flag) in enumerate(model.plates, 1):
+        room_plates.setdefault(p_room, []).append(p_idx)
+    parent: Dict[int, Tuple[int, str]] = {start: (start, "")}
+    preds: Dict[int, List[int]] = {}
+    queue = deque([start])
+    goal_states: Set[int] = set()
+    first_goal: Optional[int] = None  # BFS reaches it first, so its path is a shortest one
+    seen_rooms: Set[int] = set()
+    seen_objs: Set[Tuple[int, int]] = set()
+    fired_acts: Set[int] = set()
+    edges = 0
+    truncated = False
+
+    def link(src: int, dst: int, label: str) -> None:
+        nonlocal edges
+        edges += 1
+        preds.setdefault(dst, []).append(src)
+        if dst not in parent:
+            parent[dst] = (src, label)
+            if dst != GOAL:
+                queue.append(dst)
+
+    while queue:
+        if len(parent) > max_states:
+            truncated = True
+            break
+        key = queue.popleft()
+        room, flags, items, vars_, bodies, dialog = packer.unpack(key)
+        seen_rooms.add(room)
+
+        if model.goal_cond is not None and mach.cond(model.goal_cond, flags, items, vars_):
+            goal_states.add(key)
+            if first_goal is None:
+                first_goal = key
+            continue
+
+        # An open dialog holds the player (mirrors src/dialog.c): only its Fire/choice moves apply.
+        if dialog != DIALOG_END:
+            node = model.dialogs[dialog]
+            if not node.choices:
+                link(key, packer.pack(room, flags, items, tuple(vars_), bodies, node.next), "dialog: continue")
+                continue
+            shown = [ch for ch in node.choices if mach.cond(ch[1], flags, items, vars_)]
+            if not shown:
+                link(key, packer.pack(room, flags, items, tuple(vars_), bodies), "dialog: no choice shown")
+            for msg, _cond, act, nxt_node in shown:
+                if act:
+                    fired_acts.add(act)
+                n_room, n_flags, n_items, n_vars, n_bodies, n_dialog = mach.act(act, room, flags, items, vars_, bodies)
+                if n_dialog == DIALOG_END:
+                    n_dialog = nxt_node
+                nxt = packer.pack(n_room, n_flags, n_items, n_vars, n_bodies, n_dialog)
+                if nxt != key:
+                    link(key, nxt, f"dialog > {msg}")
+            continue
+
+        for dest in model.room_exits[room]:
+            n_flags, n_bodies = flags, bodies
+            if model.plates:
+                n_flags, n_bodies = bodies_room_change(model, flags, bodies, dest)
+                n_flags = route_update(model, n_flags)
+            link(
+                key,
+                packer.pack(dest, n_flags, items, tuple(vars_), n_bodies),
+                f"walk {model.room_names[room]} -> {model.room_names[dest]}",
+            )
+
+        # Plates: the player, or the companion when it follows the player here.
+        escort = bodies & BODY_FOLLOW and bodies >> BODY_COMP_ROOM & 0xFF == room
+        moves = [(False, p, "step onto") for p in room_plates.get(room, ())]
+        moves += [(True, p, "lead companion onto") for p in room_plates.get(room, ()) if escort]
+        if bodies & 0xFF:
+            moves.append((False, 0, "step off"))
+        if escort and bodies >> BODY_COMP_PLATE & 0xFF:
+            moves.append((True, 0, "lead companion off"))
+        for comp, plate, verb in moves:
+            n_flags, n_bodies = plate_set(model, flags, bodies, comp, plate)
+            nxt = packer.pack(room, route_update(model, n_flags), items, tuple(vars_), n_bodies)
+            if nxt != key:
+                cell = model.plates[(plate or bodies >> (BODY_COMP_PLATE if comp else 0) & 0xFF) - 1][1]
+                link(key, nxt, f"{model.room_names[room]} {verb} plate {cell}")
+
+        for it in model.interactions[room]:
+            if not mach.cond(it.cond_ofs, flags, items, vars_):
+                continue
+            seen_objs.add((room, it.obj_index))
+            if it.item is not None and (items == 0 if it.item < 0 else not (items >> it.item & 1)):
+                continue
+            if it.act_ofs:
+                fired_acts.add(it.act_ofs)
+            if it.is_exit and model.goal_cond is None:
+                link(key, GOAL, it.label)
+                goal_states.add(GOAL)
+                if first_goal is None:
+                    first_goal = GOAL
+                continue
+            starts = [vars_]
+            if it.var_write is not None:
+                var_id, values = it.var_write
+                slot = packer.var_slots.get(var_id)
+                if slot is not None:
+                    starts = []
+                    for v in values:
+                        nv = list(vars_)
+                        nv[slot] = v
+                        starts.append(nv)
+            for sv in starts:
+                n_room, n_flags, n_items, n_vars, n_bodies, n_dialog = mach.act(
+                    it.act_ofs, room, flags, items, sv, bodies
+                )
+                nxt = packer.pack(n_room, n_flags, n_items, n_vars, n_bodies, n_dialog)
+                if nxt != key:
+                    link(key, nxt, it.label)
+
+    # Backward reachability from goal states -> everything else reachable is a softlock.
+    can_finish: Set[int] = set(goal_states)
+    back = deque(goal_states)
+    while back:
+        k = back.popleft()
+        for p in preds.get(k, ()):
+            if p not in can_finish:
+                can_finish.add(p)
+                back.append(p)
+
+    def path_to(k: int) -> List[str]:
+        steps: List[str] = []
+        while k != start:
+            k, label = parent[k]
+            steps.append(label)
+        steps.reverse()
+        return steps
+
+    completable = bool(goal_states)
+    solution = path_to(first_goal) if first_goal is not None else []
+
+    reachable = [k for k in parent if k != GOAL]
+    softlocked = [k for k in reachable if k not in can_finish] if completable and not truncated else []
+    softlock_path = path_to(min(softlocked, key=lambda k: len(path_to(k)))) if softlocked else []
+
+    unreachable_rooms = [model.room_names[r] for r in range(len(model.room_names)) if r not in seen_rooms]
+    unreachable_objects = [
+        f"{model.room_names[r]}.{name}"
+        for r, objs in enumerate(model.objects)
+        for o_idx, (name, _c) in enumerate(objs)
+        if (r, o_idx) not in seen_objs
+    ]
+    dead_scripts = sorted(name for ofs, name in model.act_names.items() if ofs not in fired_acts)
+    pruned_flags = [n for i, n in enumerate(model.flag_names) if not (model.live_flags >> i & 1)]
+
+    return CheckResult(
+        name=model.name,
+        completable=completable,
+        solution=solution,
+        states=len(reachable),
+        edges=edges,
+        softlocks=len(softlocked),
+        softlock_path=softlock_path,
+        unreachable_rooms=unreachable_rooms,
+        unreachable_objects=unreachable_objects,
+        dead_scripts=dead_scripts,
+        pruned_flags=pruned_flags,
+        seconds=time.perf_counter() - t0,
+        truncated=truncated,
+    )
+
+
+# ----------------------------
+# Reporting
+# ----------------------------
+
+
+def print_report(model: LevelModel, res: CheckResult) -> None:
+    path = os.path.abspath(model.path)
+    loc = f"{path}:{model.line_no}:1"
+    print(f'LEVEL "{res.name}" goal={model.goal_label or "NONE"}')
+    print(f"  states={res.states} edges={res.edges} time={res.seconds * 1000:.1f}ms")
+    if res.pruned_flags:
+        print(f"  pruned write-only flags: {', '.join(res.pruned_flags)}")
+    if res.truncated:
+        print(f"{loc}: warning: search stopped at {res.states} states (--max-states)")
+    if not model.goal_label:
+        print(f"{loc}: warning: no goal (add LEVEL goal=<COND> or an EXIT_TRIGGER object)")
+    elif res.completable:
+        print(f"  COMPLETABLE in {len(res.solution)} steps:")
+        for i, step in enumerate(res.solution, 1):
+            print(f"    {i:2d}. {step}")
+    elif not res.truncated:
+        print(f"{loc}: error: level is not completable ({model.goal_label} never reached)")
+        if model.campaign_reads:
+            print(f"{loc}: note: campaign state tested: {', '.join(model.campaign_reads)} (set with --campaign)")
+    if res.softlocks:
+        print(f"{loc}: warning: {res.softlocks} softlocked states; shortest route into one:")
+        for i, step in enumerate(res.softlock_path, 1):
+            print(f"    {i:2d}. {step}")
+    for r in res.unreachable_rooms:
+        print(f"{loc}: warning: room {r} is never reached")
+    for o in res.unreachable_objects:
+        print(f"{loc}: warning: object {o} is never interactable")
+    for s in res.dead_scripts:
+        print(f"{loc}: warning: ACT {s} can never run")
+
+
+# ----------------------------
+# CLI
+# ----------------------------
+
+
+def parse_campaign_arg(text: str) -> Dict[str, int]:
+    """NAME=VALUE,... -> {name: value}; a bare NAME means 1."""
+    out: Dict[str, int] = {}
+    for part in filter(None, (p.strip() for p in text.split(","))):
+        name, _eq, value = part.partition("=")
+        try:
+            out[name.strip()] = int(value, 0) if value else 1
+        except ValueError:
+            raise argparse.ArgumentTypeError(f"bad campaign value: {part}")
+        if not 0 <= out[name.strip()] <= 255:
+            raise argparse.ArgumentTypeError(f"campaign value out of range 0..255: {part}")
+    return out
+
+
+def main() -> None:
+    ap = argparse.ArgumentParser()
+    ap.add_argument("inputs", nargs="*", help="Input .lvl files (default: levels/*.lvl)")
+    ap.add_argument("--goal", default="", help="Override goal COND name")
+    ap.add_argument("--max-states", type=int, default=2_000_000, help="Abort search after N states")
+    ap.add_argument(
+        "--campaign",
+        type=parse_campaign_arg,
+        default={},
+        help="Campaign state at level start: FLAG=0|1,VAR=n,... (default: all clear)",
+    )
+    ap.add_argument("--json", default="", help="Write results to JSON (default: none)")
+    args = ap.parse_args()
+
+    project_root = os.path.abspath(os.path.join(os.path.dirname(__file__), ".."))
+    inputs = args.inputs
+    if not inputs:
+        levels_dir = os.path.join(project_root, "levels")
+        inputs = sorted(os.path.join(levels_dir, f) for f in os.listdir(levels_dir) if f.endswith(".lvl"))
+
+    failed = False
+    results = []
+    t_all = time.perf_counter()
+    for path in inputs:
+        errors = ErrorCollector(default_file=path)
+        level = parse_lvltext(path, errors)
+        if level is None:
+            errors.report_and_exit()
+        blob, _ids_h, debug = compile_level(level, errors)
+        errors.report_and_exit()
+        for name, value in args.campaign.items():
+            if name in level.campaign_flags and value > 1:
+                errors.add_error(f"--campaign {name}={value}: campaign flags are 0 or 1", line=level.line_no, col=1)
+            elif name not in level.campaign_flags and name not in level.campaign_vars:
+                errors.add_error(
+                    f"--campaign {name}: not a campaign flag or var of this level", line=level.line_no, col=1
+                )
+        errors.report_and_exit()
+
+        model = build_model(level, blob, debug, path, goal_override=args.goal, campaign=args.campaign)
+        res = check_level(model, args.max_states)
+        print_report(model, res)
+        print()
+        if model.goal_label and not res.completable:
+            failed = True
+        results.append(res.__dict__)
+
+    print(f"Checked {len(inputs)} level(s) in {(time.perf_counter() - t_all) * 1000:.1f}ms")
+
+    if args.json:
+        out = args.json
+        if not os.path.isabs(out):
+            out = os.path.join(project_root, out)
+        os.makedirs(os.path.dirname(out), exist_ok=True)
+        with open(out, "w", encoding="utf-8") as f:
+            json.dump(results, f, indent=2)
+        print(f"Wrote {out}")
+
+    if failed:
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
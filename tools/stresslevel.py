@@ -0,0 +1,425 @@
+#!/usr/bin/env python3
+"""
+stresslevel.py - Synthetic .lvl/.tset generator + toolchain scaling benchmark.
+
+Generates a valid tileset, campaign file and level at a configurable scale
+(rooms, objects, flags, script length, tiles). Scripts use every COND op and
+every ACT op except PARTICLES and DIALOG (no tset PARTICLES or DIALOG
+blocks are generated); campaign names compile to the wide ops. The
+companion waits in R0. Every object type is placed. In --bench mode it
+sweeps room counts and records, per step: tilesetc/levelc compile time,
+blob size, and runtime lookup cost measured by the host harness in
+tools/bench/lvl_bench.c (built with the host C compiler).
+
+Outputs (default under gen/stress/):
+  - stress.tset / stress.cmp / stress.lvl  Generated sources
+  - build/                         levelc/tilesetc outputs (--bench)
+  - gen/analysis/stress/bench.json Scaling curve (--bench)
+
+Usage:
+  python tools/stresslevel.py --rooms 64 --objects 12 --flags 255
+  python tools/stresslevel.py --bench 4,16,64,128,255 --objects 8
+  python tools/stresslevel.py --bench 64,255 --segmented
+
+Notes:
+- Generation is deterministic for a given --seed.
+- LVL1 limits (255 rooms, u16 offsets) are not enforced here; levelc reports
+  them. --bench then recompiles the step with levelc --segmented (LVL2) and
+  runs the harness on every segment; --segmented compiles every step as LVL2.
+"""
+
+from __future__ import annotations
+import argparse
+import json
+import os
+import random
+import shutil
+import subprocess
+import sys
+import time
+from dataclasses import dataclass
+from typing import Dict, List, Optional
+
+from gen_paths import GEN_ROOT, ANALYSIS_ROOT
+
+
+# ----------------------------
+# Scale parameters
+# ----------------------------
+
+
+@dataclass
+class StressParams:
+    rooms: int = 16
+    objects: int = 8  # per room
+    flags: int = 255
+    vars: int = 32
+    campaign_flags: int = 64  # 0 = no campaign file
+    campaign_vars: int = 16
+    items: int = 32
+    messages: int = 200
+    conds: int = 64
+    acts: int = 128
+    script_len: int = 16  # ops per script
+    tiles: int = 255
+    w: int = 20
+    h: int = 12
+    seed: int = 1
+
+
+# Printable map chars; ';' starts a comment and ' ' is a separator.
+MAP_CHARS = [chr(c) for c in range(0x21, 0x7F) if chr(c) not in ";\"="]
+
+TILE_FLAG_SETS = ["SOLID", "SOLID|FLOOR", "DECOR", "STANDABLE|FLOOR", "LADDER", "DOOR", "INTERACTABLE", "HAZARD|DECOR"]
+COLOR_NAMES = ["BLACK", "WHITE", "RED", "CYAN", "PURPLE", "GREEN", "BLUE", "YELLOW"]
+
+WORDS = ["RELAY", "FUSE", "HATCH", "BADGE", "LOCKER", "TAPE", "PANEL", "VENT", "POWER", "AUDIT", "GRID", "CODE"]
+
+
+# ----------------------------
+# Generators
+# ----------------------------
+
+
+def gen_tset(p: StressParams, rng: random.Random) -> str:
+    out = [
+        "; Auto-generated by stresslevel.py\n\n",
+        'TSET name="stress" tileSize=2x2 bgColor=BLACK mc1Color=GREY mc2Color=WHITE\n\n',
+        "TILES\n",
+    ]
+    for t in range(p.tiles):
+        chars = ",".join(f"0x{rng.randrange(256):02X}" for _ in range(4))
+        colors = ",".join(rng.choice(COLOR_NAMES) for _ in range(4))
+        flags = TILE_FLAG_SETS[t % len(TILE_FLAG_SETS)]
+        out.append(f"T{t:03d} chars={chars} colors={colors} flags={flags}\n")
+    out.append("END\n")
+    return "".join(out)
+
+
+def _cond_lines(p: StressParams, idx: int) -> List[str]:
+    ops = []
+    for k in range(p.script_len):
+        n = idx * p.script_len + k
+        kind = n % 7
+        if kind == 0:
+            ops.append(f"FLAGSET F{n % p.flags:03d}")
+        elif kind == 1:
+            ops.append(f"FLAGCLR F{(n * 7) % p.flags:03d}")
+        elif kind == 2:
+            ops.append(f"HAS I{n % p.items:02d}")
+        elif kind == 3:
+            ops.append(f"VAREQ V{n % p.vars:02d} {n & 7}")
+        elif kind == 4 and p.campaign_flags:
+            ops.append(f"{'FLAGSET' if n & 8 else 'FLAGCLR'} CF{n % p.campaign_flags:03d}")
+        elif kind == 5 and p.campaign_vars:
+            ops.append(f"VAREQ CV{n % p.campaign_vars:02d} {n & 7}")
+        else:
+            ops.append("TRUE")
+    return ops
+
+
+def _act_lines(p: StressParams, idx: int) -> List[str]:
+    ops = []
+    for k in range(p.script_len - 1):
+        n = idx * p.script_len + k
+        kind = n % 10
+        if kind == 0:
+            ops.append(f"MSG M{n % p.messages:03d}")
+        elif kind == 1:
+            ops.append(f"SETFLAG F{n % p.flags:03d}")
+        elif kind == 2:
+            ops.append(f"CLRFLAG F{(n * 3) % p.flags:03d}")
+        elif kind == 3:
+            ops.append(f"GIVE I{n % p.items:02d}")
+        elif kind == 4:
+            ops.append(f"TAKE I{(n + 1) % p.items:02d}")
+        elif kind == 5:
+            ops.append(f"SETVAR V{n % p.vars:02d} {n & 7}")
+        elif kind == 6 and p.campaign_flags:
+            ops.append(f"{'SETFLAG' if n & 8 else 'CLRFLAG'} CF{(n * 3) % p.campaign_flags:03d}")
+        elif kind == 7 and p.campaign_vars:
+            ops.append(f"SETVAR CV{n % p.campaign_vars:02d} {n & 7}")
+        elif kind == 8:
+            ops.append(f"COMPANION {'FOLLOW' if n & 8 else 'STAY'}")
+        else:
+            ops.append(f"SFX {n & 0xFF}")
+    # Every other script ends in a room change
+    if idx % 2 == 0:
+        ops.append(f"TRANSITION R{idx % p.rooms} S0")
+    else:
+        ops.append(f"MSG M{idx % p.messages:03d}")
+    return ops
+
+
+def _object_line(p: StressParams, name: str, x: int, y: int, n: int) -> str:
+    cond = f"C{n % p.conds:03d}"
+    a = [f"A{(n + k) % p.acts:03d}" for k in range(3)]
+    kind = n % 7
+    if kind == 0:
+        return f"{name} at {x},{y} type=SIGN verbs=LOOK look={a[0]} cond={cond}"
+    if kind == 1:
+        return f"{name} at {x},{y} type=PICKUP verbs=LOOK|TAKE item=I{n % p.items:02d} look={a[0]} take={a[1]} cond={cond}"
+    if kind == 2:
+        return f"{name} at {x},{y} type=LOCKER_KEYPAD verbs=OPERATE code={n % 1000} ok={a[0]} bad={a[1]} cond={cond}"
+    if kind == 3:
+        return f"{name} at {x},{y} type=BREAKER_PANEL verbs=OPERATE var=V{n % p.vars:02d} expect={n & 7} ok={a[0]} bad={a[1]} cond={cond}"
+    if kind == 4:
+        return (
+            f"{name} at {x},{y} type=HATCH_PANEL verbs=LOOK|USE fuse_item=I{n % p.items:02d} "
+            f"badge_item=I{(n + 1) % p.items:02d} fuse={a[0]} badge={a[1]} reject={a[2]} cond={cond}"
+        )
+    if kind == 5:
+        return f"{name} at {x},{y} type=EXIT_TRIGGER verbs=OPERATE operate={a[0]} cond={cond}"
+    return f"{name} at {x},{y} type=NPC_INTERCOM verbs=TALK|LOOK talk={a[0]} look={a[1]} cond={cond}"
+
+
+def gen_campaign(p: StressParams) -> str:
+    out = ["; Auto-generated by stresslevel.py\n\nFLAGS\n"]
+    out += [f"  CF{i:03d}\n" for i in range(p.campaign_flags)]
+    out.append("END\n\nVARS\n")
+    out += [f"  CV{i:02d}\n" for i in range(p.campaign_vars)]
+    out.append("END\n")
+    return "".join(out)
+
+
+def gen_lvl(p: StressParams, rng: random.Random, tset_name: str, campaign_name: str = "") -> str:
+    chars = MAP_CHARS[: min(p.tiles, len(MAP_CHARS))]
+    wall, floor = chars[0], chars[1 % len(chars)]
+    campaign = f" campaign={campaign_name}" if campaign_name else ""
+    out = [
+        "; Auto-generated by stresslevel.py\n\n",
+        f'LEVEL name="STRESS" w={p.w} h={p.h} start=R0:S0 tset={tset_name} goal=C000 companion=R0:S1{campaign}\n\n',
+        "TILES\n",
+    ]
+    for i, ch in enumerate(chars):
+        out.append(f"  {ch} T{i:03d}\n")
+    out.append("END\n\nFLAGS\n")
+    out += [f"  F{i:03d}\n" for i in range(p.flags)]
+    out.append("END\n\nVARS\n")
+    out += [f"  V{i:02d}\n" for i in range(p.vars)]
+    out.append("END\n\nITEMS\n")
+    out += [f"  I{i:02d}\n" for i in range(p.items)]
+    out.append("END\n\nMESSAGES\n")
+    for i in range(p.messages):
+        text = " ".join(rng.choice(WORDS) for _ in range(1 + i % 6))[:38]
+        out.append(f'  M{i:03d} = "{text}"\n')
+    out.append("END\n\n")
+    for i in range(p.conds):
+        out.append(f"COND C{i:03d}\n" + "".join(f"  {ln}\n" for ln in _cond_lines(p, i)) + "END\n\n")
+    for i in range(p.acts):
+        out.append(f"ACT A{i:03d}\n" + "".join(f"  {ln}\n" for ln in _act_lines(p, i)) + "END\n\n")
+
+    # Object slots: interior cells, one object per cell
+    slots = [(x, y) for y in range(1, p.h - 1) for x in range(1, p.w - 1)]
+    for r in range(p.rooms):
+        out.append(f'ROOM R{r} name="STRESS {r}"\n')
+        out.append(f"  SPAWNS\n    S0 1,{p.h // 2}\n    S1 {p.w - 2},{p.h // 2}\n  END\n")
+        out.append("  EXITS\n")
+        out.append(f"    L R{(r - 1) % p.rooms}:S1\n")
+        out.append(f"    R R{(r + 1) % p.rooms}:S0\n")
+        out.append("  END\n  OBJECTS\n")
+        for o, (x, y) in enumerate(rng.sample(slots, min(p.objects, len(slots)))):
+            out.append("    " + _object_line(p, f"O{o}", x, y, r * p.objects + o) + "\n")
+        out.append("  END\n  MAP\n")
+        for y in range(p.h):
+            if y in (0, p.h - 1):
+                row = wall * p.w
+            else:
+                row = wall + "".join(rng.choice(chars) if rng.random() < 0.2 else floor for _ in range(p.w - 2)) + wall
+            out.append(f"    {row}\n")
+        out.append("  END\nENDROOM\n\n")
+    return "".join(out)
+
+
+def write_sources(p: StressParams, out_dir: str) -> Dict[str, str]:
+    rng = random.Random(p.seed)
+    os.makedirs(out_dir, exist_ok=True)
+    tset_path = os.path.join(out_dir, "stress.tset")
+    cmp_path = os.path.join(out_dir, "stress.cmp")
+    lvl_path = os.path.join(out_dir, "stress.lvl")
+    with open(tset_path, "w", encoding="utf-8") as f:
+        f.write(gen_tset(p, rng))
+    campaign_name = ""
+    if p.campaign_flags or p.campaign_vars:
+        with open(cmp_path, "w", encoding="utf-8") as f:
+            f.write(gen_campaign(p))
+        campaign_name = "stress.cmp"
+    with open(lvl_path, "w", encoding="utf-8") as f:
+        f.write(gen_lvl(p, rng, "stress.tset", campaign_name))
+    return {"tset": tset_path, "cmp": cmp_path if campaign_name else "", "lvl": lvl_path}
+
+
+# ----------------------------
+# Benchmark
+# ----------------------------
+
+
+def _timed(cmd: List[str]) -> Dict[str, object]:
+    t0 = time.perf_counter()
+    proc = subprocess.run(cmd, capture_output=True, text=True)
+    dt = time.perf_counter() - t0
+    errors = [ln for ln in proc.stderr.splitlines() if ": error: " in ln]
+    return {"ok": proc.returncode == 0, "seconds": round(dt, 4), "errors": errors[:5]}
+
+
+def build_harness(tools_dir: str, project_root: str, out_dir: str) -> Optional[str]:
+    cc = os.environ.get("CC") or shutil.which("cc") or shutil.which("gcc") or shutil.which("clang")
+    if not cc:
+        print("warning: no host C compiler found; skipping runtime lookup benchmark", file=sys.stderr)
+        return None
+    os.makedirs(out_dir, exist_ok=True)
+    exe = os.path.join(out_dir, "lvl_bench")
+    src = os.path.join(tools_dir, "bench", "lvl_bench.c")
+    cmd = [cc, "-O2", "-I", os.path.join(project_root, "include"), "-o", exe, src]
+    proc = subprocess.run(cmd, capture_output=True, text=True)
+    if proc.returncode != 0:
+        print(f"warning: harness build failed:\n{proc.stderr}", file=sys.stderr)
+        return None
+    return exe
+
+
+def _run_harness(harness: str, bins: List[str]) -> Dict[str, object]:
+    """Harness result for one LVL1 blob; for LVL2 segments the slowest segment per ns_* figure."""
+    runs = []
+    for path in bins:
+        proc = subprocess.run([harness, path], capture_output=True, text=True)
+        if proc.returncode != 0:
+            return {"runtime_error": f"{os.path.basename(path)}: {proc.stderr.strip()}"}
+        runs.append(json.loads(proc.stdout))
+    if len(runs) == 1:
+        return {"runtime": runs[0]}
+    worst = {k: max(r[k] for r in runs) for k in runs[0] if k.startswith("ns_")}
+    return {"runtime": worst, "runtime_segments": runs}
+
+
+def run_bench(
+    p: StressParams, room_steps: List[int], out_dir: str, project_root: str, segmented: bool = False
+) -> List[dict]:
+    tools_dir = os.path.dirname(os.path.abspath(__file__))
+    harness = build_harness(tools_dir, project_root, out_dir)
+    results: List[dict] = []
+
+    for rooms in room_steps:
+        step = StressParams(**{**p.__dict__, "rooms": rooms})
+        step_dir = os.path.join(out_dir, f"rooms_{rooms}")
+        src = write_sources(step, step_dir)
+        build = os.path.join(step_dir, "build")
+
+        tset_bin = os.path.join(build, "stress_tset.bin")
+        tset = _timed(
+            [
+                sys.executable,
+                os.path.join(tools_dir, "tilesetc.py"),
+                src["tset"],
+                "-o", tset_bin,
+                "--ids", os.path.join(build, "stress_tset_ids.h"),
+                "--blob-h", os.path.join(build, "stress_tset-blob.h"),
+                "--blob-c", os.path.join(build, "stress_tset.c"),
+                "--sym", os.path.join(build, "stress_tset.sym"),
+                "--json", os.path.join(build, "stress_tset.json"),
+            ]
+        )
+        def levelc(out: str, *extra: str) -> Dict[str, object]:
+            return _timed(
+                [
+                    sys.executable,
+                    os.path.join(tools_dir, "levelc.py"),
+                    src["lvl"],
+                    "--keep-unused",
+                    *extra,
+                    "--out-assets", out,
+                    "--out-src", out,
+                    "--out-include", out,
+                    "--out-debug", out,
+                ]
+            )
+
+        # LVL1 first; a step past its limits is measured as LVL2 instead.
+        lvl = {"ok": False, "errors": []} if segmented else levelc(build)
+        lvl1_errors = lvl["errors"]
+        fmt = "LVL1"
+        if not lvl["ok"]:
+            build = os.path.join(build, "lvl2")
+            lvl = levelc(build, "--segmented")
+            fmt = "LVL2"
+        lvl_bin = os.path.join(build, "stress.bin")
+        bins = [lvl_bin]
+        if fmt == "LVL2" and lvl["ok"]:
+            bins = sorted(
+                os.path.join(build, f) for f in os.listdir(build) if f.startswith("stress_s") and f.endswith(".bin")
+            )
+        row = {
+            "rooms": rooms,
+            "objects": rooms * step.objects,
+            "format": fmt,
+            "tilesetc": tset,
+            "levelc": lvl,
+            "tset_size": os.path.getsize(tset_bin) if tset["ok"] else None,
+            # LVL2: resident index plus every segment
+            "blob_size": sum(os.path.getsize(b) for b in set(bins + [lvl_bin])) if lvl["ok"] else None,
+        }
+        if fmt == "LVL2":
+            row["segments"] = len(bins) if lvl["ok"] else None
+            row["lvl1_errors"] = lvl1_errors
+        if harness and lvl["ok"]:
+            row.update(_run_harness(harness, bins))
+        results.append(row)
+
+        rt = row.get("runtime", {})
+        print(
+            f"rooms={rooms:4d} objs={row['objects']:6d} {fmt}"
+            f"{'x' + str(row['segments']) if row.get('segments') else '':<4} "
+            f"levelc={lvl['seconds']:7.3f}s tilesetc={tset['seconds']:6.3f}s "
+            f"blob={row['blob_size'] if row['blob_size'] is not None else 'FAIL':>6} "
+            f"room_load={rt.get('ns_room_load', '-')}ns obj_find={rt.get('ns_object_find', '-')}ns "
+            f"act_walk={rt.get('ns_act_walk', '-')}ns"
+        )
+        for e in lvl["errors"]:
+            print(f"    {e}")
+    return results
+
+
+# ----------------------------
+# CLI
+# ----------------------------
+
+
+def main():
+    ap = argparse.ArgumentParser(description="Generate synthetic stress levels and benchmark the toolchain")
+    defaults = StressParams()
+    for key, val in defaults.__dict__.items():
+        ap.add_argument(f"--{key.replace('_', '-')}", type=int, default=val, help=f"(default {val})")
+    ap.add_argument("--out", default=os.path.join(GEN_ROOT, "stress"), help="Output directory")
+    ap.add_argument("--bench", default="", help="Comma-separated room counts to sweep (e.g. 4,16,64,255)")
+    ap.add_argument("--segmented", action="store_true", help="Compile every --bench step as LVL2 (levelc --segmented)")
+    ap.add_argument(
+        "--bench-json",
+        default=os.path.join(ANALYSIS_ROOT, "stress", "bench.json"),
+        help="Benchmark results (.json)",
+    )
+    args = ap.parse_args()
+    project_root = os.path.abspath(os.path.join(os.path.dirname(__file__), ".."))
+
+    params = StressParams(**{k: getattr(args, k) for k in defaults.__dict__})
+    out_dir = args.out if os.path.isabs(args.out) else os.path.join(project_root, args.out)
+
+    if not args.bench:
+        src = write_sources(params, out_dir)
+        print(f"Wrote {src['tset']}")
+        if src["cmp"]:
+            print(f"Wrote {src['cmp']}")
+        print(f"Wrote {src['lvl']}")
+        return
+
+    steps = [int(s) for s in args.bench.split(",") if s.strip()]
+    results = run_bench(params, steps, out_dir, project_root, args.segmented)
+
+    bench_json = args.bench_json if os.path.isabs(args.bench_json) else os.path.join(project_root, args.bench_json)
+    os.makedirs(os.path.dirname(bench_json), exist_ok=True)
+    with open(bench_json, "w", encoding="utf-8") as f:
+        json.dump({"params": params.__dict__, "steps": results}, f, indent=2)
+    print(f"Wrote {bench_json}")
+
+
+if __name__ == "__main__":
+    main()
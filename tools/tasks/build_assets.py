@@ -1,6 +1,7 @@
 #!/usr/bin/env python3
 """
-build_assets.py - Build tileset + all levels in one pass.
+build_assets.py - Build physics tables, tileset, all levels and the tools/fixtures
+feature fixtures in one pass.
 
 Usage:
   python tools/tasks/build_assets.py
@@ -55,8 +56,12 @@ def main() -> None:
 
     tilesetc = root / "tools" / "tilesetc.py"
     levelc = root / "tools" / "levelc.py"
+    physc = root / "tools" / "physc.py"
     gen_build = root / "tools" / "tasks" / "gen_build.py"
 
+    # Build player physics tables (jump/fall curves)
+    run([sys.executable, str(physc)])
+
     # Build tileset blob + ids header
     run([sys.executable, str(tilesetc), str(tset_path)])
 
@@ -68,6 +73,31 @@ def main() -> None:
     for lvl in lvl_files:
         run([sys.executable, str(levelc), str(lvl)])
 
+    # Feature fixtures (tools/fixtures): built under gen/fixtures, outside the game sources.
+    fixtures_dir = root / "tools" / "fixtures"
+    fix_root = gen_root / "fixtures"
+    for tset in sorted(fixtures_dir.glob("*.tset")):
+        name = tset.stem
+        run([
+            sys.executable, str(tilesetc), str(tset),
+            "-o", str(fix_root / "assets" / f"{name}.bin"),
+            "--ids", str(fix_root / "include" / "tilesets" / f"{name}_tset_ids.h"),
+            "--blob-h", str(fix_root / "include" / "tilesets" / f"{name}_tset-blob.h"),
+            "--blob-c", str(fix_root / "src" / "tilesets" / f"{name}_tset.c"),
+            "--charset-h", str(fix_root / "include" / "charset" / f"{name}_charset-blob.h"),
+            "--charset-c", str(fix_root / "src" / "charset" / f"{name}_charset.c"),
+            "--sym", str(fix_root / "analysis" / "tilesets" / f"{name}.sym"),
+            "--json", str(fix_root / "analysis" / "tilesets" / f"{name}.json"),
+        ])
+    for lvl in sorted(fixtures_dir.glob("*.lvl")):
+        run([
+            sys.executable, str(levelc), str(lvl),
+            "--out-assets", str(fix_root / "assets" / "levels"),
+            "--out-src", str(fix_root / "src" / "levels"),
+            "--out-include", str(fix_root / "include" / "levels"),
+            "--out-debug", str(fix_root / "analysis" / "levels"),
+        ])
+
     # Refresh project-config.json and build/build.ninja now that gen/ outputs exist.
     run([sys.executable, str(gen_build)])
 
@@ -3,7 +3,7 @@
 tilesetc.py - Compile a metatile tileset definition (.tset) into a binary blob.
 
 Outputs:
-  - .o/.bin   TSET blob: header + metatile records (+ optional names)
+  - .o/.bin   TSET blob: header + metatile records + collision shape tables
   - *_ids.h   Flag masks + tile id constants
   - .sym      Human-readable dump (offsets, decoded tiles)
   - .json     Optional debug
@@ -16,8 +16,15 @@ Format:
   TSET name="..." tileSize=2x2 count=16   ; count is optional
   TILES
     FLOOR_A chars=0x51,0x52,0x53,0x54 color=6 flags=FLOOR|SOLID
+    RAMP    chars=... color=6 flags=SOLID shape=SLOPE_R   ; optional, default FULL
     WALL    chars=... colors=6,6,7,7 flags=...
   END
+  PLATFORMS                                ; needs charset=
+    LIFT tile=LIFT_DECK axis=V             ; V = 8 one-pixel shifts, H = 4 two-pixel shifts
+  END
+  PARTICLES                                ; char-cell particle kinds (levelc ACT PARTICLES)
+    SPARK frames=0030FC3000000000,000C000000000000 color=7 hold=3 move=2 dy=1 spread=1
+  END
 """
 
 from __future__ import annotations
@@ -27,482 +34,178 @@ import os
 import re
 import struct
 import sys
-from dataclasses import dataclass, field, asdict
-from typing import Dict, List, Optional, Tuple
+from dataclasses import asdict
+from typing import Dict, List, Tuple
 
-from tset_parser import parse_tset as parse_tset_shared, TilesetParseError
+from tset_parser import parse_tset as parse_tset_shared, TilesetParseError, FIXED_SHAPES, TileSet, TileDef
 from gen_paths import GEN_ROOT, ANALYSIS_ROOT
 
 MAGIC = b"TSET"
-VERSION = 1
+VERSION = 4
+
+# Record flags bits 8..11 hold the tile's shape slot (index into the shape
+# table section). Slot 0 is always FULL.
+SHAPE_SHIFT = 8
+SHAPE_SLOTS_MAX = 16
 
 # id(1) + chars(4) + colorMode(1) + colors(4) + flags(2) = 12 bytes
 RECORD_SIZE = 12
 
-TOKEN_KV = re.compile(r'(\w+)=(".*?"|\S+)')
+# Moving platforms: a 2x2 metatile drawn at any pixel offset along its axis
+# covers a 2x3 (V) or 3x2 (H) char footprint. One table row per shift holds
+# the footprint's 6 char codes then 6 colors, row-major. Multicolor pixels are
+# two bits wide, so H moves in 2 px steps and has 4 shifts instead of 8.
+PLATFORM_AXES = {"V": 0, "H": 1}
+PLATFORM_SHIFTS = {"V": 8, "H": 4}
+PLATFORM_CELLS = 6
+PLATFORM_RECORD_SIZE = 4  # axis, shift_rsh, ofs_table(u16)
+GLYPH_RECORD_SIZE = 9  # char code + 8 bitmap rows
+CHARSET_CHARS = 256
+# Particle kinds: color, hold, move, dy (s8), spread, frame count, 4 char codes.
+PARTICLE_RECORD_SIZE = 10
+PARTICLE_FRAMES_MAX = 4
+
+
+def _dominant(counts: List[int], fallback: int) -> int:
+    """Index of the source quadrant covering most pixels of a cell."""
+    best = max(counts)
+    return counts.index(best) if best else fallback
+
+
+def platform_shift_cells(tile: TileDef, axis: str, charset: bytes, shift: int) -> Tuple[List[bytes], List[int]]:
+    """Glyphs and colors of the footprint with the tile moved `shift` steps along `axis`."""
+    quad = [charset[c * 8:c * 8 + 8] for c in tile.chars]
+    colors = list(tile.colors) if tile.color_mode else [tile.colors[0]] * 4
+    glyphs: List[bytes] = []
+    cell_colors: List[int] = []
+    if axis == "V":
+        columns = [bytes(shift) + quad[c] + quad[2 + c] + bytes(8 - shift) for c in (0, 1)]
+        for r in range(3):
+            for c in (0, 1):
+                glyphs.append(columns[c][r * 8:r * 8 + 8])
+                counts = [0, 0]
+                for y in range(r * 8, r * 8 + 8):
+                    if 0 <= y - shift < 16:
+                        counts[(y - shift) // 8] += 1
+                cell_colors.append(colors[_dominant(counts, r // 2) * 2 + c])
+        return glyphs, cell_colors
+    bits = shift * 2
+    for r in (0, 1):
+        rows = [bytearray(), bytearray(), bytearray()]
+        for y in range(8):
+            v = ((quad[r * 2][y] << 16) | (quad[r * 2 + 1][y] << 8)) >> bits
+            rows[0].append((v >> 16) & 0xFF)
+            rows[1].append((v >> 8) & 0xFF)
+            rows[2].append(v & 0xFF)
+        for k in range(3):
+            glyphs.append(bytes(rows[k]))
+            counts = [0, 0]
+            for x in range(k * 8, k * 8 + 8):
+                if 0 <= x - bits < 16:
+                    counts[(x - bits) // 8] += 1
+            cell_colors.append(colors[r * 2 + _dominant(counts, k // 2)])
+    return glyphs, cell_colors
+
+
+class GlyphPool:
+    """Char codes for glyphs the tileset adds over its charset.
+
+    Glyphs already in the charset under a code some tile uses are shared;
+    the rest take free codes from 255 down. `glyphs` lists the (code, bitmap)
+    pairs to copy over the charset, in allocation order.
+    """
+
+    def __init__(self, ts: TileSet, charset: bytes):
+        self.charset = bytes(charset[:CHARSET_CHARS * 8]).ljust(CHARSET_CHARS * 8, b"\0")
+        used = sorted({c for t in ts.tiles.values() for c in t.chars})
+        self.code_of: Dict[bytes, int] = {}
+        if charset:
+            for c in used:
+                self.code_of.setdefault(self.charset[c * 8:c * 8 + 8], c)
+        self.free = [c for c in range(CHARSET_CHARS - 1, -1, -1) if c not in set(used)]
+        self.glyphs: List[Tuple[int, bytes]] = []
+
+    def code(self, g: bytes, what: str) -> int:
+        if g not in self.code_of:
+            if not self.free:
+                raise ValueError(f"{what}: no free char codes left for new glyphs")
+            self.code_of[g] = self.free.pop(0)
+            self.glyphs.append((self.code_of[g], g))
+        return self.code_of[g]
+
+
+def build_platforms(ts: TileSet, pool: GlyphPool) -> List[Tuple[str, int, List[int]]]:
+    """Shift every PLATFORMS tile; returns (name, axis, table bytes) per kind."""
+    kinds: List[Tuple[str, int, List[int]]] = []
+    for p in ts.platforms.values():
+        tile = ts.tiles[ts.tiles_by_name[p.tile]]
+        table: List[int] = []
+        for shift in range(PLATFORM_SHIFTS[p.axis]):
+            cells, colors = platform_shift_cells(tile, p.axis, pool.charset, shift)
+            table += [pool.code(g, f"PLATFORMS {p.name}") for g in cells]
+            table += colors
+        kinds.append((p.name, PLATFORM_AXES[p.axis], table))
+    return kinds
+
+
+def build_particles(ts: TileSet, pool: GlyphPool) -> List[Tuple[str, bytes]]:
+    """One PARTICLE_RECORD_SIZE record per PARTICLES kind; unused frame codes repeat the last."""
+    kinds: List[Tuple[str, bytes]] = []
+    for p in ts.particles.values():
+        codes = [pool.code(g, f"PARTICLES {p.name}") for g in p.frames]
+        codes += [codes[-1]] * (PARTICLE_FRAMES_MAX - len(codes))
+        record = bytes([p.color, p.hold, p.move, p.dy & 0xFF, p.spread, len(p.frames)] + codes)
+        kinds.append((p.name, record))
+    return kinds
 
-FIXED_FLAGBITS = {
-    "SOLID": 0,
-    "DECOR": 1,
-    "STANDABLE": 2,
-    "LADDER": 3,
-    "DOOR": 4,
-    "INTERACTABLE": 5,
-    "FLOOR": 6,
-    "HAZARD": 7,
-}
 
 def parse_tset(path: str, error_cb=None):
     return parse_tset_shared(path, error_cb=error_cb)
 
 
-def strip_comment(line: str) -> str:
-    if ";" in line:
-        return line.split(";", 1)[0].rstrip()
-    return line.rstrip()
-
-
-def unquote(s: str) -> str:
-    s = s.strip()
-    if len(s) >= 2 and s[0] == '"' and s[-1] == '"':
-        return s[1:-1]
-    return s
-
-
-def parse_kv(line: str) -> Dict[str, str]:
-    out: Dict[str, str] = {}
-    for m in TOKEN_KV.finditer(line):
-        out[m.group(1)] = unquote(m.group(2))
-    return out
-
-
-def parse_kv_fragment(line: str) -> Dict[str, str]:
-    return parse_kv(line)
-
-
-def parse_num(s: str) -> int:
-    s = s.strip()
-    if s.startswith("$"):
-        return int(s[1:], 16)
-    return int(s, 0)
-
-COLOR_NAMES = {
-    "black": 0,
-    "white": 1,
-    "red": 2,
-    "cyan": 3,
-    "purple": 4,
-    "green": 5,
-    "blue": 6,
-    "yellow": 7,
-    "orange": 8,
-    "brown": 9,
-    "lightred": 10,
-    "darkgray": 11,
-    "gray": 12,
-    "lightgreen": 13,
-    "lightblue": 14,
-    "lightgray": 15,
-}
-
-
-def parse_color(s: str) -> int:
-    s = s.strip()
-    key = s.lower().replace("_", "").replace("-", "").replace(" ", "")
-    if key in COLOR_NAMES:
-        return COLOR_NAMES[key]
-    return parse_num(s)
-
-
-def parse_char_or_num(s: str) -> int:
-    s = s.strip()
-    if len(s) == 1 and s.isalpha():
-        return ord(s.upper()) - ord("A") + 1
-    return parse_num(s)
-
-
-def parse_int_list(s: str, count: int, parse_fn=parse_num) -> List[int]:
-    parts = [p.strip() for p in s.split(",")]
-    if len(parts) != count:
-        raise ValueError(f"Expected {count} values, got {len(parts)}: {s}")
-    return [parse_fn(p) for p in parts]
-
-
-@dataclass
-class Tile:
-    tid: int
-    name: str
-    chars: List[int]          # 4 values TL,TR,BL,BR
-    color_mode: int           # 0 single, 1 per-quadrant
-    colors: List[int]         # 4 values (if single: [c,0,0,0])
-    flags: int
-
-
-@dataclass
-class TileSet:
-    name: str
-    tile_w: int
-    tile_h: int
-    declared_count: int
-    bg_color: int
-    mc1_color: int
-    mc2_color: int
-    charset_path: str
-    flagbits: Dict[str, int] = field(default_factory=dict)
-    tiles: Dict[int, Tile] = field(default_factory=dict)  # tid->Tile
-    objects: List[dict] = field(default_factory=list)
-
-
-def _col_for_token(line: str, token: str) -> int:
-    if not token:
-        return 1
-    idx = line.find(token)
-    return idx + 1 if idx >= 0 else 1
-
-
-def _col_for_kv_value(line: str, key: str) -> int:
-    if not key:
-        return 1
-    m = re.search(rf'(?<!\\w){re.escape(key)}\\s*=\\s*(".*?"|\\S+)', line)
-    if not m:
-        return _col_for_token(line, key)
-    return m.start(1) + 1
-
-
-def _parse_tset_legacy(path: str) -> TileSet:
-    with open(path, "r", encoding="utf-8") as f:
-        raw = f.readlines()
-
-    lines: List[Tuple[int, str, str]] = []
-    for idx, ln in enumerate(raw, 1):
-        raw_line = strip_comment(ln).rstrip("\n")
-        s = raw_line.strip()
-        if s:
-            lines.append((idx, raw_line, s))
-
-    def err(message: str, line_no: int = 1, col: int = 1) -> None:
-        raise TilesetParseError(path, line_no, col, message)
-
-    ts: Optional[TileSet] = None
-    mode: Optional[str] = None
-    next_id = 0
-    tile_names: Dict[str, int] = {}
-    charmap_entries: List[Tuple[int, str, str]] = []
-    charmap_keys: Dict[str, int] = {}
-    object_entries: List[Tuple[int, str, str]] = []
-
-    i = 0
-    while i < len(lines):
-        line_no, raw_line, line = lines[i]
-        i += 1
-
-        if line == "END":
-            mode = None
-            continue
-
-        parts = line.split()
-        head = parts[0]
-
-        if head == "TSET":
-            kv = parse_kv(line)
-            name = kv.get("name", os.path.splitext(os.path.basename(path))[0])
-            if "tileSize" not in kv:
-                err("TSET requires tileSize=2x2", line_no, _col_for_token(raw_line, "TSET"))
-            size = kv["tileSize"].lower()
-            if "x" not in size:
-                err("tileSize must look like 2x2", line_no, _col_for_token(raw_line, "tileSize"))
-            tw, th = size.split("x", 1)
-            if "count" in kv:
-                try:
-                    declared_count = parse_num(kv["count"])
-                except ValueError:
-                    err(f"Invalid count value: {kv['count']}", line_no, _col_for_kv_value(raw_line, "count"))
-                if declared_count is None:
-                    declared_count = 0
-            else:
-                declared_count = 0
-            try:
-                tile_w = int(tw)
-                tile_h = int(th)
-            except ValueError:
-                err(f"tileSize must contain integers: {size}", line_no, _col_for_token(raw_line, "tileSize"))
-            ts = TileSet(
-                name=name,
-                tile_w=tile_w,
-                tile_h=tile_h,
-                declared_count=declared_count,
-                bg_color=0,
-                mc1_color=0,
-                mc2_color=0,
-                charset_path="",
-                flagbits=dict(FIXED_FLAGBITS),
-            )
-            if ts.tile_w != 2 or ts.tile_h != 2:
-                err("This tool currently expects tileSize=2x2", line_no, _col_for_token(raw_line, "tileSize"))
-            if "bgColor" not in kv:
-                err("TSET requires bgColor=", line_no, _col_for_token(raw_line, "TSET"))
-            if "mc1Color" not in kv:
-                err("TSET requires mc1Color=", line_no, _col_for_token(raw_line, "TSET"))
-            if "mc2Color" not in kv:
-                err("TSET requires mc2Color=", line_no, _col_for_token(raw_line, "TSET"))
-            try:
-                ts.bg_color = parse_color(kv["bgColor"])
-            except ValueError:
-                err(f"Invalid bgColor value: {kv['bgColor']}", line_no, _col_for_kv_value(raw_line, "bgColor"))
-            try:
-                ts.mc1_color = parse_color(kv["mc1Color"])
-            except ValueError:
-                err(f"Invalid mc1Color value: {kv['mc1Color']}", line_no, _col_for_kv_value(raw_line, "mc1Color"))
-            try:
-                ts.mc2_color = parse_color(kv["mc2Color"])
-            except ValueError:
-                err(f"Invalid mc2Color value: {kv['mc2Color']}", line_no, _col_for_kv_value(raw_line, "mc2Color"))
-            if not (0 <= ts.bg_color <= 15):
-                err("bgColor must be 0..15", line_no, _col_for_kv_value(raw_line, "bgColor"))
-            if not (0 <= ts.mc1_color <= 15):
-                err("mc1Color must be 0..15", line_no, _col_for_kv_value(raw_line, "mc1Color"))
-            if not (0 <= ts.mc2_color <= 15):
-                err("mc2Color must be 0..15", line_no, _col_for_kv_value(raw_line, "mc2Color"))
-            if "charset" in kv:
-                ts.charset_path = kv["charset"]
-                charset_path = ts.charset_path
-                if not os.path.isabs(charset_path):
-                    charset_path = os.path.join(os.path.dirname(path), charset_path)
-                    if not os.path.isfile(charset_path):
-                        charset_path = os.path.join(os.path.dirname(path), "..", ts.charset_path)
-                if not os.path.isfile(charset_path):
-                    err(f"charset file not found: {ts.charset_path}", line_no, _col_for_kv_value(raw_line, "charset"))
-            continue
-
-        if ts is None:
-            err("File must start with TSET ...", line_no)
-
-        if head == "FLAGBITS":
-            err("FLAGBITS section is not allowed in .tset files", line_no, _col_for_token(raw_line, "FLAGBITS"))
-        if head == "TILES":
-            mode = head
-            continue
-        if head == "CHARMAP":
-            mode = head
-            continue
-        if head == "OBJECTS":
-            mode = head
-            continue
-
-        if mode == "TILES":
-            name = parts[0]
-            rest = line[len(name):].strip()
-            kv = parse_kv_fragment(rest)
-            if "id" in kv:
-                try:
-                    tid = parse_num(kv["id"])
-                except ValueError:
-                    err(f"Invalid TILE id: {kv['id']}", line_no, _col_for_kv_value(raw_line, "id"))
-                if tid >= next_id:
-                    next_id = tid + 1
-            else:
-                tid = next_id
-                next_id += 1
-            kv["id"] = str(tid)
-            if not name:
-                name = f"TILE_{tid}"
-        elif head == "TILE":
-            kv = parse_kv(line)
-            if "id" not in kv:
-                err(f"TILE missing id=: {line}", line_no, _col_for_token(raw_line, "TILE"))
-            try:
-                tid = parse_num(kv["id"])
-            except ValueError:
-                err(f"Invalid TILE id: {kv['id']}", line_no, _col_for_kv_value(raw_line, "id"))
-            if not (0 <= tid <= 255):
-                err("TILE id must be 0..255", line_no, _col_for_kv_value(raw_line, "id"))
-
-            name = kv.get("name", f"TILE_{tid}")
-        else:
-            if mode == "CHARMAP":
-                if len(parts) < 2:
-                    err(f"CHARMAP line missing tile name: {line}", line_no, _col_for_token(raw_line, "CHARMAP"))
-                ch = parts[0]
-                if len(ch) != 1:
-                    err(f"CHARMAP key must be a single char: {ch}", line_no, _col_for_token(raw_line, ch))
-                tile_name = parts[1].strip().upper()
-                if tile_name.startswith("TILE_"):
-                    tile_name = tile_name[5:]
-                if ch in charmap_keys:
-                    err(f"Duplicate CHARMAP key: {ch}", line_no, _col_for_token(raw_line, ch))
-                charmap_keys[ch] = line_no
-                charmap_entries.append((line_no, ch, tile_name))
-                continue
-            if mode == "OBJECTS":
-                name = parts[0]
-                object_entries.append((line_no, line, name))
-                continue
-            err(f"Unexpected line: {line}", line_no, 1)
-
-        if not (0 <= tid <= 255):
-            err("TILE id must be 0..255", line_no, _col_for_kv_value(raw_line, "id"))
-
-        if not name:
-            name = f"TILE_{tid}"
-
-        if "chars" not in kv:
-            err(f"TILE missing chars=: {line}", line_no, _col_for_token(raw_line, "chars"))
-        try:
-            chars = parse_int_list(kv["chars"], 4, parse_fn=parse_char_or_num)
-        except ValueError as e:
-            err(str(e), line_no, _col_for_kv_value(raw_line, "chars"))
-        for c in chars:
-            if not (0 <= c <= 255):
-                err(f"Char code out of range 0..255 in: {line}", line_no, _col_for_kv_value(raw_line, "chars"))
-
-        # color vs colors
-        if "colors" in kv:
-            color_mode = 1
-            try:
-                colors = parse_int_list(kv["colors"], 4, parse_fn=parse_color)
-            except ValueError as e:
-                err(str(e), line_no, _col_for_kv_value(raw_line, "colors"))
-        elif "color" in kv:
-            color_mode = 0
-            try:
-                c = parse_color(kv["color"])
-            except ValueError:
-                err(f"Invalid color value: {kv['color']}", line_no, _col_for_kv_value(raw_line, "color"))
-            colors = [c, 0, 0, 0]
-        else:
-            err(f"TILE must have color= or colors=: {line}", line_no, _col_for_token(raw_line, "TILE"))
-
-        for c in colors:
-            if not (0 <= c <= 15):
-                err(f"Color out of range 0..15 in: {line}", line_no, _col_for_kv_value(raw_line, "color"))
-
-        # flags
-        flags_mask = 0
-        flags_str = kv.get("flags", "")
-        if flags_str:
-            for fn in flags_str.split("|"):
-                fn = fn.strip().upper()
-                if not fn:
-                    continue
-                if fn not in ts.flagbits:
-                    err(f"Unknown flag '{fn}' in: {line}", line_no, _col_for_token(raw_line, fn))
-                bit = ts.flagbits[fn]
-                if not (0 <= bit <= 15):
-                    err(f"Flag bit out of range 0..15 for {fn}", line_no, _col_for_token(raw_line, fn))
-                flags_mask |= (1 << bit)
-
-        tile = Tile(
-            tid=tid,
-            name=name,
-            chars=chars,
-            color_mode=color_mode,
-            colors=colors,
-            flags=flags_mask
-        )
-        name_key = name.strip().upper()
-        if name_key.startswith("TILE_"):
-            name_key = name_key[5:]
-        if name_key in tile_names:
-            err(f"Duplicate TILE name: {name}", line_no, _col_for_token(raw_line, name))
-        tile_names[name_key] = tid
-        if tid in ts.tiles:
-            err(f"Duplicate TILE id={tid}", line_no, _col_for_token(raw_line, "id"))
-        ts.tiles[tid] = tile
-        continue
-
-    if ts is None:
-        err("No TSET header found", 1)
-
-
-    # Validate tile count (declared count is a sanity check)
-    if len(ts.tiles) == 0:
-        err("No TILE definitions found", 1)
-    if ts.declared_count == 0:
-        ts.declared_count = len(ts.tiles)
-    if len(ts.tiles) > ts.declared_count:
-        err(f"Defined {len(ts.tiles)} tiles but TSET count={ts.declared_count}", 1)
-    if len(ts.tiles) > 255:
-        err("Too many tiles: max 255 (count stored as u8)", 1)
-
-    if object_entries:
-        for line_no, raw_line, name in object_entries:
-            rest = raw_line[len(name):].strip()
-            kv = parse_kv_fragment(rest)
-            if "char" in kv:
-                err(
-                    f"OBJECTS entry must not include char=: {raw_line}",
-                    line_no,
-                    _col_for_kv_value(raw_line, "char"),
-                )
-                continue
-            if "size" not in kv or "tiles" not in kv:
-                err(
-                    f"OBJECTS entry requires size= tiles=: {raw_line}",
-                    line_no,
-                    _col_for_token(raw_line, "OBJECTS"),
-                )
-                continue
-            size = kv["size"].lower()
-            if "x" not in size:
-                err(f"OBJECTS size must look like WxH: {size}", line_no, _col_for_kv_value(raw_line, "size"))
-                continue
-            try:
-                w_str, h_str = size.split("x", 1)
-                ow = int(w_str)
-                oh = int(h_str)
-            except ValueError:
-                err(f"OBJECTS size must be integers: {size}", line_no, _col_for_kv_value(raw_line, "size"))
-                continue
-            tiles_list = [t.strip().upper() for t in kv["tiles"].split(",") if t.strip()]
-            if len(tiles_list) != ow * oh:
-                err(
-                    f"OBJECTS tiles count {len(tiles_list)} does not match size {ow}x{oh}",
-                    line_no,
-                    _col_for_kv_value(raw_line, "tiles"),
-                )
-                continue
-            for tname in tiles_list:
-                if tname not in tile_names:
-                    err(f"OBJECTS unknown tile name: {tname}", line_no, _col_for_kv_value(raw_line, "tiles"))
-                    continue
-            ts.objects.append(
-                {
-                    "name": name,
-                    "w": ow,
-                    "h": oh,
-                    "tiles": tiles_list,
-                }
-            )
-
-    if charmap_entries:
-        obj_by_name = {o["name"].upper(): o for o in ts.objects}
-        for line_no, ch, tile_name in charmap_entries:
-            if tile_name in tile_names:
-                continue
-            obj = obj_by_name.get(tile_name)
-            if obj is None:
-                err(f"CHARMAP unknown tile/object name: {tile_name}", line_no, 1)
-                continue
-            if "char" in obj and obj["char"] != ch:
-                err(f"OBJECT '{tile_name}' bound to multiple chars", line_no, 1)
-                continue
-            obj["char"] = ch
-
-    return ts
-
-
-def compile_tset(ts: TileSet) -> tuple[bytes, str, dict, str, str, str]:
+def compile_tset(ts: TileSet, charset: bytes = b"") -> tuple[bytes, str, dict, str, str, str]:
     # Sort tiles by ID for stable output
     tiles_sorted = [ts.tiles[k] for k in sorted(ts.tiles.keys())]
     tile_count = len(tiles_sorted)
+    aliases = ts.aliases
+
+    # Shape slots in first-use order so the blob only carries tables it needs.
+    shape_slots: List[str] = ["FULL"]
+    for t in tiles_sorted:
+        if t.shape not in shape_slots:
+            shape_slots.append(t.shape)
+    # Fixed shape set is smaller than the slot field, so this cannot overflow.
+    assert len(shape_slots) <= SHAPE_SLOTS_MAX
+    slot_of = {name: i for i, name in enumerate(shape_slots)}
+
+    pool = GlyphPool(ts, charset)
+    platform_kinds = build_platforms(ts, pool)
+    particle_kinds = build_particles(ts, pool)
+    glyphs = pool.glyphs
 
     # Header layout:
-    # magic(4) version(1) tileW(1) tileH(1) tileCount(1) recSize(1) ofsRecords(u16) ofsNames(u16) reserved(u32)
-    header_fmt = "<4sBBBBBHHI"
+    # magic(4) version(1) tileW(1) tileH(1) tileCount(1) recSize(1) ofsRecords(u16) ofsNames(u16) reserved(u32) ofsShapes(u16)
+    # ofsPlatforms(u16) ofsGlyphs(u16) ofsParticles(u16)
+    # reserved = bg | mc1 << 8 | mc2 << 16 | tileCount high byte << 24
+    header_fmt = "<4sBBBBBHHIHHHH"
     header_size = struct.calcsize(header_fmt)
     ofs_records = header_size
-    ofs_names = 0  # not used in v1 (names are for tooling headers/sym only)
-    reserved = (ts.bg_color & 0xFF) | ((ts.mc1_color & 0xFF) << 8) | ((ts.mc2_color & 0xFF) << 16)
+    ofs_names = 0  # not used (names are for tooling headers/sym only)
+    ofs_shapes = ofs_records + tile_count * RECORD_SIZE
+    end = ofs_shapes + 1 + len(shape_slots) * 16
+    ofs_platforms = end if platform_kinds else 0
+    if platform_kinds:
+        end += 1 + len(platform_kinds) * PLATFORM_RECORD_SIZE + sum(len(table) for _n, _a, table in platform_kinds)
+    ofs_particles = end if particle_kinds else 0
+    if particle_kinds:
+        end += 1 + len(particle_kinds) * PARTICLE_RECORD_SIZE
+    ofs_glyphs = end if glyphs else 0
+    reserved = (
+        (ts.bg_color & 0xFF)
+        | ((ts.mc1_color & 0xFF) << 8)
+        | ((ts.mc2_color & 0xFF) << 16)
+        | (((tile_count >> 8) & 0xFF) << 24)
+    )
 
     blob = bytearray()
     blob += struct.pack(
@@ -516,6 +219,10 @@ def compile_tset(ts: TileSet) -> tuple[bytes, str, dict, str, str, str]:
         ofs_records & 0xFFFF,
         ofs_names & 0xFFFF,
         reserved & 0xFFFFFFFF,
+        ofs_shapes & 0xFFFF,
+        ofs_platforms & 0xFFFF,
+        ofs_glyphs & 0xFFFF,
+        ofs_particles & 0xFFFF,
     )
 
     # Records
@@ -528,11 +235,41 @@ def compile_tset(ts: TileSet) -> tuple[bytes, str, dict, str, str, str]:
             t.chars[0] & 0xFF, t.chars[1] & 0xFF, t.chars[2] & 0xFF, t.chars[3] & 0xFF,
             t.color_mode & 0xFF,
             t.colors[0] & 0xFF, t.colors[1] & 0xFF, t.colors[2] & 0xFF, t.colors[3] & 0xFF,
-            t.flags & 0xFFFF,
+            (t.flags | (slot_of[t.shape] << SHAPE_SHIFT)) & 0xFFFF,
         )
         assert len(rec) == RECORD_SIZE, f"Record size mismatch: {len(rec)} != {RECORD_SIZE}"
         blob += rec
 
+    # Shape tables: u8 count, then 16 column bytes per slot.
+    blob.append(len(shape_slots))
+    for name in shape_slots:
+        blob += bytes(FIXED_SHAPES[name])
+
+    # Platforms: u8 count, [axis, shift_rsh, ofs_table] per kind, then the
+    # tables. Glyphs: u8 count, then [code, 8 rows] copied over the charset.
+    if platform_kinds:
+        assert len(blob) == ofs_platforms
+        blob.append(len(platform_kinds))
+        ofs_table = ofs_platforms + 1 + len(platform_kinds) * PLATFORM_RECORD_SIZE
+        for _name, axis, table in platform_kinds:
+            shift_rsh = 1 if axis == PLATFORM_AXES["H"] else 0
+            blob += struct.pack("<BBH", axis, shift_rsh, ofs_table)
+            ofs_table += len(table)
+        for _name, _axis, table in platform_kinds:
+            blob += bytes(table)
+    # Particles: u8 count, then one record per kind.
+    if particle_kinds:
+        assert len(blob) == ofs_particles
+        blob.append(len(particle_kinds))
+        for _name, record in particle_kinds:
+            blob += record
+    if glyphs:
+        assert len(blob) == ofs_glyphs
+        blob.append(len(glyphs))
+        for code, g in glyphs:
+            blob.append(code)
+            blob += g
+
     # IDs header: flag masks + tile IDs
     h: List[str] = []
     h.append("// Auto-generated by tilesetc.py\n#pragma once\n#include <stdint.h>\n\n")
@@ -540,7 +277,20 @@ def compile_tset(ts: TileSet) -> tuple[bytes, str, dict, str, str, str]:
     for t in tiles_sorted:
         ident = re.sub(r'[^A-Za-z0-9_]', "_", t.name).upper()
         h.append(f"#define TILE_{ident} {t.tid}\n")
+    for name, target in aliases.items():
+        ident = re.sub(r'[^A-Za-z0-9_]', "_", name).upper()
+        h.append(f"#define TILE_{ident} {ts.tiles_by_name[target]}  /* alias of {target} */\n")
     h.append("\n")
+    if platform_kinds:
+        h.append("/* Platform kinds (levelc PLATFORMS) */\n")
+        for k, (name, _axis, _table) in enumerate(platform_kinds):
+            h.append(f"#define PLATFORM_{name} {k}\n")
+        h.append("\n")
+    if particle_kinds:
+        h.append("/* Particle kinds (levelc ACT PARTICLES) */\n")
+        for k, (name, _record) in enumerate(particle_kinds):
+            h.append(f"#define PARTICLE_{name} {k}\n")
+        h.append("\n")
     ids_h = "".join(h)
 
     # Debug
@@ -567,8 +317,16 @@ def compile_tset(ts: TileSet) -> tuple[bytes, str, dict, str, str, str]:
         "tile_count": tile_count,
         "record_size": RECORD_SIZE,
         "ofs_records": ofs_records,
+        "ofs_shapes": ofs_shapes,
+        "shape_slots": shape_slots,
         "flagbits": ts.flagbits,
         "objects": objects_for_debug(ts.objects),
+        "aliases": dict(aliases),
+        "platforms": [
+            {"name": name, "axis": "VH"[axis], "table": table} for name, axis, table in platform_kinds
+        ],
+        "particles": [{"name": name, "record": list(record)} for name, record in particle_kinds],
+        "glyphs": [code for code, _g in glyphs],
         "tiles": [
             {
                 "id": t.tid,
@@ -577,6 +335,7 @@ def compile_tset(ts: TileSet) -> tuple[bytes, str, dict, str, str, str]:
                 "color_mode": t.color_mode,
                 "colors": t.colors,
                 "flags": t.flags,
+                "shape": t.shape,
             } for t in tiles_sorted
         ],
         "blob_size": len(blob),
@@ -588,7 +347,12 @@ def compile_tset(ts: TileSet) -> tuple[bytes, str, dict, str, str, str]:
     sym.append(f"GLOBAL bg={ts.bg_color} mc1={ts.mc1_color} mc2={ts.mc2_color}\n")
     if ts.charset_path:
         sym.append(f"CHARSET {ts.charset_path}\n")
-    sym.append(f"HDR records={ofs_records} tileCount={tile_count} recordSize={RECORD_SIZE}\n\n")
+    sym.append(f"HDR records={ofs_records} tileCount={tile_count} recordSize={RECORD_SIZE}\n")
+    if tile_count > 256:
+        # Levels address at most 256 tiles per room; levelc assigns the pages.
+        sym.append(f"PAGED tiles={tile_count} (levels use 256-tile pages)\n")
+    sym.append(f"SHAPES ofs={ofs_shapes} " + " ".join(f"{i}={n}" for i, n in enumerate(shape_slots)) + "\n")
+    sym.append("\n")
     sym.append("TILES\n")
     for t in tiles_sorted:
         sym.append(
@@ -596,8 +360,36 @@ def compile_tset(ts: TileSet) -> tuple[bytes, str, dict, str, str, str]:
             f"{t.chars[0]:02X},{t.chars[1]:02X},{t.chars[2]:02X},{t.chars[3]:02X} "
             f"colorMode={t.color_mode} colors="
             f"{t.colors[0]},{t.colors[1]},{t.colors[2]},{t.colors[3]} "
-            f"flags=0x{t.flags:04X}\n"
+            f"flags=0x{t.flags:04X}"
+            + (f" shape={t.shape}" if t.shape != "FULL" else "")
+            + "\n"
         )
+    if platform_kinds:
+        sym.append(f"PLATFORMS ofs={ofs_platforms}\n")
+        for k, (name, axis, table) in enumerate(platform_kinds):
+            p = ts.platforms[name]
+            shifts = len(table) // (PLATFORM_CELLS * 2)
+            sym.append(f"  kind={k} name={name} tile={p.tile} axis={'VH'[axis]} shifts={shifts}\n")
+            for s_i in range(shifts):
+                row = table[s_i * PLATFORM_CELLS * 2:(s_i + 1) * PLATFORM_CELLS * 2]
+                sym.append(
+                    f"    [{s_i}] chars=" + ",".join(f"{c:02X}" for c in row[:PLATFORM_CELLS])
+                    + " colors=" + ",".join(str(c) for c in row[PLATFORM_CELLS:]) + "\n"
+                )
+    if particle_kinds:
+        sym.append(f"PARTICLES ofs={ofs_particles}\n")
+        for k, (name, record) in enumerate(particle_kinds):
+            p = ts.particles[name]
+            sym.append(
+                f"  kind={k} name={name} color={p.color} hold={p.hold} move={p.move} dy={p.dy} spread={p.spread} "
+                f"chars=" + ",".join(f"{c:02X}" for c in record[6:6 + len(p.frames)]) + "\n"
+            )
+    if glyphs:
+        sym.append(f"GLYPHS ofs={ofs_glyphs} count={len(glyphs)}\n")
+    if aliases:
+        sym.append("ALIASES\n")
+        for name, target in aliases.items():
+            sym.append(f"  {name} -> {target} id={ts.tiles_by_name[target]}\n")
     sym_text = "".join(sym)
 
     base = re.sub(r'[^A-Za-z0-9_]', "_", ts.name)
@@ -618,7 +410,7 @@ def compile_tset(ts: TileSet) -> tuple[bytes, str, dict, str, str, str]:
     return bytes(blob), ids_h, debug, sym_text, blob_h, blob_c
 
 
-def main():
+def make_arg_parser() -> argparse.ArgumentParser:
     ap = argparse.ArgumentParser()
     ap.add_argument("input", help="Input .tset file")
     ap.add_argument("-o", "--output", default="", help="Output blob (.o/.bin)")
@@ -629,9 +421,11 @@ def main():
     ap.add_argument("--charset-c", default="", help="Output *_charset.c")
     ap.add_argument("--sym", default="AUTO", help="Output .sym")
     ap.add_argument("--json", default="AUTO", help="Output debug .json")
-    args = ap.parse_args()
+    return ap
 
-    project_root = os.path.abspath(os.path.join(os.path.dirname(__file__), ".."))
+
+def main():
+    args = make_arg_parser().parse_args()
     errors: List[Tuple[int, int, str]] = []
 
     def record_error(message: str, line: int, col: int) -> None:
@@ -652,7 +446,35 @@ def main():
         for line, col, message in errors:
             print(f"{path}:{line}:{col}: error: {message}", file=sys.stderr)
         sys.exit(1)
-    blob, ids_h, debug, sym_text, blob_h, blob_c = compile_tset(ts)
+    try:
+        write_tileset(ts, args)
+    except ValueError as e:
+        print(f"{os.path.abspath(args.input)}:1:1: error: {e}", file=sys.stderr)
+        sys.exit(1)
+
+
+def charset_source(ts: TileSet, input_path: str) -> str:
+    """charset= resolved like the parser does: next to the .tset, then one level up."""
+    charset_src = ts.charset_path
+    if not os.path.isabs(charset_src):
+        charset_src = os.path.join(os.path.dirname(input_path), charset_src)
+        if not os.path.isfile(charset_src):
+            charset_src = os.path.join(os.path.dirname(input_path), "..", ts.charset_path)
+    return os.path.normpath(charset_src)
+
+
+def write_tileset(ts: TileSet, args: argparse.Namespace) -> bytes:
+    """Compile `ts` and write every output named in `args` (see make_arg_parser).
+
+    args.input is the .tset path; it anchors the charset path and is all a
+    caller holding an in-memory TileSet needs to set. Returns the blob.
+    """
+    project_root = os.path.abspath(os.path.join(os.path.dirname(__file__), ".."))
+    charset = b""
+    if ts.platforms or (ts.particles and ts.charset_path):
+        with open(charset_source(ts, args.input), "rb") as f:
+            charset = f.read()
+    blob, ids_h, debug, sym_text, blob_h, blob_c = compile_tset(ts, charset)
 
     if not args.output:
         args.output = os.path.join(GEN_ROOT, "assets", f"{ts.name}.bin")
@@ -739,12 +561,7 @@ def main():
         print(f"Wrote {args.blob_c}")
 
     if ts.charset_path and args.charset_h and args.charset_c:
-        charset_src = ts.charset_path
-        if not os.path.isabs(charset_src):
-            charset_src = os.path.join(os.path.dirname(args.input), charset_src)
-            if not os.path.isfile(charset_src):
-                charset_src = os.path.join(os.path.dirname(args.input), "..", ts.charset_path)
-        charset_src = os.path.normpath(charset_src)
+        charset_src = charset_source(ts, args.input)
         rel = os.path.relpath(charset_src, os.path.dirname(args.charset_c))
         base = re.sub(r'[^A-Za-z0-9_]', "_", ts.name)
         charset_h = (
@@ -776,6 +593,7 @@ def main():
         with open(args.json, "w", encoding="utf-8") as f:
             json.dump(debug, f, indent=2)
         print(f"Wrote {args.json}")
+    return blob
 
 
 if __name__ == "__main__":
@@ -1,6 +1,10 @@
 #!/usr/bin/env python3
 """
-tset_parser.py - Shared .tset parser for tilesetc.py and levelc.py.
+tset_parser.py - Shared tileset model (TileSet/TileDef) and .tset parser.
+
+parse_tset() reads the text format. Tools that make a tileset in memory
+(koala_tilekit_compiler.py) fill a TileSet with the add_*/bind_char/finish
+builder instead and hand it to tilesetc.compile_tset and levelc directly.
 """
 
 from __future__ import annotations
@@ -29,6 +33,7 @@ FIXED_FLAGBITS = {
     "INTERACTABLE": 5,
     "FLOOR": 6,
     "HAZARD": 7,
+    "PLATE": 12,  # above the shape slot bits 8..11
 }
 
 COLOR_NAMES = {
@@ -55,6 +60,42 @@ COLOR_NAMES = {
 
 TOKEN_KV = re.compile(r'(\w+)=(".*?"|\S+)')
 
+# Collision shapes: one byte per pixel column (x = 0..15) of a metatile.
+#   0x00..0x10  solid from row v to the bottom (0x10 = empty column)
+#   0x80 | n    solid from the top down to row n-1
+# Keep the encoding in sync with tset_shape_* in tileset_format.h.
+SHAPE_EMPTY = 0x10
+SHAPE_CEIL = 0x80
+
+
+def _shape(fn) -> List[int]:
+    return [fn(x) for x in range(16)]
+
+
+FIXED_SHAPES: Dict[str, List[int]] = {
+    "FULL": _shape(lambda x: 0),
+    "TOP_HALF": _shape(lambda x: SHAPE_CEIL | 8),
+    "BOTTOM_HALF": _shape(lambda x: 8),
+    "LEFT_HALF": _shape(lambda x: 0 if x < 8 else SHAPE_EMPTY),
+    "RIGHT_HALF": _shape(lambda x: 0 if x >= 8 else SHAPE_EMPTY),
+    "ONEWAY_TOP": _shape(lambda x: SHAPE_CEIL | 4),
+    # SLOPE_L is high on the left, SLOPE_R high on the right. The _HI/_LO
+    # pairs split a half-steep slope across two tiles.
+    "SLOPE_L": _shape(lambda x: x),
+    "SLOPE_R": _shape(lambda x: 15 - x),
+    "SLOPE_L_HI": _shape(lambda x: x // 2),
+    "SLOPE_L_LO": _shape(lambda x: 8 + x // 2),
+    "SLOPE_R_HI": _shape(lambda x: 7 - x // 2),
+    "SLOPE_R_LO": _shape(lambda x: 15 - x // 2),
+}
+# Shapes that only stop a body landing from above.
+ONEWAY_SHAPES = {"ONEWAY_TOP"}
+
+# Tile ids are u16 in the TSET header; levels see them through 256-tile pages
+# (see levelc.py). Keep in sync with TSET_MAX_TILES in tileset_format.h.
+TSET_MAX_TILES = 1024
+PARTICLE_FRAMES_MAX = 4  # glyph codes per PARTICLES kind record
+
 
 @dataclass
 class TileDef:
@@ -64,6 +105,7 @@ class TileDef:
     color_mode: int           # 0 single, 1 per-quadrant
     colors: List[int]         # 4 values (if single: [c,0,0,0])
     flags: int
+    shape: str = "FULL"       # FIXED_SHAPES key
 
 
 @dataclass
@@ -76,7 +118,27 @@ class ObjectDef:
 
 
 @dataclass
-class TsetParseResult:
+class PlatformDef:
+    name: str
+    tile: str                 # tile name (upper); its four chars are shifted
+    axis: str                 # "V" (lift) or "H"
+    line_no: int = 0
+
+
+@dataclass
+class ParticleDef:
+    name: str
+    frames: List[bytes]       # 1..4 glyph bitmaps, shown in order
+    color: int                # color RAM color (multicolor chars: 0..7)
+    hold: int                 # frames each glyph is shown
+    move: int                 # frames per cell step, 0 = stays put
+    dy: int                   # rows per step: -1 rises, 1 falls
+    spread: int               # 1 = a burst fans out sideways
+    line_no: int = 0
+
+
+@dataclass
+class TileSet:
     name: str
     tile_w: int
     tile_h: int
@@ -91,6 +153,72 @@ class TsetParseResult:
     objects: Dict[str, ObjectDef] = field(default_factory=dict)  # name->def
     charmap_tiles: Dict[str, int] = field(default_factory=dict)
     object_stamps: Dict[str, dict] = field(default_factory=dict)  # char->def
+    aliases: Dict[str, str] = field(default_factory=dict)  # name->target tile name (no record of its own)
+    platforms: Dict[str, PlatformDef] = field(default_factory=dict)  # name->def, in declaration order
+    particles: Dict[str, ParticleDef] = field(default_factory=dict)  # name->def, in declaration order
+
+    def add_tile(self, name: str, chars: List[int], colors: List[int], flags: str, shape: str = "FULL") -> TileDef:
+        """Append a per-quadrant-color tile with the next id, as a TILES line would."""
+        mask = 0
+        for fn in (f.strip().upper() for f in flags.split("|")):
+            if fn:
+                if fn not in self.flagbits:
+                    raise ValueError(f"Unknown flag '{fn}' on tile {name}")
+                mask |= 1 << self.flagbits[fn]
+        key = tile_key(name)
+        if key in self.tiles_by_name:
+            raise ValueError(f"Duplicate TILE name: {name}")
+        tile = TileDef(len(self.tiles), name, list(chars), 1, list(colors), mask, shape)
+        self.tiles[tile.tid] = tile
+        self.tiles_by_name[key] = tile.tid
+        return tile
+
+    def add_alias(self, name: str, target: str) -> None:
+        key = tile_key(name)
+        if key in self.tiles_by_name:
+            raise ValueError(f"Duplicate TILE name: {name}")
+        self.tiles_by_name[key] = self.tiles_by_name[tile_key(target)]
+        self.aliases[key] = tile_key(target)
+
+    def add_object(self, name: str, w: int, h: int, tiles: List[str]) -> None:
+        self.objects[name.upper()] = ObjectDef(name=name, w=w, h=h, tiles=[t.upper() for t in tiles])
+
+    def bind_char(self, ch: str, name: str) -> Optional[str]:
+        """CHARMAP entry; returns an error message instead of raising."""
+        key = tile_key(name)
+        if key in self.tiles_by_name:
+            self.charmap_tiles[ch] = self.tiles_by_name[key]
+            return None
+        obj = self.objects.get(key)
+        if obj is None:
+            return f"CHARMAP unknown tile/object name: {key}"
+        if obj.char and obj.char != ch:
+            return f"OBJECT '{key}' bound to multiple chars"
+        obj.char = ch
+        return None
+
+    def finish(self) -> None:
+        """Resolve object stamps once tiles, objects and CHARMAP are in."""
+        if self.declared_count == 0:
+            self.declared_count = len(self.tiles)
+        for obj in self.objects.values():
+            if obj.char:
+                self.object_stamps[obj.char] = {
+                    "name": obj.name,
+                    "w": obj.w,
+                    "h": obj.h,
+                    "tiles": [self.tiles_by_name[n] for n in obj.tiles],
+                    "char": obj.char,
+                }
+
+
+# Older name, kept for existing imports.
+TsetParseResult = TileSet
+
+
+def tile_key(name: str) -> str:
+    key = name.strip().upper()
+    return key[5:] if key.startswith("TILE_") else key
 
 
 def strip_comment(line: str) -> str:
@@ -162,7 +290,7 @@ def _col_for_kv_value(line: str, key: str) -> int:
     return m.start(1) + 1
 
 
-def parse_tset(path: str, error_cb: Optional[Callable[[str, int, int], None]] = None) -> TsetParseResult:
+def parse_tset(path: str, error_cb: Optional[Callable[[str, int, int], None]] = None) -> TileSet:
     with open(path, "r", encoding="utf-8") as f:
         raw = f.readlines()
 
@@ -179,12 +307,15 @@ def parse_tset(path: str, error_cb: Optional[Callable[[str, int, int], None]] =
             return
         raise TilesetParseError(path, line_no, col, message)
 
-    ts: Optional[TsetParseResult] = None
+    ts: Optional[TileSet] = None
     mode: Optional[str] = None
     next_id = 0
     charmap_entries: List[Tuple[int, str, str]] = []
     charmap_keys: Dict[str, int] = {}
     object_entries: List[Tuple[int, str, str]] = []
+    platform_entries: List[Tuple[int, str, str]] = []
+    particle_entries: List[Tuple[int, str, str]] = []
+    alias_entries: List[Tuple[int, str, str, str]] = []
 
     i = 0
     while i < len(lines):
@@ -225,7 +356,7 @@ def parse_tset(path: str, error_cb: Optional[Callable[[str, int, int], None]] =
                 err(f"tileSize must contain integers: {size}", line_no, _col_for_token(raw_line, "tileSize"))
                 tile_w = 2
                 tile_h = 2
-            ts = TsetParseResult(
+            ts = TileSet(
                 name=name,
                 tile_w=tile_w,
                 tile_h=tile_h,
@@ -279,7 +410,7 @@ def parse_tset(path: str, error_cb: Optional[Callable[[str, int, int], None]] =
         if ts is None:
             err("File must start with TSET ...", line_no)
             if error_cb:
-                ts = TsetParseResult(
+                ts = TileSet(
                     name=os.path.splitext(os.path.basename(path))[0],
                     tile_w=2,
                     tile_h=2,
@@ -304,11 +435,20 @@ def parse_tset(path: str, error_cb: Optional[Callable[[str, int, int], None]] =
         if head == "OBJECTS":
             mode = head
             continue
+        if head in ("PLATFORMS", "PARTICLES"):
+            mode = head
+            continue
 
         if mode == "TILES":
             name = parts[0]
             rest = line[len(name):].strip()
             kv = parse_kv_fragment(rest)
+            if "alias" in kv:
+                # `NAME alias=TILE`: another name for TILE's record; takes no id.
+                if len(kv) != 1:
+                    err(f"TILE alias= takes no other fields: {line}", line_no, _col_for_kv_value(raw_line, "alias"))
+                alias_entries.append((line_no, raw_line, name, kv["alias"]))
+                continue
             if "id" in kv:
                 try:
                     tid = parse_num(kv["id"])
@@ -336,9 +476,9 @@ def parse_tset(path: str, error_cb: Optional[Callable[[str, int, int], None]] =
                     err(f"Invalid TILE id: {kv['id']}", line_no, _col_for_kv_value(raw_line, "id"))
                     tid = next_id
                     next_id += 1
-            if not (0 <= tid <= 255):
-                err("TILE id must be 0..255", line_no, _col_for_kv_value(raw_line, "id"))
-                tid = max(0, min(tid, 255))
+            if not (0 <= tid < TSET_MAX_TILES):
+                err(f"TILE id must be 0..{TSET_MAX_TILES - 1}", line_no, _col_for_kv_value(raw_line, "id"))
+                tid = max(0, min(tid, TSET_MAX_TILES - 1))
             name = kv.get("name", f"TILE_{tid}")
         else:
             if mode == "CHARMAP":
@@ -359,11 +499,17 @@ def parse_tset(path: str, error_cb: Optional[Callable[[str, int, int], None]] =
                 name = parts[0]
                 object_entries.append((line_no, line, name))
                 continue
+            if mode == "PLATFORMS":
+                platform_entries.append((line_no, raw_line, parts[0]))
+                continue
+            if mode == "PARTICLES":
+                particle_entries.append((line_no, raw_line, parts[0]))
+                continue
             err(f"Unexpected line: {line}", line_no, 1)
 
-        if not (0 <= tid <= 255):
-            err("TILE id must be 0..255", line_no, _col_for_kv_value(raw_line, "id"))
-            tid = max(0, min(tid, 255))
+        if not (0 <= tid < TSET_MAX_TILES):
+            err(f"TILE id must be 0..{TSET_MAX_TILES - 1}", line_no, _col_for_kv_value(raw_line, "id"))
+            tid = max(0, min(tid, TSET_MAX_TILES - 1))
 
         if not name:
             name = f"TILE_{tid}"
@@ -419,6 +565,16 @@ def parse_tset(path: str, error_cb: Optional[Callable[[str, int, int], None]] =
                     err(f"Flag bit out of range 0..15 for {fn}", line_no, _col_for_token(raw_line, fn))
                 flags_mask |= (1 << bit)
 
+        shape = kv.get("shape", "FULL").strip().upper()
+        if shape not in FIXED_SHAPES:
+            err(f"Unknown shape '{shape}' in: {line}", line_no, _col_for_kv_value(raw_line, "shape"))
+            shape = "FULL"
+        elif shape in ONEWAY_SHAPES:
+            solid = 1 << ts.flagbits["SOLID"]
+            landable = (1 << ts.flagbits["STANDABLE"]) | (1 << ts.flagbits["FLOOR"])
+            if (flags_mask & solid) or not (flags_mask & landable):
+                err(f"shape={shape} needs STANDABLE or FLOOR without SOLID: {line}", line_no, _col_for_kv_value(raw_line, "shape"))
+
         tile = TileDef(
             tid=tid,
             name=name,
@@ -426,6 +582,7 @@ def parse_tset(path: str, error_cb: Optional[Callable[[str, int, int], None]] =
             color_mode=color_mode,
             colors=colors,
             flags=flags_mask,
+            shape=shape,
         )
         name_key = name.strip().upper()
         if name_key.startswith("TILE_"):
@@ -443,7 +600,7 @@ def parse_tset(path: str, error_cb: Optional[Callable[[str, int, int], None]] =
     if ts is None:
         err("No TSET header found", 1)
         if error_cb:
-            ts = TsetParseResult(
+            ts = TileSet(
                 name=os.path.splitext(os.path.basename(path))[0],
                 tile_w=2,
                 tile_h=2,
@@ -461,8 +618,25 @@ def parse_tset(path: str, error_cb: Optional[Callable[[str, int, int], None]] =
         ts.declared_count = len(ts.tiles)
     if len(ts.tiles) > ts.declared_count:
         err(f"Defined {len(ts.tiles)} tiles but TSET count={ts.declared_count}", 1)
-    if len(ts.tiles) > 255:
-        err("Too many tiles: max 255 (count stored as u8)", 1)
+    if len(ts.tiles) > TSET_MAX_TILES:
+        err(f"Too many tiles: max {TSET_MAX_TILES}", 1)
+
+    real_names = set(ts.tiles_by_name)
+    for line_no, raw_line, name, target in alias_entries:
+        name_key = name.strip().upper()
+        target_key = target.strip().upper()
+        if name_key.startswith("TILE_"):
+            name_key = name_key[5:]
+        if target_key.startswith("TILE_"):
+            target_key = target_key[5:]
+        if name_key in ts.tiles_by_name:
+            err(f"Duplicate TILE name: {name}", line_no, _col_for_token(raw_line, name))
+            continue
+        if target_key not in real_names:
+            err(f"TILE alias target must be a defined tile: {target}", line_no, _col_for_kv_value(raw_line, "alias"))
+            continue
+        ts.tiles_by_name[name_key] = ts.tiles_by_name[target_key]
+        ts.aliases[name_key] = target_key
 
     if object_entries:
         for line_no, raw_line, name in object_entries:
@@ -512,28 +686,71 @@ def parse_tset(path: str, error_cb: Optional[Callable[[str, int, int], None]] =
                 tiles=tiles_list,
             )
 
-    for line_no, ch, tile_name in charmap_entries:
-        if tile_name in ts.tiles_by_name:
-            ts.charmap_tiles[ch] = ts.tiles_by_name[tile_name]
+    for line_no, raw_line, name in platform_entries:
+        kv = parse_kv_fragment(raw_line.strip()[len(name):])
+        key = name.strip().upper()
+        if not ts.charset_path:
+            err("PLATFORMS needs charset= on the TSET line (glyphs are shifted from it)", line_no, 1)
+            break
+        if "tile" not in kv:
+            err(f"PLATFORMS entry requires tile=: {raw_line.strip()}", line_no, _col_for_token(raw_line, name))
             continue
-        obj = ts.objects.get(tile_name)
-        if obj is None:
-            err(f"CHARMAP unknown tile/object name: {tile_name}", line_no, 1)
+        tile_name = tile_key(kv["tile"])
+        axis = kv.get("axis", "V").strip().upper()
+        if key in ts.platforms:
+            err(f"Duplicate PLATFORMS name: {name}", line_no, _col_for_token(raw_line, name))
             continue
-        if obj.char and obj.char != ch:
-            err(f"OBJECT '{tile_name}' bound to multiple chars", line_no, 1)
+        if tile_name not in ts.tiles_by_name:
+            err(f"PLATFORMS unknown tile name: {tile_name}", line_no, _col_for_kv_value(raw_line, "tile"))
             continue
-        obj.char = ch
+        if axis not in ("V", "H"):
+            err(f"PLATFORMS axis must be V or H: {axis}", line_no, _col_for_kv_value(raw_line, "axis"))
+            continue
+        ts.platforms[key] = PlatformDef(name=key, tile=tile_name, axis=axis, line_no=line_no)
+
+    for line_no, raw_line, name in particle_entries:
+        kv = parse_kv_fragment(raw_line.strip()[len(name):])
+        key = name.strip().upper()
+        if key in ts.particles:
+            err(f"Duplicate PARTICLES name: {name}", line_no, _col_for_token(raw_line, name))
+            continue
+        frames_src = [f.strip() for f in kv.get("frames", "").split(",") if f.strip()]
+        if not (1 <= len(frames_src) <= PARTICLE_FRAMES_MAX) or not all(
+            re.fullmatch(r"[0-9A-Fa-f]{16}", f) for f in frames_src
+        ):
+            err(
+                f"PARTICLES {key} needs frames= with 1..{PARTICLE_FRAMES_MAX} glyphs of 16 hex digits (8 rows)",
+                line_no,
+                _col_for_kv_value(raw_line, "frames") if "frames" in kv else _col_for_token(raw_line, name),
+            )
+            continue
+        try:
+            color = parse_color(kv.get("color", "7"))
+            hold, move, dy, spread = (int(kv.get(k, d), 0) for k, d in (("hold", "4"), ("move", "0"), ("dy", "0"), ("spread", "0")))
+        except ValueError:
+            err(f"PARTICLES {key}: bad color= or number: {raw_line.strip()}", line_no, 1)
+            continue
+        if not (0 <= color <= 7):
+            err(f"PARTICLES {key}: color must be 0..7 (multicolor chars)", line_no, _col_for_kv_value(raw_line, "color"))
+            continue
+        if not (1 <= hold <= 255 and 0 <= move <= 255 and -1 <= dy <= 1 and spread in (0, 1)):
+            err(f"PARTICLES {key}: hold 1..255, move 0..255, dy -1..1, spread 0|1", line_no, 1)
+            continue
+        ts.particles[key] = ParticleDef(
+            name=key,
+            frames=[bytes.fromhex(f) for f in frames_src],
+            color=color,
+            hold=hold,
+            move=move,
+            dy=dy,
+            spread=spread,
+            line_no=line_no,
+        )
 
-    for obj in ts.objects.values():
-        if obj.char:
-            tile_ids = [ts.tiles_by_name[n] for n in obj.tiles]
-            ts.object_stamps[obj.char] = {
-                "name": obj.name,
-                "w": obj.w,
-                "h": obj.h,
-                "tiles": tile_ids,
-                "char": obj.char,
-            }
+    for line_no, ch, tile_name in charmap_entries:
+        message = ts.bind_char(ch, tile_name)
+        if message:
+            err(message, line_no, 1)
 
+    ts.finish()
     return ts